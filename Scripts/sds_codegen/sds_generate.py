@@ -421,10 +421,12 @@ class TypeInfo:
                 serialized_statement = 'let %s: Data? = %s' % ( blob_name, value_expr, )
             else:
                 serialized_statement = 'let %s: Data = %s' % ( blob_name, value_expr, )
+            # Compact blob columns may hold either format.
+            unarchive_suffix = 'Compact' if property.should_use_compact_blob() else ''
             if is_optional:
-                value_statement = 'let %s: %s? = try SDSDeserialization.optionalUnarchive(%s, name: "%s")' % ( value_name, self._swift_type, blob_name, value_name, )
+                value_statement = 'let %s: %s? = try SDSDeserialization.optionalUnarchive%s(%s, name: "%s")' % ( value_name, self._swift_type, unarchive_suffix, blob_name, value_name, )
             else:
-                value_statement = 'let %s: %s = try SDSDeserialization.unarchive(%s, name: "%s")' % ( value_name, self._swift_type, blob_name, value_name, )
+                value_statement = 'let %s: %s = try SDSDeserialization.unarchive%s(%s, name: "%s")' % ( value_name, self._swift_type, unarchive_suffix, blob_name, value_name, )
             return [ serialized_statement, value_statement,]
         elif self.is_enum and did_force_optional and not is_optional:
             return [
@@ -473,6 +475,11 @@ class TypeInfo:
             return property.field_override_serialize_record_invocation() % ( value_expr, )
         elif self.is_codable:
             pass
+        elif self.should_use_blob and property.should_use_compact_blob():
+            if is_optional or did_force_optional:
+                return 'optionalCompactArchive(%s)' % ( value_expr, )
+            else:
+                return 'requiredCompactArchive(%s)' % ( value_expr, )
         elif self.should_use_blob:
             # blob_name = '%sSerialized' % ( str(value_name), )
             if is_optional or did_force_optional:
@@ -756,6 +763,9 @@ class ParsedProperty:
     def has_custom_column_source(self):
         return custom_property_column_source(self) is not None
 
+    def should_use_compact_blob(self):
+        return should_use_compact_blob_for_property(self)
+
     def deserialize_record_invocation(self, value_name, did_force_optional):
         return self.type_info().deserialize_record_invocation(self, value_name, self.is_optional, did_force_optional)
 
@@ -2353,6 +2363,14 @@ def was_property_renamed_for_property(property):
     return renamed_column_names.get(key) is not None
 
 
+def should_use_compact_blob_for_property(property):
+    compact_blob_columns = configuration_json.get('compact_blob_columns')
+    if compact_blob_columns is None:
+        fail('Configuration JSON is missing list of compact blob columns.')
+    key = property.class_name + '.' + property.name
+    return key in compact_blob_columns
+
+
 # ---- Config JSON
 
 property_order_json = {}
@@ -1126,6 +1126,10 @@ void uncaughtExceptionHandler(NSException *exception)
 
     [AppVersion.shared mainAppLaunchDidComplete];
 
+    [SDSCompactBlobMigrator runIfNecessary];
+
+    [FullTextSearchFinder scheduleDeferredIndexingIfNecessary];
+
     if (!Environment.shared.preferences.hasGeneratedThumbnails) {
         [self.databaseStorage
             asyncReadWithBlock:^(SDSAnyReadTransaction *transaction) {
@@ -109,6 +109,12 @@ extension ConversationSearchController: UISearchResultsUpdating {
         }
         lastSearchText = searchText
 
+        FullTextSearchFinder.indexDeferredBacklogForSearch { [weak self] in
+            self?.performSearch(searchText: searchText)
+        }
+    }
+
+    private func performSearch(searchText: String) {
         var resultSet: ConversationScreenSearchResultSet?
         databaseStorage.asyncRead(block: { [weak self] transaction in
             guard let self = self else {
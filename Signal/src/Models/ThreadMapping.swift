@@ -87,7 +87,12 @@ public class ThreadMappingDiff: NSObject {
 class ThreadMapping: NSObject {
 
     private var pinnedThreads = OrderedDictionary<String, TSThread>()
-    private var unpinnedThreads: [TSThread] = []
+    private var unpinnedThreads = IndexedThreads()
+
+    // The state that the threads were last loaded with. Incremental
+    // updates are only possible if it hasn't changed since.
+    private var loadedIsViewingArchive: Bool?
+    private var loadedPinnedThreadIds: [String] = []
 
     private let pinnedSection: Int = ConversationListViewControllerSection.pinned.rawValue
     private let unpinnedSection: Int = ConversationListViewControllerSection.unpinned.rawValue
@@ -109,7 +114,7 @@ class ThreadMapping: NSObject {
 
     @objc(indexPathForUniqueId:)
     func indexPath(uniqueId: String) -> IndexPath? {
-        if let index = (unpinnedThreads.firstIndex { $0.uniqueId == uniqueId}) {
+        if let index = unpinnedThreads.index(ofUniqueId: uniqueId) {
             return IndexPath(item: index, section: unpinnedSection)
         } else if let index = (pinnedThreads.orderedKeys.firstIndex { $0 == uniqueId}) {
             return IndexPath(item: index, section: pinnedSection)
@@ -136,34 +141,37 @@ class ThreadMapping: NSObject {
         case pinnedSection:
             return pinnedThreads[safe: indexPath.item]?.value
         case unpinnedSection:
-            return unpinnedThreads[safe: indexPath.item]
+            return unpinnedThreads.thread(at: indexPath.item)
         default:
             owsFailDebug("Unexpected index path \(indexPath)")
             return nil
         }
     }
 
-    @objc(indexPathAfterThread:)
-    func indexPath(after thread: TSThread?) -> IndexPath? {
-        let isPinnedThread: Bool
-        if let thread = thread, pinnedThreads.orderedKeys.contains(thread.uniqueId) {
-            isPinnedThread = true
-        } else {
-            isPinnedThread = false
+    // Returns the section of the thread and its index within that section.
+    private func sectionAndIndex(of thread: TSThread?) -> (section: Int, index: Int?) {
+        guard let thread = thread else {
+            return (unpinnedSection, nil)
+        }
+        if let index = pinnedThreads.orderedKeys.firstIndex(of: thread.uniqueId) {
+            return (pinnedSection, index)
         }
+        return (unpinnedSection, unpinnedThreads.index(ofUniqueId: thread.uniqueId))
+    }
 
-        let section = isPinnedThread ? pinnedSection : unpinnedSection
-        let threadsInSection = isPinnedThread ? pinnedThreads.orderedValues : unpinnedThreads
+    @objc(indexPathAfterThread:)
+    func indexPath(after thread: TSThread?) -> IndexPath? {
+        let (section, index) = sectionAndIndex(of: thread)
+        let threadCount = numberOfItems(inSection: section)
 
-        guard !threadsInSection.isEmpty else { return nil }
+        guard threadCount > 0 else { return nil }
 
         let firstIndexPath = IndexPath(item: 0, section: section)
 
-        guard let thread = thread else { return firstIndexPath }
-        guard let index = threadsInSection.firstIndex(where: { $0.uniqueId == thread.uniqueId}) else { return firstIndexPath }
+        guard let threadIndex = index else { return firstIndexPath }
 
-        if index < (threadsInSection.count - 1) {
-            return IndexPath(item: index + 1, section: section)
+        if threadIndex < (threadCount - 1) {
+            return IndexPath(item: threadIndex + 1, section: section)
         } else {
             return nil
         }
@@ -171,25 +179,17 @@ class ThreadMapping: NSObject {
 
     @objc(indexPathBeforeThread:)
     func indexPath(before thread: TSThread?) -> IndexPath? {
-        let isPinnedThread: Bool
-        if let thread = thread, pinnedThreads.orderedKeys.contains(thread.uniqueId) {
-            isPinnedThread = true
-        } else {
-            isPinnedThread = false
-        }
+        let (section, index) = sectionAndIndex(of: thread)
+        let threadCount = numberOfItems(inSection: section)
 
-        let section = isPinnedThread ? pinnedSection : unpinnedSection
-        let threadsInSection = isPinnedThread ? pinnedThreads.orderedValues : unpinnedThreads
+        guard threadCount > 0 else { return nil }
 
-        guard !threadsInSection.isEmpty else { return nil }
+        let lastIndexPath = IndexPath(item: threadCount - 1, section: section)
 
-        let lastIndexPath = IndexPath(item: threadsInSection.count - 1, section: section)
+        guard let threadIndex = index else { return lastIndexPath }
 
-        guard let thread = thread else { return lastIndexPath }
-        guard let index = threadsInSection.firstIndex(where: { $0.uniqueId == thread.uniqueId}) else { return lastIndexPath }
-
-        if index > 0 {
-            return IndexPath(item: index - 1, section: section)
+        if threadIndex > 0 {
+            return IndexPath(item: threadIndex - 1, section: section)
         } else {
             return nil
         }
@@ -208,18 +208,22 @@ class ThreadMapping: NSObject {
 
     func update(isViewingArchive: Bool, transaction: SDSAnyReadTransaction) throws {
         try Bench(title: "update thread mapping (\(isViewingArchive ? "archive" : "inbox"))") {
-            archiveCount = try threadFinder.visibleThreadCount(isArchived: true, transaction: transaction)
-            inboxCount = try threadFinder.visibleThreadCount(isArchived: false, transaction: transaction)
+            try updateCounts(transaction: transaction)
             try self.loadThreads(isViewingArchive: isViewingArchive, transaction: transaction)
         }
     }
 
+    private func updateCounts(transaction: SDSAnyReadTransaction) throws {
+        archiveCount = try threadFinder.visibleThreadCount(isArchived: true, transaction: transaction)
+        inboxCount = try threadFinder.visibleThreadCount(isArchived: false, transaction: transaction)
+    }
+
     private func loadThreads(isViewingArchive: Bool, transaction: SDSAnyReadTransaction) throws {
 
         var pinnedThreads = [TSThread]()
         var threads = [TSThread]()
 
-        var pinnedThreadIds = PinnedThreadManager.pinnedThreadIds
+        let pinnedThreadIds = PinnedThreadManager.pinnedThreadIds
 
         defer {
             // Pinned threads are always ordered in the order they were pinned.
@@ -232,13 +236,17 @@ class ThreadMapping: NSObject {
                     orderedKeys: pinnedThreadIds.filter { existingPinnedThreadIds.contains($0) }
                 )
             }
-            self.unpinnedThreads = threads
+            self.unpinnedThreads = IndexedThreads(threads: threads)
+            self.loadedIsViewingArchive = isViewingArchive
+            self.loadedPinnedThreadIds = pinnedThreadIds
         }
 
         // This method is a perf hotspot. To improve perf, we try to leverage
         // the model cache. If any problems arise, we fall back to using
         // threadFinder.enumerateVisibleThreads() which is robust but expensive.
         func loadWithoutCache() throws {
+            pinnedThreads = []
+            threads = []
             try self.threadFinder.enumerateVisibleThreads(isArchived: isViewingArchive, transaction: transaction) { thread in
                 if pinnedThreadIds.contains(thread.uniqueId) {
                     pinnedThreads.append(thread)
@@ -304,6 +312,60 @@ class ThreadMapping: NSObject {
         }
     }
 
+    // Applies the changes to the updated threads to the loaded threads,
+    // without reloading the threads which didn't change. The threads
+    // which haven't been updated keep their relative order, so we only
+    // need to remove the updated threads and re-insert those which are
+    // still visible at their sorted positions.
+    //
+    // Returns false if the mapping must be reloaded instead.
+    private func updateIncrementally(isViewingArchive: Bool,
+                                     updatedThreads: [String: TSThread?],
+                                     transaction: SDSAnyReadTransaction) throws -> Bool {
+        let pinnedThreadIds = PinnedThreadManager.pinnedThreadIds
+        guard loadedIsViewingArchive == isViewingArchive,
+              loadedPinnedThreadIds == pinnedThreadIds,
+              updatedThreads.count <= UIDatabaseObserver.kMaxIncrementalRowChanges else {
+            return false
+        }
+
+        try Bench(title: "incrementally update thread mapping (\(isViewingArchive ? "archive" : "inbox"))") {
+            try updateCounts(transaction: transaction)
+
+            var pinnedThreadMap = [String: TSThread]()
+            for (threadId, thread) in pinnedThreads {
+                pinnedThreadMap[threadId] = thread
+            }
+
+            var unpinnedThreadsToInsert = [TSThread]()
+            for threadId in updatedThreads.keys {
+                pinnedThreadMap[threadId] = nil
+            }
+            for case let thread? in updatedThreads.values {
+                guard thread.shouldThreadBeVisible, thread.isArchived == isViewingArchive else {
+                    continue
+                }
+                if pinnedThreadIds.contains(thread.uniqueId) {
+                    // Pinned threads aren't shown in the archive.
+                    if !isViewingArchive {
+                        pinnedThreadMap[thread.uniqueId] = thread
+                    }
+                } else {
+                    unpinnedThreadsToInsert.append(thread)
+                }
+            }
+            unpinnedThreads.update(removingUniqueIds: Set(updatedThreads.keys),
+                                   insertingSorted: unpinnedThreadsToInsert)
+
+            // Pinned threads are always ordered in the order they were pinned.
+            pinnedThreads = OrderedDictionary(
+                keyValueMap: pinnedThreadMap,
+                orderedKeys: pinnedThreadIds.filter { pinnedThreadMap[$0] != nil }
+            )
+        }
+        return true
+    }
+
     @objc
     func updateAndCalculateDiffSwallowingErrors(isViewingArchive: Bool,
                                                 updatedItemIds: Set<String>,
@@ -325,34 +387,60 @@ class ThreadMapping: NSObject {
 
         // Ignore updates to non-visible threads.
         var updatedItemIds = Set<String>()
+        var updatedThreads = [String: TSThread?]()
         for threadId in allUpdatedItemIds {
             guard let thread = TSThread.anyFetch(uniqueId: threadId, transaction: transaction) else {
                 // Missing thread, it was deleted and should no longer be visible.
+                updatedThreads[threadId] = .some(nil)
                 continue
             }
+            updatedThreads[threadId] = thread
             if thread.shouldThreadBeVisible {
                 updatedItemIds.insert(threadId)
             }
         }
 
         let oldPinnedThreadIds: [String] = pinnedThreads.orderedKeys
-        let oldUnpinnedThreadIds: [String] = unpinnedThreads.map { $0.uniqueId }
-        try update(isViewingArchive: isViewingArchive, transaction: transaction)
+        let oldUnpinnedThreadIds: [String] = unpinnedThreads.threadIds
+        if !(try updateIncrementally(isViewingArchive: isViewingArchive,
+                                     updatedThreads: updatedThreads,
+                                     transaction: transaction)) {
+            try update(isViewingArchive: isViewingArchive, transaction: transaction)
+        }
         let newPinnedThreadIds: [String] = pinnedThreads.orderedKeys
-        let newUnpinnedThreadIds: [String] = unpinnedThreads.map { $0.uniqueId }
+        let newUnpinnedThreadIds: [String] = unpinnedThreads.threadIds
 
-        let allNewThreadIds = Set(newPinnedThreadIds + newUnpinnedThreadIds)
-
-        // We want to be economical and issue as few changes as possible.
-        // We can skip some "moves".  E.g. if we "delete" the first item,
-        // we don't need to explicitly "move" the other items up an index.
-        // In an effort to use as few "moves" as possible, we calculate
-        // the "naive" ordering that will occur after the "deletes" and
-        // "inserts," then only "move up" items that are not in their
-        // final position.  We leverage the fact that items in the
-        // conversation view only move upwards when modified.
-        var naivePinnedThreadIdOrdering = oldPinnedThreadIds
-        var naiveUnpinnedThreadIdOrdering = oldUnpinnedThreadIds
+        // The index of every thread within its section.
+        func indexMap(_ threadIds: [String]) -> [String: Int] {
+            var result = [String: Int](minimumCapacity: threadIds.count)
+            for (index, threadId) in threadIds.enumerated() {
+                result[threadId] = index
+            }
+            return result
+        }
+        let oldPinnedIndexMap = indexMap(oldPinnedThreadIds)
+        let oldUnpinnedIndexMap = indexMap(oldUnpinnedThreadIds)
+        let newPinnedIndexMap = indexMap(newPinnedThreadIds)
+        let newUnpinnedIndexMap = indexMap(newUnpinnedThreadIds)
+
+        func oldIndexPath(_ threadId: String) -> IndexPath? {
+            if let index = oldPinnedIndexMap[threadId] {
+                return IndexPath(row: index, section: pinnedSection)
+            } else if let index = oldUnpinnedIndexMap[threadId] {
+                return IndexPath(row: index, section: unpinnedSection)
+            } else {
+                return nil
+            }
+        }
+        func newIndexPath(_ threadId: String) -> IndexPath? {
+            if let index = newPinnedIndexMap[threadId] {
+                return IndexPath(row: index, section: pinnedSection)
+            } else if let index = newUnpinnedIndexMap[threadId] {
+                return IndexPath(row: index, section: unpinnedSection)
+            } else {
+                return nil
+            }
+        }
 
         var rowChanges: [ThreadMappingRowChange] = []
 
@@ -363,39 +451,15 @@ class ThreadMapping: NSObject {
         //   are deleted in reverse order, to avoid confusion around
         //   each deletion affecting the indices of subsequent deletions.
         let deletedThreadIds = (oldPinnedThreadIds + oldUnpinnedThreadIds)
-            .filter { !newPinnedThreadIds.contains($0) && !newUnpinnedThreadIds.contains($0) }
+            .filter { newIndexPath($0) == nil }
         for deletedThreadId in deletedThreadIds.reversed() {
-            let wasPinned = oldPinnedThreadIds.contains(deletedThreadId)
-            let oldThreadIds = wasPinned ? oldPinnedThreadIds : oldUnpinnedThreadIds
-            let oldSection = wasPinned ? pinnedSection : unpinnedSection
-
-            guard let oldIndex = oldThreadIds.firstIndexAsInt(of: deletedThreadId) else {
-                throw OWSAssertionError("oldIndex was unexpectedly nil")
+            guard let oldIndexPath = oldIndexPath(deletedThreadId) else {
+                throw OWSAssertionError("oldIndexPath was unexpectedly nil")
             }
-
-            owsAssertDebug(newPinnedThreadIds.firstIndexAsInt(of: deletedThreadId) == nil)
-            owsAssertDebug(newUnpinnedThreadIds.firstIndexAsInt(of: deletedThreadId) == nil)
-
             rowChanges.append(ThreadMappingRowChange(type: .delete,
                                                      uniqueRowId: deletedThreadId,
-                                                     oldIndexPath: IndexPath(row: oldIndex, section: oldSection),
+                                                     oldIndexPath: oldIndexPath,
                                                      newIndexPath: nil))
-
-            func updateNaiveThreadIdOrdering(_ naiveThreadIdOrdering: inout [String]) throws {
-                if oldIndex >= 0 && oldIndex < naiveThreadIdOrdering.count {
-                    owsAssertDebug(naiveThreadIdOrdering[oldIndex] == deletedThreadId)
-                    naiveThreadIdOrdering.remove(at: oldIndex)
-                } else {
-                    throw OWSAssertionError("Could not delete item.")
-                }
-            }
-
-            // Update naive ordering to reflect the delete.
-            if wasPinned {
-                try updateNaiveThreadIdOrdering(&naivePinnedThreadIdOrdering)
-            } else {
-                try updateNaiveThreadIdOrdering(&naiveUnpinnedThreadIdOrdering)
-            }
         }
 
         // 2. Inserts - Always perform inserts before updates.
@@ -403,107 +467,41 @@ class ThreadMapping: NSObject {
         // * The indexPath for inserts uses post-update indices.
         // * We insert in ascending order.
         let insertedThreadIds = (newPinnedThreadIds + newUnpinnedThreadIds)
-            .filter { !oldPinnedThreadIds.contains($0) && !oldUnpinnedThreadIds.contains($0) }
+            .filter { oldIndexPath($0) == nil }
         for insertedThreadId in insertedThreadIds {
-            let isPinned = newPinnedThreadIds.contains(insertedThreadId)
-            let newThreadIds = isPinned ? newPinnedThreadIds : newUnpinnedThreadIds
-            let newSection = isPinned ? pinnedSection : unpinnedSection
-
-            owsAssertDebug(oldPinnedThreadIds.firstIndexAsInt(of: insertedThreadId) == nil)
-            owsAssertDebug(oldUnpinnedThreadIds.firstIndexAsInt(of: insertedThreadId) == nil)
-
-            guard let newIndex = newThreadIds.firstIndexAsInt(of: insertedThreadId) else {
-                throw OWSAssertionError("newIndex was unexpectedly nil")
+            guard let newIndexPath = newIndexPath(insertedThreadId) else {
+                throw OWSAssertionError("newIndexPath was unexpectedly nil")
             }
             rowChanges.append(ThreadMappingRowChange(type: .insert,
-                                               uniqueRowId: insertedThreadId,
-                                               oldIndexPath: nil,
-                                               newIndexPath: IndexPath(row: newIndex, section: newSection)))
-
-            func updateNaiveThreadIdOrdering(_ naiveThreadIdOrdering: inout [String]) throws {
-                if newIndex >= 0 && newIndex <= naiveThreadIdOrdering.count {
-                    naiveThreadIdOrdering.insert(insertedThreadId, at: newIndex)
-                } else {
-                    throw OWSAssertionError("Could not insert item.")
-                }
-            }
-
-            // Update naive ordering to reflect the insert.
-            if isPinned {
-                try updateNaiveThreadIdOrdering(&naivePinnedThreadIdOrdering)
-            } else {
-                try updateNaiveThreadIdOrdering(&naiveUnpinnedThreadIdOrdering)
-            }
+                                                     uniqueRowId: insertedThreadId,
+                                                     oldIndexPath: nil,
+                                                     newIndexPath: newIndexPath))
         }
 
         // 3. Moves
         //
-        // * As noted above, we only need to "move" items whose
-        //   naive ordering doesn't reflect the final ordering.
         // * The old indexPath for moves uses pre-update indices.
         // * The new indexPath for moves uses post-update indices.
         // * We move in ascending "new" order.
-        guard allNewThreadIds == Set<String>(naivePinnedThreadIdOrdering + naiveUnpinnedThreadIdOrdering) else {
-            throw OWSAssertionError("Could not map contents.")
-        }
-
+        //
         // We first check for items that moved to a new section (e.g.
         // was pinned and is no longer pinned) because we want to perform
         // one "move" animation for it. We don't need to reload these cells
         // because the cell contents do not change between being pinned
         // and unpinned. Using an insert and delete will result in a
         // strange animation when moving to a different section.
-        let newlyPinnedThreadIds = Array(Set(newPinnedThreadIds).subtracting(oldPinnedThreadIds))
-        let newlyUnpinnedThreadIds = Array(Set(newUnpinnedThreadIds).subtracting(oldUnpinnedThreadIds))
-        let movedToNewSectionThreadIds = newlyPinnedThreadIds + newlyUnpinnedThreadIds
-
-        for threadId in movedToNewSectionThreadIds {
-            let isPinned = newPinnedThreadIds.contains(threadId)
-            let wasPinned = oldPinnedThreadIds.contains(threadId)
-            let oldThreadIds = wasPinned ? oldPinnedThreadIds : oldUnpinnedThreadIds
-            let newThreadIds = isPinned ? newPinnedThreadIds : newUnpinnedThreadIds
-
-            guard let oldIndex = oldThreadIds.firstIndexAsInt(of: threadId) else {
+        var movedThreadIds = Set<String>()
+        for threadId in newPinnedThreadIds + newUnpinnedThreadIds {
+            guard let oldIndexPath = oldIndexPath(threadId),
+                  let newIndexPath = newIndexPath(threadId),
+                  oldIndexPath.section != newIndexPath.section else {
                 continue
             }
-            guard let newIndex = newThreadIds.firstIndexAsInt(of: threadId) else {
-                throw OWSAssertionError("newIndex was unexpectedly nil.")
-            }
-
-            let oldSection = wasPinned ? pinnedSection : unpinnedSection
-            let newSection = isPinned ? pinnedSection : unpinnedSection
-
             rowChanges.append(ThreadMappingRowChange(type: .move,
                                                      uniqueRowId: threadId,
-                                                     oldIndexPath: IndexPath(row: oldIndex, section: oldSection),
-                                                     newIndexPath: IndexPath(row: newIndex, section: newSection)))
-
-            // Update naive ordering.
-            if wasPinned {
-                guard let naiveIndex = naivePinnedThreadIdOrdering.firstIndexAsInt(of: threadId) else {
-                    throw OWSAssertionError("Missing naive index")
-                }
-                naivePinnedThreadIdOrdering.remove(at: naiveIndex)
-            } else {
-                guard let naiveIndex = naiveUnpinnedThreadIdOrdering.firstIndexAsInt(of: threadId) else {
-                    throw OWSAssertionError("Missing naive index")
-                }
-                naiveUnpinnedThreadIdOrdering.remove(at: naiveIndex)
-            }
-
-            if isPinned {
-                if newIndex >= 0 && newIndex <= naivePinnedThreadIdOrdering.count {
-                    naivePinnedThreadIdOrdering.insert(threadId, at: newIndex)
-                } else {
-                    throw OWSAssertionError("Could not insert item.")
-                }
-            } else {
-                if newIndex >= 0 && newIndex <= naiveUnpinnedThreadIdOrdering.count {
-                    naiveUnpinnedThreadIdOrdering.insert(threadId, at: newIndex)
-                } else {
-                    throw OWSAssertionError("Could not insert item.")
-                }
-            }
+                                                     oldIndexPath: oldIndexPath,
+                                                     newIndexPath: newIndexPath))
+            movedThreadIds.insert(threadId)
         }
 
         // We then check for items that moved within the same section.
@@ -512,102 +510,37 @@ class ThreadMapping: NSObject {
         // performs these moves using an insert and a delete to ensure
         // that the moved item is reloaded. This is how UICollectionView
         // performs reloads internally.
-
-        var movedThreadIds = [String]()
-        let possiblyMovedWithinSectionThreadIds = allNewThreadIds
-            .subtracting(insertedThreadIds)
-            .subtracting(deletedThreadIds)
-            .subtracting(movedToNewSectionThreadIds)
-
-        for threadId in possiblyMovedWithinSectionThreadIds {
-            let isPinned = newPinnedThreadIds.contains(threadId)
-            let wasPinned = oldPinnedThreadIds.contains(threadId)
-
-            owsAssertDebug(isPinned == wasPinned)
-
-            let section = isPinned ? pinnedSection : unpinnedSection
-
-            let oldThreadIds = wasPinned ? oldPinnedThreadIds : oldUnpinnedThreadIds
-            let newThreadIds = isPinned ? newPinnedThreadIds : newUnpinnedThreadIds
-
-            guard let oldIndex = oldThreadIds.firstIndexAsInt(of: threadId) else {
-                continue
-            }
-            guard let newIndex = newThreadIds.firstIndexAsInt(of: threadId) else {
-                throw OWSAssertionError("newIndex was unexpectedly nil.")
-            }
-
-            let naiveThreadIdOrdering = wasPinned ? naivePinnedThreadIdOrdering : naiveUnpinnedThreadIdOrdering
-
-            guard let naiveIndex = naiveThreadIdOrdering.firstIndexAsInt(of: threadId) else {
-                throw OWSAssertionError("threadId not in newThreadIdOrdering.")
-            }
-            guard newIndex != naiveIndex || isPinned != wasPinned else {
-                continue
-            }
-
-            rowChanges.append(ThreadMappingRowChange(type: .move,
-                                                     uniqueRowId: threadId,
-                                                     oldIndexPath: IndexPath(row: oldIndex, section: section),
-                                                     newIndexPath: IndexPath(row: newIndex, section: section)))
-            movedThreadIds.append(threadId)
-
-            func updateNaiveThreadIdOrdering(_ naiveThreadIdOrdering: inout [String]) throws {
-                naiveThreadIdOrdering.remove(at: naiveIndex)
-
-                if newIndex >= 0 && newIndex <= naiveThreadIdOrdering.count {
-                    naiveThreadIdOrdering.insert(threadId, at: newIndex)
-                } else {
-                    throw OWSAssertionError("Could not insert item.")
-                }
-            }
-
-            // Update naive ordering.
-            if isPinned {
-                try updateNaiveThreadIdOrdering(&naivePinnedThreadIdOrdering)
-            } else {
-                try updateNaiveThreadIdOrdering(&naiveUnpinnedThreadIdOrdering)
+        //
+        // We want to be economical and issue as few changes as possible.
+        // The items which stayed within a section and kept their relative
+        // order don't need to move; every other item of the section does.
+        // We keep the largest such set of items, i.e. the longest run of
+        // items whose new indices increase in their old order.
+        func withinSectionMoves(oldThreadIds: [String],
+                                oldIndexMap: [String: Int],
+                                newIndexMap: [String: Int],
+                                section: Int) {
+            let remainingThreadIds = oldThreadIds.filter { newIndexMap[$0] != nil }
+            let stationaryThreadIds = Self.longestIncreasingSubsequence(remainingThreadIds) { newIndexMap[$0]! }
+            let threadIdsToMove = remainingThreadIds
+                .filter { !stationaryThreadIds.contains($0) }
+                .sorted { newIndexMap[$0]! < newIndexMap[$1]! }
+            for threadId in threadIdsToMove {
+                rowChanges.append(ThreadMappingRowChange(type: .move,
+                                                         uniqueRowId: threadId,
+                                                         oldIndexPath: IndexPath(row: oldIndexMap[threadId]!, section: section),
+                                                         newIndexPath: IndexPath(row: newIndexMap[threadId]!, section: section)))
+                movedThreadIds.insert(threadId)
             }
         }
-
-        func logThreadIds(_ threadIds: [String], name: String) {
-            Logger.verbose("\(name)[\(threadIds.count)]: \(threadIds.joined(separator: "\n"))")
-        }
-
-        // Once the moves are complete, the new ordering should be correct.
-        guard newPinnedThreadIds == naivePinnedThreadIdOrdering else {
-            logThreadIds(newPinnedThreadIds, name: "newPinnedThreadIds")
-            logThreadIds(oldPinnedThreadIds, name: "oldPinnedThreadIds")
-            logThreadIds(newUnpinnedThreadIds, name: "newUnpinnedThreadIds")
-            logThreadIds(oldUnpinnedThreadIds, name: "oldUnpinnedThreadIds")
-            logThreadIds(newlyPinnedThreadIds, name: "newlyPinnedThreadIds")
-            logThreadIds(newlyUnpinnedThreadIds, name: "newlyUnpinnedThreadIds")
-            logThreadIds(naivePinnedThreadIdOrdering, name: "naivePinnedThreadIdOrdering")
-            logThreadIds(naiveUnpinnedThreadIdOrdering, name: "naiveUnpinnedThreadIdOrdering")
-            logThreadIds(insertedThreadIds, name: "insertedThreadIds")
-            logThreadIds(deletedThreadIds, name: "deletedThreadIds")
-            logThreadIds(movedToNewSectionThreadIds, name: "movedToNewSectionThreadIds")
-            logThreadIds(Array(possiblyMovedWithinSectionThreadIds), name: "possiblyMovedWithinSectionThreadIds")
-            logThreadIds(movedThreadIds, name: "movedThreadIds")
-            throw OWSAssertionError("Could not reorder pinned contents.")
-        }
-
-        guard newUnpinnedThreadIds == naiveUnpinnedThreadIdOrdering else {
-            logThreadIds(newPinnedThreadIds, name: "newPinnedThreadIds")
-            logThreadIds(oldPinnedThreadIds, name: "oldPinnedThreadIds")
-            logThreadIds(newUnpinnedThreadIds, name: "newUnpinnedThreadIds")
-            logThreadIds(oldUnpinnedThreadIds, name: "oldUnpinnedThreadIds")
-            logThreadIds(newlyPinnedThreadIds, name: "newlyPinnedThreadIds")
-            logThreadIds(newlyUnpinnedThreadIds, name: "newlyUnpinnedThreadIds")
-            logThreadIds(naivePinnedThreadIdOrdering, name: "naivePinnedThreadIdOrdering")
-            logThreadIds(naiveUnpinnedThreadIdOrdering, name: "naiveUnpinnedThreadIdOrdering")
-            logThreadIds(insertedThreadIds, name: "insertedThreadIds")
-            logThreadIds(deletedThreadIds, name: "deletedThreadIds")
-            logThreadIds(movedToNewSectionThreadIds, name: "movedToNewSectionThreadIds")
-            logThreadIds(Array(possiblyMovedWithinSectionThreadIds), name: "possiblyMovedWithinSectionThreadIds")
-            logThreadIds(movedThreadIds, name: "movedThreadIds")
-            throw OWSAssertionError("Could not reorder unpinned contents.")
-        }
+        withinSectionMoves(oldThreadIds: oldPinnedThreadIds,
+                           oldIndexMap: oldPinnedIndexMap,
+                           newIndexMap: newPinnedIndexMap,
+                           section: pinnedSection)
+        withinSectionMoves(oldThreadIds: oldUnpinnedThreadIds,
+                           oldIndexMap: oldUnpinnedIndexMap,
+                           newIndexMap: newUnpinnedIndexMap,
+                           section: unpinnedSection)
 
         // 4. Updates
         //
@@ -617,29 +550,135 @@ class ThreadMapping: NSObject {
         let updatedThreadIds = updatedItemIds
             .subtracting(insertedThreadIds)
             .subtracting(deletedThreadIds)
-            .subtracting(movedToNewSectionThreadIds)
             .subtracting(movedThreadIds)
         for updatedThreadId in updatedThreadIds {
-            let wasPinned = oldPinnedThreadIds.contains(updatedThreadId)
-            let oldThreadIds = wasPinned ? oldPinnedThreadIds : oldUnpinnedThreadIds
-            let oldSection = wasPinned ? pinnedSection : unpinnedSection
-
-            guard let oldIndex = oldThreadIds.firstIndexAsInt(of: updatedThreadId) else {
-                throw OWSAssertionError("oldIndex was unexpectedly nil")
+            guard let oldIndexPath = oldIndexPath(updatedThreadId) else {
+                throw OWSAssertionError("oldIndexPath was unexpectedly nil")
             }
             rowChanges.append(ThreadMappingRowChange(type: .update,
                                                      uniqueRowId: updatedThreadId,
-                                                     oldIndexPath: IndexPath(row: oldIndex, section: oldSection),
+                                                     oldIndexPath: oldIndexPath,
                                                      newIndexPath: nil))
         }
 
         return ThreadMappingDiff(sectionChanges: [], rowChanges: rowChanges)
     }
+
+    // Returns the elements of the longest subsequence of elements
+    // whose keys strictly increase, in O(n log n).
+    static func longestIncreasingSubsequence(_ elements: [String], key: (String) -> Int) -> Set<String> {
+        // tailIndices[k] is the index of the smallest tail element of
+        // an increasing subsequence of length k + 1.
+        var tailIndices = [Int]()
+        var predecessors = [Int](repeating: -1, count: elements.count)
+        for (index, element) in elements.enumerated() {
+            let elementKey = key(element)
+            var lowerBound = 0
+            var upperBound = tailIndices.count
+            while lowerBound < upperBound {
+                let middle = (lowerBound + upperBound) / 2
+                if key(elements[tailIndices[middle]]) < elementKey {
+                    lowerBound = middle + 1
+                } else {
+                    upperBound = middle
+                }
+            }
+            if lowerBound > 0 {
+                predecessors[index] = tailIndices[lowerBound - 1]
+            }
+            if lowerBound == tailIndices.count {
+                tailIndices.append(index)
+            } else {
+                tailIndices[lowerBound] = index
+            }
+        }
+
+        var result = Set<String>()
+        var index = tailIndices.last ?? -1
+        while index >= 0 {
+            result.insert(elements[index])
+            index = predecessors[index]
+        }
+        return result
+    }
 }
 
-extension Collection where Element: Equatable {
-    func firstIndexAsInt(of element: Element) -> Int? {
-        guard let index = firstIndex(of: element) else { return nil }
-        return distance(from: startIndex, to: index)
+// MARK: -
+
+// The threads of a section, in the order they're displayed,
+// with constant time lookups of their indices.
+private struct IndexedThreads {
+    private(set) var threads: [TSThread]
+    private var indexMap: [String: Int]
+
+    init(threads: [TSThread] = []) {
+        self.threads = threads
+        var indexMap = [String: Int](minimumCapacity: threads.count)
+        for (index, thread) in threads.enumerated() {
+            indexMap[thread.uniqueId] = index
+        }
+        self.indexMap = indexMap
+        owsAssertDebug(indexMap.count == threads.count)
+    }
+
+    var count: Int { threads.count }
+
+    var isEmpty: Bool { threads.isEmpty }
+
+    var threadIds: [String] { threads.map { $0.uniqueId } }
+
+    func thread(at index: Int) -> TSThread? {
+        threads[safe: index]
+    }
+
+    func index(ofUniqueId uniqueId: String) -> Int? {
+        indexMap[uniqueId]
+    }
+
+    // Removes the threads with the given unique ids, if present,
+    // then inserts the given threads at their sorted positions.
+    //
+    // Only the indices of the threads after the first change are
+    // updated, so changes near the end of the list are cheap.
+    mutating func update(removingUniqueIds uniqueIds: Set<String>, insertingSorted threadsToInsert: [TSThread]) {
+        var firstChangedIndex = threads.count
+
+        // Remove in descending order so that the indices of the
+        // remaining threads to remove don't change.
+        let indicesToRemove = uniqueIds.compactMap { indexMap.removeValue(forKey: $0) }.sorted(by: >)
+        for index in indicesToRemove {
+            threads.remove(at: index)
+            firstChangedIndex = index
+        }
+
+        for thread in threadsToInsert {
+            owsAssertDebug(indexMap[thread.uniqueId] == nil)
+
+            var lowerBound = 0
+            var upperBound = threads.count
+            while lowerBound < upperBound {
+                let middle = (lowerBound + upperBound) / 2
+                if Self.isOrderedBefore(threads[middle], thread) {
+                    lowerBound = middle + 1
+                } else {
+                    upperBound = middle
+                }
+            }
+            threads.insert(thread, at: lowerBound)
+            firstChangedIndex = min(firstChangedIndex, lowerBound)
+        }
+
+        for index in firstChangedIndex..<threads.count {
+            indexMap[threads[index].uniqueId] = index
+        }
+        owsAssertDebug(indexMap.count == threads.count)
+    }
+
+    // Threads are sorted like AnyThreadFinder.visibleThreadIds().
+    private static func isOrderedBefore(_ lhs: TSThread, _ rhs: TSThread) -> Bool {
+        if lhs.lastInteractionRowId != rhs.lastInteractionRowId {
+            return lhs.lastInteractionRowId > rhs.lastInteractionRowId
+        }
+        return (lhs.grdbId?.int64Value ?? 0) > (rhs.grdbId?.int64Value ?? 0)
     }
 }
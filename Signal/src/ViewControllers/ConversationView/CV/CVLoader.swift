@@ -353,8 +353,16 @@ public class CVLoader: NSObject {
             return nil
         }
 
-        let cellMeasurement = buildCellMeasurement(rootComponent: rootComponent,
+        // Only re-measure items whose inputs have changed.
+        let measurementCache = CVMeasurementCache.shared
+        let cellMeasurement: CVCellMeasurement
+        if let cachedCellMeasurement = measurementCache.cellMeasurement(for: itemModel) {
+            cellMeasurement = cachedCellMeasurement
+        } else {
+            cellMeasurement = buildCellMeasurement(rootComponent: rootComponent,
                                                    conversationStyle: conversationStyle)
+            measurementCache.setCellMeasurement(cellMeasurement, for: itemModel)
+        }
 
         return CVRenderItem(itemModel: itemModel,
                             rootComponent: rootComponent,
@@ -0,0 +1,88 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+// Measuring cells is one of the most expensive parts of a CV load.
+//
+// A cell's measurement is determined by its CVComponentState, its
+// CVItemViewState and the parts of the ConversationStyle that affect
+// layout; CVRenderItem.updateMode(other:) relies on the same invariant.
+// We cache measurements by interaction and view width, and re-use them
+// as long as those inputs are unchanged. Otherwise, the item is
+// re-measured.
+//
+// The cache is shared by all conversation views, so measurements survive
+// across loads and when the user leaves and re-enters a conversation.
+class CVMeasurementCache {
+
+    static let shared = CVMeasurementCache()
+
+    private struct CacheKey: Hashable {
+        let interactionUniqueId: String
+        let viewWidth: CGFloat
+    }
+
+    private struct CacheEntry {
+        let componentState: CVComponentState
+        let itemViewState: CVItemViewState
+        let conversationStyle: ConversationStyle
+        let cellMeasurement: CVCellMeasurement
+    }
+
+    private static let cacheSize = 2048
+
+    private let unfairLock = UnfairLock()
+    // These properties should only be accessed with unfairLock.
+    private let cache = LRUCache<CacheKey, CacheEntry>(maxSize: CVMeasurementCache.cacheSize)
+    private var _hitCount: UInt = 0
+    private var _missCount: UInt = 0
+
+    func cellMeasurement(for itemModel: CVItemModel) -> CVCellMeasurement? {
+        let cacheKey = Self.cacheKey(for: itemModel)
+        return unfairLock.withLock {
+            guard let entry = cache.get(key: cacheKey),
+                  entry.componentState == itemModel.componentState,
+                  entry.itemViewState == itemModel.itemViewState,
+                  entry.conversationStyle.isEqualForCellMeasurement(itemModel.conversationStyle) else {
+                _missCount += 1
+                return nil
+            }
+            _hitCount += 1
+            return entry.cellMeasurement
+        }
+    }
+
+    func setCellMeasurement(_ cellMeasurement: CVCellMeasurement, for itemModel: CVItemModel) {
+        let cacheKey = Self.cacheKey(for: itemModel)
+        let entry = CacheEntry(componentState: itemModel.componentState,
+                               itemViewState: itemModel.itemViewState,
+                               conversationStyle: itemModel.conversationStyle,
+                               cellMeasurement: cellMeasurement)
+        unfairLock.withLock {
+            cache.set(key: cacheKey, value: entry)
+        }
+    }
+
+    private static func cacheKey(for itemModel: CVItemModel) -> CacheKey {
+        CacheKey(interactionUniqueId: itemModel.interaction.uniqueId,
+                 viewWidth: itemModel.conversationStyle.viewWidth)
+    }
+
+    func removeAll() {
+        unfairLock.withLock {
+            cache.clear()
+            _hitCount = 0
+            _missCount = 0
+        }
+    }
+
+    var hitCount: UInt {
+        unfairLock.withLock { _hitCount }
+    }
+
+    var missCount: UInt {
+        unfairLock.withLock { _missCount }
+    }
+}
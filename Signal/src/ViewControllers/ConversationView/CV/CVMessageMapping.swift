@@ -183,17 +183,16 @@ public class CVMessageMapping: NSObject {
         // their position within the current list of interactions for the
         // conversation. These "sort indices" have nothing to do with "sortIds"
         // which are auto-incremented database indices.
+        //
+        // Sort indices are resolved against rank checkpoints, so the cost of
+        // these lookups and of fetching the load window doesn't depend on how
+        // far the load window is from either end of the conversation.
         let getSortIndex = { (interactionUniqueId: String) throws -> Int in
-            // To calculate the sort index, we figure out how far we are from the newest
-            // message, and then subtract that from the conversation size. In the most
-            // common cases, this will be *substantially* faster than trying to calculate
-            // the distance from the oldest message, since most of the time the user will
-            // be scrolled towards the bottom of the conversation. The further you scroll
-            // from the bottom of the conversation, the more expensive this query will get.
-            guard let distanceFromLatest = try self.interactionFinder.distanceFromLatest(interactionUniqueId: interactionUniqueId, transaction: transaction) else {
-                throw OWSAssertionError("viewIndex was unexpectedly nil")
+            guard let sortIndex = try self.interactionFinder.sortIndex(interactionUniqueId: interactionUniqueId,
+                                                                       transaction: transaction) else {
+                throw OWSAssertionError("sortIndex was unexpectedly nil")
             }
-            return Int(conversationSize - distanceFromLatest - 1)
+            return Int(sortIndex)
         }
 
         let minIndex = 0
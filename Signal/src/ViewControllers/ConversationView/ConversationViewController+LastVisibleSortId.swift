@@ -113,6 +113,23 @@ extension ConversationViewController {
         }
     }
 
+    @objc
+    func updateVisibleAttachmentDownloads() {
+        AssertIsOnMainThread()
+
+        let renderItems = self.renderItems
+        let visibleLayoutAttributes = layout.layoutAttributesForElements(in: visibleContentRect) ?? []
+        var attachmentIds = Set<String>()
+        for indexPath in visibleLayoutAttributes.map({ $0.indexPath }) {
+            guard let renderItem = renderItems[safe: indexPath.row],
+                  let message = renderItem.interaction as? TSMessage else {
+                continue
+            }
+            attachmentIds.formUnion(message.allAttachmentIds())
+        }
+        attachmentDownloads.setVisibleAttachmentIds(attachmentIds)
+    }
+
     #if TESTABLE_BUILD
     @objc
     func logFirstAndLastVisibleItems() {
@@ -556,6 +556,7 @@ typedef enum : NSUInteger {
     [self cancelReadTimer];
     [self dismissPresentedViewControllerIfNecessary];
     [self saveLastVisibleSortIdAndOnScreenPercentage];
+    [self.attachmentDownloads setVisibleAttachmentIds:[NSSet new]];
 
     [self dismissKeyBoard];
 }
@@ -2972,6 +2973,7 @@ typedef enum : NSUInteger {
     }
 
     [self autoLoadMoreIfNecessary];
+    [self updateVisibleAttachmentDownloads];
 
     if (!self.isUserScrolling) {
         [self saveLastVisibleSortIdAndOnScreenPercentage];
@@ -178,6 +178,28 @@ NS_ASSUME_NONNULL_BEGIN
     [items addObject:[OWSTableItem itemWithTitle:@"Save plaintext database key"
                                      actionBlock:^() { [DebugUIMisc enableExternalDatabaseAccess]; }]];
 
+    [items addObject:[OWSTableItem itemWithTitle:@"Log SQL statistics"
+                                     actionBlock:^() { [GRDBQueryStatistics.shared logReport]; }]];
+
+    [items addObject:[OWSTableItem itemWithTitle:@"Reset SQL statistics"
+                                     actionBlock:^() { [GRDBQueryStatistics.shared reset]; }]];
+
+    [items addObject:[OWSTableItem itemWithTitle:@"Log key-value store statistics"
+                                     actionBlock:^() { [SDSKeyValueStoreStatistics.shared logReport]; }]];
+
+    [items addObject:[OWSTableItem itemWithTitle:@"Reset key-value store statistics"
+                                     actionBlock:^() { [SDSKeyValueStoreStatistics.shared reset]; }]];
+
+    [items addObject:[OWSTableItem itemWithTitle:@"Log WAL checkpoint metrics"
+                                     actionBlock:^() { [GRDBCheckpointMetrics.shared logMetrics]; }]];
+
+    [items addObject:[OWSTableItem itemWithTitle:@"Verify unread counts"
+                                     actionBlock:^() {
+                                         DatabaseStorageWrite(SDSDatabaseStorage.shared, ^(SDSAnyWriteTransaction *transaction) {
+                                             [ThreadUnreadCountFinder verifyAndRepairIfNecessaryWithTransaction:transaction];
+                                         });
+                                     }]];
+
     [items addObject:[OWSTableItem itemWithTitle:@"Update account attributes"
                                      actionBlock:^() { [TSAccountManager.shared updateAccountAttributes]; }]];
 
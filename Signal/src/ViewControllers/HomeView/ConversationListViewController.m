@@ -48,6 +48,9 @@ typedef NS_ENUM(NSInteger, ConversationListMode) {
 NSString *const kReminderViewPseudoGroup = @"kReminderViewPseudoGroup";
 NSString *const kArchiveButtonPseudoGroup = @"kArchiveButtonPseudoGroup";
 
+// The number of thread view models which are built at a time.
+static const NSUInteger kThreadViewModelBatchSize = 32;
+
 @interface ConversationListViewController () <UITableViewDelegate,
     UITableViewDataSource,
     UIViewControllerPreviewingDelegate,
@@ -1179,14 +1182,28 @@ NSString *const kArchiveButtonPseudoGroup = @"kArchiveButtonPseudoGroup";
         return cachedThreadViewModel;
     }
 
-    __block ThreadViewModel *_Nullable newThreadViewModel;
+    // Rows are usually requested in order, so we build the view models
+    // of the rows which follow this one in the same batch.
+    NSMutableArray<TSThread *> *threads = [NSMutableArray arrayWithObject:threadRecord];
+    NSInteger rowCount = [self.threadMapping numberOfItemsInSection:indexPath.section];
+    for (NSInteger row = indexPath.row + 1; row < rowCount && threads.count < kThreadViewModelBatchSize; row++) {
+        TSThread *thread = [self threadForIndexPath:[NSIndexPath indexPathForRow:row inSection:indexPath.section]];
+        if ([self.threadViewModelCache objectForKey:thread.uniqueId] == nil) {
+            [threads addObject:thread];
+        }
+    }
+
+    __block NSArray<ThreadViewModel *> *newThreadViewModels;
     [self.databaseStorage uiReadWithBlock:^(SDSAnyReadTransaction *transaction) {
-        newThreadViewModel = [[ThreadViewModel alloc] initWithThread:threadRecord
-                                                 forConversationList:YES
-                                                         transaction:transaction];
+        newThreadViewModels = [ThreadViewModel threadViewModelsWithThreads:threads
+                                                       forConversationList:YES
+                                                               transaction:transaction];
     }];
-    [self.threadViewModelCache setObject:newThreadViewModel forKey:threadRecord.uniqueId];
-    return newThreadViewModel;
+    for (ThreadViewModel *threadViewModel in newThreadViewModels) {
+        [self.threadViewModelCache setObject:threadViewModel forKey:threadViewModel.threadRecord.uniqueId];
+    }
+    OWSAssertDebug(newThreadViewModels.firstObject.threadRecord == threadRecord);
+    return newThreadViewModels.firstObject;
 }
 
 - (nullable UIView *)tableView:(UITableView *)tableView viewForHeaderInSection:(NSInteger)section
@@ -454,6 +454,12 @@ class ConversationSearchViewController: UITableViewController, BlockListCacheDel
 
         lastSearchText = searchText
 
+        FullTextSearchFinder.indexDeferredBacklogForSearch { [weak self] in
+            self?.performSearch(searchText: searchText)
+        }
+    }
+
+    private func performSearch(searchText: String) {
         var searchResults: HomeScreenSearchResultSet?
         self.databaseStorage.asyncRead(block: {[weak self] transaction in
             guard let strongSelf = self else { return }
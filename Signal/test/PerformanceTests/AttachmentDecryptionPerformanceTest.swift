@@ -0,0 +1,94 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+// Decrypts a large synthetic attachment and verifies that the memory
+// footprint stays bounded while doing so.
+class AttachmentDecryptionPerformanceTest: PerformanceBaseTest {
+
+    private let plaintextLength = (DebugFlags.fastPerfTests ? 50 : 500) * 1024 * 1024
+
+    // Decryption streams from file to file; this leaves plenty of
+    // headroom for the test harness and logging.
+    private let maxFootprintGrowth: UInt64 = 32 * 1024 * 1024
+
+    func testPerf_decryptLargeAttachment() throws {
+        let plaintextUrl = try writeSyntheticPlaintext(length: plaintextLength)
+        defer { try? OWSFileSystem.deleteFileIfExists(url: plaintextUrl) }
+
+        let encryptedUrl = OWSFileSystem.temporaryFileUrl()
+        defer { try? OWSFileSystem.deleteFileIfExists(url: encryptedUrl) }
+        let metadata = try Cryptography.encryptAttachment(at: plaintextUrl, output: encryptedUrl)
+
+        let outputUrl = OWSFileSystem.temporaryFileUrl()
+        defer { try? OWSFileSystem.deleteFileIfExists(url: outputUrl) }
+
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            let baselineFootprint = Self.physicalFootprint()
+            let maxFootprint = AtomicValue<UInt64>(baselineFootprint)
+            let isDecrypting = AtomicBool(true)
+            let samplerDidComplete = DispatchSemaphore(value: 0)
+            DispatchQueue.global(qos: .userInitiated).async {
+                while isDecrypting.get() {
+                    let footprint = Self.physicalFootprint()
+                    _ = maxFootprint.map { max($0, footprint) }
+                    usleep(5 * 1000)
+                }
+                samplerDidComplete.signal()
+            }
+
+            startMeasuring()
+            do {
+                try Cryptography.decryptAttachment(at: encryptedUrl, metadata: metadata, output: outputUrl)
+            } catch {
+                XCTFail("Error: \(error)")
+            }
+            stopMeasuring()
+
+            isDecrypting.set(false)
+            samplerDidComplete.wait()
+
+            let footprintGrowth = maxFootprint.get() - min(baselineFootprint, maxFootprint.get())
+            Logger.info("Footprint growth: \(footprintGrowth) bytes.")
+            XCTAssertLessThan(footprintGrowth, maxFootprintGrowth)
+            XCTAssertEqual(OWSFileSystem.fileSize(of: outputUrl)?.intValue, plaintextLength)
+        }
+    }
+
+    private func writeSyntheticPlaintext(length: Int) throws -> URL {
+        let url = OWSFileSystem.temporaryFileUrl()
+        guard FileManager.default.createFile(atPath: url.path, contents: nil) else {
+            throw OWSAssertionError("Could not create file.")
+        }
+        let fileHandle = try FileHandle(forWritingTo: url)
+        defer { fileHandle.closeFile() }
+
+        let chunk = Randomness.generateRandomBytes(Int32(1024 * 1024))
+        var remainingLength = length
+        while remainingLength > 0 {
+            let count = min(chunk.count, remainingLength)
+            fileHandle.write(chunk.prefix(count))
+            remainingLength -= count
+        }
+        return url
+    }
+
+    private static func physicalFootprint() -> UInt64 {
+        var info = task_vm_info_data_t()
+        var count = mach_msg_type_number_t(MemoryLayout<task_vm_info_data_t>.size / MemoryLayout<natural_t>.size)
+        let result = withUnsafeMutablePointer(to: &info) {
+            $0.withMemoryRebound(to: integer_t.self, capacity: Int(count)) {
+                task_info(mach_task_self_, task_flavor_t(TASK_VM_INFO), $0, &count)
+            }
+        }
+        guard result == KERN_SUCCESS else {
+            owsFailDebug("Could not sample footprint.")
+            return 0
+        }
+        return info.phys_footprint
+    }
+}
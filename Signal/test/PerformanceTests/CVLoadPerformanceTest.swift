@@ -0,0 +1,111 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import Signal
+
+// Measures headless conversation view loads: the initial load followed by
+// paging through the entire conversation, with cold and warm measurement
+// caches.
+class CVLoadPerformanceTest: PerformanceBaseTest {
+
+    private let messageCount = DebugFlags.fastPerfTests ? 500 : 5000
+
+    private var thread: TSThread!
+
+    override func setUp() {
+        super.setUp()
+
+        let thread = ContactThreadFactory().create()
+        let messageFactory = IncomingMessageFactory()
+        messageFactory.threadCreator = { _ in thread }
+        write { transaction in
+            _ = messageFactory.create(count: UInt(self.messageCount), transaction: transaction)
+        }
+        self.thread = thread
+    }
+
+    func testPerf_loadConversation_coldMeasurementCache() {
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            CVMeasurementCache.shared.removeAll()
+
+            startMeasuring()
+            let loadedCount = loadEntireConversation()
+            stopMeasuring()
+
+            XCTAssertEqual(loadedCount, messageCount)
+        }
+    }
+
+    func testPerf_loadConversation_warmMeasurementCache() {
+        CVMeasurementCache.shared.removeAll()
+        _ = loadEntireConversation()
+
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            startMeasuring()
+            let loadedCount = loadEntireConversation()
+            stopMeasuring()
+
+            XCTAssertEqual(loadedCount, messageCount)
+        }
+
+        let cache = CVMeasurementCache.shared
+        Logger.info("Measurement cache hits: \(cache.hitCount), misses: \(cache.missCount).")
+        XCTAssertGreaterThan(cache.hitCount, 0)
+    }
+
+    // MARK: -
+
+    // Returns the number of messages which were loaded. The load window
+    // is bounded, so older messages are evicted as we page through.
+    private func loadEntireConversation() -> Int {
+        let threadViewModel = databaseStorage.read { transaction in
+            ThreadViewModel(thread: self.thread, forConversationList: false, transaction: transaction)
+        }
+        let conversationStyle = ConversationStyle(type: .default,
+                                                  thread: thread,
+                                                  viewWidth: 375,
+                                                  hasWallpaper: false)
+        let coreState = CVCoreState(conversationStyle: conversationStyle, mediaCache: CVMediaCache())
+        let viewStateSnapshot = CVViewStateSnapshot.mockSnapshotForStandaloneItems(coreState: coreState)
+        let messageMapping = CVMessageMapping(thread: thread)
+
+        var renderState = CVRenderState.defaultRenderState(threadViewModel: threadViewModel,
+                                                           viewStateSnapshot: viewStateSnapshot)
+        var loadRequestBuilder = CVLoadRequest.Builder()
+        loadRequestBuilder.loadInitialMapping(focusMessageIdOnOpen: nil)
+        var loadRequest = loadRequestBuilder.build()
+        var loadedMessageIds = Set<String>()
+
+        while let request = loadRequest {
+            let loader = CVLoader(threadUniqueId: thread.uniqueId,
+                                  loadRequest: request,
+                                  viewStateSnapshot: viewStateSnapshot,
+                                  prevRenderState: renderState,
+                                  messageMapping: messageMapping)
+            let expectLoad = expectation(description: "load")
+            loader.loadPromise().done { update in
+                renderState = update.renderState
+                expectLoad.fulfill()
+            }.catch { error in
+                XCTFail("Error: \(error)")
+            }
+            waitForExpectations(timeout: 60)
+
+            for renderItem in renderState.items where renderItem.interaction is TSIncomingMessage {
+                loadedMessageIds.insert(renderItem.interactionUniqueId)
+            }
+
+            guard renderState.canLoadOlderItems else {
+                break
+            }
+            loadRequestBuilder = CVLoadRequest.Builder()
+            loadRequestBuilder.loadOlderItems()
+            loadRequest = loadRequestBuilder.build()
+        }
+
+        return loadedMessageIds.count
+    }
+}
@@ -0,0 +1,101 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalMessaging
+@testable import SignalServiceKit
+
+// Measures filtering contacts and groups as a query is typed,
+// one keystroke at a time.
+class ContactSearchPerformanceTest: PerformanceBaseTest {
+
+    private let contactCount = DebugFlags.fastPerfTests ? 300 : 3000
+    private let groupCount = DebugFlags.fastPerfTests ? 30 : 300
+    private let groupSize = DebugFlags.fastPerfTests ? 20 : 100
+
+    private let searchText = "alice smith"
+
+    private var threads = [TSThread]()
+    private var signalAccounts = [SignalAccount]()
+
+    override func setUp() {
+        super.setUp()
+
+        let addresses = (0..<contactCount).map { _ in CommonGenerator.address() }
+        signalAccounts = addresses.map { SignalAccount(address: $0) }
+
+        let contactThreadFactory = ContactThreadFactory()
+        var addressIterator = addresses.makeIterator()
+        contactThreadFactory.contactAddressBuilder = { addressIterator.next()! }
+        let groupThreadFactory = GroupThreadFactory()
+        groupThreadFactory.memberAddressesBuilder = {
+            Array(addresses.shuffled().prefix(self.groupSize))
+        }
+        write { transaction in
+            self.threads = (0..<self.contactCount).map { _ in
+                contactThreadFactory.create(transaction: transaction)
+            } + (0..<self.groupCount).map { _ in
+                groupThreadFactory.create(transaction: transaction)
+            }
+        }
+    }
+
+    // Rebuilds every index string on every keystroke, as the
+    // searchers did before their index strings were cached.
+    func testPerf_filterThreads_uncached() {
+        measureKeystrokes(isCached: false) { searchText, transaction in
+            _ = FullTextSearcher.shared.filterThreads(self.threads, searchText: searchText, transaction: transaction)
+        }
+    }
+
+    func testPerf_filterThreads_cached() {
+        measureKeystrokes(isCached: true) { searchText, transaction in
+            _ = FullTextSearcher.shared.filterThreads(self.threads, searchText: searchText, transaction: transaction)
+        }
+    }
+
+    func testPerf_filterSignalAccounts_cached() {
+        measureKeystrokes(isCached: true) { searchText, transaction in
+            _ = FullTextSearcher.shared.filterSignalAccounts(self.signalAccounts, searchText: searchText, transaction: transaction)
+        }
+    }
+
+    // MARK: -
+
+    private func measureKeystrokes(isCached: Bool, filterBlock: @escaping (String, SDSAnyReadTransaction) -> Void) {
+        let keystrokes = (1...searchText.count).map { String(searchText.prefix($0)) }
+        let clearSearchIndexCache = {
+            NotificationCenter.default.post(name: .OWSContactsManagerSignalAccountsDidChange, object: nil)
+        }
+
+        var totalDuration: TimeInterval = 0
+        var totalKeystrokeCount = 0
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            clearSearchIndexCache()
+            if isCached {
+                read { transaction in
+                    filterBlock(self.searchText, transaction)
+                }
+            }
+
+            startMeasuring()
+            let startTime = CACurrentMediaTime()
+            for keystroke in keystrokes {
+                if !isCached {
+                    clearSearchIndexCache()
+                }
+                read { transaction in
+                    filterBlock(keystroke, transaction)
+                }
+            }
+            totalDuration += CACurrentMediaTime() - startTime
+            totalKeystrokeCount += keystrokes.count
+            stopMeasuring()
+        }
+
+        let keystrokeMs = totalDuration * 1000 / Double(totalKeystrokeCount)
+        Logger.info("Cached: \(isCached), per keystroke: \(String(format: "%.2f", keystrokeMs)) ms.")
+    }
+}
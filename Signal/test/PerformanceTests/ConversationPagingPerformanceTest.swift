@@ -0,0 +1,85 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+// Measures page loads at the top, middle and bottom of a very large
+// conversation. Page loads should take about as long at any position.
+class ConversationPagingPerformanceTest: PerformanceBaseTest {
+
+    private let messageCount = DebugFlags.fastPerfTests ? 5000 : 100 * 1000
+    private let pageSize = 50
+    private let pagesPerMeasurement = 20
+
+    private var thread: TSThread!
+
+    override func setUp() {
+        super.setUp()
+
+        let thread = ContactThreadFactory().create()
+        let messageFactory = IncomingMessageFactory()
+        messageFactory.threadCreator = { _ in thread }
+        let batchSize = 1000
+        for batchStart in stride(from: 0, to: messageCount, by: batchSize) {
+            write { transaction in
+                _ = messageFactory.create(count: UInt(min(batchSize, self.messageCount - batchStart)),
+                                          transaction: transaction)
+            }
+        }
+        self.thread = thread
+    }
+
+    func testPerf_pageLoad_top() {
+        measurePageLoads(sortIndex: 0)
+    }
+
+    func testPerf_pageLoad_middle() {
+        measurePageLoads(sortIndex: messageCount / 2)
+    }
+
+    func testPerf_pageLoad_bottom() {
+        measurePageLoads(sortIndex: messageCount - pageSize)
+    }
+
+    // MARK: -
+
+    // Like CVMessageMapping, we load a page by range and then
+    // resolve the sort index of its first interaction.
+    private func measurePageLoads(sortIndex: Int) {
+        let finder = InteractionFinder(threadUniqueId: thread.uniqueId)
+        let range = NSRange(location: sortIndex, length: pageSize)
+
+        // Load the rank checkpoints outside of the measurements.
+        read { transaction in
+            XCTAssertEqual(try! finder.interactionIds(inRange: range, transaction: transaction).count, self.pageSize)
+        }
+
+        var totalDuration: TimeInterval = 0
+        var totalPageCount = 0
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            startMeasuring()
+            let startTime = CACurrentMediaTime()
+            read { transaction in
+                for _ in 0..<self.pagesPerMeasurement {
+                    var interactions = [TSInteraction]()
+                    try! finder.enumerateInteractions(range: range, transaction: transaction) { interaction, _ in
+                        interactions.append(interaction)
+                    }
+                    XCTAssertEqual(interactions.count, self.pageSize)
+                    let firstSortIndex = try! finder.sortIndex(interactionUniqueId: interactions.first!.uniqueId,
+                                                               transaction: transaction)
+                    XCTAssertEqual(firstSortIndex, UInt(sortIndex))
+                }
+            }
+            totalDuration += CACurrentMediaTime() - startTime
+            totalPageCount += pagesPerMeasurement
+            stopMeasuring()
+        }
+
+        let pageLoadMs = totalDuration * 1000 / Double(totalPageCount)
+        Logger.info("Sort index: \(sortIndex) / \(messageCount), page load: \(String(format: "%.2f", pageLoadMs)) ms.")
+    }
+}
@@ -0,0 +1,77 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+import SignalServiceKit
+
+// Compares message insert latency with FTS indexing done inline
+// vs. deferred to the background indexer.
+class FullTextSearchIndexingPerformanceTest: PerformanceBaseTest {
+
+    private let messageCount = DebugFlags.fastPerfTests ? 50 : 1000
+
+    private var wasDeferredIndexingEnabled = false
+
+    override func setUp() {
+        super.setUp()
+
+        wasDeferredIndexingEnabled = FullTextSearchFinder.isDeferredIndexingEnabled
+    }
+
+    override func tearDown() {
+        FullTextSearchFinder.isDeferredIndexingEnabled = wasDeferredIndexingEnabled
+
+        super.tearDown()
+    }
+
+    func testPerf_insertMessages_inlineIndexing() {
+        FullTextSearchFinder.isDeferredIndexingEnabled = false
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            insertMessages()
+        }
+    }
+
+    func testPerf_insertMessages_deferredIndexing() {
+        FullTextSearchFinder.isDeferredIndexingEnabled = true
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            insertMessages()
+        }
+    }
+
+    private func insertMessages() {
+        let contactThread = ContactThreadFactory().create()
+
+        // Punctuation, digits and non-ASCII text exercise normalization.
+        let messageBodies = [
+            "See you at 7:30? I'll bring the 🍕 and the board games!",
+            "Bon appétit — la crème brûlée était délicieuse.",
+            "Call me back at +1 (323) 555-1234 when you're free.",
+            String(repeating: "Lorem ipsum dolor sit amet, consectetur adipiscing elit. ", count: 8)
+        ]
+        let messages = (0..<messageCount).map { index in
+            TSOutgoingMessage(in: contactThread,
+                              messageBody: messageBodies[index % messageBodies.count],
+                              attachmentId: nil)
+        }
+
+        startMeasuring()
+        write { transaction in
+            for message in messages {
+                message.anyInsert(transaction: transaction)
+            }
+        }
+        stopMeasuring()
+
+        read { transaction in
+            XCTAssertEqual(UInt(messageCount), TSInteraction.anyCount(transaction: transaction))
+        }
+
+        // cleanup for next iteration
+        write { transaction in
+            TSThread.anyRemoveAllWithInstantation(transaction: transaction)
+            TSInteraction.anyRemoveAllWithInstantation(transaction: transaction)
+        }
+    }
+}
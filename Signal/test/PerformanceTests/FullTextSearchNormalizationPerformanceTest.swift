@@ -0,0 +1,51 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+// Compares the throughput of FTS text normalization with and
+// without the ASCII fast path.
+class FullTextSearchNormalizationPerformanceTest: PerformanceBaseTest {
+
+    private let iterationCount = DebugFlags.fastPerfTests ? 1000 : 100 * 1000
+
+    // Typical message bodies and search-as-you-type queries.
+    private let asciiTexts = [
+        "See you at 7:30? I'll bring the pizza and the board games!",
+        "Call me back at +1 (323) 555-1234 when you're free.",
+        "ok",
+        "Liza",
+        "Lizaveta +1-323",
+        String(repeating: "Lorem ipsum dolor sit amet, consectetur adipiscing elit. ", count: 8)
+    ]
+
+    func testPerf_normalizeASCII_fastPath() {
+        measureNormalize(texts: asciiTexts) { FullTextSearchFinder.normalize(text: $0) }
+    }
+
+    func testPerf_normalizeASCII_unicodePath() {
+        measureNormalize(texts: asciiTexts) { FullTextSearchFinder.normalizeUnicode(text: $0) }
+    }
+
+    // Non-ASCII text pays for the fast path's scan before falling back.
+    func testPerf_normalizeNonASCII() {
+        let texts = [
+            "Bon appétit — la crème brûlée était délicieuse.",
+            "See you at 7:30? I'll bring the 🍕 and the board games!"
+        ]
+        measureNormalize(texts: texts) { FullTextSearchFinder.normalize(text: $0) }
+    }
+
+    private func measureNormalize(texts: [String], normalize: (String) -> String) {
+        var outputLength = 0
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: true) {
+            for index in 0..<iterationCount {
+                outputLength += normalize(texts[index % texts.count]).utf8.count
+            }
+        }
+        Logger.verbose("outputLength: \(outputLength)")
+    }
+}
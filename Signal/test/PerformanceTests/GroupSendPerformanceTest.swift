@@ -0,0 +1,101 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import XCTest
+@testable import SignalServiceKit
+
+// Measures encryption and session persistence for group sends, with
+// the network mocked out.
+class GroupSendPerformanceTest: PerformanceBaseTest {
+
+    let localE164Identifier = "+13235551234"
+    let localUUID = UUID()
+
+    let localClient = LocalSignalClient()
+    let runner = TestProtocolRunner()
+
+    // MARK: - Tests
+
+    func testPerf_groupSend_10() {
+        measureGroupSend(groupSize: 10)
+    }
+
+    func testPerf_groupSend_100() {
+        measureGroupSend(groupSize: DebugFlags.fastPerfTests ? 20 : 100)
+    }
+
+    func testPerf_groupSend_500() {
+        measureGroupSend(groupSize: DebugFlags.fastPerfTests ? 50 : 500)
+    }
+
+    // MARK: -
+
+    private func measureGroupSend(groupSize: Int) {
+        identityManager.generateNewIdentityKey()
+        tsAccountManager.registerForTests(withLocalNumber: localE164Identifier, uuid: localUUID)
+
+        let groupMemberClients: [FakeSignalClient] = (0..<groupSize).map { _ in
+            FakeSignalClient.generate(e164Identifier: CommonGenerator.e164())
+        }
+        write { transaction in
+            for client in groupMemberClients {
+                try! self.runner.initialize(senderClient: self.localClient,
+                                            recipientClient: client,
+                                            transaction: transaction)
+                SignalRecipient.mark(asRegisteredAndGet: client.address,
+                                     deviceId: client.deviceId,
+                                     trustLevel: .high,
+                                     transaction: transaction)
+            }
+        }
+
+        let threadFactory = GroupThreadFactory()
+        threadFactory.memberAddressesBuilder = {
+            groupMemberClients.map { $0.address }
+        }
+        let (thread, message): (TSGroupThread, TSOutgoingMessage) = databaseStorage.write { transaction in
+            let thread = threadFactory.create(transaction: transaction)
+            let message = TSOutgoingMessage(in: thread, messageBody: "Hello", attachmentId: nil)
+            message.anyInsert(transaction: transaction)
+            return (thread, message)
+        }
+
+        let localAddress = localClient.address
+        var totalSendCount = 0
+        var totalDuration: TimeInterval = 0
+
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            let messageSends = groupMemberClients.map { client in
+                OWSMessageSend(message: message,
+                               thread: thread,
+                               address: client.address,
+                               udSendingAccess: nil,
+                               localAddress: localAddress,
+                               sendErrorBlock: nil)
+            }
+
+            startMeasuring()
+            let startTime = CACurrentMediaTime()
+            var sentCount = 0
+            GroupSendEncryptor.prepareMessageSends(messageSends) { batch in
+                // Mocked network: we just take the device messages
+                // that would have been sent.
+                for messageSend in batch {
+                    if let deviceMessages = messageSend.takePreparedDeviceMessages() {
+                        XCTAssertEqual(deviceMessages.count, 1)
+                        sentCount += 1
+                    }
+                }
+            }
+            let duration = CACurrentMediaTime() - startTime
+            stopMeasuring()
+
+            XCTAssertEqual(sentCount, groupSize)
+            totalSendCount += sentCount
+            totalDuration += duration
+        }
+
+        Logger.info("Group size: \(groupSize), sends/sec: \(Int(Double(totalSendCount) / totalDuration)).")
+    }
+}
@@ -0,0 +1,127 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+import SignalServiceKit
+
+class LRUCachePerformanceTest: PerformanceBaseTest {
+
+    // MARK: - LRUCache
+
+    func testLRUCache_1k() {
+        measureLRUCache(entryCount: 1000)
+    }
+
+    func testLRUCache_10k() {
+        measureLRUCache(entryCount: 10 * 1000)
+    }
+
+    func testLRUCache_100k() {
+        measureLRUCache(entryCount: 100 * 1000)
+    }
+
+    // MARK: - Array-backed LRU cache (the previous implementation)
+
+    func testArrayBackedLRUCache_1k() {
+        measureArrayBackedLRUCache(entryCount: 1000)
+    }
+
+    func testArrayBackedLRUCache_10k() {
+        measureArrayBackedLRUCache(entryCount: 10 * 1000)
+    }
+
+    func testArrayBackedLRUCache_100k() {
+        // The array-backed cache is quadratic; keep this run short.
+        measureArrayBackedLRUCache(entryCount: 100 * 1000, operationCount: 1000)
+    }
+
+    // MARK: -
+
+    private func operationCount(entryCount: Int) -> Int {
+        DebugFlags.fastPerfTests ? 1000 : entryCount * 2
+    }
+
+    private func measureLRUCache(entryCount: Int, operationCount: Int? = nil) {
+        let operationCount = operationCount ?? self.operationCount(entryCount: entryCount)
+        let cache = LRUCache<Int, String>(maxSize: entryCount)
+        let value = "value"
+        for key in 0..<entryCount {
+            cache.set(key: key, value: value)
+        }
+        var hitCount = 0
+
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: true) {
+            for i in 0..<operationCount {
+                let key = (i * 7919) % (entryCount * 2)
+                if cache.get(key: key) != nil {
+                    hitCount += 1
+                } else {
+                    cache.set(key: key, value: value)
+                }
+            }
+        }
+
+        Logger.verbose("hitCount: \(hitCount)")
+    }
+
+    private func measureArrayBackedLRUCache(entryCount: Int, operationCount: Int? = nil) {
+        let operationCount = operationCount ?? self.operationCount(entryCount: entryCount)
+        let cache = ArrayBackedLRUCache<Int, String>(maxSize: entryCount)
+        let value = "value"
+        for key in 0..<entryCount {
+            cache.set(key: key, value: value)
+        }
+        var hitCount = 0
+
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: true) {
+            for i in 0..<operationCount {
+                let key = (i * 7919) % (entryCount * 2)
+                if cache.get(key: key) != nil {
+                    hitCount += 1
+                } else {
+                    cache.set(key: key, value: value)
+                }
+            }
+        }
+
+        Logger.verbose("hitCount: \(hitCount)")
+    }
+}
+
+// MARK: -
+
+// The previous LRUCache implementation, retained as a baseline.
+private class ArrayBackedLRUCache<KeyType: Hashable & Equatable, ValueType> {
+
+    private var cacheMap: [KeyType: ValueType] = [:]
+    private var cacheOrder: [KeyType] = []
+    private let maxSize: Int
+
+    init(maxSize: Int) {
+        self.maxSize = maxSize
+    }
+
+    private func updateCacheOrder(key: KeyType) {
+        cacheOrder = cacheOrder.filter { $0 != key }
+        cacheOrder.append(key)
+    }
+
+    func get(key: KeyType) -> ValueType? {
+        guard let value = cacheMap[key] else {
+            return nil
+        }
+        updateCacheOrder(key: key)
+        return value
+    }
+
+    func set(key: KeyType, value: ValueType) {
+        cacheMap[key] = value
+        updateCacheOrder(key: key)
+        while cacheOrder.count > maxSize {
+            let staleKey = cacheOrder.removeFirst()
+            cacheMap.removeValue(forKey: staleKey)
+        }
+    }
+}
@@ -49,6 +49,60 @@ class MessageProcessingPerformanceTest: PerformanceBaseTest {
         }
     }
 
+    // Replays a large backlog of already-decrypted envelopes, which
+    // exercises batching and message handling without session crypto.
+    func testPerf_decryptedEnvelopeThroughput() {
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            processDecryptedEnvelopes()
+        }
+    }
+
+    func processDecryptedEnvelopes() {
+        identityManager.generateNewIdentityKey()
+        tsAccountManager.registerForTests(withLocalNumber: localE164Identifier, uuid: localUUID)
+
+        let envelopeCount: Int = DebugFlags.fastPerfTests ? 50 : 10 * 1000
+        let plaintextData = try! fakeService.buildContentData(bodyText: "Hello")
+        let envelopeDatas: [Data] = (0..<envelopeCount).map { index in
+            let envelopeBuilder = SSKProtoEnvelope.builder(timestamp: UInt64(index + 1))
+            envelopeBuilder.setType(.ciphertext)
+            envelopeBuilder.setSourceUuid(self.bobUUID.uuidString)
+            envelopeBuilder.setSourceDevice(1)
+            return try! envelopeBuilder.buildSerializedData()
+        }
+
+        let expectMessagesProcessed = expectation(description: "messages processed")
+        expectMessagesProcessed.expectedFulfillmentCount = envelopeCount
+
+        startMeasuring()
+
+        for envelopeData in envelopeDatas {
+            messageProcessor.processDecryptedEnvelopeData(
+                envelopeData,
+                plaintextData: plaintextData,
+                serverDeliveryTimestamp: 0,
+                wasReceivedByUD: false
+            ) { error in
+                XCTAssertNil(error)
+                expectMessagesProcessed.fulfill()
+            }
+        }
+
+        waitForExpectations(timeout: 120.0) { _ in
+            self.stopMeasuring()
+
+            self.read { transaction in
+                XCTAssertEqual(envelopeCount, TSInteraction.anyCount(transaction: transaction))
+            }
+
+            self.write { transaction in
+                TSInteraction.anyRemoveAllWithInstantation(transaction: transaction)
+                TSThread.anyRemoveAllWithInstantation(transaction: transaction)
+                OWSRecipientIdentity.anyRemoveAllWithInstantation(transaction: transaction)
+            }
+        }
+    }
+
     func processIncomingMessages() {
         // ensure local client has necessary "registered" state
         identityManager.generateNewIdentityKey()
@@ -0,0 +1,91 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+// Measures MessageSenderJobQueue throughput (jobs per second) with a
+// local mock sender, so that the cost of the queue's own bookkeeping
+// (job record reads and status writes) dominates.
+class MessageSenderJobQueuePerformanceTest: PerformanceBaseTest {
+
+    private let threadCount = 10
+    private let jobsPerThread = DebugFlags.fastPerfTests ? 5 : 50
+
+    override func setUp() {
+        super.setUp()
+
+        let sskEnvironment = SSKEnvironment.shared as! MockSSKEnvironment
+        sskEnvironment.messageSenderRef = MockLatencyMessageSender()
+    }
+
+    func testPerf_jobsPerSecond() {
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            sendMessages()
+        }
+    }
+
+    private func sendMessages() {
+        let jobQueue = MessageSenderJobQueue()
+        let jobCount = threadCount * jobsPerThread
+
+        write { transaction in
+            for _ in 0..<self.threadCount {
+                let thread = ContactThreadFactory().create(transaction: transaction)
+                let messageFactory = OutgoingMessageFactory()
+                messageFactory.threadCreator = { _ in thread }
+                for _ in 0..<self.jobsPerThread {
+                    let message = messageFactory.create(transaction: transaction)
+                    jobQueue.add(message: message.asPreparer, transaction: transaction)
+                }
+            }
+        }
+
+        startMeasuring()
+        let startTime = CACurrentMediaTime()
+        jobQueue.setup()
+        waitForJobsToComplete(timeout: 60)
+        let duration = CACurrentMediaTime() - startTime
+        stopMeasuring()
+
+        Logger.info("Completed \(jobCount) jobs in \(duration)s: \(Double(jobCount) / duration) jobs/sec")
+
+        // cleanup for next iteration
+        write { transaction in
+            TSInteraction.anyRemoveAllWithInstantation(transaction: transaction)
+            TSThread.anyRemoveAllWithInstantation(transaction: transaction)
+            SSKMessageSenderJobRecord.anyRemoveAllWithInstantation(transaction: transaction)
+        }
+    }
+
+    private func waitForJobsToComplete(timeout: TimeInterval) {
+        let deadline = Date().addingTimeInterval(timeout)
+        while Date() < deadline {
+            let remainingJobCount = databaseStorage.read { transaction in
+                SSKMessageSenderJobRecord.anyCount(transaction: transaction)
+            }
+            if remainingJobCount == 0 {
+                return
+            }
+            usleep(1000)
+        }
+        XCTFail("Timed out waiting for jobs.")
+    }
+}
+
+// MARK: -
+
+// Succeeds every send after a short delay, standing in for the network.
+private class MockLatencyMessageSender: MessageSender {
+    private let latency: DispatchTimeInterval = .milliseconds(5)
+
+    override func sendMessage(_ outgoingMessagePreparer: OutgoingMessagePreparer,
+                              success successHandler: @escaping () -> Void,
+                              failure failureHandler: @escaping (Error) -> Void) {
+        DispatchQueue.global().asyncAfter(deadline: .now() + latency) {
+            successHandler()
+        }
+    }
+}
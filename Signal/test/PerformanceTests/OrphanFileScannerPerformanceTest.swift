@@ -0,0 +1,90 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+@testable import SignalMessaging
+
+// Scans a synthetic attachments directory, checking each file against
+// a filter of referenced file paths, as the orphan data cleaner does.
+class OrphanFileScannerPerformanceTest: PerformanceBaseTest {
+
+    private let fileCount = DebugFlags.fastPerfTests ? 20 * 1000 : 200 * 1000
+    // The scan is interrupted (e.g. by the app resigning active)
+    // after this many files.
+    private let filesPerScan = 10 * 1000
+
+    private let keyValueStore = SDSKeyValueStore(collection: "OrphanFileScannerPerformanceTest")
+    private var rootDirPath: String!
+    private var referencedFilePaths: BloomFilter!
+
+    override func setUp() {
+        super.setUp()
+
+        // Like the attachments directory: half of the files are at the top
+        // level, and the rest are in per-attachment directories.
+        rootDirPath = OWSFileSystem.temporaryFilePath()
+        OWSFileSystem.ensureDirectoryExists(rootDirPath)
+        referencedFilePaths = BloomFilter(expectedCount: fileCount / 2)
+        let filesPerDir = 4
+        for index in 0..<fileCount / 2 {
+            let filePath = (rootDirPath as NSString).appendingPathComponent(UUID().uuidString)
+            FileManager.default.createFile(atPath: filePath, contents: nil, attributes: nil)
+            if index % 2 == 0 {
+                referencedFilePaths.insert(filePath)
+            }
+        }
+        for _ in 0..<fileCount / 2 / filesPerDir {
+            let dirPath = (rootDirPath as NSString).appendingPathComponent(UUID().uuidString)
+            OWSFileSystem.ensureDirectoryExists(dirPath)
+            for index in 0..<filesPerDir {
+                let filePath = (dirPath as NSString).appendingPathComponent("\(index).jpg")
+                FileManager.default.createFile(atPath: filePath, contents: nil, attributes: nil)
+                referencedFilePaths.insert(filePath)
+            }
+        }
+    }
+
+    override func tearDown() {
+        OWSFileSystem.deleteFileIfExists(rootDirPath)
+
+        super.tearDown()
+    }
+
+    func testPerf_scan() {
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            startMeasuring()
+            var scanCount = 0
+            var visitCount = 0
+            var orphanCount = 0
+            var didComplete = false
+            while !didComplete {
+                scanCount += 1
+                var scanVisitCount = 0
+                didComplete = self.makeScanner().scan(shouldContinue: { scanVisitCount < self.filesPerScan }) { filePath in
+                    scanVisitCount += 1
+                    if !self.referencedFilePaths.contains(filePath) {
+                        orphanCount += 1
+                    }
+                }
+                visitCount += scanVisitCount
+            }
+            stopMeasuring()
+
+            XCTAssertEqual(visitCount, fileCount)
+            XCTAssertEqual(scanCount, (fileCount + filesPerScan - 1) / filesPerScan)
+            // A referenced file is never reported as an orphan; a few
+            // orphans may be missed due to false positives.
+            let unreferencedCount = fileCount / 4
+            XCTAssertLessThanOrEqual(orphanCount, unreferencedCount)
+            XCTAssertGreaterThan(orphanCount, unreferencedCount * 99 / 100)
+            Logger.info("Files: \(fileCount), scans: \(scanCount), orphans: \(orphanCount), filter size: \(referencedFilePaths.byteCount) bytes.")
+        }
+    }
+
+    private func makeScanner() -> OrphanFileScanner {
+        OrphanFileScanner(rootDirPaths: [rootDirPath], keyValueStore: keyValueStore, cursorKey: "cursor")
+    }
+}
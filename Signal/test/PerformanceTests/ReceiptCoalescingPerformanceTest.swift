@@ -0,0 +1,121 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+// Counts the receipt store writes and receipt messages generated when
+// a busy group conversation is marked as read.
+class ReceiptCoalescingPerformanceTest: PerformanceBaseTest {
+
+    private let messageCount = 1000
+    private let senderCount = 20
+    // See OWSReceiptManager.markAsReadLocallyBeforeSortId().
+    private let batchSize = 500
+
+    private var thread: TSGroupThread!
+    private let messageFactory = IncomingMessageFactory()
+
+    private var receiptStores: [SDSKeyValueStore] {
+        [
+            OWSOutgoingReceiptManager.readReceiptStore(),
+            SDSKeyValueStore(collection: "OWSReceiptManager.toLinkedDevicesReadReceiptMapStore")
+        ]
+    }
+
+    override func setUp() {
+        super.setUp()
+
+        SDSKeyValueStoreStatistics.isEnabled = true
+
+        let senders = (0..<senderCount).map { _ in CommonGenerator.address() }
+        let groupThreadFactory = GroupThreadFactory()
+        groupThreadFactory.memberAddressesBuilder = { senders }
+        var nextTimestamp = NSDate.ows_millisecondTimeStamp()
+        messageFactory.timestampBuilder = {
+            nextTimestamp += 1
+            return nextTimestamp
+        }
+        write { transaction in
+            self.receiptManager.setAreReadReceiptsEnabled(true, transaction: transaction)
+
+            let thread = groupThreadFactory.create(transaction: transaction)
+            self.messageFactory.threadCreator = { _ in thread }
+            self.thread = thread
+        }
+    }
+
+    override func tearDown() {
+        SDSKeyValueStoreStatistics.isEnabled = DebugFlags.logSQLStatistics
+        ReceiptCoalescing.isEnabled = true
+
+        super.tearDown()
+    }
+
+    func testPerf_markAsRead_uncoalesced() {
+        measureMarkAsRead(isCoalescing: false)
+    }
+
+    func testPerf_markAsRead_coalesced() {
+        measureMarkAsRead(isCoalescing: true)
+    }
+
+    // MARK: -
+
+    private func measureMarkAsRead(isCoalescing: Bool) {
+        ReceiptCoalescing.isEnabled = isCoalescing
+
+        var readCount: UInt64 = 0
+        var writeCount: UInt64 = 0
+        var senderMessageCount = 0
+        var linkedDeviceMessageCount = 0
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            let messages = self.createUnreadMessages()
+            SDSKeyValueStoreStatistics.shared.reset()
+
+            startMeasuring()
+            let readTimestamp = NSDate.ows_millisecondTimeStamp()
+            for batchStart in stride(from: 0, to: messageCount, by: batchSize) {
+                write { transaction in
+                    for message in messages[batchStart..<min(batchStart + self.batchSize, self.messageCount)] {
+                        message.markAsRead(atTimestamp: readTimestamp,
+                                           thread: self.thread,
+                                           circumstance: .onThisDevice,
+                                           transaction: transaction)
+                    }
+                }
+            }
+            stopMeasuring()
+
+            readCount = 0
+            writeCount = 0
+            for store in self.receiptStores {
+                let entry = SDSKeyValueStoreStatistics.shared.entry(forCollection: store.collection)
+                readCount += entry?.readCount ?? 0
+                writeCount += entry?.writeCount ?? 0
+            }
+            read { transaction in
+                // The next processing passes send one message per
+                // sender, and one message to linked devices.
+                senderMessageCount = Int(OWSOutgoingReceiptManager.readReceiptStore().numberOfKeys(transaction: transaction))
+                linkedDeviceMessageCount = self.receiptStores[1].numberOfKeys(transaction: transaction) > 0 ? 1 : 0
+            }
+        }
+
+        Logger.info("Coalescing: \(isCoalescing), messages marked read: \(messageCount), receipt store reads: \(readCount), writes: \(writeCount), receipt messages: \(senderMessageCount + linkedDeviceMessageCount).")
+    }
+
+    // Also clears the receipts queued by the previous measurement.
+    private func createUnreadMessages() -> [TSIncomingMessage] {
+        var messages = [TSIncomingMessage]()
+        write { transaction in
+            for store in self.receiptStores {
+                store.removeAll(transaction: transaction)
+            }
+            messages = self.messageFactory.create(count: UInt(self.messageCount), transaction: transaction)
+        }
+        return messages
+    }
+}
@@ -0,0 +1,71 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+// Simulates the contact sync of a large account, inserting the
+// accounts one-by-one and with SDSModel.anyInsert(batch:).
+class SDSBatchInsertPerformanceTest: PerformanceBaseTest {
+
+    private let accountCount = DebugFlags.fastPerfTests ? 500 : 5000
+    // Matches the batch size of IncomingContactSyncOperation.
+    private let transactionBatchSize = 32
+
+    override func setUp() {
+        super.setUp()
+
+        try! databaseStorage.grdbStorage.setupUIDatabase()
+    }
+
+    override func tearDown() {
+        databaseStorage.grdbStorage.testing_tearDownUIDatabase()
+
+        super.tearDown()
+    }
+
+    func testPerf_insertAccounts() {
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            insertAccounts(isBatched: false)
+        }
+    }
+
+    func testPerf_insertAccountsBatched() {
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            insertAccounts(isBatched: true)
+        }
+    }
+
+    private func insertAccounts(isBatched: Bool) {
+        let accounts = (0..<accountCount).map { _ in
+            SignalAccount(address: CommonGenerator.address())
+        }
+
+        startMeasuring()
+
+        for batch in accounts.chunked(by: transactionBatchSize) {
+            write { transaction in
+                if isBatched {
+                    SignalAccount.anyInsert(batch: batch, transaction: transaction)
+                } else {
+                    for account in batch {
+                        account.anyInsert(transaction: transaction)
+                    }
+                }
+            }
+        }
+
+        stopMeasuring()
+
+        read { transaction in
+            XCTAssertEqual(SignalAccount.anyCount(transaction: transaction), UInt(self.accountCount))
+        }
+
+        // cleanup for next iteration
+        write { transaction in
+            SignalAccount.anyRemoveAllWithInstantation(transaction: transaction)
+        }
+    }
+}
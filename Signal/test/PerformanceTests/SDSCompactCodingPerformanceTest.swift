@@ -0,0 +1,61 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+import SignalServiceKit
+
+// Compares the cost of decoding the hot interaction blob columns
+// (attachmentIds and recipientAddress) in keyed-archive vs. compact format.
+class SDSCompactCodingPerformanceTest: PerformanceBaseTest {
+
+    private let interactionCount = DebugFlags.fastPerfTests ? 1000 : 100 * 1000
+
+    func testPerf_decodeKeyedArchive() {
+        measureDecode(useCompactFormat: false)
+    }
+
+    func testPerf_decodeCompact() {
+        measureDecode(useCompactFormat: true)
+    }
+
+    private func measureDecode(useCompactFormat: Bool) {
+        // Most interactions have zero or one attachment.
+        let attachmentIdsValues: [[String]] = [
+            [],
+            [UUID().uuidString],
+            [UUID().uuidString, UUID().uuidString, UUID().uuidString]
+        ]
+        let addressValues: [SignalServiceAddress] = [
+            SignalServiceAddress(uuid: UUID()),
+            SignalServiceAddress(phoneNumber: "+13213214321")
+        ]
+
+        let encode = { (value: Any) -> Data in
+            if useCompactFormat, let compactData = SDSCompactCoding.encode(value) {
+                return compactData
+            }
+            return NSKeyedArchiver.archivedData(withRootObject: value)
+        }
+        let encodedAttachmentIds = attachmentIdsValues.map(encode)
+        let encodedAddresses = addressValues.map(encode)
+
+        var decodedCount = 0
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: true) {
+            for index in 0..<interactionCount {
+                let attachmentIdsData = encodedAttachmentIds[index % encodedAttachmentIds.count]
+                let addressData = encodedAddresses[index % encodedAddresses.count]
+                let attachmentIds: [String] = try! SDSDeserialization.unarchive(attachmentIdsData,
+                                                                                name: "attachmentIds")
+                let address: SignalServiceAddress = try! SDSDeserialization.unarchive(addressData,
+                                                                                      name: "recipientAddress")
+                if address.isValid {
+                    decodedCount += attachmentIds.count + 1
+                }
+            }
+        }
+
+        Logger.verbose("decodedCount: \(decodedCount)")
+    }
+}
@@ -0,0 +1,136 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import Signal
+
+// Measures the conversation list's thread mapping for a large inbox:
+// full reloads, incremental updates when a message arrives and index
+// path lookups.
+class ThreadMappingPerformanceTest: PerformanceBaseTest {
+
+    private let threadCount = DebugFlags.fastPerfTests ? 1000 : 10 * 1000
+    private let updatesPerMeasurement = 20
+
+    private var threads = [TSThread]()
+
+    override func setUp() {
+        super.setUp()
+
+        let threadFactory = ContactThreadFactory()
+        threadFactory.messageCount = 1
+        let batchSize = 1000
+        for batchStart in stride(from: 0, to: threadCount, by: batchSize) {
+            write { transaction in
+                self.threads += (0..<min(batchSize, self.threadCount - batchStart)).map { _ in
+                    threadFactory.create(transaction: transaction)
+                }
+            }
+        }
+    }
+
+    func testPerf_fullUpdate() {
+        let mapping = ThreadMapping()
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            startMeasuring()
+            read { transaction in
+                try! mapping.update(isViewingArchive: false, transaction: transaction)
+            }
+            stopMeasuring()
+
+            XCTAssertEqual(mapping.numberOfItems(inSection: ConversationListViewControllerSection.unpinned.rawValue),
+                           threadCount)
+        }
+    }
+
+    func testPerf_incrementalUpdate() {
+        let mapping = ThreadMapping()
+        read { transaction in
+            try! mapping.update(isViewingArchive: false, transaction: transaction)
+        }
+
+        var totalDuration: TimeInterval = 0
+        var totalUpdateCount = 0
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            // A message arrives in a random thread, moving it to the top.
+            let updatedThreads = (0..<updatesPerMeasurement).map { _ in threads.randomElement()! }
+            var diffs = [ThreadMappingDiff]()
+
+            startMeasuring()
+            var duration: TimeInterval = 0
+            for thread in updatedThreads {
+                write { transaction in
+                    let messageFactory = IncomingMessageFactory()
+                    messageFactory.threadCreator = { _ in thread }
+                    _ = messageFactory.create(transaction: transaction)
+                }
+                let startTime = CACurrentMediaTime()
+                read { transaction in
+                    diffs.append(try! mapping.updateAndCalculateDiff(isViewingArchive: false,
+                                                                     updatedItemIds: [thread.uniqueId],
+                                                                     transaction: transaction))
+                }
+                duration += CACurrentMediaTime() - startTime
+            }
+            stopMeasuring()
+            totalDuration += duration
+            totalUpdateCount += updatedThreads.count
+
+            for (thread, diff) in zip(updatedThreads, diffs) {
+                let unpinnedSection = ConversationListViewControllerSection.unpinned.rawValue
+                XCTAssertEqual(diff.rowChanges.count, 1)
+                if let rowChange = diff.rowChanges.first {
+                    XCTAssertEqual(rowChange.uniqueRowId, thread.uniqueId)
+                    if rowChange.type == .move {
+                        XCTAssertEqual(rowChange.newIndexPath, IndexPath(row: 0, section: unpinnedSection))
+                    } else {
+                        // The thread was already at the top.
+                        XCTAssertEqual(rowChange.type, .update)
+                        XCTAssertEqual(rowChange.oldIndexPath, IndexPath(row: 0, section: unpinnedSection))
+                    }
+                }
+            }
+            assertMatchesFullUpdate(mapping)
+        }
+
+        let updateMs = totalDuration * 1000 / Double(totalUpdateCount)
+        Logger.info("Threads: \(threadCount), per incremental update: \(String(format: "%.3f", updateMs)) ms.")
+    }
+
+    func testPerf_indexPathLookups() {
+        let mapping = ThreadMapping()
+        read { transaction in
+            try! mapping.update(isViewingArchive: false, transaction: transaction)
+        }
+
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            startMeasuring()
+            for thread in threads {
+                XCTAssertNotNil(mapping.indexPath(uniqueId: thread.uniqueId))
+                _ = mapping.indexPath(after: thread)
+                _ = mapping.indexPath(before: thread)
+            }
+            stopMeasuring()
+        }
+    }
+
+    // MARK: -
+
+    private func threadIds(_ mapping: ThreadMapping) -> [String] {
+        let section = ConversationListViewControllerSection.unpinned.rawValue
+        return (0..<mapping.numberOfItems(inSection: section)).map {
+            mapping.thread(indexPath: IndexPath(row: $0, section: section))!.uniqueId
+        }
+    }
+
+    private func assertMatchesFullUpdate(_ mapping: ThreadMapping, file: StaticString = #file, line: UInt = #line) {
+        let fullMapping = ThreadMapping()
+        read { transaction in
+            try! fullMapping.update(isViewingArchive: false, transaction: transaction)
+        }
+        XCTAssertEqual(threadIds(mapping), threadIds(fullMapping), file: file, line: line)
+        XCTAssertEqual(mapping.inboxCount, fullMapping.inboxCount, file: file, line: line)
+    }
+}
@@ -0,0 +1,84 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalMessaging
+@testable import SignalServiceKit
+
+// Measures building the view models of every thread in a large
+// conversation list, one thread at a time and in batches.
+class ThreadViewModelPerformanceTest: PerformanceBaseTest {
+
+    private let contactThreadCount = DebugFlags.fastPerfTests ? 90 : 900
+    private let groupThreadCount = DebugFlags.fastPerfTests ? 10 : 100
+    private let messagesPerThread: UInt = 5
+
+    // Like ConversationListViewController.
+    private let batchSize = 32
+
+    private var threads = [TSThread]()
+
+    override func setUp() {
+        super.setUp()
+
+        let contactThreadFactory = ContactThreadFactory()
+        let groupThreadFactory = GroupThreadFactory()
+        write { transaction in
+            self.threads = (0..<self.contactThreadCount).map { _ in
+                contactThreadFactory.create(transaction: transaction)
+            } + (0..<self.groupThreadCount).map { _ in
+                groupThreadFactory.create(transaction: transaction)
+            }
+            for thread in self.threads {
+                let messageFactory = IncomingMessageFactory()
+                messageFactory.threadCreator = { _ in thread }
+                _ = messageFactory.create(count: self.messagesPerThread, transaction: transaction)
+            }
+        }
+    }
+
+    func testPerf_threadViewModels_perThread() {
+        measureThreadViewModels(isBatched: false)
+    }
+
+    func testPerf_threadViewModels_batched() {
+        measureThreadViewModels(isBatched: true)
+    }
+
+    // MARK: -
+
+    private func measureThreadViewModels(isBatched: Bool) {
+        var totalDuration: TimeInterval = 0
+        var totalThreadCount = 0
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            var threadViewModels = [ThreadViewModel]()
+
+            startMeasuring()
+            let startTime = CACurrentMediaTime()
+            read { transaction in
+                if isBatched {
+                    for batch in self.threads.chunked(by: self.batchSize) {
+                        threadViewModels += ThreadViewModel.threadViewModels(threads: batch,
+                                                                             forConversationList: true,
+                                                                             transaction: transaction)
+                    }
+                } else {
+                    threadViewModels = self.threads.map {
+                        ThreadViewModel(thread: $0, forConversationList: true, transaction: transaction)
+                    }
+                }
+            }
+            totalDuration += CACurrentMediaTime() - startTime
+            totalThreadCount += threads.count
+            stopMeasuring()
+
+            XCTAssertEqual(threadViewModels.count, threads.count)
+            XCTAssertTrue(threadViewModels.allSatisfy { $0.lastMessageForInbox != nil })
+        }
+
+        let threadMs = totalDuration * 1000 / Double(totalThreadCount)
+        Logger.info("Batched: \(isBatched), per thread: \(String(format: "%.3f", threadMs)) ms.")
+    }
+}
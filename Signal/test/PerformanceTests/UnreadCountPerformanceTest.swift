@@ -0,0 +1,76 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+// Compares the materialized unread counts with the COUNT(*) queries
+// they replace, on a database with many (mostly read) interactions.
+class UnreadCountPerformanceTest: PerformanceBaseTest {
+
+    private let threadCount = 20
+    private let messagesPerThread = DebugFlags.fastPerfTests ? 100 : 2500
+    private let unreadMessagesPerThread = 10
+    private let readCount = 500
+
+    private var threads = [TSThread]()
+
+    override func setUp() {
+        super.setUp()
+
+        threads = (0..<threadCount).map { _ in ContactThreadFactory().create() }
+        for thread in threads {
+            let messageFactory = IncomingMessageFactory()
+            messageFactory.threadCreator = { _ in thread }
+            write { transaction in
+                let messages = messageFactory.create(count: UInt(self.messagesPerThread), transaction: transaction)
+                for message in messages.dropLast(self.unreadMessagesPerThread) {
+                    message.markAsRead(atTimestamp: NSDate.ows_millisecondTimeStamp(),
+                                       thread: thread,
+                                       circumstance: .onLinkedDevice,
+                                       transaction: transaction)
+                }
+            }
+        }
+    }
+
+    func testPerf_materializedUnreadCounts() {
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            readUnreadCounts(thread: { thread, transaction in
+                ThreadUnreadCountFinder.unreadCount(threadUniqueId: thread.uniqueId, transaction: transaction)
+            }, allThreads: { transaction in
+                ThreadUnreadCountFinder.unreadCountInAllThreads(includeMutedThreads: false, transaction: transaction)
+            })
+        }
+    }
+
+    func testPerf_scannedUnreadCounts() {
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            readUnreadCounts(thread: { thread, transaction in
+                ThreadUnreadCountFinder.scanUnreadCount(threadUniqueId: thread.uniqueId, transaction: transaction)
+            }, allThreads: { transaction in
+                ThreadUnreadCountFinder.scanUnreadCountInAllThreads(includeMutedThreads: false, transaction: transaction)
+            })
+        }
+    }
+
+    // Simulates refreshing the badge and conversation list after
+    // each incoming batch.
+    private func readUnreadCounts(thread threadBlock: @escaping (TSThread, GRDBReadTransaction) -> UInt,
+                                  allThreads allThreadsBlock: @escaping (GRDBReadTransaction) -> UInt) {
+        startMeasuring()
+        for index in 0..<readCount {
+            read { transaction in
+                let grdbTransaction = transaction.unwrapGrdbRead
+                let allThreadsCount = allThreadsBlock(grdbTransaction)
+                XCTAssertEqual(allThreadsCount, UInt(self.threadCount * self.unreadMessagesPerThread))
+
+                let thread = self.threads[index % self.threads.count]
+                XCTAssertEqual(threadBlock(thread, grdbTransaction), UInt(self.unreadMessagesPerThread))
+            }
+        }
+        stopMeasuring()
+    }
+}
@@ -0,0 +1,97 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+// Interleaves bursts of heavy writes (e.g. message receipt) on a
+// background queue with UI reads on the main thread, and reports the
+// UI read latency alongside WAL size and checkpoint metrics.
+class WALCheckpointPerformanceTest: PerformanceBaseTest {
+
+    private let writeCount = DebugFlags.fastPerfTests ? 20 : 500
+    private let messagesPerWrite = 20
+
+    override func setUp() {
+        super.setUp()
+
+        try! databaseStorage.grdbStorage.setupUIDatabase()
+        GRDBCheckpointMetrics.shared.reset()
+    }
+
+    override func tearDown() {
+        databaseStorage.grdbStorage.testing_tearDownUIDatabase()
+
+        super.tearDown()
+    }
+
+    func testPerf_uiReadsDuringWriteBursts() {
+        measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            readDuringWriteBursts()
+        }
+    }
+
+    private func readDuringWriteBursts() {
+        let thread: TSThread = databaseStorage.write { transaction in
+            ContactThreadFactory().create(transaction: transaction)
+        }
+        let interactionFinder = InteractionFinder(threadUniqueId: thread.uniqueId)
+
+        let messageFactory = OutgoingMessageFactory()
+        messageFactory.threadCreator = { _ in thread }
+
+        let writesDidComplete = AtomicBool(false)
+        var readDurations = [TimeInterval]()
+
+        startMeasuring()
+
+        DispatchQueue.global().async {
+            for _ in 0..<self.writeCount {
+                self.databaseStorage.write { transaction in
+                    _ = messageFactory.create(count: UInt(self.messagesPerWrite), transaction: transaction)
+                }
+            }
+            writesDidComplete.set(true)
+        }
+
+        while !writesDidComplete.get() {
+            let startTime = CACurrentMediaTime()
+            databaseStorage.uiRead { transaction in
+                _ = interactionFinder.count(transaction: transaction)
+                _ = interactionFinder.mostRecentInteractionForInbox(transaction: transaction)
+            }
+            readDurations.append(CACurrentMediaTime() - startTime)
+
+            // Let the UI database snapshot update (and checkpoint).
+            RunLoop.current.run(until: Date(timeIntervalSinceNow: 0.001))
+        }
+
+        stopMeasuring()
+
+        // Let the idle passive checkpoint run.
+        RunLoop.current.run(until: Date(timeIntervalSinceNow: GRDBCheckpointScheduler.idleInterval * 2))
+
+        readDurations.sort()
+        if !readDurations.isEmpty {
+            func formatMs(_ duration: TimeInterval) -> String {
+                String(format: "%0.3fms", duration * 1000)
+            }
+            let p50 = readDurations[readDurations.count / 2]
+            let p95 = readDurations[readDurations.count * 95 / 100]
+            Logger.info("UI reads: \(readDurations.count), p50: \(formatMs(p50)), p95: \(formatMs(p95)), max: \(formatMs(readDurations.last!))")
+        }
+        GRDBCheckpointMetrics.shared.logMetrics()
+
+        let checkpointCount = (GRDBCheckpointMetrics.shared.metrics(forMode: .passive).count +
+                                GRDBCheckpointMetrics.shared.metrics(forMode: .truncate).count)
+        XCTAssertGreaterThan(checkpointCount, 0)
+
+        // cleanup for next iteration
+        write { transaction in
+            TSInteraction.anyRemoveAllWithInstantation(transaction: transaction)
+            TSThread.anyRemoveAllWithInstantation(transaction: transaction)
+        }
+    }
+}
@@ -46,5 +46,10 @@ class ConversationViewTest: SignalBaseTest {
         XCTAssertFalse(style4.isEqualForCellRendering(style1))
         XCTAssertFalse(style4.isEqualForCellRendering(style2))
         XCTAssertFalse(style4.isEqualForCellRendering(style3))
+
+        // The theme doesn't affect measurement.
+        XCTAssertTrue(style4.isEqualForCellMeasurement(style1))
+        XCTAssertTrue(style4.isEqualForCellMeasurement(style2))
+        XCTAssertFalse(style4.isEqualForCellMeasurement(style3))
     }
 }
@@ -327,6 +327,40 @@ class GRDBFullTextSearcherTest: SignalBaseTest {
         AssertEqualThreadLists([bookClubThread], threads)
     }
 
+    func testFilterThreads() {
+        // Start from an empty search index cache.
+        NotificationCenter.default.post(name: .OWSContactsManagerSignalAccountsDidChange, object: nil)
+
+        let threads = [bookClubThread, snackClubThread, aliceThread, bobEmptyThread].map { $0!.threadRecord }
+        func filterThreads(searchText: String) -> [TSThread] {
+            read { transaction in
+                self.searcher.filterThreads(threads, searchText: searchText, transaction: transaction)
+            }
+        }
+        func AssertFilteredThreads(searchText: String, _ expectedThreads: [ThreadViewModel], file: StaticString = #file, line: UInt = #line) {
+            XCTAssertEqual(filterThreads(searchText: searchText).map { $0.uniqueId },
+                           expectedThreads.map { $0.threadRecord.uniqueId },
+                           file: file,
+                           line: line)
+        }
+
+        AssertFilteredThreads(searchText: "alice", [bookClubThread, snackClubThread, aliceThread])
+        AssertFilteredThreads(searchText: "bob bark", [bookClubThread, bobEmptyThread])
+        AssertFilteredThreads(searchText: "snack", [snackClubThread])
+        AssertFilteredThreads(searchText: "1-234-56", [bookClubThread, snackClubThread, aliceThread])
+        AssertFilteredThreads(searchText: "Robert", [])
+
+        // The cached index strings are rebuilt when a profile changes.
+        let contactsManager = SSKEnvironment.shared.contactsManagerRef as! GRDBFullTextSearcherContactsManager
+        contactsManager.setMockDisplayName("Robert Barker", for: bobRecipient)
+        NotificationCenter.default.post(name: .otherUsersProfileDidChange,
+                                        object: nil,
+                                        userInfo: [kNSNotificationKey_ProfileAddress: bobRecipient!])
+        AssertFilteredThreads(searchText: "Robert", [bookClubThread, bobEmptyThread])
+        AssertFilteredThreads(searchText: "bob bark", [])
+        AssertFilteredThreads(searchText: "alice", [bookClubThread, snackClubThread, aliceThread])
+    }
+
     func testSearchMessageByBodyContent() {
         var resultSet: HomeScreenSearchResultSet = .empty
 
@@ -574,6 +608,86 @@ class GRDBFullTextSearcherTest: SignalBaseTest {
         AssertValidResultSet(query: "DEFEAT", expectedResultCount: 0)
     }
 
+    func testDeferredIndexing() {
+        let wasDeferredIndexingEnabled = FullTextSearchFinder.isDeferredIndexingEnabled
+        FullTextSearchFinder.isDeferredIndexingEnabled = true
+        defer { FullTextSearchFinder.isDeferredIndexingEnabled = wasDeferredIndexingEnabled }
+
+        var thread: TSGroupThread! = nil
+        self.write { transaction in
+            thread = try! GroupManager.createGroupForTests(members: [self.aliceRecipient, self.bobRecipient],
+                                                           name: "Lifecycle",
+                                                           transaction: transaction)
+        }
+
+        let message1 = TSOutgoingMessage(in: thread, messageBody: "This world contains glory and despair.", attachmentId: nil)
+        let message2 = TSOutgoingMessage(in: thread, messageBody: "This world contains hope and despair.", attachmentId: nil)
+
+        self.write { transaction in
+            message1.anyInsert(transaction: transaction)
+            message2.anyInsert(transaction: transaction)
+        }
+
+        // Not-yet-indexed messages are matched in memory.
+        AssertValidResultSet(query: "GLORY", expectedResultCount: 1)
+        AssertValidResultSet(query: "despair", expectedResultCount: 2)
+        AssertValidResultSet(query: "hope despair", expectedResultCount: 1)
+        AssertValidResultSet(query: "DEFEAT", expectedResultCount: 0)
+
+        self.write { transaction in
+            message2.update(withMessageBody: "This world contains hope and defeat.", transaction: transaction)
+            var indexedCount = 0
+            repeat {
+                indexedCount = GRDBFullTextSearchFinder.indexPendingBatch(transaction: transaction.unwrapGrdbWrite)
+            } while indexedCount > 0
+        }
+
+        // Once indexed, the FTS table has the latest content.
+        AssertValidResultSet(query: "GLORY", expectedResultCount: 1)
+        AssertValidResultSet(query: "despair", expectedResultCount: 1)
+        AssertValidResultSet(query: "DEFEAT", expectedResultCount: 1)
+
+        // Edits to indexed messages are visible before they're re-indexed.
+        self.write { transaction in
+            message1.update(withMessageBody: "This world contains glory and defeat.", transaction: transaction)
+        }
+        AssertValidResultSet(query: "despair", expectedResultCount: 0)
+        AssertValidResultSet(query: "DEFEAT", expectedResultCount: 2)
+    }
+
+    func testDeferredIndexingBacklog() {
+        let wasDeferredIndexingEnabled = FullTextSearchFinder.isDeferredIndexingEnabled
+        FullTextSearchFinder.isDeferredIndexingEnabled = true
+        defer { FullTextSearchFinder.isDeferredIndexingEnabled = wasDeferredIndexingEnabled }
+
+        var thread: TSGroupThread! = nil
+        self.write { transaction in
+            thread = try! GroupManager.createGroupForTests(members: [self.aliceRecipient, self.bobRecipient],
+                                                           name: "Lifecycle",
+                                                           transaction: transaction)
+        }
+
+        // Queue more messages than searches match in memory; the oldest
+        // is the only match.
+        self.write { transaction in
+            TSOutgoingMessage(in: thread, messageBody: "This world contains glory.", attachmentId: nil)
+                .anyInsert(transaction: transaction)
+            for _ in 0..<500 {
+                TSOutgoingMessage(in: thread, messageBody: "This world contains despair.", attachmentId: nil)
+                    .anyInsert(transaction: transaction)
+            }
+        }
+
+        // The backlog is indexed before searching, so the match isn't dropped.
+        let expectIndexed = expectation(description: "indexed")
+        FullTextSearchFinder.indexDeferredBacklogForSearch {
+            expectIndexed.fulfill()
+        }
+        waitForExpectations(timeout: 10)
+
+        AssertValidResultSet(query: "GLORY", expectedResultCount: 1)
+    }
+
     // MARK: - Perf
 
     func testPerf() {
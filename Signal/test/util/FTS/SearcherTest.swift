@@ -5,6 +5,7 @@
 import XCTest
 @testable import Signal
 @testable import SignalMessaging
+@testable import SignalServiceKit
 
 class SearcherTest: SignalBaseTest {
 
@@ -103,5 +104,43 @@ class SearcherTest: SignalBaseTest {
         XCTAssertEqual(FullTextSearchFinder.normalize(text: "\"\\ `~!@#$%^&*()_+-={}|[]:;'<>?,./Liza +1-323"), "Liza 1323")
         XCTAssertEqual(FullTextSearchFinder.normalize(text: "renaldo RENALDO reñaldo REÑALDO"), "renaldo RENALDO reñaldo REÑALDO")
         XCTAssertEqual(FullTextSearchFinder.normalize(text: "😏"), "😏")
+        XCTAssertEqual(FullTextSearchFinder.normalize(text: "  Liza\t\r\nLizaveta  "), "LizaLizaveta")
+        XCTAssertEqual(FullTextSearchFinder.normalize(text: " - "), "")
+        XCTAssertEqual(FullTextSearchFinder.normalize(text: ""), "")
+    }
+
+    func testTextNormalizationASCIIFastPath() {
+        XCTAssertEqual(FullTextSearchFinder.normalizeASCII(text: "Liza +1-323"), "Liza 1323")
+        XCTAssertNil(FullTextSearchFinder.normalizeASCII(text: "reñaldo"))
+        XCTAssertNil(FullTextSearchFinder.normalizeASCII(text: "😏"))
+
+        // Differential fuzzing against the Unicode path. Mostly ASCII so
+        // that the fast path is exercised, with some non-ASCII scalars
+        // (combining marks, non-ASCII whitespace, emoji) mixed in.
+        let asciiScalars = (0..<0x80).map { UnicodeScalar(UInt8($0)) }
+        let nonASCIIScalars: [UnicodeScalar] = ["\u{A0}", "\u{85}", "\u{2028}", "\u{3000}", "\u{301}", "ñ", "é", "ß", "Ø", "😏"]
+        for iteration in 0..<10 * 1000 {
+            let length = Int.random(in: 0...32)
+            let includeNonASCII = iteration % 10 == 0
+            var scalars = String.UnicodeScalarView()
+            for _ in 0..<length {
+                if includeNonASCII && Int.random(in: 0..<4) == 0 {
+                    scalars.append(nonASCIIScalars.randomElement()!)
+                } else {
+                    scalars.append(asciiScalars.randomElement()!)
+                }
+            }
+            let text = String(scalars)
+
+            let expected = FullTextSearchFinder.normalizeUnicode(text: text)
+            let actual = FullTextSearchFinder.normalize(text: text)
+            XCTAssertEqual(Array(expected.utf8), Array(actual.utf8), "text: \(text.debugDescription)")
+
+            if let fastPathResult = FullTextSearchFinder.normalizeASCII(text: text) {
+                XCTAssertEqual(Array(expected.utf8), Array(fastPathResult.utf8), "text: \(text.debugDescription)")
+            } else {
+                XCTAssert(text.unicodeScalars.contains { !$0.isASCII }, "text: \(text.debugDescription)")
+            }
+        }
     }
 }
@@ -0,0 +1,107 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import XCTest
+@testable import SignalServiceKit
+@testable import SignalMessaging
+
+class OrphanFileScannerTest: SignalBaseTest {
+
+    private let keyValueStore = SDSKeyValueStore(collection: "OrphanFileScannerTest")
+    private var rootDirPaths = [String]()
+    private var filePaths = [String]()
+
+    override func setUp() {
+        super.setUp()
+
+        // Two roots; the first has nested directories.
+        rootDirPaths = [OWSFileSystem.temporaryFilePath(), OWSFileSystem.temporaryFilePath()]
+        for (rootIndex, rootDirPath) in rootDirPaths.enumerated() {
+            for dirName in ["a", "b", "c"] {
+                let dirPath = rootIndex == 0 ? (rootDirPath as NSString).appendingPathComponent(dirName) : rootDirPath
+                OWSFileSystem.ensureDirectoryExists(dirPath)
+                for fileIndex in 0..<5 {
+                    let filePath = (dirPath as NSString).appendingPathComponent("\(dirName)-\(fileIndex)")
+                    FileManager.default.createFile(atPath: filePath, contents: Data(), attributes: nil)
+                    filePaths.append(filePath)
+                }
+            }
+        }
+    }
+
+    override func tearDown() {
+        for rootDirPath in rootDirPaths {
+            OWSFileSystem.deleteFileIfExists(rootDirPath)
+        }
+
+        super.tearDown()
+    }
+
+    // Directory listings are split into batches of two entries, so that
+    // every directory spans several batches.
+    private func makeScanner(cursorKey: String = "cursor") -> OrphanFileScanner {
+        OrphanFileScanner(rootDirPaths: rootDirPaths,
+                          keyValueStore: keyValueStore,
+                          cursorKey: cursorKey,
+                          checkpointInterval: 4,
+                          listingBatchSize: 2)
+    }
+
+    func testScan() {
+        var visitedPaths = [String]()
+        XCTAssertTrue(makeScanner().scan(shouldContinue: { true }) { visitedPaths.append($0) })
+
+        XCTAssertEqual(visitedPaths, filePaths)
+        XCTAssertFalse(makeScanner().hasScanInProgress)
+    }
+
+    func testResume() {
+        var visitedPaths = [String]()
+        var scanCount = 0
+        // Stop every 7 files, which is out of step with the checkpoints.
+        while true {
+            scanCount += 1
+            var visitCount = 0
+            let didComplete = makeScanner().scan(shouldContinue: { visitCount < 7 }) { filePath in
+                visitCount += 1
+                visitedPaths.append(filePath)
+            }
+            if didComplete {
+                break
+            }
+            XCTAssertTrue(makeScanner().hasScanInProgress)
+        }
+
+        // Each file is visited exactly once, in order.
+        XCTAssertEqual(visitedPaths, filePaths)
+        XCTAssertEqual(scanCount, filePaths.count / 7 + 1)
+        XCTAssertFalse(makeScanner().hasScanInProgress)
+    }
+
+    func testResumeAfterCheckpointedFileIsDeleted() {
+        var visitedPaths = [String]()
+        XCTAssertFalse(makeScanner().scan(shouldContinue: { visitedPaths.count < 3 }) { visitedPaths.append($0) })
+
+        // Delete the last visited file, as the visitor would for an orphan.
+        XCTAssertTrue(OWSFileSystem.deleteFile(visitedPaths.last!))
+
+        XCTAssertTrue(makeScanner().scan(shouldContinue: { true }) { visitedPaths.append($0) })
+        XCTAssertEqual(visitedPaths, filePaths)
+    }
+
+    func testScansWithSeparateCursorsDoNotInterfere() {
+        var visitedPaths = [String]()
+        XCTAssertFalse(makeScanner().scan(shouldContinue: { visitedPaths.count < 9 }) { visitedPaths.append($0) })
+
+        // A complete scan with another cursor, e.g. an audit, leaves the
+        // interrupted scan in progress.
+        var auditedPaths = [String]()
+        XCTAssertTrue(makeScanner(cursorKey: "auditCursor").scan(shouldContinue: { true }) { auditedPaths.append($0) })
+        XCTAssertEqual(auditedPaths, filePaths)
+        XCTAssertTrue(makeScanner().hasScanInProgress)
+
+        XCTAssertTrue(makeScanner().scan(shouldContinue: { true }) { visitedPaths.append($0) })
+        XCTAssertEqual(visitedPaths, filePaths)
+    }
+}
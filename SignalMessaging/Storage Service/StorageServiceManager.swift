@@ -1065,6 +1065,10 @@ class StorageServiceOperation: OWSOperation {
             return StorageService.fetchItems(for: newOrUpdatedItems)
         }.done(on: .global()) { items in
             self.databaseStorage.write { transaction in
+                // Insert recipients for new contacts in bulk before merging.
+                SignalRecipient.insertRegisteredRecipients(forNewAddresses: items.compactMap { $0.contactRecord?.serviceAddress },
+                                                           transaction: transaction)
+
                 for item in items {
                     if let contactRecord = item.contactRecord {
                         self.mergeContactRecordWithLocalContactAndUpdateState(
@@ -35,9 +35,42 @@ public class ThreadViewModel: NSObject {
     public let conversationListInfo: ConversationListInfo?
 
     @objc
-    public init(thread: TSThread, forConversationList: Bool, transaction: SDSAnyReadTransaction) {
+    public convenience init(thread: TSThread, forConversationList: Bool, transaction: SDSAnyReadTransaction) {
+        self.init(thread: thread,
+                  forConversationList: forConversationList,
+                  attributes: PrefetchedAttributes(thread: thread, transaction: transaction),
+                  transaction: transaction)
+    }
+
+    // Builds the view models for many threads at once, e.g. for the rows
+    // of the conversation list. Most attributes are loaded with one query
+    // per batch rather than one query per thread.
+    @objc
+    public static func threadViewModels(threads: [TSThread],
+                                        forConversationList: Bool,
+                                        transaction: SDSAnyReadTransaction) -> [ThreadViewModel] {
+        let attributesMap = PrefetchedAttributes.attributesMap(threads: threads, transaction: transaction)
+        return threads.map { thread in
+            let attributes: PrefetchedAttributes
+            if let prefetchedAttributes = attributesMap[thread.uniqueId] {
+                attributes = prefetchedAttributes
+            } else {
+                owsFailDebug("Missing attributes for thread.")
+                attributes = PrefetchedAttributes(thread: thread, transaction: transaction)
+            }
+            return ThreadViewModel(thread: thread,
+                                   forConversationList: forConversationList,
+                                   attributes: attributes,
+                                   transaction: transaction)
+        }
+    }
+
+    private init(thread: TSThread,
+                 forConversationList: Bool,
+                 attributes: PrefetchedAttributes,
+                 transaction: SDSAnyReadTransaction) {
         self.threadRecord = thread
-        self.disappearingMessagesConfiguration = thread.disappearingMessagesConfiguration(with: transaction)
+        self.disappearingMessagesConfiguration = attributes.disappearingMessagesConfiguration
 
         self.isGroupThread = thread.isGroupThread
         self.name = Self.contactsManager.displayName(for: thread, transaction: transaction)
@@ -50,16 +83,14 @@ public class ThreadViewModel: NSObject {
             self.contactAddress = nil
         }
 
-        let unreadCount = InteractionFinder(threadUniqueId: thread.uniqueId).unreadCount(transaction: transaction.unwrapGrdbRead)
+        let unreadCount = attributes.unreadCount
         self.unreadCount = unreadCount
         self.hasUnreadMessages = thread.isMarkedUnread || unreadCount > 0
         self.hasPendingMessageRequest = thread.hasPendingMessageRequest(transaction: transaction.unwrapGrdbRead)
 
-        self.groupCallInProgress = GRDBInteractionFinder.unendedCallsForGroupThread(thread, transaction: transaction)
-            .filter { $0.joinedMemberAddresses.count > 0 }
-            .count > 0
+        self.groupCallInProgress = attributes.groupCallInProgress
 
-        self.lastMessageForInbox = thread.lastInteractionForInbox(transaction: transaction)
+        self.lastMessageForInbox = attributes.lastMessageForInbox
 
         if forConversationList {
             conversationListInfo = ConversationListInfo(thread: thread,
@@ -69,7 +100,7 @@ public class ThreadViewModel: NSObject {
             conversationListInfo = nil
         }
 
-        self.hasWallpaper = Wallpaper.exists(for: thread, transaction: transaction)
+        self.hasWallpaper = attributes.hasWallpaper
     }
 
     @objc
@@ -84,6 +115,79 @@ public class ThreadViewModel: NSObject {
 
 // MARK: -
 
+// The attributes of a thread view model which can be loaded
+// for many threads at once.
+private struct PrefetchedAttributes {
+    let unreadCount: UInt
+    let groupCallInProgress: Bool
+    let lastMessageForInbox: TSInteraction?
+    let disappearingMessagesConfiguration: OWSDisappearingMessagesConfiguration
+    let hasWallpaper: Bool
+
+    init(unreadCount: UInt,
+         groupCallInProgress: Bool,
+         lastMessageForInbox: TSInteraction?,
+         disappearingMessagesConfiguration: OWSDisappearingMessagesConfiguration,
+         hasWallpaper: Bool) {
+        self.unreadCount = unreadCount
+        self.groupCallInProgress = groupCallInProgress
+        self.lastMessageForInbox = lastMessageForInbox
+        self.disappearingMessagesConfiguration = disappearingMessagesConfiguration
+        self.hasWallpaper = hasWallpaper
+    }
+
+    init(thread: TSThread, transaction: SDSAnyReadTransaction) {
+        self.unreadCount = InteractionFinder(threadUniqueId: thread.uniqueId).unreadCount(transaction: transaction.unwrapGrdbRead)
+        self.groupCallInProgress = GRDBInteractionFinder.unendedCallsForGroupThread(thread, transaction: transaction)
+            .filter { $0.joinedMemberAddresses.count > 0 }
+            .count > 0
+        self.lastMessageForInbox = thread.lastInteractionForInbox(transaction: transaction)
+        self.disappearingMessagesConfiguration = thread.disappearingMessagesConfiguration(with: transaction)
+        self.hasWallpaper = Wallpaper.exists(for: thread, transaction: transaction)
+    }
+
+    // Keyed by thread unique id.
+    static func attributesMap(threads: [TSThread], transaction: SDSAnyReadTransaction) -> [String: PrefetchedAttributes] {
+        let threadUniqueIds = threads.map { $0.uniqueId }
+        let groupThreadUniqueIds = threads.filter { $0.isGroupThread }.map { $0.uniqueId }
+
+        let unreadCounts = ThreadUnreadCountFinder.unreadCounts(threadUniqueIds: threadUniqueIds,
+                                                                transaction: transaction.unwrapGrdbRead)
+        let groupCallThreadUniqueIds = GRDBInteractionFinder.threadUniqueIdsWithGroupCallInProgress(
+            threadUniqueIds: groupThreadUniqueIds,
+            transaction: transaction
+        )
+        let lastMessagesForInbox = GRDBInteractionFinder.mostRecentInteractionsForInbox(
+            threadUniqueIds: threadUniqueIds,
+            transaction: transaction.unwrapGrdbRead
+        )
+        let disappearingMessagesConfigurations = OWSDisappearingMessagesConfiguration.fetchOrBuildDefaults(
+            threads: threads,
+            transaction: transaction
+        )
+        let hasWallpapers = Wallpaper.exists(for: threads, transaction: transaction)
+
+        var result = [String: PrefetchedAttributes]()
+        for thread in threads {
+            let threadUniqueId = thread.uniqueId
+            guard let disappearingMessagesConfiguration = disappearingMessagesConfigurations[threadUniqueId] else {
+                owsFailDebug("Missing disappearing messages configuration.")
+                continue
+            }
+            result[threadUniqueId] = PrefetchedAttributes(
+                unreadCount: unreadCounts[threadUniqueId] ?? 0,
+                groupCallInProgress: groupCallThreadUniqueIds.contains(threadUniqueId),
+                lastMessageForInbox: lastMessagesForInbox[threadUniqueId],
+                disappearingMessagesConfiguration: disappearingMessagesConfiguration,
+                hasWallpaper: hasWallpapers[threadUniqueId] ?? false
+            )
+        }
+        return result
+    }
+}
+
+// MARK: -
+
 @objc
 public class ConversationListInfo: NSObject {
 
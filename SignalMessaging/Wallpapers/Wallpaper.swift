@@ -133,6 +133,21 @@ public enum Wallpaper: String, CaseIterable {
         return true
     }
 
+    // The batch equivalent of exists(for:transaction:), keyed by thread unique id.
+    public static func exists(for threads: [TSThread], transaction: SDSAnyReadTransaction) -> [String: Bool] {
+        // Only a handful of threads have their own wallpaper,
+        // so we read the keys once rather than once per thread.
+        let keys = Set(allKeys(transaction: transaction))
+        let globalExists = keys.contains(key(for: nil)) && exists(transaction: transaction)
+
+        var result = [String: Bool]()
+        for thread in threads {
+            let key = self.key(for: thread)
+            result[thread.uniqueId] = globalExists || (keys.contains(key) && get(for: key, transaction: transaction) != nil)
+        }
+        return result
+    }
+
     public static func dimInDarkMode(for thread: TSThread? = nil, transaction: SDSAnyReadTransaction) -> Bool {
         guard let dimInDarkMode = getDimInDarkMode(for: thread, transaction: transaction) else {
             if thread != nil { return self.dimInDarkMode(transaction: transaction) }
@@ -247,6 +262,10 @@ fileprivate extension Wallpaper {
         return get(for: key(for: thread), transaction: transaction)
     }
 
+    static func allKeys(transaction: SDSAnyReadTransaction) -> [String] {
+        return enumStore.allKeys(transaction: transaction)
+    }
+
     static func get(for key: String, transaction: SDSAnyReadTransaction) -> Wallpaper? {
         guard let rawValue = enumStore.getString(key, transaction: transaction) else {
             return nil
@@ -209,6 +209,9 @@ public class IncomingContactSyncOperation: OWSOperation, DurableOperation {
                 while let contacts = try Self.buildBatch(contactStream: contactStream) {
                     try databaseStorage.write { transaction in
                         try autoreleasepool {
+                            // Insert the batch's new accounts before processing
+                            // the threads, which are indexed using them.
+                            try self.processSignalAccounts(contacts: contacts, transaction: transaction)
                             for contact in contacts {
                                 try self.process(contactDetails: contact, transaction: transaction)
                             }
@@ -227,7 +230,9 @@ public class IncomingContactSyncOperation: OWSOperation, DurableOperation {
     }
 
     private static func buildBatch(contactStream: ContactsInputStream) throws -> [ContactDetails]? {
-        let batchSize = 8
+        // New accounts are inserted in bulk, so larger batches are cheaper
+        // per contact, but we still want to avoid long-running write transactions.
+        let batchSize = 32
         var contacts = [ContactDetails]()
         while contacts.count < batchSize,
               let contact = try contactStream.decodeContact() {
@@ -239,43 +244,58 @@ public class IncomingContactSyncOperation: OWSOperation, DurableOperation {
         return contacts
     }
 
-    private func process(contactDetails: ContactDetails, transaction: SDSAnyWriteTransaction) throws {
-        Logger.debug("contactDetails: \(contactDetails)")
+    private func processSignalAccounts(contacts: [ContactDetails], transaction: SDSAnyWriteTransaction) throws {
+        var newAccounts = [SignalAccount]()
+        var newAccountIndexMap = [SignalServiceAddress: Int]()
 
-        // Mark as registered, since we trust the contact information sent from our other devices.
-        SignalRecipient.mark(asRegisteredAndGet: contactDetails.address, trustLevel: .high, transaction: transaction)
+        for contactDetails in contacts {
+            Logger.debug("contactDetails: \(contactDetails)")
 
-        let contactAvatarHash: Data?
-        let contactAvatarJpegData: Data?
-        if let avatarData = contactDetails.avatarData {
-            contactAvatarHash = Cryptography.computeSHA256Digest(avatarData)
-            contactAvatarJpegData = UIImage.validJpegData(fromAvatarData: avatarData)
-        } else {
-            contactAvatarHash = nil
-            contactAvatarJpegData = nil
-        }
+            // Mark as registered, since we trust the contact information sent from our other devices.
+            SignalRecipient.mark(asRegisteredAndGet: contactDetails.address, trustLevel: .high, transaction: transaction)
 
-        if let existingAccount = self.contactsManagerImpl.fetchSignalAccount(for: contactDetails.address,
-                                                                             transaction: transaction) {
-            if existingAccount.contact == nil {
-                owsFailDebug("Persisted account missing contact.")
+            let contactAvatarHash: Data?
+            let contactAvatarJpegData: Data?
+            if let avatarData = contactDetails.avatarData {
+                contactAvatarHash = Cryptography.computeSHA256Digest(avatarData)
+                contactAvatarJpegData = UIImage.validJpegData(fromAvatarData: avatarData)
+            } else {
+                contactAvatarHash = nil
+                contactAvatarJpegData = nil
             }
-            if let contact = existingAccount.contact,
-                contact.isFromContactSync {
+
+            if let existingAccount = self.contactsManagerImpl.fetchSignalAccount(for: contactDetails.address,
+                                                                                 transaction: transaction) {
+                if existingAccount.contact == nil {
+                    owsFailDebug("Persisted account missing contact.")
+                }
+                if let contact = existingAccount.contact,
+                    contact.isFromContactSync {
+                    let contact = try self.buildContact(contactDetails, transaction: transaction)
+                    existingAccount.updateWithContact(contact, transaction: transaction)
+                }
+            } else {
                 let contact = try self.buildContact(contactDetails, transaction: transaction)
-                existingAccount.updateWithContact(contact, transaction: transaction)
+                let newAccount = SignalAccount(contact: contact,
+                                               contactAvatarHash: contactAvatarHash,
+                                               contactAvatarJpegData: contactAvatarJpegData,
+                                               multipleAccountLabelText: "",
+                                               recipientPhoneNumber: contactDetails.address.phoneNumber,
+                                               recipientUUID: contactDetails.address.uuidString)
+                if let index = newAccountIndexMap[contactDetails.address] {
+                    // The last entry for a given contact wins.
+                    newAccounts[index] = newAccount
+                } else {
+                    newAccountIndexMap[contactDetails.address] = newAccounts.count
+                    newAccounts.append(newAccount)
+                }
             }
-        } else {
-            let contact = try self.buildContact(contactDetails, transaction: transaction)
-            let newAccount = SignalAccount(contact: contact,
-                                           contactAvatarHash: contactAvatarHash,
-                                           contactAvatarJpegData: contactAvatarJpegData,
-                                           multipleAccountLabelText: "",
-                                           recipientPhoneNumber: contactDetails.address.phoneNumber,
-                                           recipientUUID: contactDetails.address.uuidString)
-            newAccount.anyInsert(transaction: transaction)
         }
 
+        SignalAccount.anyInsert(batch: newAccounts, transaction: transaction)
+    }
+
+    private func process(contactDetails: ContactDetails, transaction: SDSAnyWriteTransaction) throws {
         let contactThread: TSContactThread
         let isNewThread: Bool
         var threadDidChange = false
@@ -1348,7 +1348,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 {
     OWSAssertDebug(address.isValid);
 
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
 
     return userProfile.profileKey;
 }
@@ -1358,7 +1358,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 {
     OWSAssertDebug(address.isValid);
 
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
 
     return userProfile.unfilteredGivenName;
 }
@@ -1368,7 +1368,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 {
     OWSAssertDebug(address.isValid);
 
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
 
     return userProfile.givenName;
 }
@@ -1378,7 +1378,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 {
     OWSAssertDebug(address.isValid);
 
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
 
     return userProfile.unfilteredFamilyName;
 }
@@ -1389,7 +1389,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 {
     OWSAssertDebug(address.isValid);
 
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
 
     return userProfile.familyName;
 }
@@ -1399,7 +1399,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 {
     OWSAssertDebug(address.isValid);
 
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
 
     return userProfile.nameComponents;
 }
@@ -1409,7 +1409,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 {
     OWSAssertDebug(address.isValid);
 
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
 
     return userProfile.fullName;
 }
@@ -1435,7 +1435,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 
 - (BOOL)hasProfileAvatarData:(SignalServiceAddress *)address transaction:(SDSAnyReadTransaction *)transaction
 {
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
     if (userProfile.avatarFileName.length < 1) {
         return NO;
     } else {
@@ -1449,7 +1449,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 {
     OWSAssertDebug(address.isValid);
 
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
 
     if (userProfile.avatarFileName.length > 0) {
         return [self loadProfileDataWithFilename:userProfile.avatarFileName];
@@ -1463,7 +1463,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 {
     OWSAssertDebug(address.isValid);
 
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
 
     return userProfile.avatarUrlPath;
 }
@@ -1471,7 +1471,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 - (nullable NSString *)usernameForAddress:(SignalServiceAddress *)address
                               transaction:(SDSAnyReadTransaction *)transaction
 {
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
 
     if (userProfile.username.length > 0) {
         return userProfile.username;
@@ -1485,7 +1485,7 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
 {
     OWSAssertDebug(address.isValid);
 
-    OWSUserProfile *_Nullable userProfile = [self getUserProfileForAddress:address transaction:transaction];
+    OWSUserProfile *_Nullable userProfile = [self getUserProfileForReadOnlyAccessForAddress:address transaction:transaction];
 
     return [OWSUserProfile bioForDisplayWithBio:userProfile.bio bioEmoji:userProfile.bioEmoji];
 }
@@ -1504,6 +1504,22 @@ const NSString *kNSNotificationKey_WasLocallyInitiated = @"kNSNotificationKey_Wa
     return [self.modelReadCaches.userProfileReadCache getUserProfileWithAddress:address transaction:transaction];
 }
 
+// Avoids copying the cached profile; callers must not mutate or retain it.
+- (nullable OWSUserProfile *)getUserProfileForReadOnlyAccessForAddress:(SignalServiceAddress *)addressParam
+                                                           transaction:(SDSAnyReadTransaction *)transaction
+{
+    SignalServiceAddress *address = [OWSUserProfile resolveUserProfileAddress:addressParam];
+    OWSAssertDebug(address.isValid);
+
+    // For "local reads", use the local user profile.
+    if ([OWSUserProfile isLocalProfileAddress:address]) {
+        return [self getLocalUserProfileWithTransaction:transaction];
+    }
+
+    return [self.modelReadCaches.userProfileReadCache getUserProfileForReadOnlyAccessWithAddress:address
+                                                                                     transaction:transaction];
+}
+
 - (NSString *)generateAvatarFilename
 {
     return [[NSUUID UUID].UUIDString stringByAppendingPathExtension:@"jpg"];
@@ -388,6 +388,23 @@ public class ConversationStyle: NSObject {
             lastTextLineAxis == other.lastTextLineAxis)
     }
 
+    // Cell measurements don't depend on colors, so they can
+    // be re-used when only the theme or chat color changes.
+    public func isEqualForCellMeasurement(_ other: ConversationStyle) -> Bool {
+        (type.isValid == other.type.isValid &&
+            viewWidth == other.viewWidth &&
+            dynamicBodyTypePointSize == other.dynamicBodyTypePointSize &&
+            hasWallpaper == other.hasWallpaper &&
+            maxMessageWidth == other.maxMessageWidth &&
+            maxMediaMessageWidth == other.maxMediaMessageWidth &&
+            textInsets == other.textInsets &&
+            gutterLeading == other.gutterLeading &&
+            gutterTrailing == other.gutterTrailing &&
+            fullWidthGutterLeading == other.fullWidthGutterLeading &&
+            fullWidthGutterTrailing == other.fullWidthGutterTrailing &&
+            lastTextLineAxis == other.lastTextLineAxis)
+    }
+
     @objc
     public override var debugDescription: String {
         "[" +
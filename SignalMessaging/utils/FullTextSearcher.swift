@@ -314,6 +314,40 @@ public class FullTextSearcher: NSObject {
     override private init() {
         finder = FullTextSearchFinder()
         super.init()
+
+        NotificationCenter.default.addObserver(self,
+                                               selector: #selector(signalAccountsDidChange),
+                                               name: .OWSContactsManagerSignalAccountsDidChange,
+                                               object: nil)
+        NotificationCenter.default.addObserver(self,
+                                               selector: #selector(localProfileDidChange),
+                                               name: .localProfileDidChange,
+                                               object: nil)
+        NotificationCenter.default.addObserver(self,
+                                               selector: #selector(otherUsersProfileDidChange(notification:)),
+                                               name: .otherUsersProfileDidChange,
+                                               object: nil)
+    }
+
+    // MARK: - Notifications
+
+    @objc
+    private func signalAccountsDidChange() {
+        searchIndexCache.removeAll()
+    }
+
+    @objc
+    private func localProfileDidChange() {
+        searchIndexCache.removeAll()
+    }
+
+    @objc
+    private func otherUsersProfileDidChange(notification: Notification) {
+        guard let address = notification.userInfo?[kNSNotificationKey_ProfileAddress] as? SignalServiceAddress else {
+            searchIndexCache.removeAll()
+            return
+        }
+        searchIndexCache.remove(address: address)
     }
 
     @objc
@@ -710,12 +744,13 @@ public class FullTextSearcher: NSObject {
             return threads
         }
 
+        let query = SearcherQuery(searchText)
         return threads.filter { thread in
             switch thread {
             case let groupThread as TSGroupThread:
-                return self.groupThreadSearcher.matches(item: groupThread, query: searchText, transaction: transaction)
+                return self.groupThreadSearcher.matches(item: groupThread, query: query, transaction: transaction)
             case let contactThread as TSContactThread:
-                return self.contactThreadSearcher.matches(item: contactThread, query: searchText, transaction: transaction)
+                return self.contactThreadSearcher.matches(item: contactThread, query: query, transaction: transaction)
             default:
                 owsFailDebug("Unexpected thread type: \(thread.uniqueId)")
                 return false
@@ -729,8 +764,9 @@ public class FullTextSearcher: NSObject {
             return groupThreads
         }
 
+        let query = SearcherQuery(searchText)
         return groupThreads.filter { groupThread in
-            return self.groupThreadSearcher.matches(item: groupThread, query: searchText, transaction: transaction)
+            return self.groupThreadSearcher.matches(item: groupThread, query: query, transaction: transaction)
         }
     }
 
@@ -740,45 +776,128 @@ public class FullTextSearcher: NSObject {
             return signalAccounts
         }
 
+        let query = SearcherQuery(searchText)
         return signalAccounts.filter { signalAccount in
-            self.signalAccountSearcher.matches(item: signalAccount, query: searchText, transaction: transaction)
+            self.signalAccountSearcher.matches(item: signalAccount, query: query, transaction: transaction)
         }
     }
 
     // MARK: Searchers
 
-    private lazy var groupThreadSearcher: Searcher<TSGroupThread> = Searcher { (groupThread: TSGroupThread, transaction: SDSAnyReadTransaction) in
-        let groupName = groupThread.groupModel.groupName
-        let memberStrings = groupThread.groupModel.groupMembers.map { address in
-            self.indexingString(address: address, transaction: transaction)
-        }.joined(separator: " ")
+    private let searchIndexCache = SearchIndexCache()
 
-        return "\(memberStrings) \(groupName ?? "")"
-    }
+    private lazy var groupThreadSearcher: Searcher<TSGroupThread> = Searcher(normalizedIndexer: { (groupThread: TSGroupThread, transaction: SDSAnyReadTransaction) in
+        self.searchIndexCache.indexString(groupThread: groupThread) { groupModel in
+            let groupName = groupModel.groupName
+            let memberStrings = groupModel.groupMembers.map { address in
+                self.indexingString(address: address, transaction: transaction)
+            }.joined(separator: " ")
+
+            return "\(memberStrings) \(groupName ?? "")"
+        }
+    })
 
-    private lazy var contactThreadSearcher: Searcher<TSContactThread> = Searcher { (contactThread: TSContactThread, transaction: SDSAnyReadTransaction) in
+    private lazy var contactThreadSearcher: Searcher<TSContactThread> = Searcher(normalizedIndexer: { (contactThread: TSContactThread, transaction: SDSAnyReadTransaction) in
         let recipientAddress = contactThread.contactAddress
         return self.conversationIndexingString(address: recipientAddress, transaction: transaction)
-    }
+    })
 
-    private lazy var signalAccountSearcher: Searcher<SignalAccount> = Searcher { (signalAccount: SignalAccount, transaction: SDSAnyReadTransaction) in
+    private lazy var signalAccountSearcher: Searcher<SignalAccount> = Searcher(normalizedIndexer: { (signalAccount: SignalAccount, transaction: SDSAnyReadTransaction) in
         let recipientAddress = signalAccount.recipientAddress
         return self.conversationIndexingString(address: recipientAddress, transaction: transaction)
-    }
+    })
 
     private func conversationIndexingString(address: SignalServiceAddress, transaction: SDSAnyReadTransaction) -> String {
         var result = self.indexingString(address: address, transaction: transaction)
 
         if address.isLocalAddress {
-            result += " \(MessageStrings.noteToSelf)"
+            result += " \(Searcher<Any>.normalize(string: MessageStrings.noteToSelf))"
         }
 
         return result
     }
 
+    // Returns a normalized string.
     private func indexingString(address: SignalServiceAddress, transaction: SDSAnyReadTransaction) -> String {
-        let displayName = contactsManager.displayName(for: address, transaction: transaction)
+        searchIndexCache.indexString(address: address) {
+            let displayName = contactsManager.displayName(for: address, transaction: transaction)
 
-        return "\(address.phoneNumber ?? "") \(displayName)"
+            return "\(address.phoneNumber ?? "") \(displayName)"
+        }
+    }
+}
+
+// MARK: -
+
+// Caches the normalized strings that contacts and groups are searched by.
+//
+// Building these strings resolves display names, which is expensive, and
+// the searchers used to rebuild them for every item on every keystroke.
+// Instead, they're built on first use and kept until the relevant contacts
+// or profiles change. Group strings are also rebuilt if the group's name
+// or members change.
+private class SearchIndexCache {
+
+    private struct GroupEntry {
+        let groupName: String?
+        let groupMembers: [SignalServiceAddress]
+        let indexString: String
+    }
+
+    private let unfairLock = UnfairLock()
+    // These properties should only be accessed with unfairLock.
+    private var addressIndexStrings = [SignalServiceAddress: String]()
+    private var groupEntries = [String: GroupEntry]()
+    // Incremented whenever entries are removed, so that strings which
+    // were being built at the time aren't cached.
+    private var generation: UInt = 0
+
+    func indexString(address: SignalServiceAddress, buildIndexString: () -> String) -> String {
+        let (cachedIndexString, generation) = unfairLock.withLock { (addressIndexStrings[address], self.generation) }
+        if let indexString = cachedIndexString {
+            return indexString
+        }
+        let indexString = Searcher<Any>.normalize(string: buildIndexString())
+        unfairLock.withLock {
+            if generation == self.generation {
+                addressIndexStrings[address] = indexString
+            }
+        }
+        return indexString
+    }
+
+    func indexString(groupThread: TSGroupThread, buildIndexString: (TSGroupModel) -> String) -> String {
+        let groupModel = groupThread.groupModel
+        let (cachedEntry, generation) = unfairLock.withLock { (groupEntries[groupThread.uniqueId], self.generation) }
+        if let entry = cachedEntry,
+           entry.groupName == groupModel.groupName,
+           entry.groupMembers == groupModel.groupMembers {
+            return entry.indexString
+        }
+        let indexString = Searcher<Any>.normalize(string: buildIndexString(groupModel))
+        unfairLock.withLock {
+            if generation == self.generation {
+                groupEntries[groupThread.uniqueId] = GroupEntry(groupName: groupModel.groupName,
+                                                                groupMembers: groupModel.groupMembers,
+                                                                indexString: indexString)
+            }
+        }
+        return indexString
+    }
+
+    func remove(address: SignalServiceAddress) {
+        unfairLock.withLock {
+            addressIndexStrings[address] = nil
+            groupEntries = groupEntries.filter { !$0.value.groupMembers.contains(address) }
+            generation += 1
+        }
+    }
+
+    func removeAll() {
+        unfairLock.withLock {
+            addressIndexStrings.removeAll()
+            groupEntries.removeAll()
+            generation += 1
+        }
     }
 }
@@ -33,12 +33,16 @@ NS_ASSUME_NONNULL_BEGIN
 
 NSString *const OWSOrphanDataCleaner_LastCleaningVersionKey = @"OWSOrphanDataCleaner_LastCleaningVersionKey";
 NSString *const OWSOrphanDataCleaner_LastCleaningDateKey = @"OWSOrphanDataCleaner_LastCleaningDateKey";
+NSString *const OWSOrphanDataCleaner_FileScanCursorKey = @"OWSOrphanDataCleaner_FileScanCursorKey";
+// Audits (which don't remove orphans) checkpoint separately so that they
+// never advance or clear the cursor of an interrupted cleanup.
+NSString *const OWSOrphanDataCleaner_AuditFileScanCursorKey = @"OWSOrphanDataCleaner_AuditFileScanCursorKey";
 
 @interface OWSOrphanData : NSObject
 
 @property (nonatomic) NSSet<NSString *> *interactionIds;
 @property (nonatomic) NSSet<NSString *> *attachmentIds;
-@property (nonatomic) NSSet<NSString *> *filePaths;
+@property (nonatomic) BloomFilter *referencedFilePaths;
 @property (nonatomic) NSSet<NSString *> *reactionIds;
 @property (nonatomic) NSSet<NSString *> *mentionIds;
 
@@ -89,41 +93,6 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
     return CurrentAppContext().reportedApplicationState == UIApplicationStateActive;
 }
 
-+ (void)printPaths:(NSArray<NSString *> *)paths label:(NSString *)label
-{
-    for (NSString *path in [paths sortedArrayUsingSelector:@selector(compare:)]) {
-        OWSLogDebug(@"%@: %@", label, path);
-    }
-}
-
-+ (long long)fileSizeOfFilePath:(NSString *)filePath
-{
-    NSError *error;
-    NSNumber *fileSize = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:&error][NSFileSize];
-    if (error) {
-        if ([error.domain isEqualToString:NSCocoaErrorDomain] && error.code == 260) {
-            OWSLogWarn(@"can't find size of missing file.");
-            OWSLogDebug(@"can't find size of missing file: %@", filePath);
-        } else {
-            OWSFailDebug(@"attributesOfItemAtPath: %@ error: %@", filePath, error);
-        }
-        return 0;
-    }
-    return fileSize.longLongValue;
-}
-
-+ (nullable NSNumber *)fileSizeOfFilePathsSafe:(NSArray<NSString *> *)filePaths
-{
-    long long result = 0;
-    for (NSString *filePath in filePaths) {
-        if (!self.isMainAppAndActive) {
-            return nil;
-        }
-        result += [self fileSizeOfFilePath:filePath];
-    }
-    return @(result);
-}
-
 + (nullable NSSet<NSString *> *)filePathsInDirectorySafe:(NSString *)dirPath
 {
     NSMutableSet *filePaths = [NSMutableSet new];
@@ -165,18 +134,10 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
 //
 // * Orphan TSInteractions (with no thread).
 // * Orphan TSAttachments (with no message).
-// * Orphan attachment files (with no corresponding TSAttachment).
-// * Orphan profile avatars.
-// * Temporary files (all).
-//
-// It also finds (we don't clean these up).
+// * Orphan reactions and mentions (with no message).
 //
-// * Missing attachment files (cannot be cleaned up).
-//   These are attachments which have no file on disk.  They should be extremely rare -
-//   the only cases I have seen are probably due to debugging.
-//   They can't be cleaned up - we don't want to delete the TSAttachmentStream or
-//   its corresponding message.  Better that the broken message shows up in the
-//   conversation view.
+// It also finds the file paths referenced by the database, which
+// are used to find orphan files; see scanOrphanFilesSync.
 + (void)findOrphanDataWithRetries:(NSInteger)remainingRetries
                           success:(OrphanDataBlock)success
                           failure:(dispatch_block_t)failure
@@ -241,113 +202,6 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
     }
 #endif
 
-    // We treat _all_ temp files as orphan files.  This is safe
-    // because temp files only need to be retained for the
-    // a single launch of the app.  Since our "date threshold"
-    // for deletion is relative to the current launch time,
-    // all temp files currently in use should be safe.
-    NSArray<NSString *> *_Nullable tempFilePaths = [self getTempFilePaths];
-    if (!tempFilePaths || !self.isMainAppAndActive) {
-        return nil;
-    }
-
-#ifdef LOG_ALL_FILE_PATHS
-    {
-        NSDateFormatter *dateFormatter = [NSDateFormatter new];
-        [dateFormatter setDateStyle:NSDateFormatterLongStyle];
-        [dateFormatter setTimeStyle:NSDateFormatterLongStyle];
-
-        tempFilePaths = [tempFilePaths sortedArrayUsingSelector:@selector(compare:)];
-        for (NSString *filePath in tempFilePaths) {
-            NSError *error;
-            NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:&error];
-            if (!attributes || error) {
-                OWSLogDebug(@"Could not get attributes of file at: %@", filePath);
-                OWSFailDebug(@"Could not get attributes of file");
-                continue;
-            }
-            OWSLogVerbose(
-                @"temp file: %@, %@", filePath, [dateFormatter stringFromDate:attributes.fileModificationDate]);
-        }
-    }
-#endif
-
-    NSString *legacyAttachmentsDirPath = TSAttachmentStream.legacyAttachmentsDirPath;
-    NSString *sharedDataAttachmentsDirPath = TSAttachmentStream.sharedDataAttachmentsDirPath;
-    NSSet<NSString *> *_Nullable legacyAttachmentFilePaths = [self filePathsInDirectorySafe:legacyAttachmentsDirPath];
-    if (!legacyAttachmentFilePaths || !self.isMainAppAndActive) {
-        return nil;
-    }
-    NSSet<NSString *> *_Nullable sharedDataAttachmentFilePaths =
-        [self filePathsInDirectorySafe:sharedDataAttachmentsDirPath];
-    if (!sharedDataAttachmentFilePaths || !self.isMainAppAndActive) {
-        return nil;
-    }
-
-    NSString *legacyProfileAvatarsDirPath = OWSUserProfile.legacyProfileAvatarsDirPath;
-    NSString *sharedDataProfileAvatarsDirPath = OWSUserProfile.sharedDataProfileAvatarsDirPath;
-    NSSet<NSString *> *_Nullable legacyProfileAvatarsFilePaths =
-        [self filePathsInDirectorySafe:legacyProfileAvatarsDirPath];
-    if (!legacyProfileAvatarsFilePaths || !self.isMainAppAndActive) {
-        return nil;
-    }
-    NSSet<NSString *> *_Nullable sharedDataProfileAvatarFilePaths =
-        [self filePathsInDirectorySafe:sharedDataProfileAvatarsDirPath];
-    if (!sharedDataProfileAvatarFilePaths || !self.isMainAppAndActive) {
-        return nil;
-    }
-
-    NSString *stickersDirPath = StickerManager.cacheDirUrl.path;
-    NSSet<NSString *> *_Nullable allStickerFilePaths = [self filePathsInDirectorySafe:stickersDirPath];
-    if (!allStickerFilePaths || !self.isMainAppAndActive) {
-        return nil;
-    }
-
-    NSString *voiceMessageDirPath = VoiceMessageModel.draftVoiceMessageDirectory.path;
-    NSSet<NSString *> *_Nullable allVoiceMessageFilePaths = [self filePathsInDirectorySafe:voiceMessageDirPath];
-    if (!allVoiceMessageFilePaths || !self.isMainAppAndActive) {
-        return nil;
-    }
-
-    NSMutableSet<NSString *> *allOnDiskFilePaths = [NSMutableSet new];
-    [allOnDiskFilePaths unionSet:legacyAttachmentFilePaths];
-    [allOnDiskFilePaths unionSet:sharedDataAttachmentFilePaths];
-    [allOnDiskFilePaths unionSet:legacyProfileAvatarsFilePaths];
-    [allOnDiskFilePaths unionSet:sharedDataProfileAvatarFilePaths];
-    [allOnDiskFilePaths unionSet:allStickerFilePaths];
-    [allOnDiskFilePaths unionSet:allVoiceMessageFilePaths];
-    [allOnDiskFilePaths addObjectsFromArray:tempFilePaths];
-
-    // This should be redundant, but this will future-proof us against
-    // ever accidentally removing the GRDB databases during
-    // orphan clean up.
-    NSString *grdbPrimaryDirectoryPath =
-        [GRDBDatabaseStorageAdapter databaseDirUrlWithBaseDir:SDSDatabaseStorage.baseDir
-                                                directoryMode:DirectoryModePrimary]
-            .path;
-    NSString *grdbHotswapDirectoryPath =
-        [GRDBDatabaseStorageAdapter databaseDirUrlWithBaseDir:SDSDatabaseStorage.baseDir
-                                                directoryMode:DirectoryModeHotswap]
-            .path;
-
-    NSMutableSet<NSString *> *databaseFilePaths = [NSMutableSet new];
-    for (NSString *filePath in allOnDiskFilePaths) {
-        if ([filePath hasPrefix:grdbPrimaryDirectoryPath]) {
-            OWSLogInfo(@"Protecting database file: %@", filePath);
-            [databaseFilePaths addObject:filePath];
-        } else if ([filePath hasPrefix:grdbHotswapDirectoryPath]) {
-            OWSLogInfo(@"Protecting database hotswap file: %@", filePath);
-            [databaseFilePaths addObject:filePath];
-        }
-    }
-    [allOnDiskFilePaths minusSet:databaseFilePaths];
-    OWSLogVerbose(@"grdbDirectoryPath: %@ (%d)",
-        grdbPrimaryDirectoryPath,
-        [OWSFileSystem fileOrFolderExistsAtPath:grdbPrimaryDirectoryPath]);
-    OWSLogVerbose(@"databaseFilePaths: %lu", (unsigned long)databaseFilePaths.count);
-
-    OWSLogVerbose(@"allOnDiskFilePaths: %lu", (unsigned long)allOnDiskFilePaths.count);
-
     __block NSSet<NSString *> *voiceMessageDraftFilePaths;
     [self.databaseStorage readWithBlock:^(SDSAnyReadTransaction *transaction) {
         voiceMessageDraftFilePaths = [VoiceMessageModel allDraftFilePathsWithTransaction:transaction];
@@ -362,66 +216,32 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
         return nil;
     }
 
-    NSNumber *_Nullable totalFileSize = [self fileSizeOfFilePathsSafe:allOnDiskFilePaths.allObjects];
-
-    if (!totalFileSize || !self.isMainAppAndActive) {
-        return nil;
-    }
-
-    NSUInteger fileCount = allOnDiskFilePaths.count;
+    // We only need to know whether an id or file path is referenced, so
+    // we use bloom filters rather than sets of every id and file path.
+    // A false positive only means that an orphan isn't cleaned up.
 
     // Attachments
     __block int attachmentStreamCount = 0;
-    NSMutableSet<NSString *> *allAttachmentFilePaths = [NSMutableSet new];
-    NSMutableSet<NSString *> *allAttachmentIds = [NSMutableSet new];
+    __block BloomFilter *allReferencedFilePaths;
+    NSMutableSet<NSString *> *orphanAttachmentIds = [NSMutableSet new];
     // Reactions
-    NSMutableSet<NSString *> *allReactionIds = [NSMutableSet new];
+    NSMutableSet<NSString *> *orphanReactionIds = [NSMutableSet new];
     // Mentions
-    NSMutableSet<NSString *> *allMentionIds = [NSMutableSet new];
+    NSMutableSet<NSString *> *orphanMentionIds = [NSMutableSet new];
     // Threads
     __block NSSet *threadIds;
     // Messages
     NSMutableSet<NSString *> *orphanInteractionIds = [NSMutableSet new];
-    NSMutableSet<NSString *> *allMessageAttachmentIds = [NSMutableSet new];
-    NSMutableSet<NSString *> *allMessageReactionIds = [NSMutableSet new];
-    NSMutableSet<NSString *> *allMessageMentionIds = [NSMutableSet new];
-    // Stickers
-    NSMutableSet<NSString *> *activeStickerFilePaths = [NSMutableSet new];
+    __block BloomFilter *allInteractionIds;
+    __block BloomFilter *allMessageAttachmentIds;
     [self.databaseStorage readWithBlock:^(SDSAnyReadTransaction *transaction) {
-        [TSAttachmentStream
-            anyEnumerateWithTransaction:transaction
-                                batched:YES
-                                  block:^(TSAttachment *attachment, BOOL *stop) {
-                                      if (!self.isMainAppAndActive) {
-                                          shouldAbort = YES;
-                                          *stop = YES;
-                                          return;
-                                      }
-                                      if (![attachment isKindOfClass:[TSAttachmentStream class]]) {
-                                          return;
-                                      }
-                                      [allAttachmentIds addObject:attachment.uniqueId];
-
-                                      TSAttachmentStream *attachmentStream = (TSAttachmentStream *)attachment;
-                                      attachmentStreamCount++;
-                                      NSString *_Nullable filePath = [attachmentStream originalFilePath];
-                                      if (filePath) {
-                                          [allAttachmentFilePaths addObject:filePath];
-                                      } else {
-                                          OWSFailDebug(@"attachment has no file path.");
-                                      }
-
-                                      [allAttachmentFilePaths
-                                          addObjectsFromArray:attachmentStream.allSecondaryFilePaths];
-                                  }];
-
-        if (shouldAbort) {
-            return;
-        }
+        NSUInteger attachmentCount = [TSAttachment anyCountWithTransaction:transaction];
+        NSUInteger interactionCount = [TSInteraction anyCountWithTransaction:transaction];
+        allInteractionIds = [[BloomFilter alloc] initWithExpectedCount:(NSInteger)interactionCount];
+        allMessageAttachmentIds = [[BloomFilter alloc] initWithExpectedCount:(NSInteger)attachmentCount];
 
         threadIds = [NSSet setWithArray:[TSThread anyAllUniqueIdsWithTransaction:transaction]];
 
-        NSMutableSet<NSString *> *allInteractionIds = [NSMutableSet new];
         [TSInteraction anyEnumerateWithTransaction:transaction
                                            batched:YES
                                              block:^(TSInteraction *interaction, BOOL *stop) {
@@ -435,13 +255,13 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
                                                      [orphanInteractionIds addObject:interaction.uniqueId];
                                                  }
 
-                                                 [allInteractionIds addObject:interaction.uniqueId];
+                                                 [allInteractionIds insert:interaction.uniqueId];
                                                  if (![interaction isKindOfClass:[TSMessage class]]) {
                                                      return;
                                                  }
 
                                                  TSMessage *message = (TSMessage *)interaction;
-                                                 [allMessageAttachmentIds addObjectsFromArray:message.allAttachmentIds];
+                                                 [allMessageAttachmentIds insertAll:message.allAttachmentIds];
                                              }];
 
         if (shouldAbort) {
@@ -459,9 +279,8 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
                                                if (![reaction isKindOfClass:[OWSReaction class]]) {
                                                    return;
                                                }
-                                               [allReactionIds addObject:reaction.uniqueId];
-                                               if ([allInteractionIds containsObject:reaction.uniqueMessageId]) {
-                                                   [allMessageReactionIds addObject:reaction.uniqueId];
+                                               if (![allInteractionIds contains:reaction.uniqueMessageId]) {
+                                                   [orphanReactionIds addObject:reaction.uniqueId];
                                                }
                                            }];
 
@@ -480,9 +299,8 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
                                              if (![mention isKindOfClass:[TSMention class]]) {
                                                  return;
                                              }
-                                             [allMentionIds addObject:mention.uniqueId];
-                                             if ([allInteractionIds containsObject:mention.uniqueMessageId]) {
-                                                 [allMessageMentionIds addObject:mention.uniqueId];
+                                             if (![allInteractionIds contains:mention.uniqueMessageId]) {
+                                                 [orphanMentionIds addObject:mention.uniqueId];
                                              }
                                          }];
 
@@ -502,8 +320,7 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
                                                            return;
                                                        }
                                                        TSMessage *message = (TSMessage *)interaction;
-                                                       [allMessageAttachmentIds
-                                                           addObjectsFromArray:message.allAttachmentIds];
+                                                       [allMessageAttachmentIds insertAll:message.allAttachmentIds];
                                                    }];
 
         [[JobRecordFinderObjC new]
@@ -516,8 +333,7 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
                                        }
                                        OWSBroadcastMediaMessageJobRecord *broadcastJobRecord
                                            = (OWSBroadcastMediaMessageJobRecord *)jobRecord;
-                                       [allMessageAttachmentIds
-                                           addObjectsFromArray:broadcastJobRecord.attachmentIdMap.allKeys];
+                                       [allMessageAttachmentIds insertAll:broadcastJobRecord.attachmentIdMap.allKeys];
                                    }];
 
         [[JobRecordFinderObjC new]
@@ -530,7 +346,7 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
                                        }
                                        OWSIncomingGroupSyncJobRecord *groupSyncJobRecord
                                            = (OWSIncomingGroupSyncJobRecord *)jobRecord;
-                                       [allMessageAttachmentIds addObject:groupSyncJobRecord.attachmentId];
+                                       [allMessageAttachmentIds insert:groupSyncJobRecord.attachmentId];
                                    }];
 
         [[JobRecordFinderObjC new]
@@ -543,71 +359,69 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
                                        }
                                        OWSIncomingContactSyncJobRecord *contactSyncJobRecord
                                            = (OWSIncomingContactSyncJobRecord *)jobRecord;
-                                       [allMessageAttachmentIds addObject:contactSyncJobRecord.attachmentId];
+                                       [allMessageAttachmentIds insert:contactSyncJobRecord.attachmentId];
                                    }];
 
         if (shouldAbort) {
             return;
         }
 
-        [activeStickerFilePaths
-            addObjectsFromArray:[StickerManager filepathsForAllInstalledStickersWithTransaction:transaction]];
+        NSArray<NSString *> *activeStickerFilePaths =
+            [StickerManager filepathsForAllInstalledStickersWithTransaction:transaction];
+
+        // Most attachments have a thumbnail as well as the original file.
+        NSUInteger expectedFilePathCount = 2 * attachmentCount + activeStickerFilePaths.count
+            + profileAvatarFilePaths.count + voiceMessageDraftFilePaths.count;
+        allReferencedFilePaths = [[BloomFilter alloc] initWithExpectedCount:(NSInteger)expectedFilePathCount];
+        [allReferencedFilePaths insertAll:activeStickerFilePaths];
+        [allReferencedFilePaths insertAll:profileAvatarFilePaths.allObjects];
+        [allReferencedFilePaths insertAll:voiceMessageDraftFilePaths.allObjects];
+
+        [TSAttachmentStream
+            anyEnumerateWithTransaction:transaction
+                                batched:YES
+                                  block:^(TSAttachment *attachment, BOOL *stop) {
+                                      if (!self.isMainAppAndActive) {
+                                          shouldAbort = YES;
+                                          *stop = YES;
+                                          return;
+                                      }
+                                      if (![attachment isKindOfClass:[TSAttachmentStream class]]) {
+                                          return;
+                                      }
+                                      if (![allMessageAttachmentIds contains:attachment.uniqueId]) {
+                                          [orphanAttachmentIds addObject:attachment.uniqueId];
+                                      }
+
+                                      TSAttachmentStream *attachmentStream = (TSAttachmentStream *)attachment;
+                                      attachmentStreamCount++;
+                                      NSString *_Nullable filePath = [attachmentStream originalFilePath];
+                                      if (filePath) {
+                                          [allReferencedFilePaths insert:filePath];
+                                      } else {
+                                          OWSFailDebug(@"attachment has no file path.");
+                                      }
+
+                                      [allReferencedFilePaths insertAll:attachmentStream.allSecondaryFilePaths];
+                                  }];
     }];
     if (shouldAbort) {
         return nil;
     }
 
-    OWSLogDebug(@"fileCount: %zu", fileCount);
-    OWSLogDebug(@"totalFileSize: %lld", totalFileSize.longLongValue);
     OWSLogDebug(@"attachmentStreams: %d", attachmentStreamCount);
-    OWSLogDebug(@"attachmentStreams with file paths: %zu", allAttachmentFilePaths.count);
-
-    NSMutableSet<NSString *> *orphanFilePaths = [allOnDiskFilePaths mutableCopy];
-    [orphanFilePaths minusSet:allAttachmentFilePaths];
-    [orphanFilePaths minusSet:profileAvatarFilePaths];
-    [orphanFilePaths minusSet:voiceMessageDraftFilePaths];
-    [orphanFilePaths minusSet:activeStickerFilePaths];
-    NSMutableSet<NSString *> *missingAttachmentFilePaths = [allAttachmentFilePaths mutableCopy];
-    [missingAttachmentFilePaths minusSet:allOnDiskFilePaths];
-
-    OWSLogDebug(@"orphan file paths: %zu", orphanFilePaths.count);
-    OWSLogDebug(@"missing attachment file paths: %zu", missingAttachmentFilePaths.count);
-
-    [self printPaths:orphanFilePaths.allObjects label:@"orphan file paths"];
-    [self printPaths:missingAttachmentFilePaths.allObjects label:@"missing attachment file paths"];
-
-    OWSLogDebug(@"attachmentIds: %zu", allAttachmentIds.count);
-    OWSLogDebug(@"allMessageAttachmentIds: %zu", allMessageAttachmentIds.count);
-
-    NSMutableSet<NSString *> *orphanAttachmentIds = [allAttachmentIds mutableCopy];
-    [orphanAttachmentIds minusSet:allMessageAttachmentIds];
-    NSMutableSet<NSString *> *missingAttachmentIds = [allMessageAttachmentIds mutableCopy];
-    [missingAttachmentIds minusSet:allAttachmentIds];
-
+    OWSLogDebug(@"referenced file paths: %zd (%zd bytes)",
+        allReferencedFilePaths.count,
+        allReferencedFilePaths.byteCount);
     OWSLogDebug(@"orphan attachmentIds: %zu", orphanAttachmentIds.count);
-    OWSLogDebug(@"missing attachmentIds: %zu", missingAttachmentIds.count);
     OWSLogDebug(@"orphan interactions: %zu", orphanInteractionIds.count);
-
-    NSMutableSet<NSString *> *orphanReactionIds = [allReactionIds mutableCopy];
-    [orphanReactionIds minusSet:allMessageReactionIds];
-    NSMutableSet<NSString *> *missingReactionIds = [allMessageReactionIds mutableCopy];
-    [missingReactionIds minusSet:allReactionIds];
-
     OWSLogDebug(@"orphan reactionIds: %zu", orphanReactionIds.count);
-    OWSLogDebug(@"missing reactionIds: %zu", missingReactionIds.count);
-
-    NSMutableSet<NSString *> *orphanMentionIds = [allMentionIds mutableCopy];
-    [orphanMentionIds minusSet:allMessageMentionIds];
-    NSMutableSet<NSString *> *missingMentionIds = [allMessageMentionIds mutableCopy];
-    [missingMentionIds minusSet:allMentionIds];
-
     OWSLogDebug(@"orphan mentionIds: %zu", orphanMentionIds.count);
-    OWSLogDebug(@"missing mentionIds: %zu", missingMentionIds.count);
 
     OWSOrphanData *result = [OWSOrphanData new];
     result.interactionIds = [orphanInteractionIds copy];
     result.attachmentIds = [orphanAttachmentIds copy];
-    result.filePaths = [orphanFilePaths copy];
+    result.referencedFilePaths = allReferencedFilePaths;
     result.reactionIds = [orphanReactionIds copy];
     result.mentionIds = [orphanMentionIds copy];
     return result;
@@ -633,6 +447,12 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
             [self.keyValueStore getDate:OWSOrphanDataCleaner_LastCleaningDateKey transaction:transaction];
     }];
 
+    // Finish any file scan that was interrupted.
+    if ([self fileScannerForRemovingOrphans:YES].hasScanInProgress) {
+        OWSLogVerbose(@"Performing orphan data cleanup; resuming file scan.");
+        return YES;
+    }
+
     // Clean up once per app version.
     NSString *currentAppVersion = AppVersion.shared.currentAppVersion;
     if (!lastCleaningVersion || ![lastCleaningVersion isEqualToString:currentAppVersion]) {
@@ -719,8 +539,10 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
     //
     // To prevent 0xdead10cc, the cleaner continually checks
     // whether the app has resigned active.  If so, it aborts.
-    // Each phase (search, re-search, processing) retries N times,
-    // then gives up until the next app launch.
+    // Each phase (search, processing, file scan) retries N times,
+    // then gives up until the next app launch.  The file scan
+    // checkpoints its progress, so it resumes where it stopped,
+    // even in a later launch.
     //
     // To prevent accidental data deletion, we take the following
     // measures:
@@ -740,21 +562,32 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
                 remainingRetries:kMaxRetries
                 shouldRemoveOrphans:shouldRemoveOrphans
                 success:^{
-                    OWSLogInfo(@"Completed orphan data cleanup.");
-
-                    DatabaseStorageWrite(self.databaseStorage, ^(SDSAnyWriteTransaction *transaction) {
-                        [self.keyValueStore setString:AppVersion.shared.currentAppVersion
-                                                  key:OWSOrphanDataCleaner_LastCleaningVersionKey
-                                          transaction:transaction];
-
-                        [self.keyValueStore setDate:[NSDate new]
-                                                key:OWSOrphanDataCleaner_LastCleaningDateKey
-                                        transaction:transaction];
-                    });
-
-                    if (completion) {
-                        completion();
-                    }
+                    [self scanOrphanFiles:orphanData
+                        remainingRetries:kMaxRetries
+                        shouldRemoveOrphans:shouldRemoveOrphans
+                        success:^{
+                            OWSLogInfo(@"Completed orphan data cleanup.");
+
+                            DatabaseStorageWrite(self.databaseStorage, ^(SDSAnyWriteTransaction *transaction) {
+                                [self.keyValueStore setString:AppVersion.shared.currentAppVersion
+                                                          key:OWSOrphanDataCleaner_LastCleaningVersionKey
+                                                  transaction:transaction];
+
+                                [self.keyValueStore setDate:[NSDate new]
+                                                        key:OWSOrphanDataCleaner_LastCleaningDateKey
+                                                transaction:transaction];
+                            });
+
+                            if (completion) {
+                                completion();
+                            }
+                        }
+                        failure:^{
+                            OWSLogInfo(@"Pausing orphan file scan.");
+                            if (completion) {
+                                completion();
+                            }
+                        }];
                 }
                 failure:^{
                     OWSLogInfo(@"Aborting orphan data cleanup.");
@@ -951,58 +784,141 @@ typedef void (^OrphanDataBlock)(OWSOrphanData *);
         return NO;
     }
 
-    NSUInteger filesRemoved = 0;
-    NSArray<NSString *> *filePaths = [orphanData.filePaths.allObjects sortedArrayUsingSelector:@selector(compare:)];
-    for (NSString *filePath in filePaths) {
-        if (!self.isMainAppAndActive) {
-            return NO;
-        }
+    return YES;
+}
 
-        NSError *error;
-        NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:&error];
-        if (!attributes || error) {
-            // This is fine; the file may have been deleted since we found it.
-            OWSLogWarn(@"Could not get attributes of file at: %@", filePath);
-            continue;
-        }
-        // Don't delete files which were created in the last N minutes.
-        NSDate *creationDate = attributes.fileModificationDate;
-        if ([creationDate isAfterDate:thresholdDate]) {
-            OWSLogInfo(@"Skipping file due to age: %f", fabs([creationDate timeIntervalSinceNow]));
-            continue;
-        }
-        OWSLogInfo(@"Deleting file: %@", filePath);
-        filesRemoved++;
-        if (!shouldRemoveOrphans) {
-            continue;
-        }
-        if (![OWSFileSystem fileOrFolderExistsAtPath:filePath]) {
-            // Already removed.
-            continue;
-        }
-        if (![OWSFileSystem deleteFile:filePath ignoreIfMissing:YES]) {
-            OWSLogDebug(@"Could not remove orphan file at: %@", filePath);
-            OWSFailDebug(@"Could not remove orphan file");
-        }
++ (void)scanOrphanFiles:(OWSOrphanData *)orphanData
+       remainingRetries:(NSInteger)remainingRetries
+    shouldRemoveOrphans:(BOOL)shouldRemoveOrphans
+                success:(dispatch_block_t)success
+                failure:(dispatch_block_t)failure
+{
+    OWSAssertDebug(orphanData);
+
+    if (remainingRetries < 1) {
+        OWSLogInfo(@"Aborting orphan file scan.");
+        dispatch_async(self.workQueue, ^{
+            failure();
+        });
+        return;
     }
-    OWSLogInfo(@"Deleted orphan files: %zu", filesRemoved);
 
-    return YES;
+    // Wait until the app is active...
+    [CurrentAppContext() runNowOrWhenMainAppIsActive:^{
+        // ...but perform the work off the main thread.
+        dispatch_async(self.workQueue, ^{
+            if ([self scanOrphanFilesSync:orphanData shouldRemoveOrphans:shouldRemoveOrphans]) {
+                success();
+            } else {
+                [self scanOrphanFiles:orphanData
+                       remainingRetries:remainingRetries - 1
+                    shouldRemoveOrphans:shouldRemoveOrphans
+                                success:success
+                                failure:failure];
+            }
+        });
+    }];
 }
 
-+ (nullable NSArray<NSString *> *)getTempFilePaths
++ (OrphanFileScanner *)fileScannerForRemovingOrphans:(BOOL)shouldRemoveOrphans
 {
-    NSString *dir1 = OWSTemporaryDirectory();
-    NSArray<NSString *> *_Nullable paths1 = [[self filePathsInDirectorySafe:dir1].allObjects mutableCopy];
+    // We treat _all_ temp files as orphan files.  This is safe
+    // because temp files only need to be retained for the
+    // a single launch of the app.  Since our "date threshold"
+    // for deletion is relative to the current launch time,
+    // all temp files currently in use should be safe.
+    NSArray<NSString *> *rootDirPaths = @[
+        TSAttachmentStream.legacyAttachmentsDirPath,
+        TSAttachmentStream.sharedDataAttachmentsDirPath,
+        OWSUserProfile.legacyProfileAvatarsDirPath,
+        OWSUserProfile.sharedDataProfileAvatarsDirPath,
+        StickerManager.cacheDirUrl.path,
+        VoiceMessageModel.draftVoiceMessageDirectory.path,
+        OWSTemporaryDirectory(),
+        OWSTemporaryDirectoryAccessibleAfterFirstAuth(),
+    ];
+    return [[OrphanFileScanner alloc] initWithRootDirPaths:rootDirPaths
+                                             keyValueStore:self.keyValueStore
+                                                 cursorKey:(shouldRemoveOrphans ? OWSOrphanDataCleaner_FileScanCursorKey
+                                                                                 : OWSOrphanDataCleaner_AuditFileScanCursorKey)];
+}
 
-    NSString *dir2 = OWSTemporaryDirectoryAccessibleAfterFirstAuth();
-    NSArray<NSString *> *_Nullable paths2 = [[self filePathsInDirectorySafe:dir2].allObjects mutableCopy];
+// Returns NO on failure, usually indicating that the scan aborted due to
+// the app resigning active. The scan checkpoints its progress, so the
+// next attempt (possibly in a later launch) resumes where this one stopped.
++ (BOOL)scanOrphanFilesSync:(OWSOrphanData *)orphanData shouldRemoveOrphans:(BOOL)shouldRemoveOrphans
+{
+    OWSAssertDebug(orphanData);
 
-    if (paths1 && paths2) {
-        return [paths1 arrayByAddingObjectsFromArray:paths2];
-    } else {
-        return nil;
+    if (!self.isMainAppAndActive) {
+        return NO;
     }
+
+    // We need to avoid cleaning up new files that are still in the process of
+    // being created/written, so we don't clean up anything recent.
+    const NSTimeInterval kMinimumOrphanAgeSeconds = CurrentAppContext().isRunningTests ? 0.f : 15 * kMinuteInterval;
+    NSDate *appLaunchTime = CurrentAppContext().appLaunchTime;
+    NSTimeInterval thresholdTimestamp = appLaunchTime.timeIntervalSince1970 - kMinimumOrphanAgeSeconds;
+    NSDate *thresholdDate = [NSDate dateWithTimeIntervalSince1970:thresholdTimestamp];
+
+    // This should be redundant, but this will future-proof us against
+    // ever accidentally removing the GRDB databases during
+    // orphan clean up.
+    NSString *grdbPrimaryDirectoryPath =
+        [GRDBDatabaseStorageAdapter databaseDirUrlWithBaseDir:SDSDatabaseStorage.baseDir
+                                                directoryMode:DirectoryModePrimary]
+            .path;
+    NSString *grdbHotswapDirectoryPath =
+        [GRDBDatabaseStorageAdapter databaseDirUrlWithBaseDir:SDSDatabaseStorage.baseDir
+                                                directoryMode:DirectoryModeHotswap]
+            .path;
+
+    __block NSUInteger fileCount = 0;
+    __block NSUInteger filesRemoved = 0;
+    BOOL didComplete = [[self fileScannerForRemovingOrphans:shouldRemoveOrphans]
+        scanWithShouldContinue:^{ return self.isMainAppAndActive; }
+                       visitor:^(NSString *filePath) {
+                           fileCount++;
+
+                           if ([filePath hasPrefix:grdbPrimaryDirectoryPath]) {
+                               OWSLogInfo(@"Protecting database file: %@", filePath);
+                               return;
+                           } else if ([filePath hasPrefix:grdbHotswapDirectoryPath]) {
+                               OWSLogInfo(@"Protecting database hotswap file: %@", filePath);
+                               return;
+                           }
+                           if ([orphanData.referencedFilePaths contains:filePath]) {
+                               return;
+                           }
+
+                           NSError *error;
+                           NSDictionary *attributes =
+                               [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:&error];
+                           if (!attributes || error) {
+                               // This is fine; the file may have been deleted since we found it.
+                               OWSLogWarn(@"Could not get attributes of file at: %@", filePath);
+                               return;
+                           }
+                           // Don't delete files which were created in the last N minutes.
+                           NSDate *creationDate = attributes.fileModificationDate;
+                           if ([creationDate isAfterDate:thresholdDate]) {
+                               OWSLogInfo(@"Skipping file due to age: %f", fabs([creationDate timeIntervalSinceNow]));
+                               return;
+                           }
+                           OWSLogInfo(@"Deleting file: %@", filePath);
+                           filesRemoved++;
+                           if (!shouldRemoveOrphans) {
+                               return;
+                           }
+                           if (![OWSFileSystem deleteFile:filePath ignoreIfMissing:YES]) {
+                               OWSLogDebug(@"Could not remove orphan file at: %@", filePath);
+                               OWSFailDebug(@"Could not remove orphan file");
+                           }
+                       }];
+
+    OWSLogInfo(@"Scanned files: %zu, deleted orphan files: %zu, complete: %d", fileCount, filesRemoved, didComplete);
+
+    return didComplete;
 }
 
 @end
@@ -0,0 +1,242 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+// Visits the files in a list of directories and checkpoints its position
+// in a key-value store, so that a scan which is interrupted (e.g. because
+// the app resigned active) resumes where it stopped, even across launches.
+//
+// Directories are walked depth-first, and the entries of each directory are
+// visited in sorted order, so the scan order is stable across launches. The
+// entries of a directory are listed in bounded batches: each batch streams
+// the directory and keeps only the lowest names above the last visited one,
+// so large flat directories are never held in memory in full.
+@objc
+public class OrphanFileScanner: NSObject {
+
+    struct Cursor: Codable, Equatable {
+        let rootDirPath: String
+        // The path of the last file that was visited, relative to rootDirPath.
+        let pathComponents: [String]
+    }
+
+    private let rootDirPaths: [String]
+    private let keyValueStore: SDSKeyValueStore
+    private let cursorKey: String
+    private let checkpointInterval: Int
+    private let listingBatchSize: Int
+
+    @objc
+    public convenience init(rootDirPaths: [String], keyValueStore: SDSKeyValueStore, cursorKey: String) {
+        self.init(rootDirPaths: rootDirPaths,
+                  keyValueStore: keyValueStore,
+                  cursorKey: cursorKey,
+                  checkpointInterval: 500,
+                  listingBatchSize: 2000)
+    }
+
+    public init(rootDirPaths: [String],
+                keyValueStore: SDSKeyValueStore,
+                cursorKey: String,
+                checkpointInterval: Int,
+                listingBatchSize: Int) {
+        owsAssertDebug(checkpointInterval > 0)
+        owsAssertDebug(listingBatchSize > 0)
+
+        self.rootDirPaths = rootDirPaths
+        self.keyValueStore = keyValueStore
+        self.cursorKey = cursorKey
+        self.checkpointInterval = checkpointInterval
+        self.listingBatchSize = listingBatchSize
+
+        super.init()
+    }
+
+    // MARK: - Cursor
+
+    func loadCursor() -> Cursor? {
+        databaseStorage.read { transaction in
+            do {
+                return try self.keyValueStore.getCodableValue(forKey: self.cursorKey, transaction: transaction)
+            } catch {
+                owsFailDebug("Error: \(error)")
+                return nil
+            }
+        }
+    }
+
+    private func saveCursor(_ cursor: Cursor?) {
+        databaseStorage.write { transaction in
+            guard let cursor = cursor else {
+                self.keyValueStore.removeValue(forKey: self.cursorKey, transaction: transaction)
+                return
+            }
+            do {
+                try self.keyValueStore.setCodable(cursor, key: self.cursorKey, transaction: transaction)
+            } catch {
+                owsFailDebug("Error: \(error)")
+            }
+        }
+    }
+
+    @objc
+    public var hasScanInProgress: Bool {
+        loadCursor() != nil
+    }
+
+    // MARK: - Scan
+
+    // Visits each file that hasn't been visited since the scan began.
+    //
+    // Returns false if the scan was stopped because shouldContinue returned
+    // false; the next call will resume the scan. Returns true once every
+    // file has been visited; the next call will begin a new scan.
+    @objc
+    public func scan(shouldContinue: () -> Bool, visitor: (String) -> Void) -> Bool {
+        var resumeCursor = loadCursor()
+        var startIndex = 0
+        if let cursor = resumeCursor {
+            if let rootIndex = rootDirPaths.firstIndex(of: cursor.rootDirPath) {
+                Logger.info("Resuming scan of \(cursor.rootDirPath).")
+                startIndex = rootIndex
+            } else {
+                Logger.warn("Discarding cursor for unknown directory.")
+                resumeCursor = nil
+            }
+        }
+
+        var lastVisitedCursor: Cursor?
+        var uncheckpointedCount = 0
+        for rootDirPath in rootDirPaths[startIndex...] {
+            let resumeAfter = resumeCursor?.rootDirPath == rootDirPath ? resumeCursor?.pathComponents[...] : nil
+            let didComplete = walk(dirPath: rootDirPath,
+                                   pathComponents: [],
+                                   resumeAfter: resumeAfter) { filePath, pathComponents in
+                guard shouldContinue() else {
+                    return false
+                }
+                visitor(filePath)
+
+                lastVisitedCursor = Cursor(rootDirPath: rootDirPath, pathComponents: pathComponents)
+                uncheckpointedCount += 1
+                if uncheckpointedCount >= checkpointInterval {
+                    saveCursor(lastVisitedCursor)
+                    uncheckpointedCount = 0
+                }
+                return true
+            }
+            guard didComplete else {
+                if uncheckpointedCount > 0 {
+                    saveCursor(lastVisitedCursor)
+                }
+                return false
+            }
+        }
+
+        saveCursor(nil)
+        return true
+    }
+
+    // Returns false if the walk was stopped by the visitor.
+    private func walk(dirPath: String,
+                      pathComponents: [String],
+                      resumeAfter: ArraySlice<String>?,
+                      visitor: (String, [String]) -> Bool) -> Bool {
+        guard FileManager.default.fileExists(atPath: dirPath) else {
+            return true
+        }
+
+        // Entries at or below the lower bound have already been visited.
+        var lowerBound: String?
+        if let resumeAfter = resumeAfter, let resumeFileName = resumeAfter.first {
+            lowerBound = resumeFileName
+            if resumeAfter.count > 1 {
+                // The cursor is inside this subdirectory; finish it first.
+                guard visit(fileName: resumeFileName,
+                            dirPath: dirPath,
+                            pathComponents: pathComponents,
+                            resumeAfter: resumeAfter.dropFirst(),
+                            visitor: visitor) else {
+                    return false
+                }
+            }
+        }
+
+        while true {
+            let fileNames = nextFileNames(dirPath: dirPath, after: lowerBound)
+            for fileName in fileNames {
+                guard visit(fileName: fileName,
+                            dirPath: dirPath,
+                            pathComponents: pathComponents,
+                            resumeAfter: nil,
+                            visitor: visitor) else {
+                    return false
+                }
+            }
+            guard fileNames.count == listingBatchSize else {
+                return true
+            }
+            lowerBound = fileNames.last
+        }
+    }
+
+    // Returns false if the walk was stopped by the visitor.
+    private func visit(fileName: String,
+                       dirPath: String,
+                       pathComponents: [String],
+                       resumeAfter: ArraySlice<String>?,
+                       visitor: (String, [String]) -> Bool) -> Bool {
+        let filePath = (dirPath as NSString).appendingPathComponent(fileName)
+        var isDirectory: ObjCBool = false
+        guard FileManager.default.fileExists(atPath: filePath, isDirectory: &isDirectory) else {
+            // Races may cause files to be removed while we crawl the directory contents.
+            return true
+        }
+        let childPathComponents = pathComponents + [fileName]
+        if isDirectory.boolValue {
+            return walk(dirPath: filePath,
+                        pathComponents: childPathComponents,
+                        resumeAfter: resumeAfter,
+                        visitor: visitor)
+        } else {
+            return visitor(filePath, childPathComponents)
+        }
+    }
+
+    // Returns the lowest listingBatchSize entry names of the directory that
+    // sort after lowerBound, in sorted order.
+    private func nextFileNames(dirPath: String, after lowerBound: String?) -> [String] {
+        guard let enumerator = FileManager.default.enumerator(at: URL(fileURLWithPath: dirPath),
+                                                              includingPropertiesForKeys: nil,
+                                                              options: .skipsSubdirectoryDescendants,
+                                                              errorHandler: { _, error in
+                                                                // Races may cause files to be removed while we crawl the directory contents.
+                                                                Logger.warn("Error: \(error)")
+                                                                return true
+                                                              }) else {
+            return []
+        }
+
+        var fileNames = [String]()
+        func truncateToBatch() {
+            fileNames.sort()
+            if fileNames.count > listingBatchSize {
+                fileNames.removeLast(fileNames.count - listingBatchSize)
+            }
+        }
+        for case let fileUrl as URL in enumerator {
+            let fileName = fileUrl.lastPathComponent
+            if let lowerBound = lowerBound, fileName <= lowerBound {
+                continue
+            }
+            fileNames.append(fileName)
+            if fileNames.count >= listingBatchSize * 2 {
+                truncateToBatch()
+            }
+        }
+        truncateToBatch()
+        return fileNames
+    }
+}
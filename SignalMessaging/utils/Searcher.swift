@@ -1,5 +1,5 @@
 //
-//  Copyright (c) 2019 Open Whisper Systems. All rights reserved.
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
 //
 
 import Foundation
@@ -19,36 +19,56 @@ import Foundation
     }
 }
 
+// A search query which has been normalized and split into terms, so
+// that it can be matched against many items.
+public struct SearcherQuery {
+    fileprivate let terms: [String]
+
+    public init(_ query: String) {
+        var normalized = Searcher<Any>.normalize(string: query)
+
+        // Remove any phone number formatting from the search terms
+        let nonformattingScalars = normalized.unicodeScalars.lazy.filter {
+            !CharacterSet.punctuationCharacters.contains($0)
+        }
+
+        normalized = String(String.UnicodeScalarView(nonformattingScalars))
+
+        terms = normalized.components(separatedBy: .whitespacesAndNewlines)
+    }
+}
+
 // A generic searching class, configurable with an indexing block
 public class Searcher<T> {
 
     private let indexer: (T, SDSAnyReadTransaction) -> String
+    private let isIndexNormalized: Bool
 
     public init(indexer: @escaping (T, SDSAnyReadTransaction) -> String) {
         self.indexer = indexer
+        self.isIndexNormalized = false
     }
 
-    public func matches(item: T, query: String, transaction: SDSAnyReadTransaction) -> Bool {
-        let itemString = normalize(string: indexer(item, transaction))
-        return stem(string: query).map { queryStem in
-            return itemString.contains(queryStem)
-        }.reduce(true) { $0 && $1 }
+    // The strings returned by normalizedIndexer must already be
+    // normalized with Searcher.normalize(string:), e.g. because
+    // they're cached.
+    public init(normalizedIndexer: @escaping (T, SDSAnyReadTransaction) -> String) {
+        self.indexer = normalizedIndexer
+        self.isIndexNormalized = true
     }
 
-    private func stem(string: String) -> [String] {
-        var normalized = normalize(string: string)
-
-        // Remove any phone number formatting from the search terms
-        let nonformattingScalars = normalized.unicodeScalars.lazy.filter {
-            !CharacterSet.punctuationCharacters.contains($0)
-        }
-
-        normalized = String(String.UnicodeScalarView(nonformattingScalars))
+    public func matches(item: T, query: String, transaction: SDSAnyReadTransaction) -> Bool {
+        return matches(item: item, query: SearcherQuery(query), transaction: transaction)
+    }
 
-        return normalized.components(separatedBy: .whitespacesAndNewlines)
+    // Prefer this method when matching a query against many items.
+    public func matches(item: T, query: SearcherQuery, transaction: SDSAnyReadTransaction) -> Bool {
+        let indexString = indexer(item, transaction)
+        let itemString = isIndexNormalized ? indexString : Self.normalize(string: indexString)
+        return query.terms.allSatisfy { itemString.contains($0) }
     }
 
-    private func normalize(string: String) -> String {
+    public static func normalize(string: String) -> String {
         return string.lowercased().trimmingCharacters(in: .whitespacesAndNewlines)
     }
 }
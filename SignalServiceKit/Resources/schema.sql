@@ -1079,3 +1079,242 @@ CREATE
         ON "pending_viewed_receipts"("threadId"
 )
 ;
+
+CREATE
+    TABLE
+        IF NOT EXISTS "indexable_text_pending" (
+            "id" INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL
+            ,"collection" TEXT NOT NULL
+            ,"uniqueId" TEXT NOT NULL
+        )
+;
+
+CREATE
+    UNIQUE INDEX "index_indexable_text_pending_on_collection_and_uniqueId"
+        ON "indexable_text_pending"("collection"
+    ,"uniqueId"
+)
+;
+
+CREATE
+    TABLE
+        IF NOT EXISTS "thread_unread_count" (
+            "threadUniqueId" TEXT NOT NULL PRIMARY KEY
+            ,"unreadCount" INTEGER NOT NULL
+        )
+;
+
+CREATE
+    TRIGGER "thread_unread_count_on_interaction_insert" AFTER INSERT
+        ON "model_TSInteraction"
+        WHEN (
+            NEW."read" IS 0
+            AND (
+                NEW."recordType" IN (
+                    19
+                    ,20
+                )
+                OR (
+                    NEW."recordType" IS 10
+                    AND NEW."messageType" IS 11
+                )
+            )
+        ) BEGIN INSERT
+            OR IGNORE INTO
+                "thread_unread_count"("threadUniqueId"
+                ,"unreadCount"
+)
+VALUES (
+NEW. "uniqueThreadId"
+,0
+)
+;
+
+UPDATE
+    "thread_unread_count"
+SET
+    "unreadCount" = "unreadCount" + 1
+WHERE
+    "threadUniqueId" = NEW. "uniqueThreadId"
+;
+
+END
+;
+
+CREATE
+    TRIGGER "thread_unread_count_on_interaction_delete" AFTER DELETE
+        ON "model_TSInteraction"
+        WHEN (
+            OLD."read" IS 0
+            AND (
+                OLD."recordType" IN (
+                    19
+                    ,20
+                )
+                OR (
+                    OLD."recordType" IS 10
+                    AND OLD."messageType" IS 11
+                )
+            )
+        ) BEGIN UPDATE
+            "thread_unread_count"
+        SET
+            "unreadCount" = "unreadCount" - 1
+        WHERE
+            "threadUniqueId" = OLD. "uniqueThreadId"
+;
+
+END
+;
+
+CREATE
+    TRIGGER "thread_unread_count_on_interaction_update" AFTER UPDATE
+        OF "read"
+        ,"recordType"
+        ,"messageType"
+        ,"uniqueThreadId"
+            ON "model_TSInteraction"
+        WHEN (
+            OLD."read" IS 0
+            AND (
+                OLD."recordType" IN (
+                    19
+                    ,20
+                )
+                OR (
+                    OLD."recordType" IS 10
+                    AND OLD."messageType" IS 11
+                )
+            )
+        ) IS NOT (
+            NEW."read" IS 0
+            AND (
+                NEW."recordType" IN (
+                    19
+                    ,20
+                )
+                OR (
+                    NEW."recordType" IS 10
+                    AND NEW."messageType" IS 11
+                )
+            )
+        )
+        OR OLD. "uniqueThreadId" IS NOT NEW. "uniqueThreadId" BEGIN UPDATE
+            "thread_unread_count"
+        SET
+            "unreadCount" = "unreadCount" - 1
+        WHERE
+            "threadUniqueId" = OLD. "uniqueThreadId"
+            AND (
+            OLD."read" IS 0
+            AND (
+                OLD."recordType" IN (
+                    19
+                    ,20
+                )
+                OR (
+                    OLD."recordType" IS 10
+                    AND OLD."messageType" IS 11
+                )
+            )
+        )
+;
+
+INSERT
+    OR IGNORE INTO
+        "thread_unread_count"("threadUniqueId"
+        ,"unreadCount"
+)
+SELECT
+    NEW. "uniqueThreadId"
+    ,0
+WHERE
+    (
+            NEW."read" IS 0
+            AND (
+                NEW."recordType" IN (
+                    19
+                    ,20
+                )
+                OR (
+                    NEW."recordType" IS 10
+                    AND NEW."messageType" IS 11
+                )
+            )
+        )
+;
+
+UPDATE
+    "thread_unread_count"
+SET
+    "unreadCount" = "unreadCount" + 1
+WHERE
+    "threadUniqueId" = NEW. "uniqueThreadId"
+    AND (
+            NEW."read" IS 0
+            AND (
+                NEW."recordType" IN (
+                    19
+                    ,20
+                )
+                OR (
+                    NEW."recordType" IS 10
+                    AND NEW."messageType" IS 11
+                )
+            )
+        )
+;
+
+END
+;
+
+CREATE
+    TRIGGER "thread_unread_count_on_thread_delete" AFTER DELETE
+        ON "model_TSThread" BEGIN DELETE
+        FROM
+            "thread_unread_count"
+        WHERE
+            "threadUniqueId" = OLD. "uniqueId"
+;
+
+END
+;
+
+CREATE
+    TABLE
+        IF NOT EXISTS "cross_process_change_journal" (
+            "sequence" INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL
+            ,"changes" BLOB NOT NULL
+        )
+;
+
+CREATE
+    TABLE
+        IF NOT EXISTS "interaction_delete_generation" (
+            "threadUniqueId" TEXT NOT NULL PRIMARY KEY
+            ,"generation" INTEGER NOT NULL
+        )
+;
+
+CREATE
+    TRIGGER "interaction_delete_generation_on_interaction_delete" AFTER DELETE
+        ON "model_TSInteraction" BEGIN INSERT
+            OR IGNORE INTO "interaction_delete_generation"("threadUniqueId"
+            ,"generation"
+)
+VALUES (
+OLD. "uniqueThreadId"
+,0
+)
+;
+
+UPDATE
+    "interaction_delete_generation"
+SET
+    "generation" = "generation" + 1
+WHERE
+    "threadUniqueId" = OLD. "uniqueThreadId"
+;
+
+END
+;
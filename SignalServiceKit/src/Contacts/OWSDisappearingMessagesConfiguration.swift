@@ -3,6 +3,7 @@
 //
 
 import Foundation
+import GRDB
 
 @objc
 public class DisappearingMessageToken: MTLModel {
@@ -81,6 +82,42 @@ public extension OWSDisappearingMessagesConfiguration {
         return oldConfiguration.applyToken(token, transaction: transaction)
     }
 
+    // The batch equivalent of fetchOrBuildDefault(with:transaction:),
+    // keyed by thread unique id.
+    static func fetchOrBuildDefaults(threads: [TSThread],
+                                     transaction: SDSAnyReadTransaction) -> [String: OWSDisappearingMessagesConfiguration] {
+        // Thread id == configuration id.
+        var result = [String: OWSDisappearingMessagesConfiguration]()
+        let threadIds = threads.map { $0.uniqueId }
+        for chunk in threadIds.chunked(by: GRDBWriteTransaction.maxVariablesPerStatement) {
+            let placeholders = Array(repeating: "?", count: chunk.count).joined(separator: ", ")
+            let sql = """
+                SELECT *
+                FROM \(DisappearingMessagesConfigurationRecord.databaseTableName)
+                WHERE \(disappearingMessagesConfigurationColumn: .uniqueId) IN (\(placeholders))
+            """
+            let cursor = grdbFetchCursor(sql: sql,
+                                         arguments: StatementArguments(chunk),
+                                         transaction: transaction.unwrapGrdbRead)
+            do {
+                while let configuration = try cursor.next() {
+                    result[configuration.uniqueId] = configuration
+                }
+            } catch {
+                owsFailDebug("Error: \(error)")
+            }
+        }
+
+        for threadId in threadIds where result[threadId] == nil {
+            result[threadId] = OWSDisappearingMessagesConfiguration(
+                threadId: threadId,
+                enabled: OWSDisappearingMessagesConfigurationDefaultExpirationDuration > 0,
+                durationSeconds: UInt32(OWSDisappearingMessagesConfigurationDefaultExpirationDuration)
+            )
+        }
+        return result
+    }
+
     @objc
     @discardableResult
     func applyToken(_ token: DisappearingMessageToken,
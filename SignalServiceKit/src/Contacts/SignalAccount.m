@@ -315,6 +315,21 @@ static NSString *kSignalPreferNicknamesPreference = @"NSPersonNameDefaultShouldP
     [self.modelReadCaches.signalAccountReadCache didInsertOrUpdateSignalAccount:self transaction:transaction];
 }
 
++ (void)anyDidInsertBatch:(NSArray<TSYapDatabaseObject *> *)models transaction:(SDSAnyWriteTransaction *)transaction
+{
+    // Mirrors anyDidInsertWithTransaction:, but updates the cache once per batch.
+    NSMutableArray<SignalAccount *> *signalAccounts = [NSMutableArray new];
+    for (TSYapDatabaseObject *model in models) {
+        if (![model isKindOfClass:[SignalAccount class]]) {
+            OWSFailDebug(@"Unexpected model: %@", model.class);
+            continue;
+        }
+        [signalAccounts addObject:(SignalAccount *)model];
+    }
+    [self.modelReadCaches.signalAccountReadCache didInsertOrUpdateSignalAccounts:signalAccounts
+                                                                     transaction:transaction];
+}
+
 - (void)anyDidUpdateWithTransaction:(SDSAnyWriteTransaction *)transaction
 {
     [super anyDidUpdateWithTransaction:transaction];
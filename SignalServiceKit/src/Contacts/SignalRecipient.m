@@ -599,6 +599,21 @@ const NSUInteger SignalRecipientSchemaVersion = 1;
     [self.modelReadCaches.signalRecipientReadCache didInsertOrUpdateSignalRecipient:self transaction:transaction];
 }
 
++ (void)anyDidInsertBatch:(NSArray<TSYapDatabaseObject *> *)models transaction:(SDSAnyWriteTransaction *)transaction
+{
+    // Mirrors anyDidInsertWithTransaction:, but updates the cache once per batch.
+    NSMutableArray<SignalRecipient *> *signalRecipients = [NSMutableArray new];
+    for (TSYapDatabaseObject *model in models) {
+        if (![model isKindOfClass:[SignalRecipient class]]) {
+            OWSFailDebug(@"Unexpected model: %@", model.class);
+            continue;
+        }
+        [signalRecipients addObject:(SignalRecipient *)model];
+    }
+    [self.modelReadCaches.signalRecipientReadCache didInsertOrUpdateSignalRecipients:signalRecipients
+                                                                         transaction:transaction];
+}
+
 - (void)anyDidUpdateWithTransaction:(SDSAnyWriteTransaction *)transaction
 {
     [super anyDidUpdateWithTransaction:transaction];
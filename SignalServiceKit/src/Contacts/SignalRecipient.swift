@@ -145,3 +145,64 @@ extension SignalRecipient {
         transaction.addAsyncCompletion(queue: .main) { ModelReadCaches.shared.evacuateAllCaches() }
     }
 }
+
+// MARK: - Batch Insert
+
+extension SignalRecipient {
+    // Inserts registered, high trust recipients in bulk for any of the given
+    // addresses which have no recipient yet, e.g. when restoring contacts from
+    // the storage service.
+    //
+    // Addresses which match an existing recipient (by UUID or phone number)
+    // are skipped, since they may need to be merged. Callers should still call
+    // mark(asRegisteredAndGet:) for every address; it will find the recipients
+    // inserted here.
+    public static func insertRegisteredRecipients(forNewAddresses addresses: [SignalServiceAddress],
+                                                  transaction: SDSAnyWriteTransaction) {
+        let recipientFinder = AnySignalRecipientFinder()
+        var uuids = Set<UUID>()
+        var phoneNumbers = Set<String>()
+        var newRecipients = [SignalRecipient]()
+        for address in addresses {
+            guard address.isValid else {
+                continue
+            }
+            // Skip addresses which overlap with another address in the batch.
+            if let uuid = address.uuid {
+                guard !uuids.contains(uuid),
+                      recipientFinder.signalRecipientForUUID(uuid, transaction: transaction) == nil else {
+                    continue
+                }
+            }
+            if let phoneNumber = address.phoneNumber {
+                guard !phoneNumbers.contains(phoneNumber),
+                      recipientFinder.signalRecipientForPhoneNumber(phoneNumber, transaction: transaction) == nil else {
+                    continue
+                }
+            }
+            if let uuid = address.uuid {
+                uuids.insert(uuid)
+            }
+            if let phoneNumber = address.phoneNumber {
+                phoneNumbers.insert(phoneNumber)
+            }
+            newRecipients.append(SignalRecipient(address: address))
+        }
+        guard !newRecipients.isEmpty else {
+            return
+        }
+
+        Logger.info("Inserting \(newRecipients.count) new recipients.")
+        anyInsert(batch: newRecipients, transaction: transaction)
+
+        for recipient in newRecipients {
+            // Update the SignalServiceAddressCache mappings with the new recipient.
+            if let uuidString = recipient.recipientUUID, let uuid = UUID(uuidString: uuidString) {
+                Self.signalServiceAddressCache.updateMapping(uuid: uuid, phoneNumber: recipient.recipientPhoneNumber)
+            }
+        }
+
+        // Record the new contacts in the social graph.
+        Self.storageServiceManager.recordPendingUpdates(updatedAccountIds: newRecipients.map { $0.accountId })
+    }
+}
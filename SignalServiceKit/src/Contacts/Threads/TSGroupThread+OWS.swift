@@ -157,19 +157,22 @@ public extension TSGroupThread {
         }
 
         let interactionFinder = InteractionFinder(threadUniqueId: uniqueId)
-        for address in addressesToAdd {
+        let newMembers = addressesToAdd.map { address -> TSGroupMember in
             // We look up the latest interaction by this user, because they could
             // have been a member of the group previously.
             let lastInteraction = interactionFinder.latestInteraction(
                 from: address,
                 transaction: transaction
             )
-            TSGroupMember(
+            return TSGroupMember(
                 address: address,
                 groupThreadId: uniqueId,
                 lastInteractionTimestamp: lastInteraction?.timestamp ?? 0
-            ).anyInsert(transaction: transaction)
+            )
         }
+        // New groups (e.g. from group sync or a storage service restore)
+        // add every member at once.
+        TSGroupMember.anyInsert(batch: newMembers, transaction: transaction)
     }
 }
 
@@ -0,0 +1,264 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+@objc
+public enum AttachmentDownloadPriority: UInt, Comparable, CaseIterable {
+    // e.g. downloads of all attachments in a newly whitelisted thread.
+    case backfill
+    // Other message attachments.
+    case media
+    // Stickers, thumbnails and avatars, which are small and which
+    // we'd rather not leave as placeholders.
+    case thumbnail
+    // Attachments which are currently on screen.
+    case visible
+
+    public static func < (lhs: AttachmentDownloadPriority, rhs: AttachmentDownloadPriority) -> Bool {
+        lhs.rawValue < rhs.rawValue
+    }
+}
+
+// MARK: -
+
+// Orders pending attachment downloads and decides how many may run at once.
+//
+// * Jobs are dequeued highest priority first, and in FIFO order within
+//   a priority.
+// * Jobs for attachments which are visible are promoted to .visible,
+//   including jobs which are already queued.
+// * The concurrency limit adapts to the observed throughput; see
+//   AttachmentDownloadConcurrency.
+//
+// This class is not thread-safe.
+class AttachmentDownloadScheduler<Job> {
+
+    typealias AttachmentId = String
+
+    private struct Entry {
+        let job: Job
+        let attachmentId: AttachmentId
+        let basePriority: AttachmentDownloadPriority
+        var priority: AttachmentDownloadPriority
+    }
+
+    // Entries are keyed by a sequence number which preserves FIFO order.
+    private var nextSequenceNumber: UInt64 = 0
+    private var entries = [UInt64: Entry]()
+    private var sequenceNumbersByAttachmentId = [AttachmentId: Set<UInt64>]()
+
+    // A FIFO of sequence numbers for each priority. When a job is
+    // re-prioritized, it is appended to the FIFO of its new priority
+    // and its stale position in the old FIFO is skipped on dequeue.
+    private var fifos = [AttachmentDownloadPriority: [UInt64]]()
+    private var fifoHeads = [AttachmentDownloadPriority: Int]()
+
+    private var visibleAttachmentIds = Set<AttachmentId>()
+
+    let concurrency: AttachmentDownloadConcurrency
+
+    init(concurrency: AttachmentDownloadConcurrency = AttachmentDownloadConcurrency()) {
+        self.concurrency = concurrency
+    }
+
+    var count: Int { entries.count }
+
+    var isEmpty: Bool { entries.isEmpty }
+
+    func enqueue(_ job: Job, attachmentId: AttachmentId, priority basePriority: AttachmentDownloadPriority) {
+        let sequenceNumber = nextSequenceNumber
+        nextSequenceNumber += 1
+
+        let priority = (visibleAttachmentIds.contains(attachmentId)
+                            ? AttachmentDownloadPriority.visible
+                            : basePriority)
+        entries[sequenceNumber] = Entry(job: job,
+                                        attachmentId: attachmentId,
+                                        basePriority: basePriority,
+                                        priority: priority)
+        sequenceNumbersByAttachmentId[attachmentId, default: []].insert(sequenceNumber)
+        fifos[priority, default: []].append(sequenceNumber)
+    }
+
+    // Returns nil if the queue is empty or if activeCount has reached
+    // the concurrency limit. One extra slot is reserved for visible
+    // attachments, so they never wait behind a full set of background
+    // downloads.
+    func dequeue(activeCount: Int) -> Job? {
+        guard let priority = nextPriority() else {
+            return nil
+        }
+        let maxActiveCount = concurrency.limit + (priority == .visible ? 1 : 0)
+        guard activeCount < maxActiveCount else {
+            return nil
+        }
+        guard let sequenceNumber = popFifo(priority: priority),
+              let entry = entries.removeValue(forKey: sequenceNumber) else {
+            owsFailDebug("Missing entry.")
+            return nil
+        }
+        sequenceNumbersByAttachmentId[entry.attachmentId]?.remove(sequenceNumber)
+        if sequenceNumbersByAttachmentId[entry.attachmentId]?.isEmpty == true {
+            sequenceNumbersByAttachmentId[entry.attachmentId] = nil
+        }
+        return entry.job
+    }
+
+    // Replaces the set of visible attachments, e.g. when the user scrolls.
+    // Queued jobs for attachments which are no longer visible revert to
+    // their original priority.
+    func setVisibleAttachmentIds(_ attachmentIds: Set<AttachmentId>) {
+        let hiddenAttachmentIds = visibleAttachmentIds.subtracting(attachmentIds)
+        let shownAttachmentIds = attachmentIds.subtracting(visibleAttachmentIds)
+        visibleAttachmentIds = attachmentIds
+
+        for attachmentId in hiddenAttachmentIds {
+            reprioritize(attachmentId: attachmentId) { $0.basePriority }
+        }
+        for attachmentId in shownAttachmentIds {
+            reprioritize(attachmentId: attachmentId) { _ in .visible }
+        }
+    }
+
+    func priority(forAttachmentId attachmentId: AttachmentId) -> AttachmentDownloadPriority? {
+        sequenceNumbersByAttachmentId[attachmentId]?.compactMap { entries[$0]?.priority }.max()
+    }
+
+    // MARK: -
+
+    private func reprioritize(attachmentId: AttachmentId,
+                              block: (Entry) -> AttachmentDownloadPriority) {
+        guard let sequenceNumbers = sequenceNumbersByAttachmentId[attachmentId] else {
+            return
+        }
+        for sequenceNumber in sequenceNumbers.sorted() {
+            guard var entry = entries[sequenceNumber] else {
+                owsFailDebug("Missing entry.")
+                continue
+            }
+            let priority = block(entry)
+            guard priority != entry.priority else {
+                continue
+            }
+            entry.priority = priority
+            entries[sequenceNumber] = entry
+            fifos[priority, default: []].append(sequenceNumber)
+        }
+    }
+
+    private func nextPriority() -> AttachmentDownloadPriority? {
+        for priority in AttachmentDownloadPriority.allCases.reversed() {
+            skipStaleFifoEntries(priority: priority)
+            if let fifo = fifos[priority],
+               fifoHeads[priority, default: 0] < fifo.count {
+                return priority
+            }
+        }
+        return nil
+    }
+
+    private func skipStaleFifoEntries(priority: AttachmentDownloadPriority) {
+        guard let fifo = fifos[priority] else {
+            return
+        }
+        var head = fifoHeads[priority, default: 0]
+        while head < fifo.count {
+            if let entry = entries[fifo[head]], entry.priority == priority {
+                break
+            }
+            head += 1
+        }
+        if head >= fifo.count {
+            fifos[priority] = nil
+            fifoHeads[priority] = nil
+        } else if head > 64, head * 2 > fifo.count {
+            // Compact the FIFO once most of it has been consumed.
+            fifos[priority] = Array(fifo[head...])
+            fifoHeads[priority] = 0
+        } else {
+            fifoHeads[priority] = head
+        }
+    }
+
+    private func popFifo(priority: AttachmentDownloadPriority) -> UInt64? {
+        guard let fifo = fifos[priority] else {
+            return nil
+        }
+        let head = fifoHeads[priority, default: 0]
+        guard head < fifo.count else {
+            return nil
+        }
+        fifoHeads[priority] = head + 1
+        return fifo[head]
+    }
+}
+
+// MARK: -
+
+// Adapts the number of simultaneous downloads to the observed throughput.
+//
+// Each completed download yields an estimate of the aggregate throughput:
+// its own throughput multiplied by the number of downloads which were
+// running alongside it. These estimates are averaged over windows. At the
+// end of each window, we compare its throughput to that of the previous
+// window. If throughput improved, we keep moving the limit in the same
+// direction; if it got worse, we reverse direction. Otherwise, the limit
+// is left alone.
+//
+// This class is not thread-safe.
+class AttachmentDownloadConcurrency {
+
+    static let minLimit = 2
+    static let maxLimit = 8
+    static let initialLimit = 4
+
+    // The number of completed downloads in each window.
+    static let windowSize = 8
+
+    // Changes in throughput smaller than this are ignored.
+    static let throughputTolerance = 0.1
+
+    // The throughput of small downloads is dominated by latency.
+    static let minSampleByteCount: UInt64 = 100 * 1024
+
+    private(set) var limit = AttachmentDownloadConcurrency.initialLimit
+
+    private var direction = 1
+    private var windowThroughputs = [Double]()
+    private var lastThroughput: Double?
+
+    // concurrentCount should include the completed download.
+    func didCompleteDownload(byteCount: UInt64, duration: TimeInterval, concurrentCount: Int) {
+        guard byteCount >= Self.minSampleByteCount, duration > 0, concurrentCount > 0 else {
+            return
+        }
+        windowThroughputs.append(Double(byteCount) / duration * Double(concurrentCount))
+        guard windowThroughputs.count >= Self.windowSize else {
+            return
+        }
+        let throughput = windowThroughputs.reduce(0, +) / Double(windowThroughputs.count)
+        windowThroughputs.removeAll()
+        adjustLimit(throughput: throughput)
+        lastThroughput = throughput
+    }
+
+    private func adjustLimit(throughput: Double) {
+        if let lastThroughput = lastThroughput {
+            if throughput < lastThroughput * (1 - Self.throughputTolerance) {
+                direction = -direction
+            } else if throughput <= lastThroughput * (1 + Self.throughputTolerance) {
+                return
+            }
+        }
+        let newLimit = (limit + direction).clamp(Self.minLimit, Self.maxLimit)
+        if newLimit == limit {
+            // We've hit a bound; probe in the other direction next time.
+            direction = -direction
+        } else {
+            Logger.verbose("Download concurrency limit: \(limit) -> \(newLimit), throughput: \(Int(throughput)) bytes/sec.")
+            limit = newLimit
+        }
+    }
+}
@@ -36,6 +36,11 @@ public class OWSAttachmentDownloads: NSObject {
     private struct JobRequest {
         let jobType: JobType
         let category: AttachmentCategory
+        var isBackfill = false
+
+        var priority: AttachmentDownloadPriority {
+            isBackfill ? .backfill : category.defaultPriority
+        }
 
         var attachmentId: AttachmentId { jobType.attachmentId }
         var message: TSMessage? { jobType.message }
@@ -54,9 +59,13 @@ public class OWSAttachmentDownloads: NSObject {
         let resolver: Resolver<TSAttachmentStream>
 
         var progress: CGFloat = 0
+        var downloadStartTime: TimeInterval?
+        // This is set if the download succeeds.
+        var downloadedByteCount: UInt64?
         var attachmentId: AttachmentId { jobType.attachmentId }
         var message: TSMessage? { jobType.message }
         var category: AttachmentCategory { jobRequest.category }
+        var priority: AttachmentDownloadPriority { jobRequest.priority }
 
         init(jobRequest: JobRequest, downloadBehavior: AttachmentDownloadBehavior) {
 
@@ -77,7 +86,7 @@ public class OWSAttachmentDownloads: NSObject {
     // This property should only be accessed with unfairLock.
     private var activeJobMap = [AttachmentId: Job]()
     // This property should only be accessed with unfairLock.
-    private var jobQueue = [Job]()
+    private let jobQueue = AttachmentDownloadScheduler<Job>()
     // This property should only be accessed with unfairLock.
     private var completeAttachmentMap = Set<AttachmentId>()
 
@@ -133,11 +142,23 @@ public class OWSAttachmentDownloads: NSObject {
         }
     }
 
+    // Queued downloads of visible attachments are moved to the front
+    // of the queue. This should be updated as the user scrolls.
+    @objc
+    public func setVisibleAttachmentIds(_ attachmentIds: Set<AttachmentId>) {
+        Self.unfairLock.withLock {
+            jobQueue.setVisibleAttachmentIds(attachmentIds)
+        }
+
+        // Visible downloads may use a reserved download slot.
+        tryToStartNextDownload()
+    }
+
     // MARK: -
 
     private func enqueueJob(job: Job) {
         Self.unfairLock.withLock {
-            jobQueue.append(job)
+            jobQueue.enqueue(job, attachmentId: job.attachmentId, priority: job.priority)
         }
 
         tryToStartNextDownload()
@@ -145,20 +166,16 @@ public class OWSAttachmentDownloads: NSObject {
 
     private func dequeueNextJob() -> Job? {
         Self.unfairLock.withLock {
-            let kMaxSimultaneousDownloads = 4
-            guard activeJobMap.count < kMaxSimultaneousDownloads else {
-                return nil
-            }
-            guard let job = jobQueue.first else {
+            guard let job = jobQueue.dequeue(activeCount: activeJobMap.count) else {
                 return nil
             }
-            jobQueue.remove(at: 0)
             guard activeJobMap[job.attachmentId] == nil else {
                 // Ensure we only have one download in flight at a time for a given attachment.
                 Logger.warn("Ignoring duplicate download.")
                 return nil
             }
             activeJobMap[job.attachmentId] = job
+            job.downloadStartTime = CACurrentMediaTime()
             return job
         }
     }
@@ -168,6 +185,12 @@ public class OWSAttachmentDownloads: NSObject {
             let attachmentId = job.attachmentId
 
             owsAssertDebug(activeJobMap[attachmentId] != nil)
+            if let downloadedByteCount = job.downloadedByteCount,
+               let downloadStartTime = job.downloadStartTime {
+                jobQueue.concurrency.didCompleteDownload(byteCount: downloadedByteCount,
+                                                         duration: CACurrentMediaTime() - downloadStartTime,
+                                                         concurrentCount: activeJobMap.count)
+            }
             activeJobMap[attachmentId] = nil
 
             cancellationRequestMap[attachmentId] = nil
@@ -182,23 +205,27 @@ public class OWSAttachmentDownloads: NSObject {
 
     private func tryToStartNextDownload() {
         Self.serialQueue.async {
-            guard let job = self.dequeueNextJob() else {
-                return
+            // The concurrency limit may have grown, so start as
+            // many downloads as we can.
+            while let job = self.dequeueNextJob() {
+                self.startDownload(job: job)
             }
+        }
+    }
 
-            guard let attachmentPointer = self.prepareDownload(job: job) else {
-                // Abort.
-                self.markJobComplete(job, isAttachmentDownloaded: false)
-                return
-            }
+    private func startDownload(job: Job) {
+        guard let attachmentPointer = self.prepareDownload(job: job) else {
+            // Abort.
+            self.markJobComplete(job, isAttachmentDownloaded: false)
+            return
+        }
 
-            firstly { () -> Promise<TSAttachmentStream> in
-                self.retrieveAttachment(job: job, attachmentPointer: attachmentPointer)
-            }.done(on: Self.serialQueue) { (attachmentStream: TSAttachmentStream) in
-                self.downloadDidSucceed(attachmentStream: attachmentStream, job: job)
-            }.catch(on: Self.serialQueue) { (error: Error) in
-                self.downloadDidFail(error: error, job: job)
-            }
+        firstly { () -> Promise<TSAttachmentStream> in
+            self.retrieveAttachment(job: job, attachmentPointer: attachmentPointer)
+        }.done(on: Self.serialQueue) { (attachmentStream: TSAttachmentStream) in
+            self.downloadDidSucceed(attachmentStream: attachmentStream, job: job)
+        }.catch(on: Self.serialQueue) { (error: Error) in
+            self.downloadDidFail(error: error, job: job)
         }
     }
 
@@ -412,6 +439,8 @@ public class OWSAttachmentDownloads: NSObject {
         // TODO: Should we fulfill() if the attachmentPointer no longer existed?
         job.resolver.fulfill(attachmentStream)
 
+        job.downloadedByteCount = UInt64(attachmentStream.byteCount)
+
         markJobComplete(job, isAttachmentDownloaded: true)
     }
 
@@ -734,6 +763,7 @@ public extension OWSAttachmentDownloads {
                                                   attachmentGroup: .allAttachmentsIncoming,
                                                   downloadBehavior: .default,
                                                   touchMessageImmediately: false,
+                                                  isBackfill: true,
                                                   success: { downloadedAttachments in
                                                     unfairLock.withLock {
                                                         attachmentStreams.append(contentsOf: downloadedAttachments)
@@ -810,6 +840,15 @@ public extension OWSAttachmentDownloads {
             (self == .stickerSmall || self == .stickerLarge)
         }
 
+        var defaultPriority: AttachmentDownloadPriority {
+            switch self {
+            case .stickerSmall, .stickerLarge, .quotedReplyThumbnail, .linkedPreviewThumbnail, .contactShareAvatar:
+                return .thumbnail
+            case .bodyMediaImage, .bodyMediaVideo, .bodyAudioVoiceMemo, .bodyAudioOther, .bodyFile, .bodyOversizeText, .other:
+                return .media
+            }
+        }
+
         // MARK: - CustomStringConvertible
 
         public var description: String {
@@ -847,6 +886,7 @@ public extension OWSAttachmentDownloads {
 
     private class func buildJobRequests(forMessage message: TSMessage,
                                         attachmentGroup: AttachmentGroup,
+                                        isBackfill: Bool,
                                         transaction: SDSAnyReadTransaction) -> [JobRequest] {
 
         var jobRequests = [JobRequest]()
@@ -873,7 +913,7 @@ public extension OWSAttachmentDownloads {
             }
             attachmentIds.insert(attachmentId)
             let jobType = JobType.messageAttachment(attachmentId: attachmentId, message: message)
-            jobRequests.append(JobRequest(jobType: jobType, category: category))
+            jobRequests.append(JobRequest(jobType: jobType, category: category, isBackfill: isBackfill))
         }
 
         func addJobRequest(attachmentId: AttachmentId, category: AttachmentCategory) {
@@ -955,6 +995,23 @@ public extension OWSAttachmentDownloads {
                                       touchMessageImmediately: Bool,
                                       success: @escaping ([TSAttachmentStream]) -> Void,
                                       failure: @escaping (Error) -> Void) {
+        enqueueDownloadOfAttachments(forMessageId: messageId,
+                                     attachmentGroup: attachmentGroup,
+                                     downloadBehavior: downloadBehavior,
+                                     touchMessageImmediately: touchMessageImmediately,
+                                     isBackfill: false,
+                                     success: success,
+                                     failure: failure)
+    }
+
+    // Backfill downloads are queued behind all other downloads.
+    private func enqueueDownloadOfAttachments(forMessageId messageId: String,
+                                              attachmentGroup: AttachmentGroup,
+                                              downloadBehavior: AttachmentDownloadBehavior,
+                                              touchMessageImmediately: Bool,
+                                              isBackfill: Bool,
+                                              success: @escaping ([TSAttachmentStream]) -> Void,
+                                              failure: @escaping (Error) -> Void) {
 
         Self.serialQueue.async {
             guard !CurrentAppContext().isRunningTests else {
@@ -968,6 +1025,7 @@ public extension OWSAttachmentDownloads {
                 }
                 let jobRequests = Self.buildJobRequests(forMessage: message,
                                                         attachmentGroup: attachmentGroup,
+                                                        isBackfill: isBackfill,
                                                         transaction: transaction)
                 guard !jobRequests.isEmpty else {
                     success([])
@@ -1266,45 +1324,61 @@ public extension OWSAttachmentDownloads {
 
     // MARK: -
 
+    // Attachments are decrypted from file to file without loading the
+    // ciphertext into memory, so we can decrypt a few at a time without
+    // holding up the download queue.
+    private static let decryptionQueue: OperationQueue = {
+        let operationQueue = OperationQueue()
+        operationQueue.name = "org.whispersystems.signal.download.decrypt"
+        operationQueue.qualityOfService = .utility
+        operationQueue.maxConcurrentOperationCount = 2
+        return operationQueue
+    }()
+
     private class func decrypt(encryptedFileUrl: URL,
                                attachmentPointer: TSAttachmentPointer) -> Promise<TSAttachmentStream> {
 
-        // Use serialQueue to ensure that we only load into memory
-        // & decrypt a single attachment at a time.
-        return firstly(on: Self.serialQueue) { () -> TSAttachmentStream in
-            let cipherText = try Data(contentsOf: encryptedFileUrl)
-            return try autoreleasepool {
-                let attachmentStream = databaseStorage.read { transaction in
-                    TSAttachmentStream(pointer: attachmentPointer, transaction: transaction)
+        let (promise, resolver) = Promise<TSAttachmentStream>.pending()
+        decryptionQueue.addOperation {
+            defer {
+                do {
+                    try OWSFileSystem.deleteFileIfExists(url: encryptedFileUrl)
+                } catch {
+                    owsFailDebug("Error: \(error).")
                 }
+            }
+            do {
+                let attachmentStream = try autoreleasepool { () -> TSAttachmentStream in
+                    let attachmentStream = databaseStorage.read { transaction in
+                        TSAttachmentStream(pointer: attachmentPointer, transaction: transaction)
+                    }
 
-                guard let originalMediaURL = attachmentStream.originalMediaURL else {
-                    throw OWSAssertionError("Missing originalMediaURL.")
-                }
+                    guard let originalMediaURL = attachmentStream.originalMediaURL else {
+                        throw OWSAssertionError("Missing originalMediaURL.")
+                    }
 
-                guard let encryptionKey = attachmentPointer.encryptionKey else {
-                    throw OWSAssertionError("Missing encryptionKey.")
-                }
+                    guard let encryptionKey = attachmentPointer.encryptionKey else {
+                        throw OWSAssertionError("Missing encryptionKey.")
+                    }
 
-                try Cryptography.decryptAttachment(
-                    at: encryptedFileUrl,
-                    metadata: EncryptionMetadata(
-                        key: encryptionKey,
-                        digest: attachmentPointer.digest,
-                        plaintextLength: Int(attachmentPointer.byteCount)
-                    ),
-                    output: originalMediaURL
-                )
-
-                return attachmentStream
-            }
-        }.ensure(on: Self.serialQueue) {
-            do {
-                try OWSFileSystem.deleteFileIfExists(url: encryptedFileUrl)
+                    try Cryptography.decryptAttachment(
+                        at: encryptedFileUrl,
+                        metadata: EncryptionMetadata(
+                            key: encryptionKey,
+                            digest: attachmentPointer.digest,
+                            plaintextLength: Int(attachmentPointer.byteCount)
+                        ),
+                        output: originalMediaURL
+                    )
+
+                    return attachmentStream
+                }
+                resolver.fulfill(attachmentStream)
             } catch {
-                owsFailDebug("Error: \(error).")
+                resolver.reject(error)
             }
         }
+        return promise
     }
 
     // MARK: -
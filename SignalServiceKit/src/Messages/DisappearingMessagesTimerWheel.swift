@@ -0,0 +1,286 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+// A hierarchical timing wheel of the messages whose expiration has started.
+//
+// The wheel is seeded from a single query when the disappearing messages
+// job starts, and is maintained as expirations are started. This lets the
+// job find the expired messages and the next expiration without querying
+// the database on every pass.
+//
+// Each level has 64 slots; a slot at level N spans 64^N ticks. An entry is
+// placed at the level of the highest bit in which its tick differs from
+// the current tick, and is "cascaded" down a level each time the current
+// tick reaches the start of its slot. Inserting, removing and expiring an
+// entry therefore costs a bounded number of slot operations, regardless
+// of how many expirations are pending.
+@objc
+public class DisappearingMessagesTimerWheel: NSObject {
+
+    // Expirations are rounded up to the next tick, so messages are never
+    // deleted before they expire.
+    @objc
+    public static let tickMs: UInt64 = 1000
+
+    private static let slotBits = 6
+    private static let slotMask: UInt64 = (1 << UInt64(slotBits)) - 1
+    // 10 levels of 64 slots span 2^60 ticks, which covers any expiresAt.
+    private static let levelCount = 10
+
+    private enum Location {
+        case expired
+        case slot(level: Int, slot: Int)
+    }
+
+    private struct Entry {
+        let tick: UInt64
+        var location: Location
+    }
+
+    private let unfairLock = UnfairLock()
+
+    // The following properties should only be accessed with unfairLock.
+    private var currentTick: UInt64
+    private var entries = [String: Entry]()
+    private var slots: [[Set<String>]]
+    // A bitmask of the non-empty slots of each level.
+    private var occupancy: [UInt64]
+    private var expiredIds = Set<String>()
+
+    #if TESTABLE_BUILD
+    // The number of times that an entry was placed into a slot.
+    var slotOperationCount: UInt64 = 0
+    #endif
+
+    @objc
+    public convenience override init() {
+        self.init(nowMs: NSDate.ows_millisecondTimeStamp())
+    }
+
+    init(nowMs: UInt64) {
+        currentTick = nowMs / Self.tickMs
+        slots = Array(repeating: Array(repeating: Set<String>(), count: Int(Self.slotMask) + 1),
+                      count: Self.levelCount)
+        occupancy = Array(repeating: 0, count: Self.levelCount)
+
+        super.init()
+    }
+
+    private static func tick(forExpiresAt expiresAt: UInt64) -> UInt64 {
+        let tick = expiresAt / tickMs
+        return expiresAt % tickMs == 0 ? tick : tick + 1
+    }
+
+    // The time at which an expiration will be found by the wheel.
+    @objc
+    public static func deadline(forExpiresAt expiresAt: UInt64) -> UInt64 {
+        tick(forExpiresAt: expiresAt) * tickMs
+    }
+
+    @objc
+    public var count: Int {
+        unfairLock.withLock { entries.count }
+    }
+
+    // MARK: -
+
+    // Replaces any existing entry for the message.
+    @objc
+    public func insert(uniqueId: String, expiresAt: UInt64) {
+        owsAssertDebug(expiresAt > 0)
+
+        unfairLock.withLock {
+            removeEntry(uniqueId: uniqueId)
+            place(uniqueId: uniqueId, tick: Self.tick(forExpiresAt: expiresAt))
+        }
+    }
+
+    @objc
+    public func remove(uniqueId: String) {
+        unfairLock.withLock {
+            removeEntry(uniqueId: uniqueId)
+        }
+    }
+
+    // Replaces all of the entries in the wheel.
+    public func reset(nowMs: UInt64, expirations: [String: UInt64]) {
+        unfairLock.withLock {
+            currentTick = nowMs / Self.tickMs
+            entries.removeAll()
+            expiredIds.removeAll()
+            for level in 0..<Self.levelCount where occupancy[level] != 0 {
+                for slot in 0..<slots[level].count {
+                    slots[level][slot].removeAll()
+                }
+                occupancy[level] = 0
+            }
+            for (uniqueId, expiresAt) in expirations {
+                place(uniqueId: uniqueId, tick: Self.tick(forExpiresAt: expiresAt))
+            }
+        }
+    }
+
+    // Removes and returns up to `limit` of the messages that have expired.
+    @objc
+    public func popExpired(nowMs: UInt64, limit: Int) -> [String] {
+        unfairLock.withLock {
+            advance(toTick: nowMs / Self.tickMs)
+
+            var result = [String]()
+            while result.count < limit, let uniqueId = expiredIds.popFirst() {
+                entries.removeValue(forKey: uniqueId)
+                result.append(uniqueId)
+            }
+            return result
+        }
+    }
+
+    // The next time at which the wheel needs to be advanced, or nil if
+    // no expirations are pending.
+    //
+    // This may precede the next expiration if an entry needs to be
+    // cascaded to a lower level.
+    @objc
+    public var nextDeadline: NSNumber? {
+        unfairLock.withLock {
+            if !expiredIds.isEmpty {
+                return NSNumber(value: currentTick * Self.tickMs)
+            }
+            guard let (tick, _) = nextEvent() else {
+                return nil
+            }
+            return NSNumber(value: tick * Self.tickMs)
+        }
+    }
+
+    // MARK: - Locked
+
+    private func place(uniqueId: String, tick: UInt64) {
+        guard tick > currentTick else {
+            expiredIds.insert(uniqueId)
+            entries[uniqueId] = Entry(tick: tick, location: .expired)
+            return
+        }
+
+        let highestDifferingBit = UInt64.bitWidth - 1 - (tick ^ currentTick).leadingZeroBitCount
+        let level = highestDifferingBit / Self.slotBits
+        let slot = Int((tick >> UInt64(level * Self.slotBits)) & Self.slotMask)
+        slots[level][slot].insert(uniqueId)
+        occupancy[level] |= 1 << UInt64(slot)
+        entries[uniqueId] = Entry(tick: tick, location: .slot(level: level, slot: slot))
+
+        #if TESTABLE_BUILD
+        slotOperationCount += 1
+        #endif
+    }
+
+    private func removeEntry(uniqueId: String) {
+        guard let entry = entries.removeValue(forKey: uniqueId) else {
+            return
+        }
+        switch entry.location {
+        case .expired:
+            expiredIds.remove(uniqueId)
+        case .slot(let level, let slot):
+            slots[level][slot].remove(uniqueId)
+            if slots[level][slot].isEmpty {
+                occupancy[level] &= ~(1 << UInt64(slot))
+            }
+        }
+    }
+
+    // Returns the tick and level of the next non-empty slot.
+    //
+    // Every entry shares the bits above its level with the current tick,
+    // so each level only needs to look at the slots after the current
+    // tick's slot, and the next event at a lower level always precedes
+    // the next event at a higher level.
+    private func nextEvent() -> (tick: UInt64, level: Int)? {
+        for level in 0..<Self.levelCount {
+            let shift = UInt64(level * Self.slotBits)
+            let currentSlot = (currentTick >> shift) & Self.slotMask
+            let laterSlots = occupancy[level] & (UInt64.max << (currentSlot + 1))
+            guard laterSlots != 0 else {
+                continue
+            }
+            let blockShift = shift + UInt64(Self.slotBits)
+            let blockStart = (currentTick >> blockShift) << blockShift
+            return (blockStart | (UInt64(laterSlots.trailingZeroBitCount) << shift), level)
+        }
+        return nil
+    }
+
+    private func advance(toTick targetTick: UInt64) {
+        while let (tick, level) = nextEvent(), tick <= targetTick {
+            currentTick = tick
+
+            let slot = Int((tick >> UInt64(level * Self.slotBits)) & Self.slotMask)
+            let uniqueIds = slots[level][slot]
+            slots[level][slot].removeAll()
+            occupancy[level] &= ~(1 << UInt64(slot))
+
+            // Entries at level 0 have expired; entries at higher
+            // levels are cascaded to a lower level.
+            for uniqueId in uniqueIds {
+                guard let entry = entries[uniqueId] else {
+                    owsFailDebug("Missing entry.")
+                    continue
+                }
+                place(uniqueId: uniqueId, tick: entry.tick)
+            }
+        }
+        currentTick = max(currentTick, targetTick)
+    }
+}
+
+// MARK: -
+
+public extension DisappearingMessagesTimerWheel {
+
+    // Seeds the wheel from the database.
+    //
+    // This uses a write transaction so that no expirations are started
+    // (and added to the wheel) between the query and the reset.
+    @objc
+    func reload(transaction: SDSAnyWriteTransaction) {
+        var expirations = [String: UInt64]()
+        InteractionFinder.enumerateStartedPerConversationExpirations(transaction: transaction) { uniqueId, expiresAt in
+            expirations[uniqueId] = expiresAt
+        }
+        reset(nowMs: NSDate.ows_millisecondTimeStamp(), expirations: expirations)
+
+        Logger.info("Pending expirations: \(expirations.count).")
+    }
+
+    // The interactions that other processes inserted, updated or removed,
+    // as journaled in the cross-process change journal. Returns nil if
+    // those changes aren't known, in which case the wheel should be
+    // reloaded.
+    @objc
+    static func interactionUniqueIds(crossProcessNotification notification: Notification) -> Set<String>? {
+        guard let changes = SDSDatabaseStorage.crossProcessDatabaseChanges(notification: notification) else {
+            return nil
+        }
+        return changes.interactionUniqueIds.union(changes.interactionDeletedUniqueIds)
+    }
+
+    // Brings the entries for these messages up to date with the database,
+    // e.g. after another process started their expirations.
+    //
+    // Like reload(transaction:), this uses a write transaction so that no
+    // expirations are started between the fetch and the update.
+    @objc
+    func update(uniqueIds: Set<String>, transaction: SDSAnyWriteTransaction) {
+        for uniqueId in uniqueIds {
+            guard let message = TSMessage.anyFetchMessage(uniqueId: uniqueId, transaction: transaction),
+                  message.expiresAt > 0 else {
+                remove(uniqueId: uniqueId)
+                continue
+            }
+            insert(uniqueId: uniqueId, expiresAt: message.expiresAt)
+        }
+    }
+}
@@ -0,0 +1,279 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import SignalClient
+
+// Encrypts the device messages for a group send ahead of the
+// per-recipient message sends.
+//
+// Encrypting in MessageSender costs a write transaction per recipient,
+// and large groups spend most of their send time serialized on session
+// lookups and writes. Instead, for each batch of recipients we:
+//
+// 1. Load the recipients, plaintexts, identities and sessions in one read.
+// 2. Encrypt in parallel against an in-memory copy of those sessions.
+// 3. Persist the updated sessions in one write.
+//
+// Each batch is handed off to be sent as soon as it has been persisted,
+// so network requests for one batch overlap encryption of the next.
+//
+// Recipients we can't prepare (e.g. those without an active session or
+// with an untrusted identity) are left alone; MessageSender encrypts for
+// them as usual, which fetches pre-keys and surfaces the proper errors.
+@objc
+public class GroupSendEncryptor: NSObject {
+
+    static let batchSize = 64
+
+    // Sessions may be updated (e.g. by message decryption) while we're
+    // encrypting. We only persist sessions which are unchanged since we
+    // loaded them; other recipients fall back to MessageSender.
+    fileprivate struct PreparedRecipient {
+        let messageSend: OWSMessageSend
+        let isUDSend: Bool
+        let plainText: Data
+        let identityKey: IdentityKey
+        let protocolAddresses: [ProtocolAddress]
+        let sessions: [SessionRecord]
+        let serializedSessions: [Data]
+    }
+
+    @objc
+    public static func prepareMessageSends(_ messageSends: [OWSMessageSend],
+                                           batchBlock: ([OWSMessageSend]) -> Void) {
+        owsAssertDebug(!Thread.isMainThread)
+
+        // There's nothing to gain for 1:1 sends.
+        guard messageSends.count > 1 else {
+            batchBlock(messageSends)
+            return
+        }
+
+        // This may perform a write, so we do it outside the batches.
+        let localRegistrationId = tsAccountManager.getOrGenerateRegistrationId()
+
+        var preparedCount = 0
+        for batch in messageSends.chunked(by: batchSize) {
+            preparedCount += prepare(batch: batch, localRegistrationId: localRegistrationId)
+            batchBlock(batch)
+        }
+        Logger.info("Prepared \(preparedCount) / \(messageSends.count) message sends.")
+    }
+
+    // Returns the number of message sends which were prepared.
+    static func prepare(batch messageSends: [OWSMessageSend], localRegistrationId: UInt32) -> Int {
+        // 1. Load
+        var identityKeyPair: IdentityKeyPair?
+        let recipients: [PreparedRecipient] = databaseStorage.read { transaction in
+            identityKeyPair = identityManager.identityKeyPair(with: transaction)?.identityKeyPair
+            return messageSends.compactMap { loadRecipient(messageSend: $0, transaction: transaction) }
+        }
+        guard let localIdentityKeyPair = identityKeyPair, !recipients.isEmpty else {
+            return 0
+        }
+
+        // 2. Encrypt
+        let protocolStore = PrefetchedProtocolStore(identityKeyPair: localIdentityKeyPair,
+                                                    localRegistrationId: localRegistrationId)
+        for recipient in recipients {
+            protocolStore.add(recipient: recipient)
+        }
+        let unfairLock = UnfairLock()
+        var deviceMessagesMap = [Int: [NSDictionary]]()
+        DispatchQueue.concurrentPerform(iterations: recipients.count) { index in
+            let recipient = recipients[index]
+            do {
+                let deviceMessages = try recipient.protocolAddresses.map { protocolAddress in
+                    try MessageSender.encryptedMessage(for: recipient.messageSend,
+                                                       deviceId: Int32(bitPattern: protocolAddress.deviceId),
+                                                       plainText: recipient.plainText,
+                                                       sessionStore: protocolStore,
+                                                       identityStore: protocolStore,
+                                                       context: NullContext())
+                }
+                unfairLock.withLock {
+                    deviceMessagesMap[index] = deviceMessages
+                }
+            } catch {
+                // MessageSender will try again.
+                Logger.warn("Could not prepare message send: \(error)")
+            }
+        }
+
+        // 3. Persist
+        var preparedRecipients = [(PreparedRecipient, [NSDictionary])]()
+        databaseStorage.write { transaction in
+            for (index, recipient) in recipients.enumerated() {
+                guard let deviceMessages = deviceMessagesMap[index] else {
+                    continue
+                }
+                let isUnchanged = zip(recipient.protocolAddresses, recipient.serializedSessions).allSatisfy { protocolAddress, serializedSession in
+                    let currentSession = sessionStore.loadSerializedSession(for: recipient.messageSend.address,
+                                                                            deviceId: Int32(bitPattern: protocolAddress.deviceId),
+                                                                            readTransaction: transaction)
+                    return currentSession == serializedSession
+                }
+                guard isUnchanged else {
+                    Logger.warn("Session changed while preparing message send.")
+                    continue
+                }
+                do {
+                    for protocolAddress in recipient.protocolAddresses {
+                        guard let session = try protocolStore.loadSession(for: protocolAddress, context: NullContext()) else {
+                            throw OWSAssertionError("Missing session.")
+                        }
+                        try sessionStore.storeSession(session, for: protocolAddress, context: transaction)
+                    }
+                } catch {
+                    owsFailDebug("Error: \(error)")
+                    continue
+                }
+                preparedRecipients.append((recipient, deviceMessages))
+            }
+        }
+
+        for (recipient, deviceMessages) in preparedRecipients {
+            recipient.messageSend.setPreparedDeviceMessages(deviceMessages, isUDSend: recipient.isUDSend)
+        }
+        return preparedRecipients.count
+    }
+
+    private static func loadRecipient(messageSend: OWSMessageSend,
+                                      transaction: SDSAnyReadTransaction) -> PreparedRecipient? {
+        let address = messageSend.address
+        guard !messageSend.isLocalAddress,
+              address.uuid != nil,
+              !(messageSend.message is OWSOutgoingSyncMessage) else {
+            return nil
+        }
+        guard let recipient = SignalRecipient.get(address: address, mustHaveDevices: true, transaction: transaction),
+              let deviceIds = recipient.devices.array as? [NSNumber],
+              !deviceIds.isEmpty else {
+            return nil
+        }
+        guard let identityKeyData = identityManager.identityKey(for: address, transaction: transaction),
+              identityManager.isTrustedIdentityKey(identityKeyData,
+                                                   address: address,
+                                                   direction: .outgoing,
+                                                   transaction: transaction) else {
+            return nil
+        }
+        guard let plainText = messageSend.message.buildPlainTextData(address,
+                                                                     thread: messageSend.thread,
+                                                                     transaction: transaction) else {
+            return nil
+        }
+
+        let identityKey: IdentityKey
+        do {
+            identityKey = try IdentityKey(publicKey: ECPublicKey(keyData: identityKeyData).key)
+        } catch {
+            owsFailDebug("Error: \(error)")
+            return nil
+        }
+
+        var protocolAddresses = [ProtocolAddress]()
+        var sessions = [SessionRecord]()
+        var serializedSessions = [Data]()
+        for deviceId in deviceIds {
+            guard let serializedSession = sessionStore.loadSerializedSession(for: address,
+                                                                            deviceId: deviceId.int32Value,
+                                                                            readTransaction: transaction),
+                  let session = try? SessionRecord(bytes: serializedSession),
+                  session.hasCurrentState,
+                  let protocolAddress = try? ProtocolAddress(from: address, deviceId: deviceId.uint32Value) else {
+                // MessageSender will establish the session.
+                return nil
+            }
+            protocolAddresses.append(protocolAddress)
+            sessions.append(session)
+            serializedSessions.append(serializedSession)
+        }
+
+        return PreparedRecipient(messageSend: messageSend,
+                                 isUDSend: messageSend.isUDSend,
+                                 plainText: plainText,
+                                 identityKey: identityKey,
+                                 protocolAddresses: protocolAddresses,
+                                 sessions: sessions,
+                                 serializedSessions: serializedSessions)
+    }
+}
+
+// MARK: -
+
+// An in-memory snapshot of the protocol state needed to encrypt.
+//
+// It is safe to encrypt for different recipients concurrently.
+private class PrefetchedProtocolStore: SessionStore, IdentityKeyStore {
+
+    private let identityKeyPair: IdentityKeyPair
+    private let localRegistrationId: UInt32
+
+    private let unfairLock = UnfairLock()
+    // These properties should only be accessed with unfairLock.
+    // They are keyed by ProtocolAddress.name and by sessionKey().
+    private var trustedIdentities = [String: IdentityKey]()
+    private var sessions = [String: SessionRecord]()
+
+    init(identityKeyPair: IdentityKeyPair, localRegistrationId: UInt32) {
+        self.identityKeyPair = identityKeyPair
+        self.localRegistrationId = localRegistrationId
+    }
+
+    func add(recipient: GroupSendEncryptor.PreparedRecipient) {
+        unfairLock.withLock {
+            for (protocolAddress, session) in zip(recipient.protocolAddresses, recipient.sessions) {
+                trustedIdentities[protocolAddress.name] = recipient.identityKey
+                sessions[Self.sessionKey(for: protocolAddress)] = session
+            }
+        }
+    }
+
+    private static func sessionKey(for address: ProtocolAddress) -> String {
+        "\(address.name).\(address.deviceId)"
+    }
+
+    // MARK: - SessionStore
+
+    func loadSession(for address: ProtocolAddress, context: StoreContext) throws -> SessionRecord? {
+        unfairLock.withLock { sessions[Self.sessionKey(for: address)] }
+    }
+
+    func storeSession(_ record: SessionRecord, for address: ProtocolAddress, context: StoreContext) throws {
+        unfairLock.withLock { sessions[Self.sessionKey(for: address)] = record }
+    }
+
+    // MARK: - IdentityKeyStore
+
+    func identityKeyPair(context: StoreContext) throws -> IdentityKeyPair {
+        identityKeyPair
+    }
+
+    func localRegistrationId(context: StoreContext) throws -> UInt32 {
+        localRegistrationId
+    }
+
+    func saveIdentity(_ identity: IdentityKey, for address: ProtocolAddress, context: StoreContext) throws -> Bool {
+        // Identities only change when we process pre-key bundles,
+        // which we leave to MessageSender.
+        throw OWSAssertionError("Unexpected identity change.")
+    }
+
+    func isTrustedIdentity(_ identity: IdentityKey,
+                           for address: ProtocolAddress,
+                           direction: Direction,
+                           context: StoreContext) throws -> Bool {
+        guard direction == .sending,
+              let trustedIdentity = unfairLock.withLock({ trustedIdentities[address.name] }) else {
+            return false
+        }
+        return trustedIdentity.serialize() == identity.serialize()
+    }
+
+    func identity(for address: ProtocolAddress, context: StoreContext) throws -> IdentityKey? {
+        unfairLock.withLock { trustedIdentities[address.name] }
+    }
+}
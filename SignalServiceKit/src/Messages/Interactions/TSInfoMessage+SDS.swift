@@ -64,7 +64,7 @@ class TSInfoMessageSerializer: SDSSerializer {
         let receivedAtTimestamp: UInt64 = model.receivedAtTimestamp
         let timestamp: UInt64 = model.timestamp
         let threadUniqueId: String = model.uniqueThreadId
-        let attachmentIds: Data? = optionalArchive(model.attachmentIds)
+        let attachmentIds: Data? = optionalCompactArchive(model.attachmentIds)
         let authorId: String? = nil
         let authorPhoneNumber: String? = nil
         let authorUUID: String? = nil
@@ -284,7 +284,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -347,7 +347,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -410,7 +410,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -507,7 +507,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -594,7 +594,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -618,7 +618,7 @@ extension TSInteraction {
             }
             let read: Bool = try SDSDeserialization.required(record.read, name: "read")
             let recipientAddressSerialized: Data? = record.recipientAddress
-            let recipientAddress: SignalServiceAddress? = try SDSDeserialization.optionalUnarchive(recipientAddressSerialized, name: "recipientAddress")
+            let recipientAddress: SignalServiceAddress? = try SDSDeserialization.optionalUnarchiveCompact(recipientAddressSerialized, name: "recipientAddress")
             let wasIdentityVerified: Bool = try SDSDeserialization.required(record.wasIdentityVerified, name: "wasIdentityVerified")
 
             return OWSUnknownContactBlockOfferMessage(grdbId: recordId,
@@ -654,7 +654,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -722,7 +722,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -752,7 +752,7 @@ extension TSInteraction {
             let unregisteredAddress: SignalServiceAddress? = try SDSDeserialization.optionalUnarchive(unregisteredAddressSerialized, name: "unregisteredAddress")
             let isLocalChange: Bool = try SDSDeserialization.required(record.isLocalChange, name: "isLocalChange")
             let recipientAddressSerialized: Data? = record.recipientAddress
-            let recipientAddress: SignalServiceAddress = try SDSDeserialization.unarchive(recipientAddressSerialized, name: "recipientAddress")
+            let recipientAddress: SignalServiceAddress = try SDSDeserialization.unarchiveCompact(recipientAddressSerialized, name: "recipientAddress")
             guard let verificationState: OWSVerificationState = record.verificationState else {
                throw SDSError.missingRequiredField
             }
@@ -819,7 +819,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -843,7 +843,7 @@ extension TSInteraction {
             }
             let read: Bool = try SDSDeserialization.required(record.read, name: "read")
             let recipientAddressSerialized: Data? = record.recipientAddress
-            let recipientAddress: SignalServiceAddress? = try SDSDeserialization.optionalUnarchive(recipientAddressSerialized, name: "recipientAddress")
+            let recipientAddress: SignalServiceAddress? = try SDSDeserialization.optionalUnarchiveCompact(recipientAddressSerialized, name: "recipientAddress")
             let wasIdentityVerified: Bool = try SDSDeserialization.required(record.wasIdentityVerified, name: "wasIdentityVerified")
 
             return TSErrorMessage(grdbId: recordId,
@@ -879,7 +879,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -944,7 +944,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -1022,7 +1022,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -1046,7 +1046,7 @@ extension TSInteraction {
             }
             let read: Bool = try SDSDeserialization.required(record.read, name: "read")
             let recipientAddressSerialized: Data? = record.recipientAddress
-            let recipientAddress: SignalServiceAddress? = try SDSDeserialization.optionalUnarchive(recipientAddressSerialized, name: "recipientAddress")
+            let recipientAddress: SignalServiceAddress? = try SDSDeserialization.optionalUnarchiveCompact(recipientAddressSerialized, name: "recipientAddress")
             let wasIdentityVerified: Bool = try SDSDeserialization.required(record.wasIdentityVerified, name: "wasIdentityVerified")
 
             return TSInvalidIdentityKeyErrorMessage(grdbId: recordId,
@@ -1082,7 +1082,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -1106,7 +1106,7 @@ extension TSInteraction {
             }
             let read: Bool = try SDSDeserialization.required(record.read, name: "read")
             let recipientAddressSerialized: Data? = record.recipientAddress
-            let recipientAddress: SignalServiceAddress? = try SDSDeserialization.optionalUnarchive(recipientAddressSerialized, name: "recipientAddress")
+            let recipientAddress: SignalServiceAddress? = try SDSDeserialization.optionalUnarchiveCompact(recipientAddressSerialized, name: "recipientAddress")
             let wasIdentityVerified: Bool = try SDSDeserialization.required(record.wasIdentityVerified, name: "wasIdentityVerified")
             let authorId: String = try SDSDeserialization.required(record.authorId, name: "authorId")
             let envelopeData: Data? = SDSDeserialization.optionalData(record.envelopeData, name: "envelopeData")
@@ -1146,7 +1146,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -1170,7 +1170,7 @@ extension TSInteraction {
             }
             let read: Bool = try SDSDeserialization.required(record.read, name: "read")
             let recipientAddressSerialized: Data? = record.recipientAddress
-            let recipientAddress: SignalServiceAddress? = try SDSDeserialization.optionalUnarchive(recipientAddressSerialized, name: "recipientAddress")
+            let recipientAddress: SignalServiceAddress? = try SDSDeserialization.optionalUnarchiveCompact(recipientAddressSerialized, name: "recipientAddress")
             let wasIdentityVerified: Bool = try SDSDeserialization.required(record.wasIdentityVerified, name: "wasIdentityVerified")
             let messageId: String = try SDSDeserialization.required(record.messageId, name: "messageId")
             let preKeyBundleSerialized: Data? = record.preKeyBundle
@@ -1211,7 +1211,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
@@ -1260,7 +1260,7 @@ extension TSInteraction {
             let timestamp: UInt64 = record.timestamp
             let uniqueThreadId: String = record.threadUniqueId
             let attachmentIdsSerialized: Data? = record.attachmentIds
-            let attachmentIds: [String] = try SDSDeserialization.unarchive(attachmentIdsSerialized, name: "attachmentIds")
+            let attachmentIds: [String] = try SDSDeserialization.unarchiveCompact(attachmentIdsSerialized, name: "attachmentIds")
             let body: String? = record.body
             let bodyRangesSerialized: Data? = record.bodyRanges
             let bodyRanges: MessageBodyRanges? = try SDSDeserialization.optionalUnarchive(bodyRangesSerialized, name: "bodyRanges")
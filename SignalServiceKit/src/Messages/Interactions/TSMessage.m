@@ -588,7 +588,13 @@ static const NSUInteger OWSMessageSchemaVersion = 4;
 {
     [super anyDidInsertWithTransaction:transaction];
 
-    [self ensurePerConversationExpirationWithTransaction:transaction];
+    if (self.hasPerConversationExpirationStarted) {
+        // Messages can be inserted with expiration already started,
+        // e.g. outgoing messages.
+        [[OWSDisappearingMessagesJob shared] scheduleExpirationForMessage:self transaction:transaction];
+    } else {
+        [self ensurePerConversationExpirationWithTransaction:transaction];
+    }
 }
 
 - (void)anyWillUpdateWithTransaction:(SDSAnyWriteTransaction *)transaction
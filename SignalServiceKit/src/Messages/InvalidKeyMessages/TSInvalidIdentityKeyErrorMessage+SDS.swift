@@ -64,7 +64,7 @@ class TSInvalidIdentityKeyErrorMessageSerializer: SDSSerializer {
         let receivedAtTimestamp: UInt64 = model.receivedAtTimestamp
         let timestamp: UInt64 = model.timestamp
         let threadUniqueId: String = model.uniqueThreadId
-        let attachmentIds: Data? = optionalArchive(model.attachmentIds)
+        let attachmentIds: Data? = optionalCompactArchive(model.attachmentIds)
         let authorId: String? = nil
         let authorPhoneNumber: String? = nil
         let authorUUID: String? = nil
@@ -100,7 +100,7 @@ class TSInvalidIdentityKeyErrorMessageSerializer: SDSSerializer {
         let protocolVersion: UInt? = nil
         let quotedMessage: Data? = optionalArchive(model.quotedMessage)
         let read: Bool? = model.wasRead
-        let recipientAddress: Data? = optionalArchive(model.recipientAddress)
+        let recipientAddress: Data? = optionalCompactArchive(model.recipientAddress)
         let recipientAddressStates: Data? = nil
         let sender: Data? = nil
         let serverTimestamp: UInt64? = nil
@@ -169,6 +169,13 @@ public class MessageProcessor: NSObject {
             }
         }
 
+        // Reject malformed envelopes before they reach the write transaction.
+        if let error = OWSMessageDecrypter.validateEnvelopeStructure(encryptedEnvelope) {
+            Logger.warn("Dropping invalid envelope: \(error)")
+            completion(error)
+            return
+        }
+
         pendingEnvelopesLock.withLock {
             pendingEnvelopes.append(EncryptedEnvelope(
                 encryptedEnvelopeData: encryptedEnvelopeData,
@@ -189,8 +196,19 @@ public class MessageProcessor: NSObject {
         wasReceivedByUD: Bool,
         completion: @escaping (Error?) -> Void
     ) {
+        // Parse the envelope here, off the write transaction.
+        let envelope: SSKProtoEnvelope
+        do {
+            envelope = try SSKProtoEnvelope(serializedData: envelopeData)
+        } catch {
+            owsFailDebug("Failed to parse decrypted envelope \(error)")
+            completion(error)
+            return
+        }
+
         pendingEnvelopesLock.withLock {
             pendingEnvelopes.append(DecryptedEnvelope(
+                envelope: envelope,
                 envelopeData: envelopeData,
                 plaintextData: plaintextData,
                 serverDeliveryTimestamp: serverDeliveryTimestamp,
@@ -212,6 +230,14 @@ public class MessageProcessor: NSObject {
         didSet { assertOnQueue(serialQueue) }
     }
 
+    // If the app is in the background, we use smaller transactions.
+    // This reduces the risk of us never being able to drain any
+    // messages from the queue before we're suspended.
+    private var foregroundBatchSizer = MessageProcessingBatchSizer(initialBatchSize: 16,
+                                                                   targetTransactionDuration: 0.1)
+    private var backgroundBatchSizer = MessageProcessingBatchSizer(initialBatchSize: 1,
+                                                                   targetTransactionDuration: 0.02)
+
     private func drainPendingEnvelopes() {
         guard Self.messagePipelineSupervisor.isMessageProcessingPermitted else { return }
         guard TSAccountManager.shared.isRegisteredAndReady else { return }
@@ -228,13 +254,10 @@ public class MessageProcessor: NSObject {
     private func drainNextBatch() {
         assertOnQueue(serialQueue)
 
-        // We want a value that is just high enough to yield perf benefits.
-        let kIncomingMessageBatchSize = 16
-        // If the app is in the background, use batch size of 1.
-        // This reduces the risk of us never being able to drain any
-        // messages from the queue. We should fine tune this number
-        // to yield the best perf we can get.
-        let batchSize = CurrentAppContext().isInBackground() ? 1 : kIncomingMessageBatchSize
+        let isInBackground = CurrentAppContext().isInBackground()
+        let batchSize = (isInBackground
+                            ? backgroundBatchSizer.batchSize
+                            : foregroundBatchSizer.batchSize)
         let batchEnvelopes = pendingEnvelopesLock.withLock {
             pendingEnvelopes.prefix(batchSize)
         }
@@ -247,9 +270,19 @@ public class MessageProcessor: NSObject {
 
         Logger.info("Processing batch of \(batchEnvelopes.count) received envelope(s).")
 
+        let startTime = CACurrentMediaTime()
         SDSDatabaseStorage.shared.write { transaction in
             batchEnvelopes.forEach { self.processEnvelope($0, transaction: transaction) }
         }
+        let transactionDuration = CACurrentMediaTime() - startTime
+
+        // Grow or shrink subsequent batches so that each write
+        // transaction stays close to the target duration.
+        if isInBackground {
+            backgroundBatchSizer.didProcessBatch(count: batchEnvelopes.count, duration: transactionDuration)
+        } else {
+            foregroundBatchSizer.didProcessBatch(count: batchEnvelopes.count, duration: transactionDuration)
+        }
 
         // Remove the processed envelopes from the pending list.
         pendingEnvelopesLock.withLock {
@@ -269,14 +302,18 @@ public class MessageProcessor: NSObject {
         switch pendingEnvelope.decrypt(transaction: transaction) {
         case .success(let result):
             let envelope: SSKProtoEnvelope
-            do {
-                // NOTE: We use envelopeData from the decrypt result, not the pending envelope,
-                // since the envelope may be altered by the decryption process in the UD case.
-                envelope = try SSKProtoEnvelope(serializedData: result.envelopeData)
-            } catch {
-                owsFailDebug("Failed to parse decrypted envelope \(error)")
-                transaction.addAsyncCompletionOffMain { pendingEnvelope.completion(error) }
-                return
+            if let parsedEnvelope = result.envelope {
+                envelope = parsedEnvelope
+            } else {
+                do {
+                    // NOTE: We use envelopeData from the decrypt result, not the pending envelope,
+                    // since the envelope may be altered by the decryption process in the UD case.
+                    envelope = try SSKProtoEnvelope(serializedData: result.envelopeData)
+                } catch {
+                    owsFailDebug("Failed to parse decrypted envelope \(error)")
+                    transaction.addAsyncCompletionOffMain { pendingEnvelope.completion(error) }
+                    return
+                }
             }
 
             if let groupContextV2 = GroupsV2MessageProcessor.groupContextV2(
@@ -372,7 +409,13 @@ private struct EncryptedEnvelope: PendingEnvelope, Dependencies {
         )
         switch result {
         case .success(let result):
+            // Unless decryption altered the envelope (e.g. in the UD case),
+            // re-use the envelope we parsed before entering the transaction.
+            let envelope = (result.envelopeData == encryptedEnvelopeData
+                                ? encryptedEnvelope
+                                : nil)
             return .success(DecryptedEnvelope(
+                envelope: envelope,
                 envelopeData: result.envelopeData,
                 plaintextData: result.plaintextData,
                 serverDeliveryTimestamp: serverDeliveryTimestamp,
@@ -386,6 +429,8 @@ private struct EncryptedEnvelope: PendingEnvelope, Dependencies {
 }
 
 private struct DecryptedEnvelope: PendingEnvelope {
+    // If nil, envelopeData will be parsed when the envelope is processed.
+    let envelope: SSKProtoEnvelope?
     let envelopeData: Data
     let plaintextData: Data?
     let serverDeliveryTimestamp: UInt64
@@ -396,3 +441,37 @@ private struct DecryptedEnvelope: PendingEnvelope {
         return .success(self)
     }
 }
+
+// MARK: -
+
+// Adapts the number of envelopes processed per write transaction
+// to how long recent transactions took.
+//
+// Larger batches amortize the cost of each transaction, but long
+// transactions block other writers (and, in the background, risk
+// being suspended before they can commit).
+struct MessageProcessingBatchSizer {
+    static let minBatchSize = 1
+    static let maxBatchSize = 256
+
+    let targetTransactionDuration: TimeInterval
+    private(set) var batchSize: Int
+
+    init(initialBatchSize: Int, targetTransactionDuration: TimeInterval) {
+        self.batchSize = initialBatchSize.clamp(Self.minBatchSize, Self.maxBatchSize)
+        self.targetTransactionDuration = targetTransactionDuration
+    }
+
+    mutating func didProcessBatch(count: Int, duration: TimeInterval) {
+        // A partial batch tells us nothing about whether a full
+        // batch would have exceeded our target.
+        guard count >= batchSize || duration > targetTransactionDuration else {
+            return
+        }
+        if duration > targetTransactionDuration {
+            batchSize = max(Self.minBatchSize, batchSize / 2)
+        } else if duration < targetTransactionDuration / 2 {
+            batchSize = min(Self.maxBatchSize, batchSize * 2)
+        }
+    }
+}
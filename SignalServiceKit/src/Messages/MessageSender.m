@@ -625,11 +625,17 @@ NSString *const MessageSenderRateLimitedException = @"RateLimitedException";
     return
         [MessageSender ensureSessionsforMessageSendsObjc:messageSends ignoreErrors:YES].thenInBackground(^(id value) {
             // 4. Perform the per-recipient message sends.
+            //
+            // For group sends, the device messages are encrypted in batches
+            // ahead of time, and each batch is sent as soon as it's ready.
             NSMutableArray<AnyPromise *> *sendPromises = [NSMutableArray array];
-            for (OWSMessageSend *messageSend in messageSends) {
-                [self sendMessageToRecipient:messageSend];
-                [sendPromises addObject:messageSend.asAnyPromise];
-            }
+            [GroupSendEncryptor prepareMessageSends:messageSends
+                                         batchBlock:^(NSArray<OWSMessageSend *> *batch) {
+                                             for (OWSMessageSend *messageSend in batch) {
+                                                 [self sendMessageToRecipient:messageSend];
+                                                 [sendPromises addObject:messageSend.asAnyPromise];
+                                             }
+                                         }];
 
             // We use PMKJoin(), not PMKWhen(), because we don't want the
             // completion promise to execute until _all_ send promises
@@ -1220,6 +1226,11 @@ NSString *const MessageSenderRateLimitedException = @"RateLimitedException";
     OWSAssertDebug(messageSend.message);
     OWSAssertDebug(messageSend.address.isValid);
 
+    NSArray<NSDictionary *> *_Nullable preparedDeviceMessages = [messageSend takePreparedDeviceMessages];
+    if (preparedDeviceMessages != nil) {
+        return preparedDeviceMessages;
+    }
+
     __block SignalRecipient *recipient;
     __block NSData *_Nullable plainText;
     [self.databaseStorage readWithBlock:^(SDSAnyReadTransaction *transaction) {
@@ -1136,6 +1136,24 @@ extension MessageSender {
             throw EncryptionError.missingSession(recipientAddress: recipientAddress, deviceId: deviceId)
         }
 
+        return try Self.encryptedMessage(for: messageSend,
+                                         deviceId: deviceId,
+                                         plainText: plainText,
+                                         sessionStore: Self.sessionStore,
+                                         identityStore: Self.identityManager,
+                                         context: transaction)
+    }
+
+    // The caller is responsible for ensuring that there is an active
+    // session for the recipient device in sessionStore.
+    static func encryptedMessage(for messageSend: OWSMessageSend,
+                                 deviceId: Int32,
+                                 plainText: Data,
+                                 sessionStore: SessionStore,
+                                 identityStore: IdentityKeyStore,
+                                 context: StoreContext) throws -> NSDictionary {
+        let recipientAddress = messageSend.address
+
         let paddedPlaintext = (plainText as NSData).paddedMessageBody()
 
         let serializedMessage: Data
@@ -1144,25 +1162,25 @@ extension MessageSender {
         let protocolAddress = try ProtocolAddress(from: recipientAddress, deviceId: UInt32(bitPattern: deviceId))
 
         if let udSendingAccess = messageSend.udSendingAccess {
-            let secretCipher = try SMKSecretSessionCipher(sessionStore: Self.sessionStore,
+            let secretCipher = try SMKSecretSessionCipher(sessionStore: sessionStore,
                                                           preKeyStore: Self.preKeyStore,
                                                           signedPreKeyStore: Self.signedPreKeyStore,
-                                                          identityStore: Self.identityManager)
+                                                          identityStore: identityStore)
 
             serializedMessage = try secretCipher.throwswrapped_encryptMessage(
                 recipient: SMKAddress(uuid: recipientAddress.uuid, e164: recipientAddress.phoneNumber),
                 deviceId: deviceId,
                 paddedPlaintext: paddedPlaintext,
                 senderCertificate: udSendingAccess.senderCertificate,
-                protocolContext: transaction)
+                protocolContext: context)
             messageType = .unidentifiedSenderMessageType
 
         } else {
             let result = try signalEncrypt(message: paddedPlaintext,
                                            for: protocolAddress,
-                                           sessionStore: Self.sessionStore,
-                                           identityStore: Self.identityManager,
-                                           context: transaction)
+                                           sessionStore: sessionStore,
+                                           identityStore: identityStore,
+                                           context: context)
 
             switch result.messageType {
             case .whisper:
@@ -1184,7 +1202,7 @@ extension MessageSender {
         }
 
         // We had better have a session after encrypting for this recipient!
-        let session = try Self.sessionStore.loadSession(for: protocolAddress, context: transaction)!
+        let session = try sessionStore.loadSession(for: protocolAddress, context: context)!
 
         // Returns the per-device-message parameters used when submitting a message to
         // the Signal Web Service.
@@ -11,19 +11,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface OWSDisappearingMessagesFinder : NSObject
 
-- (void)enumerateExpiredMessagesWithBlock:(void (^_Nonnull)(TSMessage *message))block
-                              transaction:(SDSAnyReadTransaction *)transaction;
-
 - (void)enumerateMessagesWhichFailedToStartExpiringWithBlock:(void (^_Nonnull)(TSMessage *message, BOOL *stop))block
                                                  transaction:(SDSAnyReadTransaction *)transaction;
 
-/**
- * @return
- *   uint64_t millisecond timestamp wrapped in a number. Retrieve with `unsignedLongLongvalue`.
- *   or nil if there are no upcoming expired messages
- */
-- (nullable NSNumber *)nextExpirationTimestampWithTransaction:(SDSAnyReadTransaction *_Nonnull)transaction;
-
 @end
 
 NS_ASSUME_NONNULL_END
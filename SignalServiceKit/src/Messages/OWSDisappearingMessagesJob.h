@@ -19,6 +19,9 @@ NS_ASSUME_NONNULL_BEGIN
                  expirationStartedAt:(uint64_t)expirationStartedAt
                          transaction:(SDSAnyWriteTransaction *_Nonnull)transaction;
 
+// Schedules the deletion of a message whose expiration has already started.
+- (void)scheduleExpirationForMessage:(TSMessage *)message transaction:(SDSAnyWriteTransaction *)transaction;
+
 // Clean up any messages that expired since last launch immediately
 // and continue cleaning in the background.
 - (void)startIfNecessary;
@@ -23,6 +23,7 @@ NS_ASSUME_NONNULL_BEGIN
 @interface OWSDisappearingMessagesJob ()
 
 @property (nonatomic, readonly) OWSDisappearingMessagesFinder *disappearingMessagesFinder;
+@property (nonatomic, readonly) DisappearingMessagesTimerWheel *timerWheel;
 
 + (dispatch_queue_t)serialQueue;
 
@@ -32,6 +33,9 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, nullable) NSDate *nextDisappearanceDate;
 @property (nonatomic, nullable) NSTimer *fallbackTimer;
 
+// This property should only be accessed on the serial queue.
+@property (nonatomic, nullable) NSDate *lastTimerWheelReloadDate;
+
 @end
 
 void AssertIsOnDisappearingMessagesQueue()
@@ -53,6 +57,7 @@ void AssertIsOnDisappearingMessagesQueue()
     }
 
     _disappearingMessagesFinder = [OWSDisappearingMessagesFinder new];
+    _timerWheel = [DisappearingMessagesTimerWheel new];
 
     // suspenders in case a deletion schedule is missed.
     NSTimeInterval kFallBackTimerInterval = 5 * kMinuteInterval;
@@ -76,6 +81,10 @@ void AssertIsOnDisappearingMessagesQueue()
                                              selector:@selector(applicationWillResignActive:)
                                                  name:OWSApplicationWillResignActiveNotification
                                                object:nil];
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(didReceiveCrossProcessNotification:)
+                                                 name:SDSDatabaseStorage.didReceiveCrossProcessNotification
+                                               object:nil];
 
     return self;
 }
@@ -101,27 +110,42 @@ void AssertIsOnDisappearingMessagesQueue()
 
     OWSBackgroundTask *_Nullable backgroundTask = [OWSBackgroundTask backgroundTaskWithLabelStr:__PRETTY_FUNCTION__];
 
+    // Delete the expired messages in batches, so that a large backlog
+    // doesn't block other writes.
+    const NSUInteger kBatchSize = 500;
     __block NSUInteger expirationCount = 0;
-    DatabaseStorageWrite(self.databaseStorage, ^(SDSAnyWriteTransaction *transaction) {
-        [self.disappearingMessagesFinder enumerateExpiredMessagesWithBlock:^(TSMessage *message) {
-            // We want to compute `now` *after* our finder fetches results.
-            // Otherwise, if we computed it before the finder, and a message had expired in the tiny
-            // gap between that computation and when the finder runs, we would skip deleting an
-            // expired message until the next expiration run.
+    __block NSUInteger batchCount;
+    do {
+        DatabaseStorageWrite(self.databaseStorage, ^(SDSAnyWriteTransaction *transaction) {
+            // We pop the expired messages within the write transaction, so that
+            // any expiration that is added to the wheel has been committed.
             uint64_t now = [NSDate ows_millisecondTimeStamp];
-
-            // sanity check
-            if (message.expiresAt > now) {
-                OWSFailDebug(@"Refusing to remove message which doesn't expire until: %llu, now: %lld", message.expiresAt, now);
-                return;
+            NSArray<NSString *> *messageIds = [self.timerWheel popExpiredWithNowMs:now limit:kBatchSize];
+            batchCount = messageIds.count;
+
+            for (NSString *messageId in messageIds) {
+                TSMessage *_Nullable message = [TSMessage anyFetchMessageWithUniqueId:messageId
+                                                                          transaction:transaction];
+                if (message == nil || message.expiresAt == 0) {
+                    // The message has already been deleted.
+                    continue;
+                }
+
+                // sanity check
+                if (message.expiresAt > now) {
+                    OWSLogWarn(@"Rescheduling message which doesn't expire until: %llu, now: %lld",
+                        message.expiresAt,
+                        now);
+                    [self.timerWheel insertWithUniqueId:messageId expiresAt:message.expiresAt];
+                    continue;
+                }
+
+                OWSLogInfo(@"Removing message which expired at: %lld", message.expiresAt);
+                [message anyRemoveWithTransaction:transaction];
+                expirationCount++;
             }
-
-            OWSLogInfo(@"Removing message which expired at: %lld", message.expiresAt);
-            [message anyRemoveWithTransaction:transaction];
-            expirationCount++;
-        }
-                                                               transaction:transaction];
-    });
+        });
+    } while (batchCount == kBatchSize);
 
     OWSLogDebug(@"Removed %lu expired messages", (unsigned long)expirationCount);
 
@@ -130,6 +154,15 @@ void AssertIsOnDisappearingMessagesQueue()
     return expirationCount;
 }
 
+- (void)reloadTimerWheel
+{
+    AssertIsOnDisappearingMessagesQueue();
+
+    DatabaseStorageWrite(self.databaseStorage,
+        ^(SDSAnyWriteTransaction *transaction) { [self.timerWheel reloadWithTransaction:transaction]; });
+    self.lastTimerWheelReloadDate = [NSDate new];
+}
+
 // deletes any expired messages and schedules the next run.
 - (NSUInteger)runLoop
 {
@@ -138,12 +171,7 @@ void AssertIsOnDisappearingMessagesQueue()
 
     NSUInteger deletedCount = [self deleteExpiredMessages];
 
-    __block NSNumber *nextExpirationTimestampNumber;
-    [self.databaseStorage readWithBlock:^(SDSAnyReadTransaction *transaction) {
-        nextExpirationTimestampNumber =
-            [self.disappearingMessagesFinder nextExpirationTimestampWithTransaction:transaction];
-    }];
-
+    NSNumber *_Nullable nextExpirationTimestampNumber = self.timerWheel.nextDeadline;
     if (!nextExpirationTimestampNumber) {
         OWSLogDebug(@"No more expiring messages.");
         return deletedCount;
@@ -174,10 +202,26 @@ void AssertIsOnDisappearingMessagesQueue()
         [message updateWithExpireStartedAt:expirationStartedAt transaction:transaction];
     }
 
+    [self scheduleExpirationForMessage:message transaction:transaction];
+}
+
+- (void)scheduleExpirationForMessage:(TSMessage *)message transaction:(SDSAnyWriteTransaction *)transaction
+{
+    OWSAssertDebug(transaction);
+
+    uint64_t expiresAt = message.expiresAt;
+    if (expiresAt == 0) {
+        OWSFailDebug(@"Message expiration has not started.");
+        return;
+    }
+
+    [self.timerWheel insertWithUniqueId:message.uniqueId expiresAt:expiresAt];
+
     [transaction addAsyncCompletion:^{
         // Necessary that the async expiration run happens *after* the message is saved with it's new
         // expiration configuration.
-        [self scheduleRunByDate:[NSDate ows_dateWithMillisecondsSince1970:message.expiresAt]];
+        uint64_t deadline = [DisappearingMessagesTimerWheel deadlineForExpiresAt:expiresAt];
+        [self scheduleRunByDate:[NSDate ows_dateWithMillisecondsSince1970:deadline]];
     }];
 }
 
@@ -199,7 +243,8 @@ void AssertIsOnDisappearingMessagesQueue()
             DatabaseStorageWrite(self.databaseStorage, ^(SDSAnyWriteTransaction *transaction) {
                 [self cleanupMessagesWhichFailedToStartExpiringWithTransaction:transaction];
             });
-            
+
+            [self reloadTimerWheel];
             [self runLoop];
         });
     });
@@ -307,6 +352,14 @@ void AssertIsOnDisappearingMessagesQueue()
 
     AppReadinessRunNowOrWhenAppDidBecomeReadyAsync(^{
         dispatch_async(OWSDisappearingMessagesJob.serialQueue, ^{
+            // The wheel is kept up to date by this process and by the changes
+            // journaled by other processes. Reloading it reads every started
+            // expiration, so we only do so occasionally, in case any were missed.
+            const NSTimeInterval kTimerWheelReloadInterval = 6 * kHourInterval;
+            if (self.lastTimerWheelReloadDate == nil
+                || fabs(self.lastTimerWheelReloadDate.timeIntervalSinceNow) >= kTimerWheelReloadInterval) {
+                [self reloadTimerWheel];
+            }
             NSUInteger deletedCount = [self runLoop];
 
             // Normally deletions should happen via the disappearanceTimer, to make sure that they're prompt.
@@ -361,8 +414,29 @@ void AssertIsOnDisappearingMessagesQueue()
 {
     OWSAssertIsOnMainThread();
 
-    AppReadinessRunNowOrWhenAppDidBecomeReadyAsync(
-        ^{ dispatch_async(OWSDisappearingMessagesJob.serialQueue, ^{ [self runLoop]; }); });
+    AppReadinessRunNowOrWhenAppDidBecomeReadyAsync(^{
+        dispatch_async(OWSDisappearingMessagesJob.serialQueue, ^{ [self runLoop]; });
+    });
+}
+
+- (void)didReceiveCrossProcessNotification:(NSNotification *)notification
+{
+    AppReadinessRunNowOrWhenAppDidBecomeReadyAsync(^{
+        dispatch_async(OWSDisappearingMessagesJob.serialQueue, ^{
+            // Expirations may have been started by other processes.
+            NSSet<NSString *> *_Nullable interactionIds =
+                [DisappearingMessagesTimerWheel interactionUniqueIdsWithCrossProcessNotification:notification];
+            if (interactionIds == nil) {
+                // We don't know what the other processes changed.
+                [self reloadTimerWheel];
+            } else if (interactionIds.count > 0) {
+                DatabaseStorageWrite(self.databaseStorage, ^(SDSAnyWriteTransaction *transaction) {
+                    [self.timerWheel updateWithUniqueIds:interactionIds transaction:transaction];
+                });
+            }
+            [self runLoop];
+        });
+    });
 }
 
 - (void)applicationWillResignActive:(NSNotification *)notification
@@ -91,30 +91,49 @@ public class OWSMessageDecrypter: OWSMessageHandler {
         }
     }
 
-    public func decryptEnvelope(_ envelope: SSKProtoEnvelope, envelopeData: Data, transaction: SDSAnyWriteTransaction) -> Result<OWSMessageDecryptResult, Error> {
-        owsAssertDebug(tsAccountManager.isRegistered)
-
-        Logger.info("decrypting envelope: \(description(for: envelope))")
-
+    // Checks that don't depend on database state. These are cheap and
+    // can be performed before acquiring a write transaction.
+    //
+    // Envelopes come from the service, so a malformed envelope isn't a
+    // local bug; callers should log and drop it without asserting.
+    public static func validateEnvelopeStructure(_ envelope: SSKProtoEnvelope) -> Error? {
         guard envelope.hasType else {
-            return .failure(OWSAssertionError("Incoming envelope is missing type."))
+            return OWSGenericError("Incoming envelope is missing type.")
         }
 
         guard SDS.fitsInInt64(envelope.timestamp) else {
-            return .failure(OWSAssertionError("Invalid timestamp."))
+            return OWSGenericError("Invalid timestamp.")
         }
 
         guard !envelope.hasServerTimestamp || SDS.fitsInInt64(envelope.serverTimestamp) else {
-            return .failure(OWSAssertionError("Invalid serverTimestamp."))
+            return OWSGenericError("Invalid serverTimestamp.")
         }
 
         if envelope.unwrappedType != .unidentifiedSender {
-            guard envelope.hasValidSource, let sourceAddress = envelope.sourceAddress else {
-                return .failure(OWSAssertionError("incoming envelope has invalid source"))
+            guard envelope.hasValidSource, envelope.sourceAddress != nil else {
+                return OWSGenericError("incoming envelope has invalid source")
             }
 
             guard envelope.hasSourceDevice, envelope.sourceDevice > 0 else {
-                return .failure(OWSAssertionError("incoming envelope has invalid source device"))
+                return OWSGenericError("incoming envelope has invalid source device")
+            }
+        }
+
+        return nil
+    }
+
+    public func decryptEnvelope(_ envelope: SSKProtoEnvelope, envelopeData: Data, transaction: SDSAnyWriteTransaction) -> Result<OWSMessageDecryptResult, Error> {
+        owsAssertDebug(tsAccountManager.isRegistered)
+
+        Logger.info("decrypting envelope: \(description(for: envelope))")
+
+        if let error = Self.validateEnvelopeStructure(envelope) {
+            return .failure(error)
+        }
+
+        if envelope.unwrappedType != .unidentifiedSender {
+            guard let sourceAddress = envelope.sourceAddress else {
+                return .failure(OWSAssertionError("incoming envelope has invalid source"))
             }
 
             guard !blockingManager.isAddressBlocked(sourceAddress) else {
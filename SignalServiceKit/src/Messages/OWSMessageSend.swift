@@ -46,6 +46,35 @@ public class OWSMessageSend: NSObject {
         set { _udSendingAccess.set(newValue) }
     }
 
+    // Device messages which were encrypted ahead of the first attempt
+    // by GroupSendEncryptor. They are only used once; retries encrypt
+    // afresh.
+    private let preparedDeviceMessagesLock = UnfairLock()
+    // These properties should only be accessed with preparedDeviceMessagesLock.
+    private var preparedDeviceMessages: [NSDictionary]?
+    private var preparedDeviceMessagesIsUDSend = false
+
+    func setPreparedDeviceMessages(_ deviceMessages: [NSDictionary], isUDSend: Bool) {
+        preparedDeviceMessagesLock.withLock {
+            owsAssertDebug(preparedDeviceMessages == nil)
+            preparedDeviceMessages = deviceMessages
+            preparedDeviceMessagesIsUDSend = isUDSend
+        }
+    }
+
+    @objc
+    public func takePreparedDeviceMessages() -> [NSDictionary]? {
+        preparedDeviceMessagesLock.withLock {
+            defer { preparedDeviceMessages = nil }
+            // If UD was disabled since the messages were encrypted,
+            // they're no longer valid.
+            guard preparedDeviceMessagesIsUDSend == isUDSend else {
+                return nil
+            }
+            return preparedDeviceMessages
+        }
+    }
+
     @objc
     public let localAddress: SignalServiceAddress
 
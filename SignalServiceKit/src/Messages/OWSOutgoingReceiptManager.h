@@ -9,10 +9,23 @@ NS_ASSUME_NONNULL_BEGIN
 @class SSKProtoEnvelope;
 @class SignalServiceAddress;
 
+typedef NS_ENUM(NSUInteger, OWSReceiptType) {
+    OWSReceiptType_Delivery,
+    OWSReceiptType_Read,
+    OWSReceiptType_Viewed,
+};
+
 @interface OWSOutgoingReceiptManager : NSObject
 
 + (SDSKeyValueStore *)deliveryReceiptStore;
 + (SDSKeyValueStore *)readReceiptStore;
++ (SDSKeyValueStore *)viewedReceiptStore;
+
+// Read and viewed receipts are sent this long after they are enqueued,
+// so that the receipts enqueued in the meantime are sent in the same
+// messages. Delivery receipts, and receipts enqueued by app extensions,
+// are sent immediately.
+@property (atomic) NSTimeInterval flushLatency;
 
 - (instancetype)init NS_DESIGNATED_INITIALIZER;
 
@@ -27,6 +40,18 @@ NS_ASSUME_NONNULL_BEGIN
                              timestamp:(uint64_t)timestamp
                            transaction:(SDSAnyWriteTransaction *)transaction;
 
+#pragma mark - Coalescing
+
+// Adds the timestamps to the receipts queued for the address.
+- (void)enqueueReceiptsForAddress:(SignalServiceAddress *)address
+                       timestamps:(NSSet<NSNumber *> *)timestamps
+                      receiptType:(OWSReceiptType)receiptType
+                      transaction:(SDSAnyWriteTransaction *)transaction;
+
+// Schedules a processing pass after the flush latency for the
+// receipt type, unless one is already scheduled.
+- (void)scheduleProcessingForReceiptType:(OWSReceiptType)receiptType;
+
 @end
 
 NS_ASSUME_NONNULL_END
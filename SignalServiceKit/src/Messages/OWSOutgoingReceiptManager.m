@@ -3,6 +3,7 @@
 //
 
 #import "OWSOutgoingReceiptManager.h"
+#import "AppContext.h"
 #import "AppReadiness.h"
 #import "MessageSender.h"
 #import "OWSError.h"
@@ -15,16 +16,13 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
-typedef NS_ENUM(NSUInteger, OWSReceiptType) {
-    OWSReceiptType_Delivery,
-    OWSReceiptType_Read,
-    OWSReceiptType_Viewed,
-};
+static const NSTimeInterval kDefaultFlushLatencySeconds = 1.0;
 
 @interface OWSOutgoingReceiptManager ()
 
-// This property should only be accessed on the serialQueue.
+// These properties should only be accessed on the serialQueue.
 @property (nonatomic) BOOL isProcessing;
+@property (nonatomic) BOOL isProcessingScheduled;
 
 @end
 
@@ -59,6 +57,8 @@ typedef NS_ENUM(NSUInteger, OWSReceiptType) {
 
     OWSSingletonAssert();
 
+    _flushLatency = kDefaultFlushLatencySeconds;
+
     [[NSNotificationCenter defaultCenter] addObserver:self
                                              selector:@selector(reachabilityChanged)
                                                  name:SSKReachability.owsReachabilityDidChange
@@ -86,6 +86,46 @@ typedef NS_ENUM(NSUInteger, OWSReceiptType) {
     return _serialQueue;
 }
 
+- (NSTimeInterval)flushLatencyForReceiptType:(OWSReceiptType)receiptType
+{
+    // Delivery receipts are mostly enqueued by the notification service
+    // extension, which can be suspended as soon as it has processed its
+    // messages, so we send them right away. App extensions in general
+    // don't stay alive long enough to wait out the latency.
+    if (receiptType == OWSReceiptType_Delivery || !CurrentAppContext().isMainApp) {
+        return 0;
+    }
+    return self.flushLatency;
+}
+
+- (void)scheduleProcessingForReceiptType:(OWSReceiptType)receiptType
+{
+    if (!AppReadiness.isAppReady) {
+        // The receipts will be sent by the pass on launch.
+        return;
+    }
+
+    if ([self flushLatencyForReceiptType:receiptType] <= 0) {
+        [self process];
+        return;
+    }
+
+    dispatch_async(self.serialQueue, ^{
+        if (self.isProcessingScheduled) {
+            return;
+        }
+        self.isProcessingScheduled = YES;
+
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.flushLatency * NSEC_PER_SEC)),
+            self.serialQueue,
+            ^{
+                self.isProcessingScheduled = NO;
+
+                [self process];
+            });
+    });
+}
+
 // Schedules a processing pass, unless one is already scheduled.
 - (void)process {
     OWSAssertDebug(AppReadiness.isAppReady);
@@ -273,14 +313,25 @@ typedef NS_ENUM(NSUInteger, OWSReceiptType) {
         return;
     }
 
-    SDSKeyValueStore *store = [self storeForReceiptType:receiptType];
-
     OWSAssertDebug(address.isValid);
     if (timestamp < 1) {
         OWSFailDebug(@"Invalid timestamp.");
         return;
     }
 
+    [self coalesceReceiptWithAddress:address timestamp:timestamp receiptType:receiptType transaction:transaction];
+}
+
+- (void)enqueueReceiptsForAddress:(SignalServiceAddress *)address
+                       timestamps:(NSSet<NSNumber *> *)timestamps
+                      receiptType:(OWSReceiptType)receiptType
+                      transaction:(SDSAnyWriteTransaction *)transaction
+{
+    SDSKeyValueStore *store = [self storeForReceiptType:receiptType];
+
+    OWSAssertDebug(address.isValid);
+    OWSAssertDebug(timestamps.count > 0);
+
     NSString *identifier = address.uuidString ?: address.phoneNumber;
 
     NSSet<NSNumber *> *_Nullable oldUUIDTimestamps;
@@ -309,14 +360,9 @@ typedef NS_ENUM(NSUInteger, OWSReceiptType) {
     }
 
     NSMutableSet<NSNumber *> *newTimestamps = (oldTimestamps ? [oldTimestamps mutableCopy] : [NSMutableSet new]);
-    [newTimestamps addObject:@(timestamp)];
+    [newTimestamps unionSet:timestamps];
 
     [store setObject:newTimestamps key:identifier transaction:transaction];
-
-    [transaction addAsyncCompletionWithQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)
-                                       block:^{
-                                           [self process];
-                                       }];
 }
 
 - (void)dequeueReceiptsForAddress:(SignalServiceAddress *)address
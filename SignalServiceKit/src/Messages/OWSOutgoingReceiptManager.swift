@@ -0,0 +1,47 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+private struct OutgoingReceiptKey: Hashable {
+    let receiptType: OWSReceiptType
+    let address: SignalServiceAddress
+}
+
+// MARK: -
+
+public extension OWSOutgoingReceiptManager {
+
+    // Receipts are queued per sender, so all of the receipts for a
+    // sender that are enqueued in a transaction are queued together.
+    private static let receiptCoalescer = ReceiptCoalescer<OutgoingReceiptKey, Set<UInt64>>(
+        label: "OWSOutgoingReceiptManager",
+        mergeBlock: { timestamps, newTimestamps in
+            timestamps.formUnion(newTimestamps)
+        },
+        flushBlock: { receiptMap, transaction in
+            let outgoingReceiptManager = SSKEnvironment.shared.outgoingReceiptManagerRef
+            for (key, timestamps) in receiptMap {
+                outgoingReceiptManager.enqueueReceipts(for: key.address,
+                                                       timestamps: Set(timestamps.map { NSNumber(value: $0) }),
+                                                       receiptType: key.receiptType,
+                                                       transaction: transaction)
+            }
+            let receiptTypes = Set(receiptMap.keys.map { $0.receiptType })
+            transaction.addAsyncCompletion(queue: .global()) {
+                for receiptType in receiptTypes {
+                    outgoingReceiptManager.scheduleProcessing(for: receiptType)
+                }
+            }
+        })
+
+    @objc
+    func coalesceReceipt(address: SignalServiceAddress,
+                         timestamp: UInt64,
+                         receiptType: OWSReceiptType,
+                         transaction: SDSAnyWriteTransaction) {
+        let key = OutgoingReceiptKey(receiptType: receiptType, address: address)
+        Self.receiptCoalescer.add([timestamp], key: key, transaction: transaction)
+    }
+}
@@ -111,6 +111,9 @@ extern NSString *const kIncomingMessageMarkedAsReadNotification;
              hasPendingMessageRequest:(BOOL)hasPendingMessageRequest
                            completion:(void (^)(void))completion;
 
+// Schedules sending the receipts enqueued for linked devices.
+- (void)scheduleProcessing;
+
 #pragma mark - Settings
 
 - (void)prepareCachedValues;
@@ -71,7 +71,10 @@ NSString *const OWSReceiptManagerAreReadReceiptsEnabled = @"areReadReceiptsEnabl
 // Schedules a processing pass, unless one is already scheduled.
 - (void)scheduleProcessing
 {
-    OWSAssertDebug(AppReadiness.isAppReady);
+    if (!AppReadiness.isAppReady) {
+        // The receipts will be sent by the pass on launch.
+        return;
+    }
 
     dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
         @synchronized(self) {
@@ -196,7 +199,6 @@ NSString *const OWSReceiptManagerAreReadReceiptsEnabled = @"areReadReceiptsEnabl
             break;
         case OWSReceiptCircumstanceOnThisDevice: {
             [self enqueueLinkedDeviceReadReceiptForMessage:message transaction:transaction];
-            [transaction addAsyncCompletion:^{ [self scheduleProcessing]; }];
 
             if (message.authorAddress.isLocalAddress) {
                 OWSFailDebug(@"We don't support incoming messages from self.");
@@ -240,7 +242,6 @@ NSString *const OWSReceiptManagerAreReadReceiptsEnabled = @"areReadReceiptsEnabl
             break;
         case OWSReceiptCircumstanceOnThisDevice: {
             [self enqueueLinkedDeviceViewedReceiptForMessage:message transaction:transaction];
-            [transaction addAsyncCompletion:^{ [self scheduleProcessing]; }];
 
             if (message.authorAddress.isLocalAddress) {
                 OWSFailDebug(@"We don't support incoming messages from self.");
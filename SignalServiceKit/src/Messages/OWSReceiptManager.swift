@@ -24,13 +24,19 @@ struct ReceiptForLinkedDevice: Codable {
 public extension OWSReceiptManager {
 
     private var toLinkedDevicesReadReceiptMapStore: SDSKeyValueStore {
-        return SDSKeyValueStore(collection: "OWSReceiptManager.toLinkedDevicesReadReceiptMapStore")
+        return Self.toLinkedDevicesReadReceiptMapStore
     }
 
+    @nonobjc
+    private static let toLinkedDevicesReadReceiptMapStore = SDSKeyValueStore(collection: "OWSReceiptManager.toLinkedDevicesReadReceiptMapStore")
+
     private var toLinkedDevicesViewedReceiptMapStore: SDSKeyValueStore {
-        return SDSKeyValueStore(collection: "OWSReceiptManager.toLinkedDevicesViewedReceiptMapStore")
+        return Self.toLinkedDevicesViewedReceiptMapStore
     }
 
+    @nonobjc
+    private static let toLinkedDevicesViewedReceiptMapStore = SDSKeyValueStore(collection: "OWSReceiptManager.toLinkedDevicesViewedReceiptMapStore")
+
     func processReceiptsForLinkedDevices(completion: @escaping () -> Void) {
         guard !DebugFlags.suppressBackgroundActivity else {
             // Don't process queues.
@@ -121,8 +127,6 @@ public extension OWSReceiptManager {
 
     func enqueueLinkedDeviceReadReceipt(forMessage message: TSIncomingMessage,
                                         transaction: SDSAnyWriteTransaction) {
-        let threadUniqueId = message.uniqueThreadId
-
         let messageAuthorAddress = message.authorAddress
         assert(messageAuthorAddress.isValid)
 
@@ -131,26 +135,11 @@ public extension OWSReceiptManager {
             messageIdTimestamp: message.timestamp,
             timestamp: Date.ows_millisecondTimestamp()
         )
-
-        do {
-            if let oldReadReceipt: ReceiptForLinkedDevice = try toLinkedDevicesReadReceiptMapStore.getCodableValue(forKey: threadUniqueId, transaction: transaction),
-                oldReadReceipt.messageIdTimestamp > newReadReceipt.messageIdTimestamp {
-                // If there's an existing "linked device" read receipt for the same thread with
-                // a newer timestamp, discard this "linked device" read receipt.
-                Logger.verbose("Ignoring redundant read receipt for linked devices.")
-            } else {
-                Logger.verbose("Enqueuing read receipt for linked devices.")
-                try toLinkedDevicesReadReceiptMapStore.setCodable(newReadReceipt, key: threadUniqueId, transaction: transaction)
-            }
-        } catch {
-            owsFailDebug("Error: \(error).")
-        }
+        Self.linkedDeviceReadReceiptCoalescer.add(newReadReceipt, key: message.uniqueThreadId, transaction: transaction)
     }
 
     func enqueueLinkedDeviceViewedReceipt(forMessage message: TSIncomingMessage,
                                         transaction: SDSAnyWriteTransaction) {
-        let threadUniqueId = message.uniqueThreadId
-
         let messageAuthorAddress = message.authorAddress
         assert(messageAuthorAddress.isValid)
 
@@ -159,19 +148,53 @@ public extension OWSReceiptManager {
             messageIdTimestamp: message.timestamp,
             timestamp: Date.ows_millisecondTimestamp()
         )
+        Self.linkedDeviceViewedReceiptCoalescer.add(newViewedReceipt, key: message.uniqueThreadId, transaction: transaction)
+    }
 
-        do {
-            if let oldViewedReceipt: ReceiptForLinkedDevice = try toLinkedDevicesViewedReceiptMapStore.getCodableValue(forKey: threadUniqueId, transaction: transaction),
-                oldViewedReceipt.messageIdTimestamp > newViewedReceipt.messageIdTimestamp {
-                // If there's an existing "linked device" viewed receipt for the same thread with
-                // a newer timestamp, discard this "linked device" read receipt.
-                Logger.verbose("Ignoring redundant viewed receipt for linked devices.")
-            } else {
-                Logger.verbose("Enqueuing viewed receipt for linked devices.")
-                try toLinkedDevicesViewedReceiptMapStore.setCodable(newViewedReceipt, key: threadUniqueId, transaction: transaction)
-            }
-        } catch {
-            owsFailDebug("Error: \(error).")
-        }
+    // MARK: - Coalescing
+
+    // Only the newest receipt for each thread is sent to linked
+    // devices, so we only write the newest receipt for each thread
+    // that is enqueued in a transaction.
+    @nonobjc
+    private static func linkedDeviceReceiptCoalescer(label: String,
+                                                     store: SDSKeyValueStore) -> ReceiptCoalescer<String, ReceiptForLinkedDevice> {
+        ReceiptCoalescer(
+            label: label,
+            mergeBlock: { receipt, newReceipt in
+                if newReceipt.messageIdTimestamp >= receipt.messageIdTimestamp {
+                    receipt = newReceipt
+                }
+            },
+            flushBlock: { receiptMap, transaction in
+                for (threadUniqueId, newReceipt) in receiptMap {
+                    do {
+                        if let oldReceipt: ReceiptForLinkedDevice = try store.getCodableValue(forKey: threadUniqueId, transaction: transaction),
+                           oldReceipt.messageIdTimestamp > newReceipt.messageIdTimestamp {
+                            // If there's an existing "linked device" receipt for the same thread with
+                            // a newer timestamp, discard this "linked device" receipt.
+                            Logger.verbose("Ignoring redundant \(label) receipt for linked devices.")
+                        } else {
+                            Logger.verbose("Enqueuing \(label) receipt for linked devices.")
+                            try store.setCodable(newReceipt, key: threadUniqueId, transaction: transaction)
+                        }
+                    } catch {
+                        owsFailDebug("Error: \(error).")
+                    }
+                }
+                transaction.addAsyncCompletion {
+                    SSKEnvironment.shared.receiptManagerRef.scheduleProcessing()
+                }
+            })
     }
+
+    @nonobjc
+    private static let linkedDeviceReadReceiptCoalescer = linkedDeviceReceiptCoalescer(
+        label: "read",
+        store: toLinkedDevicesReadReceiptMapStore)
+
+    @nonobjc
+    private static let linkedDeviceViewedReceiptCoalescer = linkedDeviceReceiptCoalescer(
+        label: "viewed",
+        store: toLinkedDevicesViewedReceiptMapStore)
 }
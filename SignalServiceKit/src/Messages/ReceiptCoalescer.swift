@@ -0,0 +1,98 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+@objc
+public class ReceiptCoalescing: NSObject {
+
+    #if TESTABLE_BUILD
+    // Lets benchmarks compare against applying each receipt
+    // as soon as it is enqueued.
+    @objc
+    public static var isEnabled = true
+    #else
+    static let isEnabled = true
+    #endif
+}
+
+// MARK: -
+
+// Marking a busy conversation as read enqueues hundreds of receipts
+// within each write transaction. Rather than update the receipt stores
+// (and schedule processing) once per receipt, we buffer the receipts
+// enqueued by each transaction, merge those with the same key (e.g.
+// the same sender) and flush them once, when the transaction is
+// finalized.
+class ReceiptCoalescer<Key: Hashable, Receipt> {
+
+    typealias MergeBlock = (inout Receipt, Receipt) -> Void
+    typealias FlushBlock = ([Key: Receipt], SDSAnyWriteTransaction) -> Void
+
+    private class PendingReceipts {
+        // Used to detect re-use of the transaction's object identifier.
+        weak var transaction: GRDBWriteTransaction?
+        var receipts = [Key: Receipt]()
+
+        init(transaction: GRDBWriteTransaction) {
+            self.transaction = transaction
+        }
+    }
+
+    private let finalizationKey: String
+    private let mergeBlock: MergeBlock
+    private let flushBlock: FlushBlock
+
+    private let unfairLock = UnfairLock()
+    // This property should only be accessed with unfairLock.
+    private var pendingReceiptsMap = [ObjectIdentifier: PendingReceipts]()
+
+    init(label: String, mergeBlock: @escaping MergeBlock, flushBlock: @escaping FlushBlock) {
+        self.finalizationKey = "ReceiptCoalescer.\(label)"
+        self.mergeBlock = mergeBlock
+        self.flushBlock = flushBlock
+    }
+
+    func add(_ receipt: Receipt, key: Key, transaction: SDSAnyWriteTransaction) {
+        guard ReceiptCoalescing.isEnabled else {
+            flushBlock([key: receipt], transaction)
+            return
+        }
+
+        let grdbWrite = transaction.unwrapGrdbWrite
+        let transactionId = ObjectIdentifier(grdbWrite)
+        let isFirstReceipt: Bool = unfairLock.withLock {
+            if let pendingReceipts = pendingReceiptsMap[transactionId],
+               pendingReceipts.transaction === grdbWrite {
+                if pendingReceipts.receipts[key] != nil {
+                    mergeBlock(&pendingReceipts.receipts[key]!, receipt)
+                } else {
+                    pendingReceipts.receipts[key] = receipt
+                }
+                return false
+            }
+            let pendingReceipts = PendingReceipts(transaction: grdbWrite)
+            pendingReceipts.receipts[key] = receipt
+            pendingReceiptsMap[transactionId] = pendingReceipts
+            return true
+        }
+        guard isFirstReceipt else {
+            return
+        }
+
+        transaction.addTransactionFinalizationBlock(forKey: finalizationKey) { transaction in
+            self.flush(transactionId: transactionId, transaction: transaction)
+        }
+    }
+
+    private func flush(transactionId: ObjectIdentifier, transaction: SDSAnyWriteTransaction) {
+        guard let pendingReceipts = unfairLock.withLock({
+            pendingReceiptsMap.removeValue(forKey: transactionId)
+        }) else {
+            owsFailDebug("Missing pending receipts.")
+            return
+        }
+        flushBlock(pendingReceipts.receipts, transaction)
+    }
+}
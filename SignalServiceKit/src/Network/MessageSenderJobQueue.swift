@@ -91,6 +91,9 @@ public class MessageSenderJobQueue: NSObject, JobQueue {
     // 110 retries will yield ~24 hours of retry.
     public static let maxRetries: UInt = 110
     public let requiresInternet: Bool = true
+    // Sends to different threads run concurrently, so start
+    // several of them at once.
+    public let maxJobsPerWorkStep: Int = 32
     public var runningOperations = AtomicArray<MessageSenderOperation>()
 
     public var jobRecordLabel: String {
@@ -138,7 +141,7 @@ public class MessageSenderJobQueue: NSObject, JobQueue {
         // message C should never send before A and B. However, if you send text
         // messages A, B, then media message C, followed by text message D, D cannot
         // send before A and B, but CAN send before C.
-        if jobRecord.isMediaMessage, let sendQueue = senderQueues[message.uniqueThreadId] {
+        if jobRecord.isMediaMessage, let sendQueue = senderQueues.existingOperationQueue(forLane: message.uniqueThreadId) {
             let orderMaintainingOperation = Operation()
             orderMaintainingOperation.queuePriority = MessageSender.queuePriority(for: message)
             sendQueue.addOperation(orderMaintainingOperation)
@@ -148,8 +151,8 @@ public class MessageSenderJobQueue: NSObject, JobQueue {
         return operation
     }
 
-    var senderQueues: [String: OperationQueue] = [:]
-    var mediaSenderQueues: [String: OperationQueue] = [:]
+    let senderQueues = JobQueueLanes(name: "SendingQueue")
+    let mediaSenderQueues = JobQueueLanes(name: "MediaSendingQueue")
     let defaultQueue: OperationQueue = {
         let operationQueue = OperationQueue()
         operationQueue.name = "DefaultSendingQueue"
@@ -166,29 +169,9 @@ public class MessageSenderJobQueue: NSObject, JobQueue {
         }
 
         if jobRecord.isMediaMessage {
-            guard let existingQueue = mediaSenderQueues[threadId] else {
-                let operationQueue = OperationQueue()
-                operationQueue.name = "MediaSendingQueue:\(threadId)"
-                operationQueue.maxConcurrentOperationCount = 1
-
-                mediaSenderQueues[threadId] = operationQueue
-
-                return operationQueue
-            }
-
-            return existingQueue
+            return mediaSenderQueues.operationQueue(forLane: threadId)
         } else {
-            guard let existingQueue = senderQueues[threadId] else {
-                let operationQueue = OperationQueue()
-                operationQueue.name = "SendingQueue:\(threadId)"
-                operationQueue.maxConcurrentOperationCount = 1
-
-                senderQueues[threadId] = operationQueue
-
-                return operationQueue
-            }
-
-            return existingQueue
+            return senderQueues.operationQueue(forLane: threadId)
         }
     }
 
@@ -254,7 +237,7 @@ public class MessageSenderOperation: OWSOperation, DurableOperation {
     }
 
     override public func didSucceed() {
-        databaseStorage.write { transaction in
+        JobQueueWriteBatcher.shared.write { transaction in
             self.durableOperationDelegate?.durableOperationDidSucceed(self, transaction: transaction)
             if self.jobRecord.removeMessageAfterSending {
                 self.message.anyRemove(transaction: transaction)
@@ -266,7 +249,7 @@ public class MessageSenderOperation: OWSOperation, DurableOperation {
     override public func didReportError(_ error: Error) {
         Logger.debug("remainingRetries: \(self.remainingRetries)")
 
-        databaseStorage.write { transaction in
+        JobQueueWriteBatcher.shared.write { transaction in
             self.durableOperationDelegate?.durableOperation(self, didReportError: error,
                                                             transaction: transaction)
         }
@@ -277,7 +260,7 @@ public class MessageSenderOperation: OWSOperation, DurableOperation {
     }
 
     override public func didFail(error: Error) {
-        databaseStorage.write { transaction in
+        JobQueueWriteBatcher.shared.write { transaction in
             self.durableOperationDelegate?.durableOperation(self,
                                                             didFailWithError: error,
                                                             transaction: transaction)
@@ -34,6 +34,9 @@ static const CGFloat kSocketReconnectDelaySeconds = 5.f;
 static const NSTimeInterval kKeepAliveDuration_Default = 20.f;
 // b) It has received a message over the socket in the last N seconds.
 static const NSTimeInterval kKeepAliveDuration_ReceiveMessage = 15.f;
+//    During catch-up bursts, we only prolong the keep-alive for received
+//    messages once every N seconds.
+static const NSTimeInterval kKeepAliveInterval_ReceiveMessage = 1.f;
 // c) It is in the process of making a request.
 static const NSTimeInterval kKeepAliveDuration_MakeRequestInForeground = 25.f;
 static const NSTimeInterval kKeepAliveDuration_MakeRequestInBackground = 20.f;
@@ -199,6 +202,12 @@ NSNotificationName const NSNotificationWebSocketStateDidChange = @"NSNotificatio
 
 @property (nonatomic) BOOL hasObservedNotifications;
 
+@property (nonatomic, nullable) NSDate *lastReceiveMessageKeepAliveDate;
+
+@property (nonatomic, readonly) WebSocketAckCoalescer *ackCoalescer;
+
+@property (nonatomic, readonly) WebSocketReceiveBudget *receiveBudget;
+
 // This property should only be accessed while synchronized on the socket manager.
 @property (nonatomic, readonly) NSMutableDictionary<NSNumber *, TSSocketMessage *> *socketMessageMap;
 
@@ -225,6 +234,13 @@ NSNotificationName const NSNotificationWebSocketStateDidChange = @"NSNotificatio
     _willEmptyInitialQueue = NO;
     _socketMessageMap = [NSMutableDictionary new];
 
+    __weak typeof(self) weakSelf = self;
+    _ackCoalescer = [[WebSocketAckCoalescer alloc]
+        initWithAckBlock:^(NSArray<WebSocketProtoWebSocketRequestMessage *> *requests) {
+            [weakSelf sendWebSocketMessageAcknowledgements:requests];
+        }];
+    _receiveBudget = [[WebSocketReceiveBudget alloc] initWithByteBudget:WebSocketReceiveBudget.defaultByteBudget];
+
     return self;
 }
 
@@ -680,6 +696,9 @@ NSNotificationName const NSNotificationWebSocketStateDidChange = @"NSNotificatio
 
     self.state = OWSWebSocketStateOpen;
 
+    // The service redelivers any frames we dropped on the previous connection.
+    [self.receiveBudget reset];
+
     // If socket opens, we know we're not de-registered.
     [self.tsAccountManager setIsDeregistered:NO];
 
@@ -755,10 +774,23 @@ NSNotificationName const NSNotificationWebSocketStateDidChange = @"NSNotificatio
 
     // If we receive a message over the socket while the app is in the background,
     // prolong how long the socket stays open.
-    [self requestSocketAliveForAtLeastSeconds:kKeepAliveDuration_ReceiveMessage];
+    if (self.lastReceiveMessageKeepAliveDate == nil ||
+        fabs(self.lastReceiveMessageKeepAliveDate.timeIntervalSinceNow) >= kKeepAliveInterval_ReceiveMessage) {
+        self.lastReceiveMessageKeepAliveDate = [NSDate new];
+        [self requestSocketAliveForAtLeastSeconds:kKeepAliveDuration_ReceiveMessage];
+    }
 
     if ([message.path isEqualToString:@"/api/v1/message"] && [message.verb isEqualToString:@"PUT"]) {
 
+        // Apply backpressure if envelopes are arriving faster than we can
+        // process them. Each envelope's bytes are reserved until it has been
+        // acked; if we're over budget, we drop the frame without acking it
+        // and cycle the socket once the retained envelopes have drained.
+        NSUInteger frameByteCount = message.body.length;
+        if (![self.receiveBudget reserveWithByteCount:(NSInteger)frameByteCount]) {
+            return;
+        }
+
         __block OWSBackgroundTask *_Nullable backgroundTask =
             [OWSBackgroundTask backgroundTaskWithLabelStr:__PRETTY_FUNCTION__];
 
@@ -772,11 +804,16 @@ NSNotificationName const NSNotificationWebSocketStateDidChange = @"NSNotificatio
                     });
                 }
 
-                dispatch_async(dispatch_get_main_queue(), ^{
-                    [self sendWebSocketMessageAcknowledgement:message];
-                    OWSAssertDebug(backgroundTask);
-                    backgroundTask = nil;
-                });
+                [self.ackCoalescer enqueueAckForRequest:message
+                                             completion:^{
+                                                 OWSAssertDebug(backgroundTask);
+                                                 backgroundTask = nil;
+
+                                                 if ([self.receiveBudget releaseWithByteCount:(NSInteger)frameByteCount]) {
+                                                     OWSLogInfo(@"Cycling socket to receive dropped messages.");
+                                                     [self cycleSocket];
+                                                 }
+                                             }];
             };
 
             uint64_t serverDeliveryTimestamp = 0;
@@ -812,7 +849,11 @@ NSNotificationName const NSNotificationWebSocketStateDidChange = @"NSNotificatio
 
         [self sendWebSocketMessageAcknowledgement:message];
 
-        if (!self.hasEmptiedInitialQueue) {
+        if (self.receiveBudget.hasDroppedFrames) {
+            // The dropped messages will be redelivered after the socket
+            // cycles, so the queue hasn't actually been emptied yet.
+            OWSLogInfo(@"Ignoring queue empty; frames were dropped.");
+        } else if (!self.hasEmptiedInitialQueue) {
 
             self.willEmptyInitialQueue = YES;
 
@@ -843,6 +884,18 @@ NSNotificationName const NSNotificationWebSocketStateDidChange = @"NSNotificatio
     }
 }
 
+- (void)sendWebSocketMessageAcknowledgements:(NSArray<WebSocketProtoWebSocketRequestMessage *> *)requests
+{
+    OWSAssertIsOnMainThread();
+
+    if (requests.count > 1) {
+        OWSLogVerbose(@"Acknowledging %lu messages.", (unsigned long)requests.count);
+    }
+    for (WebSocketProtoWebSocketRequestMessage *request in requests) {
+        [self sendWebSocketMessageAcknowledgement:request];
+    }
+}
+
 - (void)sendWebSocketMessageAcknowledgement:(WebSocketProtoWebSocketRequestMessage *)request
 {
     OWSAssertIsOnMainThread();
@@ -0,0 +1,79 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+// Coalesces the acknowledgements of incoming websocket requests.
+//
+// During catch-up bursts, envelopes complete processing in batches (one
+// write transaction per batch) and each completion used to hop to the
+// main thread to send its own acknowledgement. Instead, we collect the
+// acknowledgements and send all of those that are pending in a single
+// pass on the main thread.
+//
+// Requests should only be acknowledged once they've been durably
+// processed, since the service deletes acknowledged messages.
+@objc
+public class WebSocketAckCoalescer: NSObject {
+
+    public typealias AckBlock = ([WebSocketProtoWebSocketRequestMessage]) -> Void
+
+    private let ackBlock: AckBlock
+
+    private let unfairLock = UnfairLock()
+    // These properties should only be accessed with unfairLock.
+    private var pendingRequests = [WebSocketProtoWebSocketRequestMessage]()
+    private var pendingCompletions = [() -> Void]()
+    private var isFlushScheduled = false
+
+    // ackBlock is called on the main thread.
+    @objc
+    public init(ackBlock: @escaping AckBlock) {
+        self.ackBlock = ackBlock
+    }
+
+    // This method can be called from any thread.
+    //
+    // completion is called on the main thread after the request has
+    // been acknowledged.
+    @objc
+    public func enqueueAck(for request: WebSocketProtoWebSocketRequestMessage,
+                           completion: (() -> Void)?) {
+        let shouldScheduleFlush: Bool = unfairLock.withLock {
+            pendingRequests.append(request)
+            if let completion = completion {
+                pendingCompletions.append(completion)
+            }
+            guard !isFlushScheduled else {
+                return false
+            }
+            isFlushScheduled = true
+            return true
+        }
+        if shouldScheduleFlush {
+            DispatchQueue.main.async {
+                self.flush()
+            }
+        }
+    }
+
+    @objc
+    public func flush() {
+        AssertIsOnMainThread()
+
+        let (requests, completions): ([WebSocketProtoWebSocketRequestMessage], [() -> Void]) = unfairLock.withLock {
+            let requests = pendingRequests
+            let completions = pendingCompletions
+            pendingRequests = []
+            pendingCompletions = []
+            isFlushScheduled = false
+            return (requests, completions)
+        }
+        guard !requests.isEmpty else {
+            return
+        }
+        ackBlock(requests)
+        completions.forEach { $0() }
+    }
+}
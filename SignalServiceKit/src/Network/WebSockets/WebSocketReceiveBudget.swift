@@ -0,0 +1,96 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+// Bounds the memory retained by incoming websocket envelopes.
+//
+// During catch-up bursts, envelopes can arrive much faster than we can
+// process them. Every envelope is retained from the moment its frame is
+// read until it has been acknowledged, whether it's still waiting to be
+// handed to the message processor or is pending in it. We reserve each
+// frame's bytes before dispatching it and release them once it has
+// been acknowledged.
+//
+// Frames which would exceed the budget are dropped without being
+// acknowledged; the service redelivers unacknowledged messages on the
+// next connection. Once a frame has been dropped, every later frame is
+// dropped too, until the socket is cycled; otherwise envelopes would be
+// processed out of order, e.g. a message before the session or sender key
+// distribution message it depends on. Once everything we accepted has been
+// acknowledged, the socket should be cycled to receive the dropped messages.
+@objc
+public class WebSocketReceiveBudget: NSObject {
+
+    @objc
+    public static let defaultByteBudget = 4 * 1024 * 1024
+
+    private let byteBudget: Int
+
+    private let unfairLock = UnfairLock()
+    // These properties should only be accessed with unfairLock.
+    private var _retainedByteCount = 0
+    private var _hasDroppedFrames = false
+
+    @objc
+    public init(byteBudget: Int) {
+        self.byteBudget = byteBudget
+    }
+
+    @objc
+    public var retainedByteCount: Int {
+        unfairLock.withLock { _retainedByteCount }
+    }
+
+    // Frames have been dropped since the socket was last cycled, so the
+    // service hasn't delivered everything it has queued for us yet.
+    @objc
+    public var hasDroppedFrames: Bool {
+        unfairLock.withLock { _hasDroppedFrames }
+    }
+
+    // Returns NO if the frame should be dropped.
+    //
+    // We always accept a frame if nothing is retained, so that a single
+    // frame larger than the budget can't stall receiving.
+    @objc
+    public func reserve(byteCount: Int) -> Bool {
+        owsAssertDebug(byteCount >= 0)
+
+        return unfairLock.withLock {
+            guard !_hasDroppedFrames else {
+                // Preserve ordering; drop everything until the socket is cycled.
+                return false
+            }
+            guard _retainedByteCount == 0 || _retainedByteCount + byteCount <= byteBudget else {
+                Logger.info("Dropping frames; \(_retainedByteCount) bytes are retained.")
+                _hasDroppedFrames = true
+                return false
+            }
+            _retainedByteCount += byteCount
+            return true
+        }
+    }
+
+    // Returns YES if frames were dropped and everything we accepted has
+    // now been released, i.e. if the socket should be cycled. Frames are
+    // still dropped until reset() is called for the new connection.
+    @objc
+    public func release(byteCount: Int) -> Bool {
+        return unfairLock.withLock {
+            owsAssertDebug(_retainedByteCount >= byteCount)
+            _retainedByteCount = max(0, _retainedByteCount - byteCount)
+            return _retainedByteCount == 0 && _hasDroppedFrames
+        }
+    }
+
+    // Should be called when the socket is cycled; the service will
+    // redeliver any dropped frames on the next connection.
+    @objc
+    public func reset() {
+        unfairLock.withLock {
+            _hasDroppedFrames = false
+        }
+    }
+}
@@ -53,6 +53,18 @@ public class SSKSessionStore: NSObject {
         return serializedSession(fromDatabaseRepresentation: entry)
     }
 
+    // Unlike loadSerializedSession(for:deviceId:transaction:), this
+    // won't create an account id for the address if it lacks one.
+    func loadSerializedSession(for address: SignalServiceAddress,
+                               deviceId: Int32,
+                               readTransaction transaction: SDSAnyReadTransaction) -> Data? {
+        owsAssertDebug(address.isValid)
+        guard let accountId = OWSAccountIdFinder.accountId(forAddress: address, transaction: transaction) else {
+            return nil
+        }
+        return loadSerializedSession(forAccountId: accountId, deviceId: deviceId, transaction: transaction)
+    }
+
     fileprivate func storeSerializedSession(_ sessionData: Data,
                                             for address: SignalServiceAddress,
                                             deviceId: Int32,
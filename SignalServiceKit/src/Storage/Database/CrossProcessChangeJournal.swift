@@ -0,0 +1,262 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import GRDB
+
+// SDSCrossProcess only tells the main app _that_ another process (e.g.
+// the NSE) wrote to the database, not _what_ it wrote. On its own, that
+// forces the main app to discard all of its model caches and reload all
+// of its views after every cross-process write.
+//
+// Instead, app extensions describe each of their write transactions in
+// the cross_process_change_journal table, within that same transaction.
+// Entries are keyed by a monotonically increasing sequence number. The
+// main app tracks the last sequence number it has seen and, when it is
+// notified of a cross-process write, replays the entries since then.
+// That lets it evict only the affected cache entries and update its
+// views incrementally.
+//
+// If the main app can't account for every change since it last replayed
+// the journal (e.g. the entries were pruned before it could replay them,
+// or a transaction was too large to describe row-by-row), it falls back
+// to discarding everything.
+class CrossProcessChangeJournal {
+
+    static let tableName = "cross_process_change_journal"
+
+    // Only the most recent entries are kept. The main app replays the
+    // journal whenever it becomes active, so it should rarely fall
+    // this far behind.
+    static let maxEntryCount: Int64 = 1000
+
+    #if TESTABLE_BUILD
+    // Lets tests journal their writes, as if they were an app extension.
+    static var shouldJournalWritesForTests = false
+    #endif
+
+    static var shouldJournalWrites: Bool {
+        #if TESTABLE_BUILD
+        if shouldJournalWritesForTests {
+            return true
+        }
+        #endif
+        // Only the main app replays the journal.
+        return !CurrentAppContext().isMainApp
+    }
+
+    // The changes made by one or more write transactions.
+    struct Changes: Codable, Equatable {
+        var threadUniqueIds = Set<String>()
+        var interactionUniqueIds = Set<String>()
+        var attachmentUniqueIds = Set<String>()
+
+        var interactionDeletedUniqueIds = Set<String>()
+        var attachmentDeletedUniqueIds = Set<String>()
+
+        var tableNames = Set<String>()
+        var collections = Set<String>()
+
+        // If false, only the tables which were changed are known,
+        // not the rows.
+        var isComplete = true
+
+        static func incomplete(tableNames: Set<String>, collections: Set<String>) -> Changes {
+            var changes = Changes()
+            changes.tableNames = tableNames
+            changes.collections = collections
+            changes.isComplete = false
+            return changes
+        }
+
+        var isEmpty: Bool {
+            tableNames.isEmpty
+        }
+
+        var rowChangeCount: Int {
+            threadUniqueIds.count + interactionUniqueIds.count + attachmentUniqueIds.count
+        }
+
+        mutating func formUnion(_ other: Changes) {
+            threadUniqueIds.formUnion(other.threadUniqueIds)
+            interactionUniqueIds.formUnion(other.interactionUniqueIds)
+            attachmentUniqueIds.formUnion(other.attachmentUniqueIds)
+            interactionDeletedUniqueIds.formUnion(other.interactionDeletedUniqueIds)
+            attachmentDeletedUniqueIds.formUnion(other.attachmentDeletedUniqueIds)
+            tableNames.formUnion(other.tableNames)
+            collections.formUnion(other.collections)
+            isComplete = isComplete && other.isComplete
+        }
+    }
+
+    enum ReplayResult {
+        // No other process has written since the journal was last replayed.
+        case noChanges
+        case changes(Changes)
+        // The changes since the journal was last replayed can't
+        // be fully accounted for.
+        case unknownChanges
+    }
+
+    private let unfairLock = UnfairLock()
+    // This property should only be accessed with unfairLock.
+    //
+    // If nil, we don't know which changes this process has seen.
+    private var lastSeenSequence: Int64?
+
+    // MARK: - Writing
+
+    static func append(changes: Changes, transaction: GRDBWriteTransaction) {
+        owsAssertDebug(!changes.isEmpty)
+
+        let changesData: Data
+        do {
+            changesData = try JSONEncoder().encode(changes)
+        } catch {
+            owsFailDebug("Error: \(error)")
+            return
+        }
+        transaction.executeUpdate(sql: "INSERT INTO \(tableName) (changes) VALUES (?)",
+                                  arguments: [changesData])
+
+        let sequence = transaction.database.lastInsertedRowID
+        if sequence > maxEntryCount {
+            transaction.executeUpdate(sql: "DELETE FROM \(tableName) WHERE sequence <= ?",
+                                      arguments: [sequence - maxEntryCount])
+        }
+    }
+
+    // MARK: - Replaying
+
+    // Treats every change made so far as seen, e.g. when this
+    // process starts observing the database.
+    func markAllChangesSeen(transaction: GRDBReadTransaction) {
+        do {
+            let maxSequence = try Int64.fetchOne(transaction.database,
+                                                 sql: "SELECT MAX(sequence) FROM \(Self.tableName)") ?? 0
+            unfairLock.withLock { lastSeenSequence = maxSequence }
+        } catch {
+            // The journal doesn't exist until the schema migrations
+            // have run; until then, we can't replay it.
+            Logger.warn("Could not read journal: \(error)")
+            unfairLock.withLock { lastSeenSequence = nil }
+        }
+    }
+
+    // Returns the changes since this method was last called (or
+    // since markAllChangesSeen()) and marks them as seen.
+    func replayUnseenChanges(transaction: GRDBReadTransaction) -> ReplayResult {
+        guard let lastSeenSequence = unfairLock.withLock({ self.lastSeenSequence }) else {
+            markAllChangesSeen(transaction: transaction)
+            return .unknownChanges
+        }
+
+        var changes = Changes()
+        var latestSequence = lastSeenSequence
+        do {
+            let cursor = try Row.fetchCursor(transaction.database,
+                                             sql: """
+                                                SELECT sequence, changes
+                                                FROM \(Self.tableName)
+                                                WHERE sequence > ?
+                                                ORDER BY sequence
+                                             """,
+                                             arguments: [lastSeenSequence])
+            while let row = try cursor.next() {
+                let sequence: Int64 = row[0]
+                if sequence != latestSequence + 1 {
+                    // The entries we haven't seen were pruned.
+                    changes.isComplete = false
+                }
+                latestSequence = sequence
+
+                guard changes.isComplete else {
+                    // Skip over the rest of the entries.
+                    continue
+                }
+                let changesData: Data = row[1]
+                changes.formUnion(try JSONDecoder().decode(Changes.self, from: changesData))
+                if changes.rowChangeCount >= UIDatabaseObserver.kMaxIncrementalRowChanges {
+                    changes.isComplete = false
+                }
+            }
+        } catch {
+            owsFailDebug("Error: \(error)")
+            markAllChangesSeen(transaction: transaction)
+            return .unknownChanges
+        }
+
+        unfairLock.withLock { self.lastSeenSequence = latestSequence }
+
+        if latestSequence == lastSeenSequence {
+            return .noChanges
+        } else if changes.isComplete {
+            return .changes(changes)
+        } else {
+            Logger.info("Could not account for all changes since sequence \(lastSeenSequence).")
+            return .unknownChanges
+        }
+    }
+}
+
+// MARK: -
+
+// The changes made by other processes, as replayed from the journal.
+// This class is immutable, so unlike ObservedDatabaseChanges it can
+// be used on any thread.
+@objc
+class CrossProcessDatabaseChanges: NSObject, UIDatabaseChanges {
+
+    private let changes: CrossProcessChangeJournal.Changes
+
+    init(changes: CrossProcessChangeJournal.Changes) {
+        owsAssertDebug(changes.isComplete)
+
+        self.changes = changes
+    }
+
+    var threadUniqueIds: Set<UniqueId> { changes.threadUniqueIds }
+    var interactionUniqueIds: Set<UniqueId> { changes.interactionUniqueIds }
+    var attachmentUniqueIds: Set<UniqueId> { changes.attachmentUniqueIds }
+
+    var interactionDeletedUniqueIds: Set<UniqueId> { changes.interactionDeletedUniqueIds }
+    var attachmentDeletedUniqueIds: Set<UniqueId> { changes.attachmentDeletedUniqueIds }
+
+    var tableNames: Set<String> { changes.tableNames }
+    var collections: Set<String> { changes.collections }
+
+    var didUpdateInteractions: Bool {
+        collections.contains(TSInteraction.collection())
+    }
+
+    var didUpdateThreads: Bool {
+        collections.contains(TSThread.collection())
+    }
+
+    var didUpdateInteractionsOrThreads: Bool {
+        didUpdateInteractions || didUpdateThreads
+    }
+
+    @objc(didUpdateModelWithCollection:)
+    func didUpdateModel(collection: String) -> Bool {
+        collections.contains(collection)
+    }
+
+    @objc(didUpdateKeyValueStore:)
+    func didUpdate(keyValueStore: SDSKeyValueStore) -> Bool {
+        // See ObservedDatabaseChanges.didUpdate(keyValueStore:).
+        (collections.contains(keyValueStore.collection) ||
+            collections.contains(SDSKeyValueStore.dataStoreCollection))
+    }
+
+    @objc(didUpdateInteraction:)
+    func didUpdate(interaction: TSInteraction) -> Bool {
+        interactionUniqueIds.contains(interaction.uniqueId)
+    }
+
+    @objc(didUpdateThread:)
+    func didUpdate(thread: TSThread) -> Bool {
+        threadUniqueIds.contains(thread.uniqueId)
+    }
+}
@@ -0,0 +1,224 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import GRDB
+
+// Decides when and how the main app checkpoints the WAL.
+//
+// * Passive checkpoints are deferred until writes have been idle for
+//   a short while, and are performed off the main thread. They never
+//   block writers and keep most of the WAL integrated, which keeps
+//   truncating checkpoints cheap.
+// * Truncating checkpoints block writers, so we only perform them once
+//   the WAL file has grown past truncateThresholdBytes. They must be
+//   performed while the UI database snapshot isn't reading, i.e. on
+//   the main thread between snapshot updates (see UIDatabaseObserver).
+class GRDBCheckpointScheduler: Dependencies {
+
+    // The WAL file size above which we'll perform truncating checkpoints.
+    static var truncateThresholdBytes: UInt64 = 4 * 1024 * 1024
+
+    // How long writes must be idle before we perform a passive checkpoint.
+    static let idleInterval: TimeInterval = 0.5
+
+    // Limits the frequency of truncating checkpoints so that heavy
+    // write activity won't bog down the main thread.
+    static let minTruncateInterval: TimeInterval = 0.25
+
+    private let checkpointingQueue: DatabaseQueue
+    private let walFilePath: String
+
+    private let passiveCheckpointQueue = DispatchQueue(label: "org.signal.checkpoint.passive", qos: .utility)
+    private let isPassiveCheckpointInProgress = AtomicBool(false)
+
+    // These properties should only be accessed on the main thread.
+    private var lastTruncateDate: Date?
+    private var idleCheckpointWorkItem: DispatchWorkItem?
+
+    init(checkpointingQueue: DatabaseQueue) {
+        self.checkpointingQueue = checkpointingQueue
+        self.walFilePath = checkpointingQueue.path + "-wal"
+    }
+
+    var walFileSize: UInt64 {
+        // The WAL file won't exist until the first write.
+        OWSFileSystem.fileSize(ofPath: walFilePath)?.uint64Value ?? 0
+    }
+
+    // Should be called on the main thread, while the UI database
+    // snapshot isn't reading, after each write.
+    func didCommitWrite() {
+        AssertIsOnMainThread()
+
+        guard !tsAccountManager.isTransferInProgress else {
+            return
+        }
+
+        let walFileSize = self.walFileSize
+        GRDBCheckpointMetrics.shared.recordWalFileSize(walFileSize)
+
+        if shouldTruncate(walFileSize: walFileSize) {
+            cancelIdleCheckpoint()
+            lastTruncateDate = Date()
+            checkpoint(mode: .truncate)
+        } else {
+            scheduleIdleCheckpoint()
+        }
+    }
+
+    private func shouldTruncate(walFileSize: UInt64) -> Bool {
+        AssertIsOnMainThread()
+
+        guard walFileSize >= Self.truncateThresholdBytes else {
+            return false
+        }
+        if let lastTruncateDate = lastTruncateDate,
+           abs(lastTruncateDate.timeIntervalSinceNow) < Self.minTruncateInterval {
+            Logger.verbose("Skipping checkpoint due to frequency")
+            return false
+        }
+        // Don't block the main thread on a passive checkpoint;
+        // we'll try again after the next write.
+        guard !isPassiveCheckpointInProgress.get() else {
+            return false
+        }
+        return true
+    }
+
+    // MARK: - Idle Checkpoints
+
+    private func scheduleIdleCheckpoint() {
+        AssertIsOnMainThread()
+
+        // Each write pushes back the idle checkpoint.
+        cancelIdleCheckpoint()
+
+        let workItem = DispatchWorkItem { [weak self] in
+            self?.performIdleCheckpoint()
+        }
+        idleCheckpointWorkItem = workItem
+        passiveCheckpointQueue.asyncAfter(deadline: .now() + Self.idleInterval, execute: workItem)
+    }
+
+    private func cancelIdleCheckpoint() {
+        AssertIsOnMainThread()
+
+        idleCheckpointWorkItem?.cancel()
+        idleCheckpointWorkItem = nil
+    }
+
+    private func performIdleCheckpoint() {
+        assertOnQueue(passiveCheckpointQueue)
+
+        isPassiveCheckpointInProgress.set(true)
+        defer { isPassiveCheckpointInProgress.set(false) }
+
+        checkpoint(mode: .passive)
+    }
+
+    private func checkpoint(mode: Database.CheckpointMode) {
+        let result: GrdbTruncationResult
+        do {
+            result = try GRDBDatabaseStorageAdapter.checkpoint(checkpointingQueue: checkpointingQueue, mode: mode)
+        } catch {
+            owsFailDebug("error \(error)")
+            return
+        }
+
+        let pageSize: Int32 = 4 * 1024
+        let walFileSizeBytes = result.walSizePages * pageSize
+        let maxWalFileSizeBytes = 4 * 1024 * 1024
+        if walFileSizeBytes > maxWalFileSizeBytes {
+            Logger.info("walFileSizeBytes: \(walFileSizeBytes).")
+            Logger.info("walSizePages: \(result.walSizePages), pagesCheckpointed: \(result.pagesCheckpointed).")
+        } else {
+            Logger.verbose("walSizePages: \(result.walSizePages), pagesCheckpointed: \(result.pagesCheckpointed).")
+        }
+    }
+}
+
+// MARK: -
+
+@objc
+public class GRDBCheckpointMetrics: NSObject {
+
+    @objc
+    public static let shared = GRDBCheckpointMetrics()
+
+    public struct ModeMetrics {
+        public fileprivate(set) var count: UInt = 0
+        public fileprivate(set) var busyCount: UInt = 0
+        public fileprivate(set) var totalDuration: TimeInterval = 0
+        public fileprivate(set) var maxDuration: TimeInterval = 0
+        public fileprivate(set) var pagesCheckpointed: Int64 = 0
+    }
+
+    private let lock = UnfairLock()
+    // These should only be accessed with lock acquired.
+    private var _modeMetrics = [Database.CheckpointMode: ModeMetrics]()
+    private var _lastWalFileSize: UInt64 = 0
+    private var _maxWalFileSize: UInt64 = 0
+
+    public func metrics(forMode mode: Database.CheckpointMode) -> ModeMetrics {
+        lock.withLock { _modeMetrics[mode] ?? ModeMetrics() }
+    }
+
+    public var lastWalFileSize: UInt64 {
+        lock.withLock { _lastWalFileSize }
+    }
+
+    public var maxWalFileSize: UInt64 {
+        lock.withLock { _maxWalFileSize }
+    }
+
+    func recordWalFileSize(_ walFileSize: UInt64) {
+        lock.withLock {
+            _lastWalFileSize = walFileSize
+            _maxWalFileSize = max(_maxWalFileSize, walFileSize)
+        }
+    }
+
+    func recordCheckpoint(mode: Database.CheckpointMode,
+                          duration: TimeInterval,
+                          wasBusy: Bool,
+                          pagesCheckpointed: Int32) {
+        lock.withLock {
+            var metrics = _modeMetrics[mode] ?? ModeMetrics()
+            metrics.count += 1
+            if wasBusy {
+                metrics.busyCount += 1
+            }
+            metrics.totalDuration += duration
+            metrics.maxDuration = max(metrics.maxDuration, duration)
+            metrics.pagesCheckpointed += Int64(max(0, pagesCheckpointed))
+            _modeMetrics[mode] = metrics
+        }
+    }
+
+    @objc
+    public func logMetrics() {
+        let (modeMetrics, lastWalFileSize, maxWalFileSize): ([Database.CheckpointMode: ModeMetrics], UInt64, UInt64) = lock.withLock {
+            (_modeMetrics, _lastWalFileSize, _maxWalFileSize)
+        }
+        Logger.info("WAL file size: \(lastWalFileSize), max: \(maxWalFileSize), truncate threshold: \(GRDBCheckpointScheduler.truncateThresholdBytes)")
+        for (mode, metrics) in modeMetrics.sorted(by: { $0.key.rawValue < $1.key.rawValue }) {
+            let averageDuration = metrics.count > 0 ? metrics.totalDuration / Double(metrics.count) : 0
+            Logger.info("Checkpoint \(mode): count: \(metrics.count), busy: \(metrics.busyCount), " +
+                            "average: \(String(format: "%0.2fms", averageDuration * 1000)), " +
+                            "max: \(String(format: "%0.2fms", metrics.maxDuration * 1000)), " +
+                            "pages checkpointed: \(metrics.pagesCheckpointed)")
+        }
+        Logger.flush()
+    }
+
+    @objc
+    public func reset() {
+        lock.withLock {
+            _modeMetrics.removeAll()
+            _lastWalFileSize = 0
+            _maxWalFileSize = 0
+        }
+    }
+}
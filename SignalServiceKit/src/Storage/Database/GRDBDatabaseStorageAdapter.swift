@@ -124,10 +124,19 @@ public class GRDBDatabaseStorageAdapter: NSObject {
     @objc
     public private(set) var uiDatabaseObserver: UIDatabaseObserver?
 
+    let crossProcessChangeJournal = CrossProcessChangeJournal()
+
     @objc
     public func setupUIDatabase() throws {
         owsAssertDebug(self.uiDatabaseObserver == nil)
 
+        // The observer's initial snapshot will reflect every change
+        // which other processes have made so far. We do this first so
+        // that we can't miss changes made while the snapshot is created.
+        try read { transaction in
+            crossProcessChangeJournal.markAllChangesSeen(transaction: transaction)
+        }
+
         // UIDatabaseObserver is a general purpose observer, whose delegates
         // are notified when things change, but are not given any specific details
         // about the changes.
@@ -270,6 +279,8 @@ public class GRDBDatabaseStorageAdapter: NSObject {
         let keyspec = try keyspec.fetchString()
         try db.execute(sql: "PRAGMA \(prefix)key = \"\(keyspec)\"")
         try db.execute(sql: "PRAGMA \(prefix)cipher_plaintext_header_size = 32")
+
+        GRDBQueryStatistics.installTrace(db: db)
     }
 }
 
@@ -417,6 +428,13 @@ extension GRDBDatabaseStorageAdapter: SDSDatabaseStorageAdapter {
 
     @objc
     public func write(block: (GRDBWriteTransaction) -> Void) throws {
+        try write(block: block, didFinalize: { _ in })
+    }
+
+    // didFinalize is called after the transaction's finalization blocks
+    // have been performed, but before the database transaction commits.
+    public func write(block: (GRDBWriteTransaction) -> Void,
+                      didFinalize: (GRDBWriteTransaction) -> Void) throws {
 
         #if TESTABLE_BUILD
         owsAssertDebug(Self.canOpenTransaction)
@@ -440,6 +458,7 @@ extension GRDBDatabaseStorageAdapter: SDSDatabaseStorageAdapter {
                 let transaction = GRDBWriteTransaction(database: database)
                 block(transaction)
                 transaction.finalizeTransaction()
+                didFinalize(transaction)
 
                 syncCompletions = transaction.syncCompletions
                 asyncCompletions = transaction.asyncCompletions
@@ -470,7 +489,7 @@ func filterForDBQueryLog(_ input: String) -> String {
     return result
 }
 
-private func dbQueryLog(_ value: String) {
+func dbQueryLog(_ value: String) {
     guard SDSDatabaseStorage.shouldLogDBQueries else {
         return
     }
@@ -518,9 +537,6 @@ private struct GRDBStorage {
         var configuration = Configuration()
         configuration.readonly = false
         configuration.foreignKeysEnabled = true // Default is already true
-        configuration.trace = { logString in
-            dbQueryLog(logString)
-        }
         // Useful when your app opens multiple databases
         configuration.label = (isForCheckpointingQueue
             ? "GRDB Checkpointing"
@@ -694,11 +710,16 @@ extension GRDBDatabaseStorageAdapter {
 
         var walSizePages: Int32 = 0
         var pagesCheckpointed: Int32 = 0
+        var wasBusy = false
+        var checkpointDuration: TimeInterval = 0
         try Bench(title: "Slow checkpoint: \(mode)", logIfLongerThan: 0.01, logInProduction: true) {
             #if TESTABLE_BUILD
             let startTime = CACurrentMediaTime()
             #endif
             try checkpointingQueue.inDatabase { db in
+                let checkpointStartTime = CACurrentMediaTime()
+                defer { checkpointDuration = CACurrentMediaTime() - checkpointStartTime }
+
                 #if TESTABLE_BUILD
                 let startElapsedSeconds: TimeInterval = CACurrentMediaTime() - startTime
                 let slowStartSeconds: TimeInterval = TimeInterval(GRDBStorage.maxBusyTimeoutMs) / 1000
@@ -719,12 +740,16 @@ extension GRDBDatabaseStorageAdapter {
                 case SQLITE_BUSY:
                     // Busy is not an error.
                     Logger.info("Checkpoint \(mode) failed due to busy.")
-                    break
+                    wasBusy = true
                 default:
                     throw OWSAssertionError("checkpoint sql error with code: \(code)")
                 }
             }
         }
+        GRDBCheckpointMetrics.shared.recordCheckpoint(mode: mode,
+                                                      duration: checkpointDuration,
+                                                      wasBusy: wasBusy,
+                                                      pagesCheckpointed: pagesCheckpointed)
         return GrdbTruncationResult(walSizePages: walSizePages, pagesCheckpointed: pagesCheckpointed)
     }
 }
@@ -0,0 +1,270 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import GRDB
+
+// Collects per-statement timing statistics for our GRDB connections.
+//
+// Statements are keyed by their "normalized" SQL: whitespace is
+// collapsed and literals and IN (...) lists are replaced with
+// placeholders, so that queries which only differ by their inlined
+// values share a single entry.
+//
+// For each statement we track the number of executions, a log-scale
+// histogram of execution durations (from which we derive p50/p95/p99),
+// the number of rows visited by full table scans, the number of
+// virtual machine steps and the hit rate of the prepared statement
+// cache (see GRDBReadTransaction.cachedSelectStatement()).
+//
+// Samples are gathered by a sqlite3_trace_v2() profile hook which is
+// installed on each connection as it is opened, so this must be
+// enabled before the database is opened.
+@objc
+public class GRDBQueryStatistics: NSObject {
+
+    @objc
+    public static let shared = GRDBQueryStatistics()
+
+    @objc
+    public static var isEnabled: Bool = DebugFlags.logSQLStatistics
+
+    // MARK: - Histogram
+
+    // Durations are bucketed on a log scale with this many
+    // buckets per doubling, i.e. with a resolution of ~19%.
+    private static let bucketsPerDoubling: Double = 4
+    // 2^(64 / 4) µs ~= 65s.
+    static let bucketCount = 64
+
+    static func bucketIndex(durationNs: Int64) -> Int {
+        let durationUs = Double(durationNs) / 1000
+        guard durationUs > 1 else {
+            return 0
+        }
+        let index = Int((log2(durationUs) * bucketsPerDoubling).rounded(.up))
+        return max(0, min(bucketCount - 1, index))
+    }
+
+    // The upper bound of each bucket, in nanoseconds.
+    static func bucketUpperBoundNs(index: Int) -> Int64 {
+        Int64(pow(2, Double(index) / bucketsPerDoubling) * 1000)
+    }
+
+    struct Entry {
+        let normalizedSql: String
+        var executionCount: UInt64 = 0
+        var totalDurationNs: Int64 = 0
+        var maxDurationNs: Int64 = 0
+        var fullScanSteps: UInt64 = 0
+        var vmSteps: UInt64 = 0
+        var cacheHits: UInt64 = 0
+        var cacheMisses: UInt64 = 0
+        var durationBuckets = [UInt64](repeating: 0, count: GRDBQueryStatistics.bucketCount)
+
+        init(normalizedSql: String) {
+            self.normalizedSql = normalizedSql
+        }
+
+        // Returns the upper bound of the bucket which contains
+        // the given percentile, in nanoseconds.
+        func durationNs(percentile: Double) -> Int64 {
+            owsAssertDebug(percentile > 0 && percentile <= 1)
+
+            guard executionCount > 0 else {
+                return 0
+            }
+            let threshold = UInt64((Double(executionCount) * percentile).rounded(.up))
+            var cumulativeCount: UInt64 = 0
+            for (index, count) in durationBuckets.enumerated() {
+                cumulativeCount += count
+                if cumulativeCount >= threshold {
+                    return min(maxDurationNs, GRDBQueryStatistics.bucketUpperBoundNs(index: index))
+                }
+            }
+            return maxDurationNs
+        }
+    }
+
+    private let lock = UnfairLock()
+    // These should only be accessed with lock acquired.
+    private var entries = [String: Entry]()
+    private let normalizedSqlCache = LRUCache<String, String>(maxSize: 512)
+
+    // MARK: - Normalization
+
+    private static let normalizationRules: [(NSRegularExpression, String)] = {
+        let patterns: [(String, String)] = [
+            // String and blob literals.
+            ("[xX]?'(?:[^']|'')*'", "?"),
+            // Numeric literals which aren't part of an identifier.
+            ("(?<![\\w.])-?\\d+(?:\\.\\d+)?\\b", "?"),
+            // Whitespace.
+            ("\\s+", " "),
+            // Placeholder lists.
+            ("\\(\\s*\\?(?:\\s*,\\s*\\?)*\\s*\\)", "(...)")
+        ]
+        return patterns.map { (pattern, template) in
+            (try! NSRegularExpression(pattern: pattern, options: []), template)
+        }
+    }()
+
+    static func normalize(sql: String) -> String {
+        var result = sql
+        for (regex, template) in normalizationRules {
+            result = regex.stringByReplacingMatches(in: result,
+                                                    options: [],
+                                                    range: NSRange(result.startIndex..., in: result),
+                                                    withTemplate: template)
+        }
+        return result.trimmingCharacters(in: .whitespaces)
+    }
+
+    // This should only be called with lock acquired.
+    private func normalizedSql(forSql sql: String) -> String {
+        if let normalizedSql = normalizedSqlCache.get(key: sql) {
+            return normalizedSql
+        }
+        let normalizedSql = Self.normalize(sql: sql)
+        normalizedSqlCache.set(key: sql, value: normalizedSql)
+        return normalizedSql
+    }
+
+    // MARK: - Recording
+
+    func record(sql: String, durationNs: Int64, fullScanSteps: Int32, vmSteps: Int32) {
+        lock.withLock {
+            let key = normalizedSql(forSql: sql)
+            var entry = entries[key] ?? Entry(normalizedSql: key)
+            entry.executionCount += 1
+            entry.totalDurationNs += durationNs
+            entry.maxDurationNs = max(entry.maxDurationNs, durationNs)
+            entry.fullScanSteps += UInt64(max(0, fullScanSteps))
+            entry.vmSteps += UInt64(max(0, vmSteps))
+            entry.durationBuckets[Self.bucketIndex(durationNs: durationNs)] += 1
+            entries[key] = entry
+        }
+    }
+
+    func recordStatementCacheLookup(sql: String, isHit: Bool) {
+        lock.withLock {
+            let key = normalizedSql(forSql: sql)
+            var entry = entries[key] ?? Entry(normalizedSql: key)
+            if isHit {
+                entry.cacheHits += 1
+            } else {
+                entry.cacheMisses += 1
+            }
+            entries[key] = entry
+        }
+    }
+
+    func entry(forSql sql: String) -> Entry? {
+        lock.withLock {
+            entries[normalizedSql(forSql: sql)]
+        }
+    }
+
+    // MARK: - Tracing
+
+    // This replaces GRDB's own trace hook (Configuration.trace),
+    // so it also takes care of logging queries.
+    static func installTrace(db: Database) {
+        // Profiling adds overhead to every statement, so we only
+        // ask for it if statistics are enabled.
+        var mask = UInt32(SQLITE_TRACE_STMT)
+        if isEnabled {
+            mask |= UInt32(SQLITE_TRACE_PROFILE)
+        }
+        sqlite3_trace_v2(db.sqliteConnection, mask, { (event, _, p, x) -> Int32 in
+            guard let p = p else {
+                return 0
+            }
+            let statement = OpaquePointer(p)
+            switch Int32(event) {
+            case SQLITE_TRACE_STMT:
+                guard SDSDatabaseStorage.shouldLogDBQueries else {
+                    break
+                }
+                guard let expandedSql = sqlite3_expanded_sql(statement) else {
+                    break
+                }
+                dbQueryLog(String(cString: expandedSql))
+                sqlite3_free(expandedSql)
+            case SQLITE_TRACE_PROFILE:
+                guard let x = x,
+                      let sql = sqlite3_sql(statement) else {
+                    break
+                }
+                let durationNs = x.load(as: Int64.self)
+                // Reset the counters so that each sample only
+                // reflects a single execution of the statement.
+                let fullScanSteps = sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1)
+                let vmSteps = sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_VM_STEP, 1)
+                GRDBQueryStatistics.shared.record(sql: String(cString: sql),
+                                                  durationNs: durationNs,
+                                                  fullScanSteps: fullScanSteps,
+                                                  vmSteps: vmSteps)
+            default:
+                break
+            }
+            return 0
+        }, nil)
+    }
+
+    // MARK: - Reporting
+
+    @objc
+    public func report() -> String {
+        let entries: [Entry] = lock.withLock {
+            Array(self.entries.values)
+        }
+        guard !entries.isEmpty else {
+            return "No SQL statistics."
+        }
+
+        func formatMs(_ durationNs: Int64) -> String {
+            String(format: "%.3f", Double(durationNs) / 1_000_000)
+        }
+
+        var lines = [String]()
+        lines.append("SQL statistics for \(entries.count) statements, ordered by total duration:")
+        for entry in entries.sorted(by: { $0.totalDurationNs > $1.totalDurationNs }) {
+            let cacheLookups = entry.cacheHits + entry.cacheMisses
+            let cacheDescription = (cacheLookups > 0
+                                        ? "\(entry.cacheHits)/\(cacheLookups)"
+                                        : "n/a")
+            lines.append("count: \(entry.executionCount), " +
+                            "total: \(formatMs(entry.totalDurationNs))ms, " +
+                            "p50: \(formatMs(entry.durationNs(percentile: 0.5)))ms, " +
+                            "p95: \(formatMs(entry.durationNs(percentile: 0.95)))ms, " +
+                            "p99: \(formatMs(entry.durationNs(percentile: 0.99)))ms, " +
+                            "max: \(formatMs(entry.maxDurationNs))ms, " +
+                            "full scan steps: \(entry.fullScanSteps), " +
+                            "vm steps: \(entry.vmSteps), " +
+                            "cache hits: \(cacheDescription), " +
+                            "sql: \(entry.normalizedSql)")
+        }
+        return lines.joined(separator: "\n")
+    }
+
+    @objc
+    public func logReport() {
+        guard Self.isEnabled else {
+            Logger.warn("SQL statistics are not enabled.")
+            return
+        }
+        for line in report().components(separatedBy: "\n") {
+            Logger.info(line)
+        }
+        Logger.flush()
+    }
+
+    @objc
+    public func reset() {
+        lock.withLock {
+            entries.removeAll()
+        }
+    }
+}
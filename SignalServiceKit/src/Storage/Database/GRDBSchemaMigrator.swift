@@ -104,6 +104,10 @@ public class GRDBSchemaMigrator: NSObject {
         case addGroupMember
         case createPendingViewedReceipts
         case addViewedToInteractions
+        case createPendingFTSIndexTable
+        case createThreadUnreadCounts
+        case createCrossProcessChangeJournal
+        case createInteractionDeleteGenerations
 
         // NOTE: Every time we add a migration id, consider
         // incrementing grdbSchemaVersionLatest.
@@ -140,6 +144,7 @@ public class GRDBSchemaMigrator: NSObject {
         case dataMigration_removeOversizedGroupAvatars
         case dataMigration_scheduleStorageServiceUpdateForMutedThreads
         case dataMigration_populateGroupMember
+        case dataMigration_scheduleCompactBlobMigration
     }
 
     public static let grdbSchemaVersionDefault: UInt = 0
@@ -1095,6 +1100,150 @@ public class GRDBSchemaMigrator: NSObject {
             }
         }
 
+        migrator.registerMigration(MigrationId.createPendingFTSIndexTable.rawValue) { db in
+            do {
+                try db.create(table: "indexable_text_pending") { table in
+                    table.autoIncrementedPrimaryKey("id")
+                        .notNull()
+                    table.column("collection", .text)
+                        .notNull()
+                    table.column("uniqueId", .text)
+                        .notNull()
+                }
+                try db.create(index: "index_indexable_text_pending_on_collection_and_uniqueId",
+                              on: "indexable_text_pending",
+                              columns: ["collection", "uniqueId"],
+                              unique: true)
+            } catch {
+                owsFail("Error: \(error)")
+            }
+        }
+
+        migrator.registerMigration(MigrationId.createThreadUnreadCounts.rawValue) { db in
+            do {
+                try db.create(table: "thread_unread_count") { table in
+                    table.column("threadUniqueId", .text)
+                        .notNull()
+                        .primaryKey()
+                    table.column("unreadCount", .integer)
+                        .notNull()
+                }
+
+                // This must match InteractionFinder.sqlClauseForUnreadInteractionCounts().
+                func isUnread(_ alias: String) -> String {
+                    """
+                    (
+                        \(alias)."read" IS 0
+                        AND (
+                            \(alias)."recordType" IN (\(SDSRecordType.incomingMessage.rawValue), \(SDSRecordType.call.rawValue))
+                            OR (
+                                \(alias)."recordType" IS \(SDSRecordType.infoMessage.rawValue)
+                                AND \(alias)."messageType" IS \(TSInfoMessageType.userJoinedSignal.rawValue)
+                            )
+                        )
+                    )
+                    """
+                }
+
+                try db.execute(sql: """
+                    CREATE TRIGGER "thread_unread_count_on_interaction_insert"
+                    AFTER INSERT ON "model_TSInteraction"
+                    WHEN \(isUnread("NEW"))
+                    BEGIN
+                        INSERT OR IGNORE INTO "thread_unread_count" ("threadUniqueId", "unreadCount")
+                        VALUES (NEW."uniqueThreadId", 0);
+                        UPDATE "thread_unread_count" SET "unreadCount" = "unreadCount" + 1
+                        WHERE "threadUniqueId" = NEW."uniqueThreadId";
+                    END;
+
+                    CREATE TRIGGER "thread_unread_count_on_interaction_delete"
+                    AFTER DELETE ON "model_TSInteraction"
+                    WHEN \(isUnread("OLD"))
+                    BEGIN
+                        UPDATE "thread_unread_count" SET "unreadCount" = "unreadCount" - 1
+                        WHERE "threadUniqueId" = OLD."uniqueThreadId";
+                    END;
+
+                    CREATE TRIGGER "thread_unread_count_on_interaction_update"
+                    AFTER UPDATE OF "read", "recordType", "messageType", "uniqueThreadId" ON "model_TSInteraction"
+                    WHEN \(isUnread("OLD")) IS NOT \(isUnread("NEW"))
+                    OR OLD."uniqueThreadId" IS NOT NEW."uniqueThreadId"
+                    BEGIN
+                        UPDATE "thread_unread_count" SET "unreadCount" = "unreadCount" - 1
+                        WHERE "threadUniqueId" = OLD."uniqueThreadId"
+                        AND \(isUnread("OLD"));
+                        INSERT OR IGNORE INTO "thread_unread_count" ("threadUniqueId", "unreadCount")
+                        SELECT NEW."uniqueThreadId", 0
+                        WHERE \(isUnread("NEW"));
+                        UPDATE "thread_unread_count" SET "unreadCount" = "unreadCount" + 1
+                        WHERE "threadUniqueId" = NEW."uniqueThreadId"
+                        AND \(isUnread("NEW"));
+                    END;
+
+                    CREATE TRIGGER "thread_unread_count_on_thread_delete"
+                    AFTER DELETE ON "model_TSThread"
+                    BEGIN
+                        DELETE FROM "thread_unread_count"
+                        WHERE "threadUniqueId" = OLD."uniqueId";
+                    END;
+                """)
+
+                try db.execute(sql: """
+                    INSERT INTO "thread_unread_count" ("threadUniqueId", "unreadCount")
+                    SELECT interaction."uniqueThreadId", COUNT(*)
+                    FROM "model_TSInteraction" AS interaction
+                    WHERE \(isUnread("interaction"))
+                    GROUP BY interaction."uniqueThreadId"
+                """)
+            } catch {
+                owsFail("Error: \(error)")
+            }
+        }
+
+        migrator.registerMigration(MigrationId.createCrossProcessChangeJournal.rawValue) { db in
+            do {
+                // See CrossProcessChangeJournal.
+                try db.create(table: "cross_process_change_journal") { table in
+                    table.autoIncrementedPrimaryKey("sequence")
+                        .notNull()
+                    table.column("changes", .blob)
+                        .notNull()
+                }
+            } catch {
+                owsFail("Error: \(error)")
+            }
+        }
+
+        migrator.registerMigration(MigrationId.createInteractionDeleteGenerations.rawValue) { db in
+            do {
+                // See InteractionRankCheckpoints.
+                //
+                // Rows are never removed, so that a thread's generation
+                // only ever increases, even if the thread is deleted and
+                // re-created with the same unique id.
+                try db.create(table: "interaction_delete_generation") { table in
+                    table.column("threadUniqueId", .text)
+                        .notNull()
+                        .primaryKey()
+                    table.column("generation", .integer)
+                        .notNull()
+                }
+
+                try db.execute(sql: """
+                    CREATE TRIGGER "interaction_delete_generation_on_interaction_delete"
+                    AFTER DELETE ON "model_TSInteraction"
+                    BEGIN
+                        INSERT OR IGNORE INTO "interaction_delete_generation" ("threadUniqueId", "generation")
+                        VALUES (OLD."uniqueThreadId", 0);
+                        UPDATE "interaction_delete_generation" SET "generation" = "generation" + 1
+                        WHERE "threadUniqueId" = OLD."uniqueThreadId";
+                    END;
+                """)
+            } catch {
+                owsFail("Error: \(error)")
+            }
+        }
+
         // MARK: - Schema Migration Insertion Point
     }
 
@@ -1321,6 +1470,15 @@ public class GRDBSchemaMigrator: NSObject {
                 }
             }
         }
+
+        migrator.registerMigration(MigrationId.dataMigration_scheduleCompactBlobMigration.rawValue) { db in
+            // Existing interactions are rewritten lazily, in the background,
+            // by SDSCompactBlobMigrator; we only flag that work here.
+            let transaction = GRDBWriteTransaction(database: db)
+            defer { transaction.finalizeTransaction() }
+
+            SDSCompactBlobMigrator.markMigrationNeeded(transaction: transaction.asAnyWrite)
+        }
     }
 }
 
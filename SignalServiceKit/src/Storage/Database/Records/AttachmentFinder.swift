@@ -129,8 +129,7 @@ struct GRDBAttachmentFinderAdapter: AttachmentFinderAdapter {
         """
         var result = [String]()
         do {
-            let cursor = try String.fetchCursor(transaction.database,
-                                                sql: sql,
+            let cursor = try String.fetchCursor(transaction.cachedSelectStatement(sql: sql),
                                                 arguments: [TSAttachmentPointerState.failed.rawValue])
             while let uniqueId = try cursor.next() {
                 result.append(uniqueId)
@@ -20,10 +20,7 @@ protocol InteractionFinderAdapter {
 
     static func attemptingOutInteractionIds(transaction: ReadTransaction) -> [String]
 
-    // The interactions should be enumerated in order from "first to expire" to "last to expire".
-    static func enumerateMessagesWithStartedPerConversationExpiration(transaction: ReadTransaction, block: @escaping (TSInteraction, UnsafeMutablePointer<ObjCBool>) -> Void)
-
-    static func interactionIdsWithExpiredPerConversationExpiration(transaction: ReadTransaction) -> [String]
+    static func enumerateStartedPerConversationExpirations(transaction: ReadTransaction, block: @escaping (String, UInt64) -> Void)
 
     static func enumerateMessagesWhichFailedToStartExpiring(transaction: ReadTransaction, block: @escaping (TSMessage, UnsafeMutablePointer<ObjCBool>) -> Void)
 
@@ -38,6 +35,7 @@ protocol InteractionFinderAdapter {
     func earliestKnownInteractionRowId(transaction: ReadTransaction) -> Int?
 
     func distanceFromLatest(interactionUniqueId: String, transaction: ReadTransaction) throws -> UInt?
+    func sortIndex(interactionUniqueId: String, transaction: ReadTransaction) throws -> UInt?
     func count(transaction: ReadTransaction) -> UInt
     func enumerateInteractionIds(transaction: ReadTransaction, block: @escaping (String, UnsafeMutablePointer<ObjCBool>) throws -> Void) throws
     func enumerateRecentInteractions(transaction: ReadTransaction, block: @escaping (TSInteraction, UnsafeMutablePointer<ObjCBool>) -> Void) throws
@@ -125,21 +123,9 @@ public class InteractionFinder: NSObject, InteractionFinderAdapter {
     @objc
     public class func unreadCountInAllThreads(transaction: GRDBReadTransaction) -> UInt {
         do {
-            var unreadInteractionQuery = """
-                SELECT COUNT(interaction.\(interactionColumn: .id))
-                FROM \(InteractionRecord.databaseTableName) AS interaction
-            """
-
-            if !SSKPreferences.includeMutedThreadsInBadgeCount(transaction: transaction.asAnyRead) {
-                unreadInteractionQuery += " \(sqlClauseForIgnoringInteractionsWithMutedThread) "
-            }
-
-            unreadInteractionQuery += " WHERE \(sqlClauseForUnreadInteractionCounts(interactionsAlias: "interaction")) "
-
-            guard let unreadInteractionCount = try UInt.fetchOne(transaction.database, sql: unreadInteractionQuery) else {
-                owsFailDebug("unreadInteractionCount was unexpectedly nil")
-                return 0
-            }
+            let includeMutedThreads = SSKPreferences.includeMutedThreadsInBadgeCount(transaction: transaction.asAnyRead)
+            let unreadInteractionCount = ThreadUnreadCountFinder.unreadCountInAllThreads(includeMutedThreads: includeMutedThreads,
+                                                                                         transaction: transaction)
 
             let markedUnreadThreadQuery = """
                 SELECT COUNT(*)
@@ -148,7 +134,7 @@ public class InteractionFinder: NSObject, InteractionFinderAdapter {
                 AND \(threadColumn: .shouldThreadBeVisible) = 1
             """
 
-            guard let markedUnreadCount = try UInt.fetchOne(transaction.database, sql: markedUnreadThreadQuery) else {
+            guard let markedUnreadCount = try UInt.fetchOne(transaction.cachedSelectStatement(sql: markedUnreadThreadQuery)) else {
                 owsFailDebug("markedUnreadCount was unexpectedly nil")
                 return unreadInteractionCount
             }
@@ -160,20 +146,13 @@ public class InteractionFinder: NSObject, InteractionFinderAdapter {
         }
     }
 
-    // The interactions should be enumerated in order from "next to expire" to "last to expire".
+    // Enumerates the uniqueId and expiresAt of every message whose
+    // expiration has started, without deserializing the messages.
     @objc
-    public class func enumerateMessagesWithStartedPerConversationExpiration(transaction: SDSAnyReadTransaction, block: @escaping (TSInteraction, UnsafeMutablePointer<ObjCBool>) -> Void) {
+    public class func enumerateStartedPerConversationExpirations(transaction: SDSAnyReadTransaction, block: @escaping (String, UInt64) -> Void) {
         switch transaction.readTransaction {
         case .grdbRead(let grdbRead):
-            GRDBInteractionFinder.enumerateMessagesWithStartedPerConversationExpiration(transaction: grdbRead, block: block)
-        }
-    }
-
-    @objc
-    public class func interactionIdsWithExpiredPerConversationExpiration(transaction: SDSAnyReadTransaction) -> [String] {
-        switch transaction.readTransaction {
-        case .grdbRead(let grdbRead):
-            return GRDBInteractionFinder.interactionIdsWithExpiredPerConversationExpiration(transaction: grdbRead)
+            GRDBInteractionFinder.enumerateStartedPerConversationExpirations(transaction: grdbRead, block: block)
         }
     }
 
@@ -284,6 +263,13 @@ public class InteractionFinder: NSObject, InteractionFinderAdapter {
         }
     }
 
+    public func sortIndex(interactionUniqueId: String, transaction: SDSAnyReadTransaction) throws -> UInt? {
+        switch transaction.readTransaction {
+        case .grdbRead(let grdbRead):
+            return try grdbAdapter.sortIndex(interactionUniqueId: interactionUniqueId, transaction: grdbRead)
+        }
+    }
+
     @objc
     public func count(transaction: SDSAnyReadTransaction) -> UInt {
         switch transaction.readTransaction {
@@ -294,26 +280,7 @@ public class InteractionFinder: NSObject, InteractionFinderAdapter {
 
     @objc
     public func unreadCount(transaction: GRDBReadTransaction) -> UInt {
-        do {
-            let sql = """
-                SELECT COUNT(*)
-                FROM \(InteractionRecord.databaseTableName)
-                WHERE \(interactionColumn: .threadUniqueId) = ?
-                AND \(InteractionFinder.sqlClauseForUnreadInteractionCounts())
-            """
-            let arguments: StatementArguments = [threadUniqueId]
-
-            guard let count = try UInt.fetchOne(transaction.database,
-                                                sql: sql,
-                                                arguments: arguments) else {
-                    owsFailDebug("count was unexpectedly nil")
-                    return 0
-            }
-            return count
-        } catch {
-            owsFailDebug("error: \(error)")
-            return 0
-        }
+        ThreadUnreadCountFinder.unreadCount(threadUniqueId: threadUniqueId, transaction: transaction)
     }
 
     public func enumerateInteractionIds(transaction: SDSAnyReadTransaction, block: @escaping (String, UnsafeMutablePointer<ObjCBool>) throws -> Void) throws {
@@ -534,7 +501,8 @@ public class InteractionFinder: NSObject, InteractionFinderAdapter {
         """
     }()
 
-    private static func sqlClauseForUnreadInteractionCounts(interactionsAlias: String? = nil) -> String {
+    // The thread_unread_count triggers bake in this clause; see ThreadUnreadCountFinder.
+    static func sqlClauseForUnreadInteractionCounts(interactionsAlias: String? = nil) -> String {
         let columnPrefix: String
         if let interactionsAlias = interactionsAlias {
             columnPrefix = interactionsAlias + "."
@@ -553,17 +521,6 @@ public class InteractionFinder: NSObject, InteractionFinderAdapter {
         )
         """
     }
-
-    private static let sqlClauseForIgnoringInteractionsWithMutedThread: String = {
-        return """
-        INNER JOIN \(ThreadRecord.databaseTableName) AS thread
-        ON \(interactionColumn: .threadUniqueId) = thread.\(threadColumn: .uniqueId)
-        AND (
-            thread.\(threadColumn: .mutedUntilTimestamp) <= strftime('%s','now') * 1000
-            OR thread.\(threadColumn: .mutedUntilTimestamp) = 0
-        )
-        """
-    }()
 }
 
 // MARK: -
@@ -599,7 +556,7 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
                 )
             """
             let arguments: StatementArguments = [timestamp, uuidString, sourceDeviceId]
-            exists = try! Bool.fetchOne(transaction.database, sql: sql, arguments: arguments) ?? false
+            exists = try! Bool.fetchOne(transaction.cachedSelectStatement(sql: sql), arguments: arguments) ?? false
         }
 
         if !exists, let phoneNumber = address.phoneNumber {
@@ -613,7 +570,7 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
                 )
             """
             let arguments: StatementArguments = [timestamp, phoneNumber, sourceDeviceId]
-            exists = try! Bool.fetchOne(transaction.database, sql: sql, arguments: arguments) ?? false
+            exists = try! Bool.fetchOne(transaction.cachedSelectStatement(sql: sql), arguments: arguments) ?? false
         }
 
         return exists
@@ -669,7 +626,7 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
         )
         """
         let arguments: StatementArguments = [thread.uniqueId, eraId]
-        return try! Bool.fetchOne(transaction.unwrapGrdbRead.database, sql: sql, arguments: arguments) ?? false
+        return try! Bool.fetchOne(transaction.unwrapGrdbRead.cachedSelectStatement(sql: sql), arguments: arguments) ?? false
     }
 
     public static func unendedCallsForGroupThread(_ thread: TSThread, transaction: SDSAnyReadTransaction) -> [OWSGroupCallMessage] {
@@ -701,6 +658,99 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
         return groupCalls
     }
 
+    // Returns the unique ids of those threads which have a group call
+    // in progress, using a single query per chunk of threads.
+    public static func threadUniqueIdsWithGroupCallInProgress(threadUniqueIds: [String],
+                                                              transaction: SDSAnyReadTransaction) -> Set<String> {
+        var result = Set<String>()
+        for chunk in threadUniqueIds.chunked(by: GRDBWriteTransaction.maxVariablesPerStatement) {
+            let placeholders = Array(repeating: "?", count: chunk.count).joined(separator: ", ")
+            let sql: String = """
+            SELECT *
+            FROM \(InteractionRecord.databaseTableName)
+            WHERE \(interactionColumn: .recordType) IS \(SDSRecordType.groupCallMessage.rawValue)
+            AND \(interactionColumn: .hasEnded) IS FALSE
+            AND \(interactionColumn: .threadUniqueId) IN (\(placeholders))
+            """
+            let cursor = OWSGroupCallMessage.grdbFetchCursor(sql: sql,
+                                                             arguments: StatementArguments(chunk),
+                                                             transaction: transaction.unwrapGrdbRead)
+            do {
+                while let interaction = try cursor.next() {
+                    guard let groupCall = interaction as? OWSGroupCallMessage, !groupCall.hasEnded else {
+                        owsFailDebug("Unexpectedly result: \(interaction.timestamp)")
+                        continue
+                    }
+                    if groupCall.joinedMemberAddresses.count > 0 {
+                        result.insert(groupCall.uniqueThreadId)
+                    }
+                }
+            } catch {
+                owsFailDebug("unexpected error \(error)")
+            }
+        }
+        return result
+    }
+
+    // The batch equivalent of mostRecentInteractionForInbox(transaction:).
+    //
+    // The candidate of each thread is found with a correlated subquery,
+    // so that all candidates are loaded with a single query per chunk of
+    // threads. We only fall back to scanning a thread when its candidate
+    // is a group update which shouldn't appear in the inbox.
+    public static func mostRecentInteractionsForInbox(threadUniqueIds: [String],
+                                                      transaction: GRDBReadTransaction) -> [String: TSInteraction] {
+        let filterArguments: [DatabaseValueConvertible?] = [TSErrorMessageType.nonBlockingIdentityChange.rawValue,
+                                                            TSInfoMessageType.verificationStateChange.rawValue,
+                                                            TSInfoMessageType.profileUpdate.rawValue]
+        let chunkSize = GRDBWriteTransaction.maxVariablesPerStatement - filterArguments.count
+
+        var result = [String: TSInteraction]()
+        var threadUniqueIdsToScan = Set<String>()
+        let anyTransaction = transaction.asAnyRead
+        for chunk in threadUniqueIds.chunked(by: chunkSize) {
+            let placeholders = Array(repeating: "?", count: chunk.count).joined(separator: ", ")
+            let sql = """
+                SELECT *
+                FROM \(InteractionRecord.databaseTableName)
+                WHERE \(interactionColumn: .id) IN (
+                    SELECT (
+                        SELECT interaction.\(interactionColumn: .id)
+                        FROM \(InteractionRecord.databaseTableName) AS interaction
+                        WHERE interaction.\(interactionColumn: .threadUniqueId) = thread.\(threadColumn: .uniqueId)
+                        AND interaction.\(interactionColumn: .errorType) IS NOT ?
+                        AND interaction.\(interactionColumn: .messageType) IS NOT ?
+                        AND interaction.\(interactionColumn: .messageType) IS NOT ?
+                        ORDER BY interaction.\(interactionColumn: .id) DESC
+                        LIMIT 1
+                    )
+                    FROM \(ThreadRecord.databaseTableName) AS thread
+                    WHERE thread.\(threadColumn: .uniqueId) IN (\(placeholders))
+                )
+            """
+            let arguments = StatementArguments(filterArguments + chunk.map { $0 as DatabaseValueConvertible? })
+            do {
+                let cursor = TSInteraction.grdbFetchCursor(sql: sql, arguments: arguments, transaction: transaction)
+                while let interaction = try cursor.next() {
+                    if interaction.shouldAppearInInbox(transaction: anyTransaction) {
+                        result[interaction.uniqueThreadId] = interaction
+                    } else {
+                        threadUniqueIdsToScan.insert(interaction.uniqueThreadId)
+                    }
+                }
+            } catch {
+                owsFailDebug("Error: \(error)")
+                threadUniqueIdsToScan.formUnion(chunk.filter { result[$0] == nil })
+            }
+        }
+
+        for threadUniqueId in threadUniqueIdsToScan {
+            let finder = GRDBInteractionFinder(threadUniqueId: threadUniqueId)
+            result[threadUniqueId] = finder.mostRecentInteractionForInbox(transaction: transaction)
+        }
+        return result
+    }
+
     static func attemptingOutInteractionIds(transaction: ReadTransaction) -> [String] {
         let sql: String = """
         SELECT \(interactionColumn: .uniqueId)
@@ -718,53 +768,25 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
         return result
     }
 
-    // The interactions should be enumerated in order from "next to expire" to "last to expire".
-    static func enumerateMessagesWithStartedPerConversationExpiration(transaction: ReadTransaction, block: @escaping (TSInteraction, UnsafeMutablePointer<ObjCBool>) -> Void) {
+    static func enumerateStartedPerConversationExpirations(transaction: ReadTransaction, block: @escaping (String, UInt64) -> Void) {
         // NOTE: We DO NOT consult storedShouldStartExpireTimer here;
         //       once expiration has begun we want to see it through.
         let sql = """
-        SELECT *
+        SELECT \(interactionColumn: .uniqueId), \(interactionColumn: .expiresAt)
         FROM \(InteractionRecord.databaseTableName)
         WHERE \(interactionColumn: .expiresInSeconds) > 0
         AND \(interactionColumn: .expiresAt) > 0
-        ORDER BY \(interactionColumn: .expiresAt)
         """
-        let cursor = TSInteraction.grdbFetchCursor(sql: sql, transaction: transaction)
         do {
-            while let interaction = try cursor.next() {
-                var stop: ObjCBool = false
-                block(interaction, &stop)
-                if stop.boolValue {
-                    return
-                }
+            let cursor = try Row.fetchCursor(transaction.database, sql: sql)
+            while let row = try cursor.next() {
+                let uniqueId: String = row[0]
+                let expiresAt: Int64 = row[1]
+                block(uniqueId, UInt64(expiresAt))
             }
-        } catch {
-            owsFail("error: \(error)")
-        }
-    }
-
-    static func interactionIdsWithExpiredPerConversationExpiration(transaction: ReadTransaction) -> [String] {
-        // NOTE: We DO NOT consult storedShouldStartExpireTimer here;
-        //       once expiration has begun we want to see it through.
-        let now: UInt64 = NSDate.ows_millisecondTimeStamp()
-        let sql = """
-        SELECT \(interactionColumn: .uniqueId)
-        FROM \(InteractionRecord.databaseTableName)
-        WHERE \(interactionColumn: .expiresAt) > 0
-        AND \(interactionColumn: .expiresAt) <= ?
-        """
-        let statementArguments: StatementArguments = [
-            now
-        ]
-        var result = [String]()
-        do {
-            result = try String.fetchAll(transaction.database,
-                                         sql: sql,
-                                         arguments: statementArguments)
         } catch {
             owsFailDebug("error: \(error)")
         }
-        return result
     }
 
     static func enumerateMessagesWhichFailedToStartExpiring(transaction: ReadTransaction, block: @escaping (TSMessage, UnsafeMutablePointer<ObjCBool>) -> Void) {
@@ -932,31 +954,46 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
                 LIMIT 1
                 """
         let arguments: StatementArguments = [threadUniqueId]
-        return try? Int.fetchOne(transaction.database, sql: sql, arguments: arguments)
+        return try? Int.fetchOne(transaction.cachedSelectStatement(sql: sql), arguments: arguments)
+    }
+
+    // Sort indices and ranges are resolved with rank checkpoints,
+    // so these queries don't degrade deep into large threads.
+    // See InteractionRankCheckpoints.
+    private func ranks(transaction: GRDBReadTransaction) throws -> InteractionRanks {
+        try InteractionRankCheckpoints.shared.ranks(threadUniqueId: threadUniqueId, transaction: transaction)
     }
 
     func distanceFromLatest(interactionUniqueId: String, transaction: GRDBReadTransaction) throws -> UInt? {
-        guard let interactionId = try UInt.fetchOne(transaction.database, sql: """
-            SELECT id
-            FROM \(InteractionRecord.databaseTableName)
-            WHERE \(interactionColumn: .uniqueId) = ?
-        """, arguments: [interactionUniqueId]) else {
-            owsFailDebug("failed to find id for interaction \(interactionUniqueId)")
+        let ranks = try self.ranks(transaction: transaction)
+        guard let sortIndex = try sortIndex(interactionUniqueId: interactionUniqueId,
+                                            ranks: ranks,
+                                            transaction: transaction) else {
+            owsFailDebug("failed to find distance from latest message")
             return nil
         }
+        return ranks.count - sortIndex - 1
+    }
+
+    func sortIndex(interactionUniqueId: String, transaction: GRDBReadTransaction) throws -> UInt? {
+        try sortIndex(interactionUniqueId: interactionUniqueId,
+                      ranks: ranks(transaction: transaction),
+                      transaction: transaction)
+    }
 
-        guard let distanceFromLatest = try UInt.fetchOne(transaction.database, sql: """
-            SELECT count(*) - 1
+    private func sortIndex(interactionUniqueId: String,
+                           ranks: InteractionRanks,
+                           transaction: GRDBReadTransaction) throws -> UInt? {
+        guard let interactionId = try Int64.fetchOne(transaction.database, sql: """
+            SELECT id
             FROM \(InteractionRecord.databaseTableName)
-            WHERE \(interactionColumn: .threadUniqueId) = ?
-            AND \(interactionColumn: .id) >= ?
-            ORDER BY \(interactionColumn: .id) DESC
-        """, arguments: [threadUniqueId, interactionId]) else {
-            owsFailDebug("failed to find distance from latest message")
+            WHERE \(interactionColumn: .uniqueId) = ?
+            AND \(interactionColumn: .threadUniqueId) = ?
+        """, arguments: [interactionUniqueId, threadUniqueId]) else {
+            owsFailDebug("failed to find id for interaction \(interactionUniqueId)")
             return nil
         }
-
-        return distanceFromLatest
+        return try ranks.sortIndex(ofRowId: interactionId, transaction: transaction)
     }
 
     func count(transaction: GRDBReadTransaction) -> UInt {
@@ -1016,16 +1053,27 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
         }
     }
 
+    // Returns the row id of the first interaction in range, if any.
+    private func firstRowId(inRange range: NSRange, transaction: GRDBReadTransaction) throws -> Int64? {
+        guard range.length > 0, range.location >= 0 else {
+            return nil
+        }
+        return try ranks(transaction: transaction).rowId(atSortIndex: UInt(range.location), transaction: transaction)
+    }
+
     func enumerateInteractions(range: NSRange, transaction: GRDBReadTransaction, block: @escaping (TSInteraction, UnsafeMutablePointer<ObjCBool>) -> Void) throws {
+        guard let firstRowId = try firstRowId(inRange: range, transaction: transaction) else {
+            return
+        }
         let sql = """
         SELECT *
         FROM \(InteractionRecord.databaseTableName)
         WHERE \(interactionColumn: .threadUniqueId) = ?
+        AND \(interactionColumn: .id) >= ?
         ORDER BY \(interactionColumn: .id)
         LIMIT \(range.length)
-        OFFSET \(range.location)
         """
-        let arguments: StatementArguments = [threadUniqueId]
+        let arguments: StatementArguments = [threadUniqueId, firstRowId]
         let cursor = TSInteraction.grdbFetchCursor(sql: sql,
                                                    arguments: arguments,
                                                    transaction: transaction)
@@ -1040,15 +1088,18 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
     }
 
     func interactionIds(inRange range: NSRange, transaction: GRDBReadTransaction) throws -> [String] {
+        guard let firstRowId = try firstRowId(inRange: range, transaction: transaction) else {
+            return []
+        }
         let sql = """
         SELECT \(interactionColumn: .uniqueId)
         FROM \(InteractionRecord.databaseTableName)
         WHERE \(interactionColumn: .threadUniqueId) = ?
+        AND \(interactionColumn: .id) >= ?
         ORDER BY \(interactionColumn: .id)
         LIMIT \(range.length)
-        OFFSET \(range.location)
         """
-        let arguments: StatementArguments = [threadUniqueId]
+        let arguments: StatementArguments = [threadUniqueId, firstRowId]
         return try String.fetchAll(transaction.database,
                                    sql: sql,
                                    arguments: arguments)
@@ -1057,7 +1108,9 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
     @objc
     public func enumerateMessagesWithAttachments(transaction: GRDBReadTransaction, block: @escaping (TSMessage, UnsafeMutablePointer<ObjCBool>) -> Void) throws {
 
+        // attachmentIds may be stored in either the keyed-archive or compact format.
         let emptyArraySerializedDataString = NSKeyedArchiver.archivedData(withRootObject: [String]()).hexadecimalString
+        let emptyArrayCompactDataString = SDSCompactCoding.encode(strings: []).hexadecimalString
 
         let sql = """
             SELECT *
@@ -1065,6 +1118,7 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
             WHERE \(interactionColumn: .threadUniqueId) = ?
             AND \(interactionColumn: .attachmentIds) IS NOT NULL
             AND \(interactionColumn: .attachmentIds) != x'\(emptyArraySerializedDataString)'
+            AND \(interactionColumn: .attachmentIds) != x'\(emptyArrayCompactDataString)'
         """
         let arguments: StatementArguments = [threadUniqueId]
         let cursor = TSInteraction.grdbFetchCursor(sql: sql, arguments: arguments, transaction: transaction)
@@ -1089,16 +1143,19 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
         }
     }
 
+    // index is relative to the newest interaction.
     func interaction(at index: UInt, transaction: GRDBReadTransaction) throws -> TSInteraction? {
+        let ranks = try self.ranks(transaction: transaction)
+        guard index < ranks.count,
+              let rowId = try ranks.rowId(atSortIndex: ranks.count - index - 1, transaction: transaction) else {
+            return nil
+        }
         let sql = """
         SELECT *
         FROM \(InteractionRecord.databaseTableName)
-        WHERE \(interactionColumn: .threadUniqueId) = ?
-        ORDER BY \(interactionColumn: .id) DESC
-        LIMIT 1
-        OFFSET ?
+        WHERE \(interactionColumn: .id) = ?
         """
-        let arguments: StatementArguments = [threadUniqueId, index]
+        let arguments: StatementArguments = [rowId]
         return TSInteraction.grdbFetchOne(sql: sql, arguments: arguments, transaction: transaction)
     }
 
@@ -1155,7 +1212,7 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
         )
         """
         let arguments: StatementArguments = [threadUniqueId, SDSRecordType.outgoingMessage.rawValue]
-        return try! Bool.fetchOne(transaction.database, sql: sql, arguments: arguments) ?? false
+        return try! Bool.fetchOne(transaction.cachedSelectStatement(sql: sql), arguments: arguments) ?? false
     }
 
     func hasGroupUpdateInfoMessage(transaction: GRDBReadTransaction) -> Bool {
@@ -1170,7 +1227,7 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
         )
         """
         let arguments: StatementArguments = [threadUniqueId]
-        return try! Bool.fetchOne(transaction.database, sql: sql, arguments: arguments)!
+        return try! Bool.fetchOne(transaction.cachedSelectStatement(sql: sql), arguments: arguments)!
     }
 
     func hasUserInitiatedInteraction(transaction: GRDBReadTransaction) -> Bool {
@@ -1221,7 +1278,7 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
         )
         """
         let arguments: StatementArguments = [threadUniqueId]
-        return try! Bool.fetchOne(transaction.database, sql: sql, arguments: arguments)!
+        return try! Bool.fetchOne(transaction.cachedSelectStatement(sql: sql), arguments: arguments)!
     }
 
     func possiblyHasIncomingMessages(transaction: GRDBReadTransaction) -> Bool {
@@ -1255,7 +1312,7 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
         )
         """
         let arguments: StatementArguments = [threadUniqueId]
-        return try! Bool.fetchOne(transaction.database, sql: sql, arguments: arguments)!
+        return try! Bool.fetchOne(transaction.cachedSelectStatement(sql: sql), arguments: arguments)!
     }
 
     #if DEBUG
@@ -1299,7 +1356,7 @@ public class GRDBInteractionFinder: NSObject, InteractionFinderAdapter {
         AND \(interactionColumn: .recordType) = ?
         """
         let arguments: StatementArguments = [threadUniqueId, SDSRecordType.outgoingMessage.rawValue]
-        return try! UInt.fetchOne(transaction.database, sql: sql, arguments: arguments) ?? 0
+        return try! UInt.fetchOne(transaction.cachedSelectStatement(sql: sql), arguments: arguments) ?? 0
     }
 
     public static func maxRowId(transaction: GRDBReadTransaction) -> Int {
@@ -0,0 +1,205 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import GRDB
+
+// Maps "sort indices" (the position of an interaction within its thread,
+// ordered by row id) to row ids and back without OFFSET scans.
+//
+// SQLite evaluates OFFSET by stepping over every skipped row, so
+// positional queries deep into very large threads get linearly slower.
+// Instead, we keep the row id of every `stride`th interaction of a
+// thread. A position is resolved by seeking to the nearest checkpoint
+// and stepping over at most `stride` rows from there.
+//
+// Checkpoints stay valid while interactions are only appended to the
+// thread. Each lookup reads a change token for the thread: its max row
+// id and its delete generation, which a trigger increments whenever one
+// of its interactions is deleted (see deleteGenerationTableName). Both
+// are read from the transaction's snapshot, so changes made by other
+// transactions or processes are detected too. If only the max
+// row id has grown, the checkpoints are extended; if the generation has
+// changed, they're rebuilt from a single scan of the thread's row ids.
+class InteractionRankCheckpoints {
+
+    static let shared = InteractionRankCheckpoints()
+
+    static let stride = 256
+
+    // Maintained by the "interaction_delete_generation_on_interaction_delete" trigger.
+    static let deleteGenerationTableName = "interaction_delete_generation"
+
+    private struct Checkpoints {
+        // rowIds[k] is the row id of the interaction at sort index k * stride.
+        var rowIds: [Int64]
+        var count: UInt
+        var maxRowId: Int64
+        var deleteGeneration: Int64
+    }
+
+    private static let cacheSize = 32
+
+    private let unfairLock = UnfairLock()
+    // This property should only be accessed with unfairLock.
+    private let cache = LRUCache<String, Checkpoints>(maxSize: InteractionRankCheckpoints.cacheSize)
+
+    func ranks(threadUniqueId: String, transaction: GRDBReadTransaction) throws -> InteractionRanks {
+        let checkpoints = try validCheckpoints(threadUniqueId: threadUniqueId, transaction: transaction)
+        return InteractionRanks(threadUniqueId: threadUniqueId,
+                                checkpointRowIds: checkpoints.rowIds,
+                                count: checkpoints.count)
+    }
+
+    func removeAll() {
+        unfairLock.withLock {
+            cache.clear()
+        }
+    }
+
+    // MARK: -
+
+    private func validCheckpoints(threadUniqueId: String, transaction: GRDBReadTransaction) throws -> Checkpoints {
+        let (maxRowId, deleteGeneration) = try Self.changeToken(threadUniqueId: threadUniqueId,
+                                                                transaction: transaction)
+
+        if var checkpoints = unfairLock.withLock({ cache.get(key: threadUniqueId) }),
+           checkpoints.deleteGeneration == deleteGeneration,
+           checkpoints.maxRowId <= maxRowId {
+            if checkpoints.maxRowId < maxRowId {
+                try Self.appendCheckpoints(to: &checkpoints,
+                                           threadUniqueId: threadUniqueId,
+                                           transaction: transaction)
+                owsAssertDebug(checkpoints.maxRowId == maxRowId)
+                unfairLock.withLock { cache.set(key: threadUniqueId, value: checkpoints) }
+            }
+            return checkpoints
+        }
+
+        var checkpoints = Checkpoints(rowIds: [], count: 0, maxRowId: 0, deleteGeneration: deleteGeneration)
+        try Self.appendCheckpoints(to: &checkpoints, threadUniqueId: threadUniqueId, transaction: transaction)
+        owsAssertDebug(checkpoints.maxRowId == maxRowId)
+        unfairLock.withLock { cache.set(key: threadUniqueId, value: checkpoints) }
+        return checkpoints
+    }
+
+    // Appends checkpoints for the interactions after checkpoints.maxRowId.
+    private static func appendCheckpoints(to checkpoints: inout Checkpoints,
+                                          threadUniqueId: String,
+                                          transaction: GRDBReadTransaction) throws {
+        let sql = """
+            SELECT \(interactionColumn: .id)
+            FROM \(InteractionRecord.databaseTableName)
+            WHERE \(interactionColumn: .threadUniqueId) = ?
+            AND \(interactionColumn: .id) > ?
+            ORDER BY \(interactionColumn: .id)
+        """
+        let cursor = try Int64.fetchCursor(transaction.database,
+                                           sql: sql,
+                                           arguments: [threadUniqueId, checkpoints.maxRowId])
+        while let rowId = try cursor.next() {
+            if checkpoints.count % UInt(stride) == 0 {
+                checkpoints.rowIds.append(rowId)
+            }
+            checkpoints.count += 1
+            checkpoints.maxRowId = rowId
+        }
+    }
+
+    // Both lookups are index seeks, so this is cheap even for large threads.
+    private static func changeToken(threadUniqueId: String,
+                                    transaction: GRDBReadTransaction) throws -> (maxRowId: Int64, deleteGeneration: Int64) {
+        let sql = """
+            SELECT
+                (
+                    SELECT MAX(\(interactionColumn: .id))
+                    FROM \(InteractionRecord.databaseTableName)
+                    WHERE \(interactionColumn: .threadUniqueId) = ?
+                ),
+                (
+                    SELECT generation
+                    FROM \(deleteGenerationTableName)
+                    WHERE threadUniqueId = ?
+                )
+        """
+        guard let row = try Row.fetchOne(transaction.cachedSelectStatement(sql: sql),
+                                         arguments: [threadUniqueId, threadUniqueId]) else {
+            return (0, 0)
+        }
+        let maxRowId: Int64? = row[0]
+        let deleteGeneration: Int64? = row[1]
+        return (maxRowId ?? 0, deleteGeneration ?? 0)
+    }
+}
+
+// MARK: -
+
+// The rank checkpoints of a thread, valid for the transaction
+// they were loaded with.
+struct InteractionRanks {
+    let threadUniqueId: String
+    let checkpointRowIds: [Int64]
+
+    // The number of interactions in the thread.
+    let count: UInt
+
+    func rowId(atSortIndex sortIndex: UInt, transaction: GRDBReadTransaction) throws -> Int64? {
+        guard sortIndex < count else {
+            return nil
+        }
+        let stride = UInt(InteractionRankCheckpoints.stride)
+        let checkpointIndex = Int(sortIndex / stride)
+        let sql = """
+            SELECT \(interactionColumn: .id)
+            FROM \(InteractionRecord.databaseTableName)
+            WHERE \(interactionColumn: .threadUniqueId) = ?
+            AND \(interactionColumn: .id) >= ?
+            ORDER BY \(interactionColumn: .id)
+            LIMIT 1
+            OFFSET ?
+        """
+        return try Int64.fetchOne(transaction.cachedSelectStatement(sql: sql),
+                                  arguments: [threadUniqueId,
+                                              checkpointRowIds[checkpointIndex],
+                                              sortIndex % stride])
+    }
+
+    // rowId must belong to an interaction in this thread.
+    func sortIndex(ofRowId rowId: Int64, transaction: GRDBReadTransaction) throws -> UInt? {
+        // Find the last checkpoint at or before rowId.
+        var lowerIndex = 0
+        var upperIndex = checkpointRowIds.count
+        while lowerIndex < upperIndex {
+            let middleIndex = (lowerIndex + upperIndex) / 2
+            if checkpointRowIds[middleIndex] <= rowId {
+                lowerIndex = middleIndex + 1
+            } else {
+                upperIndex = middleIndex
+            }
+        }
+        guard lowerIndex > 0 else {
+            return nil
+        }
+        let checkpointIndex = lowerIndex - 1
+
+        let sql = """
+            SELECT COUNT(*)
+            FROM \(InteractionRecord.databaseTableName)
+            WHERE \(interactionColumn: .threadUniqueId) = ?
+            AND \(interactionColumn: .id) >= ?
+            AND \(interactionColumn: .id) < ?
+        """
+        guard let distanceFromCheckpoint = try UInt.fetchOne(transaction.cachedSelectStatement(sql: sql),
+                                                             arguments: [threadUniqueId,
+                                                                         checkpointRowIds[checkpointIndex],
+                                                                         rowId]) else {
+            return nil
+        }
+        let sortIndex = UInt(checkpointIndex * InteractionRankCheckpoints.stride) + distanceFromCheckpoint
+        guard sortIndex < count else {
+            return nil
+        }
+        return sortIndex
+    }
+}
@@ -90,7 +90,7 @@ public class GRDBThreadFinder: NSObject, ThreadFinder {
         """
         let arguments: StatementArguments = [isArchived]
 
-        guard let count = try UInt.fetchOne(transaction.database, sql: sql, arguments: arguments) else {
+        guard let count = try UInt.fetchOne(transaction.cachedSelectStatement(sql: sql), arguments: arguments) else {
             owsFailDebug("count was unexpectedly nil")
             return 0
         }
@@ -105,7 +105,7 @@ public class GRDBThreadFinder: NSObject, ThreadFinder {
             FROM \(ThreadRecord.databaseTableName)
             WHERE \(threadColumn: .shouldThreadBeVisible) = 1
             AND \(threadColumn: .isArchived) = ?
-            ORDER BY \(threadColumn: .lastInteractionRowId) DESC
+            ORDER BY \(threadColumn: .lastInteractionRowId) DESC, \(threadColumn: .id) DESC
             """
         let arguments: StatementArguments = [isArchived]
 
@@ -114,6 +114,8 @@ public class GRDBThreadFinder: NSObject, ThreadFinder {
         }
     }
 
+    // Ties are broken by row id so that ThreadMapping can reproduce
+    // this order when it updates incrementally.
     @objc
     public func visibleThreadIds(isArchived: Bool, transaction: GRDBReadTransaction) throws -> [String] {
         let sql = """
@@ -121,7 +123,7 @@ public class GRDBThreadFinder: NSObject, ThreadFinder {
         FROM \(ThreadRecord.databaseTableName)
         WHERE \(threadColumn: .shouldThreadBeVisible) = 1
         AND \(threadColumn: .isArchived) = ?
-        ORDER BY \(threadColumn: .lastInteractionRowId) DESC
+        ORDER BY \(threadColumn: .lastInteractionRowId) DESC, \(threadColumn: .id) DESC
         """
         let arguments: StatementArguments = [isArchived]
         return try String.fetchAll(transaction.database,
@@ -134,7 +136,7 @@ public class GRDBThreadFinder: NSObject, ThreadFinder {
         SELECT sortIndex
         FROM (
             SELECT
-                (ROW_NUMBER() OVER (ORDER BY \(threadColumn: .lastInteractionRowId) DESC) - 1) as sortIndex,
+                (ROW_NUMBER() OVER (ORDER BY \(threadColumn: .lastInteractionRowId) DESC, \(threadColumn: .id) DESC) - 1) as sortIndex,
                 \(threadColumn: .id)
             FROM \(ThreadRecord.databaseTableName)
             WHERE \(threadColumn: .shouldThreadBeVisible) = 1
@@ -146,7 +148,7 @@ public class GRDBThreadFinder: NSObject, ThreadFinder {
         }
 
         let arguments: StatementArguments = [grdbId.intValue]
-        return try UInt.fetchOne(transaction.database, sql: sql, arguments: arguments)
+        return try UInt.fetchOne(transaction.cachedSelectStatement(sql: sql), arguments: arguments)
     }
 
     @objc
@@ -296,6 +298,6 @@ public class GRDBThreadFinder: NSObject, ThreadFinder {
         )
         """
         let arguments: StatementArguments = [SDSRecordType.groupThread.rawValue]
-        return try! Bool.fetchOne(transaction.database, sql: sql, arguments: arguments) ?? false
+        return try! Bool.fetchOne(transaction.cachedSelectStatement(sql: sql), arguments: arguments) ?? false
     }
 }
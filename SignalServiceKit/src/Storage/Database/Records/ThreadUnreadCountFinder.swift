@@ -0,0 +1,199 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import GRDB
+
+// Unread interaction counts are materialized per thread in the
+// thread_unread_count table so that the badge count, the conversation
+// list and notifications don't need to scan the interactions table.
+//
+// The counts are maintained by triggers on model_TSInteraction (see
+// GRDBSchemaMigrator), so they're updated within the same write
+// transactions which insert, mark as read or remove interactions.
+// Those triggers bake in sqlClauseForUnreadInteractionCounts; if that
+// clause changes, the triggers must be recreated by a migration.
+@objc
+public class ThreadUnreadCountFinder: NSObject {
+
+    static let tableName = "thread_unread_count"
+
+    // MARK: - Materialized Counts
+
+    public static func unreadCount(threadUniqueId: String, transaction: GRDBReadTransaction) -> UInt {
+        do {
+            let sql = """
+                SELECT unreadCount
+                FROM \(tableName)
+                WHERE threadUniqueId = ?
+            """
+            return try UInt.fetchOne(transaction.cachedSelectStatement(sql: sql),
+                                     arguments: [threadUniqueId]) ?? 0
+        } catch {
+            owsFailDebug("error: \(error)")
+            return 0
+        }
+    }
+
+    // Threads without unread interactions are omitted.
+    public static func unreadCounts(threadUniqueIds: [String], transaction: GRDBReadTransaction) -> [String: UInt] {
+        var result = [String: UInt]()
+        for chunk in threadUniqueIds.chunked(by: GRDBWriteTransaction.maxVariablesPerStatement) {
+            let placeholders = Array(repeating: "?", count: chunk.count).joined(separator: ", ")
+            let sql = """
+                SELECT threadUniqueId, unreadCount
+                FROM \(tableName)
+                WHERE threadUniqueId IN (\(placeholders))
+                AND unreadCount != 0
+            """
+            result.merge(fetchCounts(sql: sql, arguments: StatementArguments(chunk), transaction: transaction)) { $1 }
+        }
+        return result
+    }
+
+    public static func unreadCountInAllThreads(includeMutedThreads: Bool, transaction: GRDBReadTransaction) -> UInt {
+        do {
+            let sql: String
+            if includeMutedThreads {
+                sql = """
+                    SELECT COALESCE(SUM(unreadCount), 0)
+                    FROM \(tableName)
+                """
+            } else {
+                sql = """
+                    SELECT COALESCE(SUM(counts.unreadCount), 0)
+                    FROM \(tableName) AS counts
+                    INNER JOIN \(ThreadRecord.databaseTableName) AS thread
+                    ON counts.threadUniqueId = thread.\(threadColumn: .uniqueId)
+                    AND (
+                        thread.\(threadColumn: .mutedUntilTimestamp) <= strftime('%s','now') * 1000
+                        OR thread.\(threadColumn: .mutedUntilTimestamp) = 0
+                    )
+                    WHERE counts.unreadCount > 0
+                """
+            }
+            return try UInt.fetchOne(transaction.cachedSelectStatement(sql: sql)) ?? 0
+        } catch {
+            owsFailDebug("error: \(error)")
+            return 0
+        }
+    }
+
+    // MARK: - Scanned Counts
+
+    // These count the unread interactions directly. They're used to
+    // verify the materialized counts.
+
+    static func scanUnreadCount(threadUniqueId: String, transaction: GRDBReadTransaction) -> UInt {
+        do {
+            let sql = """
+                SELECT COUNT(*)
+                FROM \(InteractionRecord.databaseTableName)
+                WHERE \(interactionColumn: .threadUniqueId) = ?
+                AND \(InteractionFinder.sqlClauseForUnreadInteractionCounts())
+            """
+            return try UInt.fetchOne(transaction.database, sql: sql, arguments: [threadUniqueId]) ?? 0
+        } catch {
+            owsFailDebug("error: \(error)")
+            return 0
+        }
+    }
+
+    static func scanUnreadCountInAllThreads(includeMutedThreads: Bool, transaction: GRDBReadTransaction) -> UInt {
+        do {
+            var sql = """
+                SELECT COUNT(interaction.\(interactionColumn: .id))
+                FROM \(InteractionRecord.databaseTableName) AS interaction
+            """
+            if !includeMutedThreads {
+                sql += """
+                    INNER JOIN \(ThreadRecord.databaseTableName) AS thread
+                    ON \(interactionColumn: .threadUniqueId) = thread.\(threadColumn: .uniqueId)
+                    AND (
+                        thread.\(threadColumn: .mutedUntilTimestamp) <= strftime('%s','now') * 1000
+                        OR thread.\(threadColumn: .mutedUntilTimestamp) = 0
+                    )
+                """
+            }
+            sql += " WHERE \(InteractionFinder.sqlClauseForUnreadInteractionCounts(interactionsAlias: "interaction")) "
+            return try UInt.fetchOne(transaction.database, sql: sql) ?? 0
+        } catch {
+            owsFailDebug("error: \(error)")
+            return 0
+        }
+    }
+
+    static func scanUnreadCounts(transaction: GRDBReadTransaction) -> [String: UInt] {
+        fetchCounts(sql: scanUnreadCountsQuery, transaction: transaction)
+    }
+
+    private static var scanUnreadCountsQuery: String {
+        """
+        SELECT \(interactionColumn: .threadUniqueId), COUNT(*)
+        FROM \(InteractionRecord.databaseTableName)
+        WHERE \(InteractionFinder.sqlClauseForUnreadInteractionCounts())
+        GROUP BY \(interactionColumn: .threadUniqueId)
+        """
+    }
+
+    static func materializedUnreadCounts(transaction: GRDBReadTransaction) -> [String: UInt] {
+        let sql = """
+            SELECT threadUniqueId, unreadCount
+            FROM \(tableName)
+            WHERE unreadCount != 0
+        """
+        return fetchCounts(sql: sql, transaction: transaction)
+    }
+
+    private static func fetchCounts(sql: String,
+                                    arguments: StatementArguments = StatementArguments(),
+                                    transaction: GRDBReadTransaction) -> [String: UInt] {
+        do {
+            var result = [String: UInt]()
+            let cursor = try Row.fetchCursor(transaction.database, sql: sql, arguments: arguments)
+            while let row = try cursor.next() {
+                let threadUniqueId: String = row[0]
+                let count: Int64 = row[1]
+                // Negative counts are inconsistent, and will
+                // never match the scanned counts.
+                result[threadUniqueId] = UInt(max(0, count))
+            }
+            return result
+        } catch {
+            owsFailDebug("error: \(error)")
+            return [:]
+        }
+    }
+
+    // MARK: - Consistency
+
+    // Returns true if the materialized counts match the interactions
+    // table. Otherwise, the counts are rebuilt.
+    @objc
+    @discardableResult
+    public static func verifyAndRepairIfNecessary(transaction: SDSAnyWriteTransaction) -> Bool {
+        let grdbTransaction = transaction.unwrapGrdbWrite
+        let scannedCounts = scanUnreadCounts(transaction: grdbTransaction)
+        let materializedCounts = materializedUnreadCounts(transaction: grdbTransaction)
+        guard scannedCounts != materializedCounts else {
+            Logger.info("Unread counts are consistent.")
+            return true
+        }
+
+        let threadUniqueIds = Set(scannedCounts.keys).union(materializedCounts.keys)
+        let inconsistentCount = threadUniqueIds.filter { scannedCounts[$0] != materializedCounts[$0] }.count
+        Logger.error("Unread counts are inconsistent for \(inconsistentCount) threads.")
+
+        rebuild(transaction: grdbTransaction)
+        return false
+    }
+
+    static func rebuild(transaction: GRDBWriteTransaction) {
+        transaction.executeUpdate(sql: "DELETE FROM \(tableName)")
+        transaction.executeUpdate(sql: """
+            INSERT INTO \(tableName) (threadUniqueId, unreadCount)
+            \(scanUnreadCountsQuery)
+        """)
+    }
+}
@@ -0,0 +1,127 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import GRDB
+
+// Lazily rewrites hot interaction blob columns from NSKeyedArchiver
+// format into SDSCompactCoding format.
+//
+// Readers accept either format, so this is purely a performance
+// migration: rows are rewritten in small batches, each in its own
+// write transaction, and progress is checkpointed so the work can
+// resume across launches. Rows that are re-saved in the meantime
+// are written in the compact format anyway.
+@objc
+public class SDSCompactBlobMigrator: NSObject {
+
+    private static let keyValueStore = SDSKeyValueStore(collection: "SDSCompactBlobMigrator")
+    private static let isMigrationNeededKey = "isMigrationNeeded"
+    private static let lastMigratedRowIdKey = "lastMigratedRowId"
+
+    private static let batchSize = 500
+
+    static let migratedColumns: [InteractionRecord.CodingKeys] = [.attachmentIds, .recipientAddress]
+
+    private static let serialQueue = DispatchQueue(label: "SDSCompactBlobMigrator", qos: .utility)
+
+    // Called by GRDBSchemaMigrator for existing users. New users
+    // never have keyed-archive rows, so they skip this work entirely.
+    public static func markMigrationNeeded(transaction: SDSAnyWriteTransaction) {
+        keyValueStore.setBool(true, key: isMigrationNeededKey, transaction: transaction)
+        keyValueStore.removeValue(forKey: lastMigratedRowIdKey, transaction: transaction)
+    }
+
+    @objc
+    public static func runIfNecessary() {
+        guard CurrentAppContext().isMainApp else {
+            return
+        }
+        AppReadiness.runNowOrWhenAppDidBecomeReadyAsync {
+            serialQueue.async {
+                migrateNextBatch()
+            }
+        }
+    }
+
+    private static func migrateNextBatch() {
+        assertOnQueue(serialQueue)
+
+        guard CurrentAppContext().isMainAppAndActive else {
+            // We'll resume on the next launch.
+            return
+        }
+
+        let isComplete: Bool = databaseStorage.write { transaction in
+            guard keyValueStore.getBool(isMigrationNeededKey, defaultValue: false, transaction: transaction) else {
+                return true
+            }
+            let lastRowId = Int64(keyValueStore.getUInt64(lastMigratedRowIdKey, defaultValue: 0, transaction: transaction))
+            let (migratedRowCount, maxRowId) = migrateBatch(afterRowId: lastRowId,
+                                                           transaction: transaction.unwrapGrdbWrite)
+            guard migratedRowCount == batchSize, let nextRowId = maxRowId else {
+                Logger.info("Complete.")
+                keyValueStore.removeValue(forKey: lastMigratedRowIdKey, transaction: transaction)
+                keyValueStore.setBool(false, key: isMigrationNeededKey, transaction: transaction)
+                return true
+            }
+            keyValueStore.setUInt64(UInt64(nextRowId), key: lastMigratedRowIdKey, transaction: transaction)
+            return false
+        }
+
+        if !isComplete {
+            // Yield to other writers between batches.
+            serialQueue.asyncAfter(deadline: .now() + 0.1) {
+                migrateNextBatch()
+            }
+        }
+    }
+
+    // Returns the number of rows visited and the largest row id visited.
+    static func migrateBatch(afterRowId lastRowId: Int64,
+                             transaction: GRDBWriteTransaction) -> (Int, Int64?) {
+        let columnNames = migratedColumns.map { $0.rawValue }
+        let sql = """
+            SELECT \(interactionColumn: .id), \(columnNames.joined(separator: ", "))
+            FROM \(InteractionRecord.databaseTableName)
+            WHERE \(interactionColumn: .id) > ?
+            ORDER BY \(interactionColumn: .id)
+            LIMIT \(batchSize)
+        """
+        let rows = transaction.database.strictRead { database in
+            try Row.fetchAll(database, sql: sql, arguments: [lastRowId])
+        }
+
+        var maxRowId: Int64?
+        for row in rows {
+            let rowId: Int64 = row[0]
+            maxRowId = rowId
+            for (index, columnName) in columnNames.enumerated() {
+                let encoded: Data? = row[index + 1]
+                guard let legacyData = encoded,
+                      !SDSCompactCoding.isCompact(legacyData),
+                      let compactData = compactEncoding(ofLegacyData: legacyData) else {
+                    continue
+                }
+                transaction.executeWithCachedStatement(
+                    sql: "UPDATE \(InteractionRecord.databaseTableName) SET \(columnName) = ? WHERE \(interactionColumn: .id) = ?",
+                    arguments: [compactData, rowId]
+                )
+            }
+        }
+        return (rows.count, maxRowId)
+    }
+
+    static func compactEncoding(ofLegacyData legacyData: Data) -> Data? {
+        do {
+            guard let value = try NSKeyedUnarchiver.unarchiveTopLevelObjectWithData(legacyData) else {
+                return nil
+            }
+            return SDSCompactCoding.encode(value)
+        } catch {
+            owsFailDebug("Could not decode legacy value: \(error)")
+            return nil
+        }
+    }
+}
@@ -0,0 +1,244 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+// A compact, versioned binary encoding for the handful of blob column
+// types that are decoded for nearly every row we load (e.g. the
+// attachmentIds and recipientAddress columns of model_TSInteraction).
+//
+// Decoding these with NSKeyedUnarchiver dominates the cost of
+// enumerating interactions; this format can be decoded without any
+// intermediate object graph.
+//
+// Layout:
+//
+//   [0x00, 'S', 'C'] magic; keyed archives (binary plists) never begin with 0x00.
+//   [version]        currently 1.
+//   [kind]           see Kind.
+//   [payload...]
+//
+// All lengths are unsigned LEB128 varints and all strings are UTF-8.
+//
+// Only the columns listed in compact_blob_columns (sds-config.json) use
+// this format; the generated serializers call optionalCompactArchive()
+// and unarchiveCompact() for them. Those columns may contain either
+// format; readers detect compact values by their magic and fall back to
+// NSKeyedUnarchiver otherwise.
+public enum SDSCompactCoding {
+
+    private static let magic: [UInt8] = [0x00, 0x53, 0x43]
+    static let currentVersion: UInt8 = 1
+    private static let headerLength = magic.count + 2
+
+    private enum Kind: UInt8 {
+        // varint count, then (varint length, bytes) per string.
+        case stringArray = 1
+        // flags (1 = uuid, 2 = phone number), then 16 uuid bytes
+        // and/or (varint length, bytes) of the phone number.
+        case serviceAddress = 2
+    }
+
+    private struct AddressFlags: OptionSet {
+        let rawValue: UInt8
+
+        static let hasUuid = AddressFlags(rawValue: 1 << 0)
+        static let hasPhoneNumber = AddressFlags(rawValue: 1 << 1)
+    }
+
+    // MARK: - Detection
+
+    public static func isCompact(_ data: Data) -> Bool {
+        guard data.count >= headerLength else {
+            return false
+        }
+        return data.starts(with: magic)
+    }
+
+    // MARK: - Encoding
+
+    // Returns nil if value isn't of a type with a compact representation,
+    // in which case the caller should use NSKeyedArchiver.
+    public static func encode(_ value: Any) -> Data? {
+        if let strings = value as? [String] {
+            return encode(strings: strings)
+        } else if let address = value as? SignalServiceAddress {
+            return encode(address: address)
+        } else {
+            return nil
+        }
+    }
+
+    private static func header(kind: Kind) -> Data {
+        var data = Data(magic)
+        data.append(currentVersion)
+        data.append(kind.rawValue)
+        return data
+    }
+
+    public static func encode(strings: [String]) -> Data {
+        var data = header(kind: .stringArray)
+        appendVarint(UInt64(strings.count), to: &data)
+        for string in strings {
+            appendString(string, to: &data)
+        }
+        return data
+    }
+
+    public static func encode(address: SignalServiceAddress) -> Data {
+        var data = header(kind: .serviceAddress)
+
+        // Match the keyed-archive behavior of SignalServiceAddress:
+        // only persist the phone number if we don't know the uuid.
+        let uuid = address.uuid
+        let phoneNumber = uuid == nil ? address.phoneNumber : nil
+
+        var flags: AddressFlags = []
+        if uuid != nil {
+            flags.insert(.hasUuid)
+        }
+        if phoneNumber != nil {
+            flags.insert(.hasPhoneNumber)
+        }
+        data.append(flags.rawValue)
+
+        if let uuid = uuid {
+            withUnsafeBytes(of: uuid.uuid) { data.append(contentsOf: $0) }
+        }
+        if let phoneNumber = phoneNumber {
+            appendString(phoneNumber, to: &data)
+        }
+        return data
+    }
+
+    private static func appendVarint(_ value: UInt64, to data: inout Data) {
+        var value = value
+        while value >= 0x80 {
+            data.append(UInt8(truncatingIfNeeded: value) | 0x80)
+            value >>= 7
+        }
+        data.append(UInt8(value))
+    }
+
+    private static func appendString(_ string: String, to data: inout Data) {
+        let utf8 = string.utf8
+        appendVarint(UInt64(utf8.count), to: &data)
+        data.append(contentsOf: utf8)
+    }
+
+    // MARK: - Decoding
+
+    public static func decode(_ data: Data) throws -> Any {
+        var reader = Reader(data: data)
+        for byte in magic {
+            guard try reader.readByte() == byte else {
+                throw SDSError.invalidValue
+            }
+        }
+        guard try reader.readByte() == currentVersion else {
+            owsFailDebug("Unknown compact encoding version.")
+            throw SDSError.invalidValue
+        }
+        guard let kind = Kind(rawValue: try reader.readByte()) else {
+            owsFailDebug("Unknown compact encoding kind.")
+            throw SDSError.invalidValue
+        }
+
+        let result: Any
+        switch kind {
+        case .stringArray:
+            let count = try reader.readVarint()
+            // Each string occupies at least one byte.
+            guard count <= UInt64(reader.remainingCount) else {
+                throw SDSError.invalidValue
+            }
+            var strings = [String]()
+            strings.reserveCapacity(Int(count))
+            for _ in 0..<count {
+                strings.append(try reader.readString())
+            }
+            result = strings
+        case .serviceAddress:
+            let flags = AddressFlags(rawValue: try reader.readByte())
+            var uuid: UUID?
+            if flags.contains(.hasUuid) {
+                let bytes = try reader.readBytes(count: 16)
+                uuid = bytes.withUnsafeBytes { UUID(uuid: $0.load(as: uuid_t.self)) }
+            }
+            var phoneNumber: String?
+            if flags.contains(.hasPhoneNumber) {
+                phoneNumber = try reader.readString()
+            }
+            guard uuid != nil || phoneNumber != nil else {
+                throw SDSError.invalidValue
+            }
+            result = SignalServiceAddress(uuid: uuid, phoneNumber: phoneNumber)
+        }
+
+        guard reader.remainingCount == 0 else {
+            throw SDSError.invalidValue
+        }
+        return result
+    }
+
+    private struct Reader {
+        let data: Data
+        private var offset: Int
+
+        init(data: Data) {
+            self.data = data
+            self.offset = data.startIndex
+        }
+
+        var remainingCount: Int {
+            data.endIndex - offset
+        }
+
+        mutating func readByte() throws -> UInt8 {
+            guard offset < data.endIndex else {
+                throw SDSError.invalidValue
+            }
+            let byte = data[offset]
+            offset += 1
+            return byte
+        }
+
+        mutating func readBytes(count: Int) throws -> Data {
+            guard count >= 0, count <= remainingCount else {
+                throw SDSError.invalidValue
+            }
+            let bytes = data[offset..<(offset + count)]
+            offset += count
+            return Data(bytes)
+        }
+
+        mutating func readVarint() throws -> UInt64 {
+            var result: UInt64 = 0
+            var shift: UInt64 = 0
+            while true {
+                guard shift < 64 else {
+                    throw SDSError.invalidValue
+                }
+                let byte = try readByte()
+                result |= UInt64(byte & 0x7f) << shift
+                if byte & 0x80 == 0 {
+                    return result
+                }
+                shift += 7
+            }
+        }
+
+        mutating func readString() throws -> String {
+            let length = try readVarint()
+            guard length <= UInt64(remainingCount) else {
+                throw SDSError.invalidValue
+            }
+            let bytes = try readBytes(count: Int(length))
+            guard let string = String(data: bytes, encoding: .utf8) else {
+                throw SDSError.invalidValue
+            }
+            return string
+        }
+    }
+}
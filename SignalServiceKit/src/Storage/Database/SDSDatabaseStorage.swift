@@ -44,6 +44,10 @@ public class SDSDatabaseStorage: SDSTransactable {
 
         super.init()
 
+        // The key-value store caches outlive any one database storage,
+        // e.g. in tests.
+        SDSKeyValueCollectionCache.evacuateAll()
+
         addObservers()
     }
 
@@ -264,6 +268,21 @@ public class SDSDatabaseStorage: SDSTransactable {
         }
     }
 
+    // The rows inserted by block are reported to the UI database
+    // observer once, rather than row-by-row. block should return
+    // the ids of the rows it inserted.
+    func observeBatchInsert(tableName: String, transaction: GRDBWriteTransaction, block: () -> [Int64]) {
+        guard let uiDatabaseObserver = grdbStorage.uiDatabaseObserver else {
+            _ = block()
+            return
+        }
+        uiDatabaseObserver.beginBatchInsert(tableName: tableName)
+        let rowIds = block()
+        UIDatabaseObserver.serializedSync {
+            uiDatabaseObserver.endBatchInsert(tableName: tableName, rowIds: rowIds)
+        }
+    }
+
     // MARK: - Touch
 
     @objc(touchInteraction:shouldReindex:transaction:)
@@ -316,6 +335,9 @@ public class SDSDatabaseStorage: SDSTransactable {
 
         Logger.info("")
 
+        // Every process caches key-value stores.
+        SDSKeyValueCollectionCache.evacuateAll()
+
         guard CurrentAppContext().isMainApp else {
             return
         }
@@ -343,20 +365,62 @@ public class SDSDatabaseStorage: SDSTransactable {
     @objc
     public static let didReceiveCrossProcessNotification = Notification.Name("didReceiveCrossProcessNotification")
 
+    static let crossProcessDatabaseChangesKey = "crossProcessDatabaseChangesKey"
+
+    // Returns the changes made by other processes, if they are known.
+    // Otherwise, observers of didReceiveCrossProcessNotification should
+    // assume that anything might have changed.
+    static func crossProcessDatabaseChanges(notification: Notification) -> UIDatabaseChanges? {
+        notification.userInfo?[crossProcessDatabaseChangesKey] as? UIDatabaseChanges
+    }
+
     private func postCrossProcessNotification() {
         Logger.info("")
 
-        // TODO: The observers of this notification will inevitably do
-        //       expensive work.  It'd be nice to only fire this event
-        //       if this had any effect, if the state of the database
-        //       has changed.
+        // Most (all?) cross process write notifications will be delivered
+        // to the main app while it is inactive. By de-bouncing notifications
+        // while inactive and only updating once when we become active, we
+        // skip most of the perf cost.
         //
-        //       In the meantime, most (all?) cross process write notifications
-        //       will be delivered to the main app while it is inactive. By
-        //       de-bouncing notifications while inactive and only updating
-        //       once when we become active, we should be able to effectively
-        //       skip most of the perf cost.
-        NotificationCenter.default.postNotificationNameAsync(SDSDatabaseStorage.didReceiveCrossProcessNotification, object: nil)
+        // The journal lets observers evict and update only what the other
+        // processes changed; see CrossProcessChangeJournal.
+        let crossProcessChangeJournal = grdbStorage.crossProcessChangeJournal
+        let replayResult: CrossProcessChangeJournal.ReplayResult = read { transaction in
+            crossProcessChangeJournal.replayUnseenChanges(transaction: transaction.unwrapGrdbRead)
+        }
+
+        var userInfo = [AnyHashable: Any]()
+        switch replayResult {
+        case .noChanges:
+            // We've already replayed these changes.
+            return
+        case .changes(let changes):
+            userInfo[Self.crossProcessDatabaseChangesKey] = CrossProcessDatabaseChanges(changes: changes)
+        case .unknownChanges:
+            break
+        }
+        NotificationCenter.default.postNotificationNameAsync(SDSDatabaseStorage.didReceiveCrossProcessNotification,
+                                                             object: nil,
+                                                             userInfo: userInfo)
+    }
+
+    // App extensions describe their writes in the cross-process change
+    // journal, so that the main app can replay them.
+    private func journalCrossProcessChanges(transaction: GRDBWriteTransaction) {
+        guard CrossProcessChangeJournal.shouldJournalWrites else {
+            return
+        }
+        guard let uiDatabaseObserver = grdbStorage.uiDatabaseObserver else {
+            return
+        }
+        var changes = CrossProcessChangeJournal.Changes()
+        UIDatabaseObserver.serializedSync {
+            changes = uiDatabaseObserver.pendingCrossProcessChanges(transaction: transaction)
+        }
+        guard !changes.isEmpty else {
+            return
+        }
+        CrossProcessChangeJournal.append(changes: changes, transaction: transaction)
     }
 
     // MARK: - SDSTransactable
@@ -397,11 +461,15 @@ public class SDSDatabaseStorage: SDSTransactable {
 
         let benchTitle = "Slow Write Transaction \(Self.owsFormatLogMessage(file: file, function: function, line: line))"
         do {
-            try grdbStorage.write { transaction in
+            try grdbStorage.write(block: { transaction in
                 Bench(title: benchTitle, logIfLongerThan: 0.1, logInProduction: DebugFlags.internalLogging) {
                     block(transaction.asAnyWrite)
                 }
-            }
+            }, didFinalize: { transaction in
+                // Finalization blocks write too (e.g. touching threads and
+                // deferred indexing), so we journal after they've run.
+                self.journalCrossProcessChanges(transaction: transaction)
+            })
         } catch {
             owsFail("error: \(error.grdbErrorForLogging)")
         }
@@ -78,4 +78,36 @@ public class SDSDeserialization {
             throw SDSError.invalidValue
         }
     }
+
+    // MARK: - Compact Blob
+
+    // Compact blob columns hold either format until SDSCompactBlobMigrator
+    // has rewritten every row.
+    public class func optionalUnarchiveCompact<T>(_ encoded: Data?, name: String) throws -> T? {
+        guard let encoded = encoded else {
+            return nil
+        }
+        return try unarchiveCompact(encoded, name: name)
+    }
+
+    public class func unarchiveCompact<T>(_ encoded: Data?, name: String) throws -> T {
+        guard let encoded = encoded else {
+            owsFailDebug("Missing required field: \(name).")
+            throw SDSError.missingRequiredField
+        }
+        guard SDSCompactCoding.isCompact(encoded) else {
+            return try unarchive(encoded, name: name)
+        }
+
+        do {
+            guard let decoded = try SDSCompactCoding.decode(encoded) as? T else {
+                owsFailDebug("Invalid value: \(name).")
+                throw SDSError.invalidValue
+            }
+            return decoded
+        } catch {
+            owsFailDebug("Read failed[\(name)]: \(error).")
+            throw SDSError.invalidValue
+        }
+    }
 }
@@ -47,6 +47,12 @@ public class SDSKeyValueStore: NSObject {
         super.init()
     }
 
+    // Hot collections have an in-memory, write-through cache
+    // of their values. See SDSKeyValueCollectionCache.
+    private var cache: SDSKeyValueCollectionCache? {
+        SDSKeyValueCollectionCache.cache(forCollection: collection)
+    }
+
     public class func createTable(database: Database) throws {
         let sql = """
             CREATE TABLE \(table.tableName) (
@@ -72,6 +78,10 @@ public class SDSKeyValueStore: NSObject {
 
     @objc
     public func hasValue(forKey key: String, transaction: SDSAnyReadTransaction) -> Bool {
+        if cache != nil {
+            return readData(key, transaction: transaction) != nil
+        }
+
         switch transaction.readTransaction {
         case .grdbRead(let grdbTransaction):
             do {
@@ -326,6 +336,11 @@ public class SDSKeyValueStore: NSObject {
             """
             grdbWrite.executeWithCachedStatement(sql: sql, arguments: [collection])
         }
+
+        cache?.didRemoveAll(transaction: transaction)
+        if SDSKeyValueStoreStatistics.isEnabled {
+            SDSKeyValueStoreStatistics.shared.recordWrite(collection: collection)
+        }
     }
 
     @objc
@@ -531,10 +546,18 @@ public class SDSKeyValueStore: NSObject {
         // GRDB values are serialized to data by this class.
         switch transaction.readTransaction {
         case .grdbRead:
-            guard let encoded = readData(key, transaction: transaction) else {
+            let entry = readEntry(key, transaction: transaction)
+            if let object = entry.object {
+                return object
+            }
+            guard let encoded = entry.data else {
                 return nil
             }
-            return parseArchivedValue(encoded)
+            let rawObject = parseArchivedValue(encoded)
+            if let rawObject = rawObject, let cache = cache {
+                cache.didUnarchive(object: rawObject, data: encoded, forKey: key, transaction: transaction)
+            }
+            return rawObject
         }
     }
 
@@ -563,12 +586,31 @@ public class SDSKeyValueStore: NSObject {
     }
 
     private func readData(_ key: String, transaction: SDSAnyReadTransaction) -> Data? {
+        return readEntry(key, transaction: transaction).data
+    }
+
+    private func readEntry(_ key: String, transaction: SDSAnyReadTransaction) -> SDSKeyValueCollectionCache.Entry {
         let collection = self.collection
 
-        switch transaction.readTransaction {
-        case .grdbRead(let grdbTransaction):
-            return SDSKeyValueStore.readData(transaction: grdbTransaction, key: key, collection: collection)
+        let readEntry = { () -> SDSKeyValueCollectionCache.Entry in
+            switch transaction.readTransaction {
+            case .grdbRead(let grdbTransaction):
+                let data = SDSKeyValueStore.readData(transaction: grdbTransaction, key: key, collection: collection)
+                return SDSKeyValueCollectionCache.Entry(data: data)
+            }
+        }
+
+        let entry: SDSKeyValueCollectionCache.Entry
+        let isCacheHit: Bool
+        if let cache = cache {
+            (entry, isCacheHit) = cache.entry(forKey: key, transaction: transaction, readEntry: readEntry)
+        } else {
+            (entry, isCacheHit) = (readEntry(), false)
         }
+        if SDSKeyValueStoreStatistics.isEnabled {
+            SDSKeyValueStoreStatistics.shared.recordRead(collection: collection, isCacheHit: isCacheHit)
+        }
+        return entry
     }
 
     private class func readData(transaction: GRDBReadTransaction, key: String, collection: String) -> Data? {
@@ -589,14 +631,15 @@ public class SDSKeyValueStore: NSObject {
         case .grdbWrite:
             if let value = value {
                 let encoded = NSKeyedArchiver.archivedData(withRootObject: value)
-                writeData(encoded, forKey: key, transaction: transaction)
+                writeData(encoded, forKey: key, transaction: transaction, object: value)
             } else {
                 writeData(nil, forKey: key, transaction: transaction)
             }
         }
     }
 
-    private func writeData(_ data: Data?, forKey key: String, transaction: SDSAnyWriteTransaction) {
+    // object is the unarchived value of data, if any.
+    private func writeData(_ data: Data?, forKey key: String, transaction: SDSAnyWriteTransaction, object: Any? = nil) {
 
         let collection = self.collection
 
@@ -606,8 +649,23 @@ public class SDSKeyValueStore: NSObject {
                 try SDSKeyValueStore.write(transaction: grdbTransaction, key: key, collection: collection, encoded: data)
             } catch {
                 owsFailDebug("error: \(error)")
+                // We don't know what was written, so stop
+                // using the cache for open transactions.
+                cache?.evacuate()
+                return
             }
         }
+
+        if SDSKeyValueStoreStatistics.isEnabled {
+            SDSKeyValueStoreStatistics.shared.recordWrite(collection: collection)
+        }
+
+        if let cache = cache {
+            let cachedObject = object.flatMap { SDSKeyValueCollectionCache.cacheableObject($0) }
+            cache.didWrite(entry: SDSKeyValueCollectionCache.Entry(data: data, object: cachedObject),
+                           forKey: key,
+                           transaction: transaction)
+        }
     }
 
     private class func write(transaction: GRDBWriteTransaction, key: String, collection: String, encoded: Data?) throws {
@@ -0,0 +1,313 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+// An in-memory, write-through cache of the values in a key-value store
+// collection. Only hot collections are cached (see cachedCollections);
+// the cache is shared by every store for the collection.
+//
+// Like the .read model caches (see ModelReadCache), the cache stays
+// consistent with the database by "excluding" keys while they are
+// being written:
+//
+// * A write updates the cached value and excludes the key until the
+//   write transaction has committed.
+// * While a key is excluded, reads ignore the cache (and don't populate
+//   it), so that they reflect the state of their own transaction.
+// * Once the write transaction has committed, reads from transactions
+//   which started before the commit still ignore the cache.
+//
+// If a write transaction is rolled back, its exclusions are never
+// lifted, so the values it wrote are never read from the cache.
+//
+// Writes by other processes can't be observed, so the caches are
+// cleared whenever we learn of a cross-process write.
+class SDSKeyValueCollectionCache {
+
+    struct Entry {
+        // nil if there is no value for the key.
+        let data: Data?
+        // The unarchived value, if it is immutable and has been
+        // unarchived. This lets us skip NSKeyedUnarchiver on reads.
+        let object: Any?
+
+        init(data: Data?, object: Any? = nil) {
+            self.data = data
+            self.object = object
+        }
+    }
+
+    // These collections are read on hot paths, e.g. when sending or
+    // receiving each message.
+    //
+    // Caches are created up front, rather than when the first store
+    // for a collection is created, since a cache couldn't account
+    // for writes which were already in flight.
+    private static var cachedCollections: Set<String> {
+        var collections: Set<String> = [
+            "SSKPreferences",
+            "kUDCollection",
+            "kUnidentifiedAccessCollection",
+            "kUnidentifiedAccessUUIDCollection"
+        ]
+        #if TESTABLE_BUILD
+        collections.insert(testCollection)
+        #endif
+        return collections
+    }
+
+    #if TESTABLE_BUILD
+    static let testCollection = "SDSKeyValueCollectionCacheTest"
+    #endif
+
+    private static let maxEntryCount = 1024
+
+    let collection: String
+
+    private let unfairLock = UnfairLock()
+    // These properties should only be accessed with unfairLock.
+    private let entries = LRUCache<String, Entry>(maxSize: SDSKeyValueCollectionCache.maxEntryCount)
+    private var exclusionCountMap = [String: Int]()
+    private var exclusionDateMap = [String: Date]()
+    // Applies to every key, e.g. after removeAll() or a cross-process write.
+    private var collectionExclusionCount = 0
+    private var collectionExclusionDate: Date?
+
+    private init(collection: String) {
+        self.collection = collection
+    }
+
+    // MARK: - Registry
+
+    // This is immutable, so it doesn't need a lock.
+    private static let registry: [String: SDSKeyValueCollectionCache] = {
+        var registry = [String: SDSKeyValueCollectionCache]()
+        for collection in cachedCollections {
+            registry[collection] = SDSKeyValueCollectionCache(collection: collection)
+        }
+        return registry
+    }()
+
+    static func cache(forCollection collection: String) -> SDSKeyValueCollectionCache? {
+        registry[collection]
+    }
+
+    // Discards every cached value, e.g. when another process
+    // may have written to any collection.
+    static func evacuateAll() {
+        for cache in registry.values {
+            cache.evacuate()
+        }
+    }
+
+    // MARK: - Reads
+
+    // Returns the cached entry for the key, or reads the entry
+    // using readEntry and (if possible) caches it.
+    func entry(forKey key: String,
+               transaction: SDSAnyReadTransaction,
+               readEntry: () -> Entry) -> (entry: Entry, isCacheHit: Bool) {
+        if let entry = unfairLock.withLock({ cachedEntry(forKey: key, transaction: transaction) }) {
+            return (entry, true)
+        }
+        let entry = readEntry()
+        unfairLock.withLock {
+            if !isExcluded(key: key, transaction: transaction) {
+                entries.set(key: key, value: entry)
+            }
+        }
+        return (entry, false)
+    }
+
+    // Caches the unarchived value for the key, if the
+    // cached value hasn't changed since it was read.
+    func didUnarchive(object: Any, data: Data, forKey key: String, transaction: SDSAnyReadTransaction) {
+        guard let object = Self.cacheableObject(object) else {
+            return
+        }
+        unfairLock.withLock {
+            guard let entry = cachedEntry(forKey: key, transaction: transaction),
+                  entry.object == nil,
+                  entry.data == data else {
+                return
+            }
+            entries.set(key: key, value: Entry(data: data, object: object))
+        }
+    }
+
+    // Only values of these classes are immutable (or can be copied
+    // cheaply), so we don't share other unarchived values.
+    static func cacheableObject(_ object: Any) -> Any? {
+        switch object {
+        case let number as NSNumber:
+            return number
+        case let string as NSString:
+            return string.copy()
+        case let date as NSDate:
+            return date
+        case let data as NSData:
+            return data.copy()
+        default:
+            return nil
+        }
+    }
+
+    // This method should only be called with unfairLock acquired.
+    private func cachedEntry(forKey key: String, transaction: SDSAnyReadTransaction) -> Entry? {
+        guard !isExcluded(key: key, transaction: transaction) else {
+            return nil
+        }
+        return entries.get(key: key)
+    }
+
+    // MARK: - Writes
+
+    func didWrite(entry: Entry, forKey key: String, transaction: SDSAnyWriteTransaction) {
+        unfairLock.withLock {
+            // The cache won't be used for this key until the
+            // exclusion is lifted.
+            entries.set(key: key, value: entry)
+            exclusionCountMap[key, default: 0] += 1
+        }
+        transaction.addSyncCompletion {
+            self.unfairLock.withLock {
+                self.exclusionDateMap[key] = Date()
+                guard let count = self.exclusionCountMap[key] else {
+                    owsFailDebug("Missing exclusion key.")
+                    return
+                }
+                if count > 1 {
+                    self.exclusionCountMap[key] = count - 1
+                } else {
+                    self.exclusionCountMap.removeValue(forKey: key)
+                }
+            }
+        }
+    }
+
+    func didRemoveAll(transaction: SDSAnyWriteTransaction) {
+        unfairLock.withLock {
+            entries.clear()
+            collectionExclusionCount += 1
+        }
+        transaction.addSyncCompletion {
+            self.unfairLock.withLock {
+                self.collectionExclusionDate = Date()
+                self.collectionExclusionCount -= 1
+            }
+        }
+    }
+
+    // Discards every cached value. Reads from transactions which
+    // are already open won't use the cache, since they may not
+    // reflect whatever invalidated it.
+    func evacuate() {
+        unfairLock.withLock {
+            entries.clear()
+            collectionExclusionDate = Date()
+        }
+    }
+
+    // MARK: - Exclusion
+
+    // This method should only be called with unfairLock acquired.
+    private func isExcluded(key: String, transaction: SDSAnyReadTransaction) -> Bool {
+        if collectionExclusionCount > 0 || exclusionCountMap[key] != nil {
+            return true
+        }
+        if let exclusionDate = collectionExclusionDate, exclusionDate > transaction.startDate {
+            return true
+        }
+        if let exclusionDate = exclusionDateMap[key], exclusionDate > transaction.startDate {
+            return true
+        }
+        return false
+    }
+}
+
+// MARK: -
+
+// Counts key-value store reads and writes per collection, so that
+// we can see which collections are hot (and might be cached).
+@objc
+public class SDSKeyValueStoreStatistics: NSObject {
+
+    @objc
+    public static let shared = SDSKeyValueStoreStatistics()
+
+    @objc
+    public static var isEnabled: Bool = DebugFlags.logSQLStatistics
+
+    struct Entry {
+        var readCount: UInt64 = 0
+        var cacheHitCount: UInt64 = 0
+        var writeCount: UInt64 = 0
+    }
+
+    private let lock = UnfairLock()
+    // This should only be accessed with lock acquired.
+    private var entries = [String: Entry]()
+
+    func recordRead(collection: String, isCacheHit: Bool) {
+        lock.withLock {
+            var entry = entries[collection] ?? Entry()
+            entry.readCount += 1
+            if isCacheHit {
+                entry.cacheHitCount += 1
+            }
+            entries[collection] = entry
+        }
+    }
+
+    func recordWrite(collection: String) {
+        lock.withLock {
+            entries[collection, default: Entry()].writeCount += 1
+        }
+    }
+
+    func entry(forCollection collection: String) -> Entry? {
+        lock.withLock {
+            entries[collection]
+        }
+    }
+
+    @objc
+    public func report() -> String {
+        let entries: [(String, Entry)] = lock.withLock {
+            Array(self.entries)
+        }
+        guard !entries.isEmpty else {
+            return "No key-value store statistics."
+        }
+
+        var lines = [String]()
+        lines.append("Key-value store statistics for \(entries.count) collections, ordered by reads:")
+        for (collection, entry) in entries.sorted(by: { $0.1.readCount > $1.1.readCount }) {
+            let isCached = SDSKeyValueCollectionCache.cache(forCollection: collection) != nil
+            let cacheDescription = isCached ? "\(entry.cacheHitCount)/\(entry.readCount)" : "n/a"
+            lines.append("reads: \(entry.readCount), cache hits: \(cacheDescription), writes: \(entry.writeCount), collection: \(collection)")
+        }
+        return lines.joined(separator: "\n")
+    }
+
+    @objc
+    public func logReport() {
+        guard Self.isEnabled else {
+            Logger.warn("Key-value store statistics are not enabled.")
+            return
+        }
+        for line in report().components(separatedBy: "\n") {
+            Logger.info(line)
+        }
+        Logger.flush()
+    }
+
+    @objc
+    public func reset() {
+        lock.withLock {
+            entries.removeAll()
+        }
+    }
+}
@@ -89,6 +89,125 @@ public extension SDSModel {
     }
 }
 
+// MARK: - Batch Insert
+
+public extension SDSModel {
+
+    // Inserts many new models of the same type at once, e.g. during
+    // contact sync. This is equivalent to calling anyInsert() on each
+    // model, but:
+    //
+    // * Rows are written with multi-row INSERT statements.
+    // * The UI database observer is notified once for the batch.
+    // * anyDidInsertBatch() is called once in place of anyDidInsert(),
+    //   so that models can coalesce (e.g. read cache) updates.
+    // * Models are indexed for FTS as a batch.
+    //
+    // Models which already exist in the database (or which are
+    // duplicated within the batch) fall back to a per-model save.
+    static func anyInsert(batch models: [Self], transaction: SDSAnyWriteTransaction) {
+        let models = models.filter { model in
+            guard model.shouldBeSaved else {
+                Logger.warn("Skipping save of: \(type(of: model))")
+                return false
+            }
+            return true
+        }
+        guard let firstModel = models.first else {
+            return
+        }
+
+        switch transaction.writeTransaction {
+        case .grdbWrite(let grdbTransaction):
+            let tableName = firstModel.sdsTableName
+            owsAssertDebug(models.allSatisfy { $0.sdsTableName == tableName })
+
+            // Partition the batch.
+            let existingUniqueIds = grdbExistingUniqueIds(models.map { $0.uniqueId },
+                                                          tableName: tableName,
+                                                          transaction: grdbTransaction)
+            var batchUniqueIds = Set<String>()
+            var newModels = [Self]()
+            var fallbackModels = [Self]()
+            for model in models {
+                if existingUniqueIds.contains(model.uniqueId) || batchUniqueIds.contains(model.uniqueId) {
+                    fallbackModels.append(model)
+                } else {
+                    batchUniqueIds.insert(model.uniqueId)
+                    newModels.append(model)
+                }
+            }
+            if !fallbackModels.isEmpty {
+                Logger.warn("Could not batch insert \(fallbackModels.count) existing or duplicate models.")
+            }
+
+            if !newModels.isEmpty {
+                grdbInsert(batch: newModels, tableName: tableName, transaction: grdbTransaction)
+            }
+            for model in fallbackModels {
+                model.sdsSave(saveMode: .insert, transaction: transaction)
+            }
+        }
+    }
+
+    private static func grdbInsert(batch models: [Self], tableName: String, transaction: GRDBWriteTransaction) {
+        let anyTransaction = transaction.asAnyWrite
+
+        for model in models {
+            model.anyWillInsert(with: anyTransaction)
+        }
+
+        let records: [SDSRecord]
+        do {
+            records = try models.map { try $0.asRecord() }
+        } catch {
+            owsFail("Write failed: \(error)")
+        }
+
+        // The id column is assigned by the database.
+        let columnNames = table.columns.map { $0.columnName }.filter { $0 != "id" }
+        let rows: [[DatabaseValueConvertible?]] = records.map { record in
+            let databaseDictionary = record.databaseDictionary
+            return columnNames.map { (databaseDictionary[$0] ?? DatabaseValue.null) as DatabaseValueConvertible? }
+        }
+        let sqlPrefix = ("INSERT INTO \(tableName.quotedDatabaseIdentifier) " +
+                            "(\(columnNames.map { $0.quotedDatabaseIdentifier }.joined(separator: ", ")))")
+
+        databaseStorage.observeBatchInsert(tableName: tableName, transaction: transaction) {
+            let rowIds = transaction.executeMultiRowInsert(sqlPrefix: sqlPrefix, rows: rows)
+            owsAssertDebug(rowIds.count == records.count)
+            for (record, rowId) in zip(records, rowIds) {
+                record.didInsert(with: rowId, for: nil)
+            }
+            return rowIds
+        }
+
+        anyDidInsertBatch(models, transaction: anyTransaction)
+
+        if shouldBeIndexedForFTS {
+            FullTextSearchFinder().modelsWereInserted(models: models, transaction: anyTransaction)
+        }
+    }
+
+    private static func grdbExistingUniqueIds(_ uniqueIds: [String],
+                                              tableName: String,
+                                              transaction: GRDBReadTransaction) -> Set<String> {
+        var result = Set<String>()
+        for chunk in uniqueIds.chunked(by: GRDBWriteTransaction.maxVariablesPerStatement) {
+            let placeholders = Array(repeating: "?", count: chunk.count).joined(separator: ", ")
+            let sql = "SELECT uniqueId FROM \(tableName.quotedDatabaseIdentifier) WHERE uniqueId IN (\(placeholders))"
+            do {
+                result.formUnion(try String.fetchAll(transaction.database,
+                                                     sql: sql,
+                                                     arguments: StatementArguments(chunk)))
+            } catch {
+                owsFail("Read failed: \(error)")
+            }
+        }
+        return result
+    }
+}
+
 // MARK: -
 
 public extension TableRecord {
@@ -58,4 +58,22 @@ public extension SDSSerializer {
     func requiredArchive(_ value: Any) -> Data {
         return NSKeyedArchiver.archivedData(withRootObject: value)
     }
+
+    // MARK: - Compact Blob
+
+    // Only used for the columns listed in SDSCompactBlobMigrator.migratedColumns;
+    // see SDSCompactCoding. Values it can't encode are archived as usual.
+    func optionalCompactArchive(_ value: Any?) -> Data? {
+        guard let value = value else {
+            return nil
+        }
+        return requiredCompactArchive(value)
+    }
+
+    func requiredCompactArchive(_ value: Any) -> Data {
+        if let compactData = SDSCompactCoding.encode(value) {
+            return compactData
+        }
+        return requiredArchive(value)
+    }
 }
@@ -260,6 +260,25 @@ public extension StoreContext {
 
 // MARK: - Convenience Methods
 
+public extension GRDBReadTransaction {
+    // Like executeWithCachedStatement(), this avoids re-preparing
+    // statements that we perform repeatedly. Prepared statements are
+    // cached per connection by GRDB, so the first lookup on each
+    // connection in the pool is a miss.
+    //
+    // This should only be used for statements whose SQL is fixed,
+    // i.e. which don't inline values.
+    func cachedSelectStatement(sql: String) throws -> SelectStatement {
+        let statement = try database.cachedSelectStatement(sql: sql)
+        if GRDBQueryStatistics.isEnabled {
+            // A statement which has never been run was just prepared.
+            let isHit = sqlite3_stmt_status(statement.sqliteStatement, SQLITE_STMTSTATUS_RUN, 0) > 0
+            GRDBQueryStatistics.shared.recordStatementCacheLookup(sql: sql, isHit: isHit)
+        }
+        return statement
+    }
+}
+
 public extension GRDBWriteTransaction {
     func executeUpdate(sql: String, arguments: StatementArguments = StatementArguments()) {
         do {
@@ -279,6 +298,47 @@ public extension GRDBWriteTransaction {
         }
     }
 
+    // SQLite's default limit on the number of variables in a statement.
+    static let maxVariablesPerStatement = 999
+
+    // Inserts rows using as few multi-row INSERT statements as the
+    // variable limit allows. sqlPrefix should have the form:
+    //
+    //   INSERT INTO table (column1, column2, ...)
+    //
+    // Returns the row ids of the inserted rows, in order. This relies on
+    // the rows inserted by a single statement being assigned consecutive
+    // row ids, so sqlPrefix shouldn't use a conflict clause which can
+    // skip rows (e.g. INSERT OR IGNORE).
+    @discardableResult
+    func executeMultiRowInsert(sqlPrefix: String, rows: [[DatabaseValueConvertible?]]) -> [Int64] {
+        guard let columnCount = rows.first?.count, columnCount > 0 else {
+            return []
+        }
+        let rowsPerStatement = max(1, Self.maxVariablesPerStatement / columnCount)
+        let rowPlaceholder = "(" + Array(repeating: "?", count: columnCount).joined(separator: ", ") + ")"
+
+        var rowIds = [Int64]()
+        rowIds.reserveCapacity(rows.count)
+        for chunk in rows.chunked(by: rowsPerStatement) {
+            owsAssertDebug(chunk.allSatisfy { $0.count == columnCount })
+
+            let sql = sqlPrefix + " VALUES " + Array(repeating: rowPlaceholder, count: chunk.count).joined(separator: ", ")
+            let arguments = StatementArguments(chunk.flatMap { $0 })
+            if chunk.count == rowsPerStatement {
+                // Full chunks share the same SQL, so we cache them.
+                executeWithCachedStatement(sql: sql, arguments: arguments)
+            } else {
+                executeUpdate(sql: sql, arguments: arguments)
+            }
+
+            let lastRowId = database.lastInsertedRowID
+            let firstRowId = lastRowId - Int64(chunk.count) + 1
+            rowIds.append(contentsOf: firstRowId...lastRowId)
+        }
+        return rowIds
+    }
+
     // This has significant perf benefits over database.execute()
     // for queries that we perform repeatedly.
     func executeWithCachedStatement(sql: String,
@@ -623,9 +623,13 @@ extension ObservedDatabaseChanges: UIDatabaseChanges {
         guard tableNames.count > 0 else {
             return
         }
+        append(collections: Self.collections(forTableNames: tableNames))
+    }
 
+    private static func collections(forTableNames tableNames: Set<String>) -> Set<String> {
         // If necessary, convert GRDB table names to "collections".
         let tableNameToCollectionMap = Self.tableNameToCollectionMap
+        var collections = Set<String>()
         for tableName in tableNames {
             guard !tableName.hasPrefix(GRDBFullTextSearchFinder.contentTableName) else {
                 owsFailDebug("should not have been notified for changes to FTS tables")
@@ -638,7 +642,62 @@ extension ObservedDatabaseChanges: UIDatabaseChanges {
                 owsFailDebug("Unknown table: \(tableName)")
                 continue
             }
-            append(collection: collection)
+            collections.insert(collection)
+        }
+        return collections
+    }
+
+    // MARK: - Cross Process Changes
+
+    // Describes these pending changes for the cross-process change
+    // journal. This is done before the write transaction commits, while
+    // the rows which were inserted or updated can still be mapped to
+    // unique ids. Unlike finalizePublishedState(), this doesn't modify
+    // the pending changes.
+    func crossProcessChanges(db: Database) -> CrossProcessChangeJournal.Changes {
+        var changes = CrossProcessChangeJournal.Changes()
+        changes.tableNames = tableNames
+        changes.collections = Self.collections(forTableNames: tableNames)
+
+        do {
+            changes.threadUniqueIds = try mapRowIdsToUniqueIds(db: db,
+                                                               rowIds: threads.rowIds,
+                                                               uniqueIds: threads.uniqueIds,
+                                                               rowIdToUniqueIdMap: threads.rowIdToUniqueIdMap,
+                                                               tableName: "\(ThreadRecord.databaseTableName)",
+                                                               uniqueIdColumnName: "\(threadColumn: .uniqueId)")
+            changes.interactionUniqueIds = try mapRowIdsToUniqueIds(db: db,
+                                                                    rowIds: interactions.rowIds,
+                                                                    uniqueIds: interactions.uniqueIds,
+                                                                    rowIdToUniqueIdMap: interactions.rowIdToUniqueIdMap,
+                                                                    tableName: "\(InteractionRecord.databaseTableName)",
+                                                                    uniqueIdColumnName: "\(interactionColumn: .uniqueId)")
+            changes.attachmentUniqueIds = try mapRowIdsToUniqueIds(db: db,
+                                                                   rowIds: attachments.rowIds,
+                                                                   uniqueIds: attachments.uniqueIds,
+                                                                   rowIdToUniqueIdMap: attachments.rowIdToUniqueIdMap,
+                                                                   tableName: "\(AttachmentRecord.databaseTableName)",
+                                                                   uniqueIdColumnName: "\(attachmentColumn: .uniqueId)")
+            changes.attachmentDeletedUniqueIds = try mapRowIdsToUniqueIds(db: db,
+                                                                          rowIds: attachments.deletedRowIds,
+                                                                          uniqueIds: attachments.deletedUniqueIds,
+                                                                          rowIdToUniqueIdMap: attachments.rowIdToUniqueIdMap,
+                                                                          tableName: "\(AttachmentRecord.databaseTableName)",
+                                                                          uniqueIdColumnName: "\(attachmentColumn: .uniqueId)")
+            changes.interactionDeletedUniqueIds = try mapRowIdsToUniqueIds(db: db,
+                                                                           rowIds: interactions.deletedRowIds,
+                                                                           uniqueIds: interactions.deletedUniqueIds,
+                                                                           rowIdToUniqueIdMap: interactions.rowIdToUniqueIdMap,
+                                                                           tableName: "\(InteractionRecord.databaseTableName)",
+                                                                           uniqueIdColumnName: "\(interactionColumn: .uniqueId)")
+        } catch DatabaseObserverError.changeTooLarge {
+            return CrossProcessChangeJournal.Changes.incomplete(tableNames: changes.tableNames,
+                                                                collections: changes.collections)
+        } catch {
+            owsFailDebug("Error: \(error)")
+            return CrossProcessChangeJournal.Changes.incomplete(tableNames: changes.tableNames,
+                                                                collections: changes.collections)
         }
+        return changes
     }
 }
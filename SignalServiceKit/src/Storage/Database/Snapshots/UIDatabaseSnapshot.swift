@@ -48,7 +48,18 @@ public class UIDatabaseObserver: NSObject {
 
     public static let kMaxIncrementalRowChanges = 200
 
-    private lazy var nonModelTables: Set<String> = Set([MediaGalleryRecord.databaseTableName, PendingReadReceiptRecord.databaseTableName])
+    private lazy var nonModelTables: Set<String> = Set([MediaGalleryRecord.databaseTableName,
+                                                        PendingReadReceiptRecord.databaseTableName,
+                                                        ThreadUnreadCountFinder.tableName,
+                                                        CrossProcessChangeJournal.tableName,
+                                                        InteractionRankCheckpoints.deleteGenerationTableName])
+
+    // Set while SDSModel.anyInsert(batch:) inserts into this table.
+    // The rows are reported once by endBatchInsert() rather than
+    // one-by-one by databaseDidChange(with:).
+    //
+    // Writes are serialized, so there is at most one batch at a time.
+    private let batchInsertTableName = AtomicOptional<String>(nil)
 
     // tldr; Instead, of protecting UIDatabaseObserver state with a nested DispatchQueue,
     // which would break GRDB's SchedulingWatchDog, we use objc_sync
@@ -124,7 +135,6 @@ public class UIDatabaseObserver: NSObject {
     #endif
 
     private let pool: DatabasePool
-    private let checkpointingQueue: DatabaseQueue?
 
     internal var latestSnapshot: DatabaseSnapshot {
         didSet {
@@ -135,8 +145,7 @@ public class UIDatabaseObserver: NSObject {
     private let hasPendingSnapshotUpdate = AtomicBool(false)
     private var lastSnapshotUpdateDate: Date?
 
-    // This property should only be accessed on the main thread.
-    private var lastCheckpointDate: Date?
+    private let checkpointScheduler: GRDBCheckpointScheduler?
 
     private var displayLink: CADisplayLink?
     private let displayLinkPreferredFramesPerSecond: Int = 20
@@ -147,7 +156,7 @@ public class UIDatabaseObserver: NSObject {
 
     init(pool: DatabasePool, checkpointingQueue: DatabaseQueue?) throws {
         self.pool = pool
-        self.checkpointingQueue = checkpointingQueue
+        self.checkpointScheduler = checkpointingQueue.map { GRDBCheckpointScheduler(checkpointingQueue: $0) }
         self.latestSnapshot = try pool.makeSnapshot()
 
         super.init()
@@ -230,9 +239,25 @@ public class UIDatabaseObserver: NSObject {
         AssertIsOnMainThread()
         Logger.verbose("")
 
-        for delegate in snapshotDelegates {
-            delegate.uiDatabaseSnapshotDidUpdateExternally()
+        guard let databaseChanges = SDSDatabaseStorage.crossProcessDatabaseChanges(notification: notification) else {
+            for delegate in snapshotDelegates {
+                delegate.uiDatabaseSnapshotDidUpdateExternally()
+            }
+            return
         }
+
+        // We know exactly what the other process changed, so we can
+        // update the snapshot as if this process had made the changes.
+        committedChanges.append(interactionUniqueIds: databaseChanges.interactionUniqueIds)
+        committedChanges.append(threadUniqueIds: databaseChanges.threadUniqueIds)
+        committedChanges.append(attachmentUniqueIds: databaseChanges.attachmentUniqueIds)
+        committedChanges.append(interactionDeletedUniqueIds: databaseChanges.interactionDeletedUniqueIds)
+        committedChanges.append(attachmentDeletedUniqueIds: databaseChanges.attachmentDeletedUniqueIds)
+        committedChanges.append(collections: databaseChanges.collections)
+
+        hasPendingSnapshotUpdate.set(true)
+        ensureDisplayLink()
+        updateSnapshotIfNecessary()
     }
 }
 
@@ -249,9 +274,42 @@ extension UIDatabaseObserver: TransactionObserver {
             return false
         }
 
+        if case .insert(tableName: let tableName) = eventKind,
+           tableName == batchInsertTableName.get() {
+            // Ignore batch inserts; see endBatchInsert().
+            return false
+        }
+
         return true
     }
 
+    // This should only be called by DatabaseStorage.
+    func beginBatchInsert(tableName: String) {
+        owsAssertDebug(batchInsertTableName.get() == nil)
+
+        batchInsertTableName.set(tableName)
+    }
+
+    // This should only be called by DatabaseStorage.
+    func endBatchInsert(tableName: String, rowIds: [Int64]) {
+        AssertHasUIDatabaseObserverLock()
+        owsAssertDebug(batchInsertTableName.get() == tableName)
+
+        batchInsertTableName.set(nil)
+
+        guard !rowIds.isEmpty else {
+            return
+        }
+        pendingChanges.append(tableName: tableName)
+        if tableName == InteractionRecord.databaseTableName {
+            pendingChanges.append(interactionRowIds: Set(rowIds))
+        } else if tableName == ThreadRecord.databaseTableName {
+            pendingChanges.append(threadRowIds: Set(rowIds))
+        } else if tableName == AttachmentRecord.databaseTableName {
+            pendingChanges.append(attachmentRowIds: Set(rowIds))
+        }
+    }
+
     // This should only be called by DatabaseStorage.
     func updateIdMapping(thread: TSThread, transaction: GRDBWriteTransaction) {
         AssertHasUIDatabaseObserverLock()
@@ -276,6 +334,13 @@ extension UIDatabaseObserver: TransactionObserver {
         pendingChanges.append(tableName: TSAttachment.table.tableName)
     }
 
+    // This should only be called by DatabaseStorage.
+    func pendingCrossProcessChanges(transaction: GRDBWriteTransaction) -> CrossProcessChangeJournal.Changes {
+        AssertHasUIDatabaseObserverLock()
+
+        return pendingChanges.crossProcessChanges(db: transaction.database)
+    }
+
     // internal - should only be called by DatabaseStorage
     func didTouch(interaction: TSInteraction, transaction: GRDBWriteTransaction) {
         AssertHasUIDatabaseObserverLock()
@@ -591,7 +656,7 @@ extension UIDatabaseObserver: TransactionObserver {
     private func checkpointIfNecessary() {
         AssertIsOnMainThread()
 
-        guard let checkpointingQueue = checkpointingQueue else {
+        guard let checkpointScheduler = checkpointScheduler else {
             // We only checkpoint in the main app;
             // checkpointingQueue will not be set in the app extensions.
             assert(!CurrentAppContext().isMainApp)
@@ -606,7 +671,7 @@ extension UIDatabaseObserver: TransactionObserver {
         //
         // * Passive checkpoints abort immediately if there are any database
         //   readers or writers. This makes them "cheap" in the sense that
-        //   they won't block the main thread for long.
+        //   they won't block writers.
         //   However they only integrate WAL contents, they don't "restart" or
         //   "truncate" so they don't inherently limit WAL growth. We use them
         //   because they're cheap and they help our other checkpoints cheaper
@@ -626,64 +691,20 @@ extension UIDatabaseObserver: TransactionObserver {
         // The only time the long-lived read transaction is *not* reading the database is
         // *right here*, between committing the last transaction and starting the next one.
         //
-        // Solution:
+        // Solution (see GRDBCheckpointScheduler):
         //
-        // * Perform passive checkpoints often to ensure WAL contents are mostly integrated
-        //   at any given time.
-        // * Perform truncate checkpoints sometimes to limit WAL size.
-        // * Limit checkpoint frequency by time so that heavy write activity won't bog down
-        //   the main thread.
+        // * Perform passive checkpoints off the main thread once writes have been idle for
+        //   a moment, to ensure WAL contents are mostly integrated at any given time.
+        // * Perform truncate checkpoints *here* once the WAL file grows past a threshold,
+        //   to limit WAL size.
+        // * Limit truncate checkpoint frequency by time so that heavy write activity won't
+        //   bog down the main thread.
         // * Perform checkpoints using a dedicated GRDB DatabaseQueue so that checkpoints
         //   don't block on writes. GRDB DatabasePool serializes writes on a queue that
         //   doesn't honor the busy mode. This also makes the checkpoints very likely to succeed.
         //
         // See: https://www.sqlite.org/c3ref/wal_checkpoint_v2.html
         // See: https://www.sqlite.org/wal.html
-        let shouldTryToCheckpoint = { () -> Bool in
-            guard !tsAccountManager.isTransferInProgress else {
-                return false
-            }
-
-            guard let lastCheckpointDate = self.lastCheckpointDate else {
-                return true
-            }
-            let maxCheckpointFrequency: TimeInterval = 0.25
-            guard abs(lastCheckpointDate.timeIntervalSinceNow) >= maxCheckpointFrequency else {
-                Logger.verbose("Skipping checkpoint due to frequency")
-                return false
-            }
-            return true
-        }()
-        guard shouldTryToCheckpoint else {
-            return
-        }
-
-        // Run truncate checkpoints after 1/N of writes.
-        let shouldDoTruncateCheckpoint = arc4random_uniform(10) == 0
-        let mode: Database.CheckpointMode = shouldDoTruncateCheckpoint ? .truncate : .passive
-        do {
-            try checkpoint(mode: mode,
-                           checkpointingQueue: checkpointingQueue)
-        } catch {
-            owsFailDebug("error \(error)")
-        }
-        lastCheckpointDate = Date()
-    }
-
-    func checkpoint(mode: Database.CheckpointMode,
-                    checkpointingQueue: DatabaseQueue) throws {
-        AssertIsOnMainThread()
-
-        let result = try GRDBDatabaseStorageAdapter.checkpoint(checkpointingQueue: checkpointingQueue, mode: mode)
-
-        let pageSize: Int32 = 4 * 1024
-        let walFileSizeBytes = result.walSizePages * pageSize
-        let maxWalFileSizeBytes = 4 * 1024 * 1024
-        if walFileSizeBytes > maxWalFileSizeBytes {
-            Logger.info("walFileSizeBytes: \(walFileSizeBytes).")
-            Logger.info("walSizePages: \(result.walSizePages), pagesCheckpointed: \(result.pagesCheckpointed).")
-        } else {
-            Logger.verbose("walSizePages: \(result.walSizePages), pagesCheckpointed: \(result.pagesCheckpointed).")
-        }
+        checkpointScheduler.didCommitWrite()
     }
 }
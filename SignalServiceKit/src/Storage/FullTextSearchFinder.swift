@@ -32,6 +32,15 @@ public class FullTextSearchFinder: NSObject {
         }
     }
 
+    public func modelsWereInserted(models: [SDSModel], transaction: SDSAnyWriteTransaction) {
+        assert(models.allSatisfy { type(of: $0).shouldBeIndexedForFTS })
+
+        switch transaction.writeTransaction {
+        case .grdbWrite(let grdbWrite):
+            GRDBFullTextSearchFinder.modelsWereInserted(models: models, transaction: grdbWrite)
+        }
+    }
+
     @objc
     public func modelWasUpdatedObjc(model: TSYapDatabaseObject, transaction: SDSAnyWriteTransaction) {
         guard let model = model as? SDSModel else {
@@ -65,6 +74,52 @@ public class FullTextSearchFinder: NSObject {
             GRDBFullTextSearchFinder.allModelsWereRemoved(collection: collection, transaction: grdbWrite)
         }
     }
+
+    // MARK: - Deferred Indexing
+
+    private static let isDeferredIndexingEnabledFlag = AtomicBool(FeatureFlags.deferredMessageIndexing)
+
+    // If enabled, inserted and updated messages are only queued for
+    // indexing within the write transaction; a low-priority worker
+    // indexes them later. Queries merge any not-yet-indexed messages,
+    // so this doesn't affect search results.
+    @objc
+    public static var isDeferredIndexingEnabled: Bool {
+        get { isDeferredIndexingEnabledFlag.get() }
+        set { isDeferredIndexingEnabledFlag.set(newValue) }
+    }
+
+    private static let isObservingForDeferredIndexing = AtomicBool(false)
+
+    // Drains any messages queued for indexing, e.g. by a previous
+    // launch or by an app extension. Extensions only enqueue, so we also
+    // drain whenever another process has written and when the app
+    // becomes active.
+    @objc
+    public class func scheduleDeferredIndexingIfNecessary() {
+        AppReadiness.runNowOrWhenAppDidBecomeReadyAsync {
+            if isObservingForDeferredIndexing.tryToSetFlag() {
+                for name in [SDSDatabaseStorage.didReceiveCrossProcessNotification, .OWSApplicationDidBecomeActive] {
+                    NotificationCenter.default.addObserver(forName: name, object: nil, queue: nil) { _ in
+                        GRDBFullTextSearchFinder.scheduleDeferredIndexing()
+                    }
+                }
+            }
+            GRDBFullTextSearchFinder.scheduleDeferredIndexing()
+        }
+    }
+
+    // Searches only match a bounded number of queued messages in memory.
+    // If more are queued, this indexes the excess before calling completion
+    // (on a background queue), so that a search performed in completion
+    // returns every match.
+    @objc
+    public class func indexDeferredBacklogForSearch(completion: @escaping () -> Void) {
+        DispatchQueue.global(qos: .userInitiated).async {
+            GRDBFullTextSearchFinder.indexBacklogForSearch()
+            completion()
+        }
+    }
 }
 
 // MARK: - Normalization
@@ -98,6 +153,52 @@ extension FullTextSearchFinder {
     // aren't adversely affected.
     @objc
     public class func normalize(text: String) -> String {
+        if let normalized = normalizeASCII(text: text) {
+            return normalized
+        }
+        return normalizeUnicode(text: text)
+    }
+
+    // A single pass over the UTF-8 view that produces exactly the same
+    // output as normalizeUnicode(text:) for ASCII text. Returns nil if
+    // the text contains any non-ASCII scalars.
+    //
+    // For ASCII, charactersToRemove filters everything except letters,
+    // digits and whitespace, and filters the ASCII whitespace other than
+    // " " since it's all control characters. That leaves only " " to
+    // trim, and nothing for the whitespace or canonical mappings to do.
+    class func normalizeASCII(text: String) -> String? {
+        let space = UInt8(ascii: " ")
+
+        var bytes = [UInt8]()
+        bytes.reserveCapacity(text.utf8.count)
+        // The length of the output up to and including its last non-space byte.
+        var trimmedCount = 0
+        for byte in text.utf8 {
+            switch byte {
+            case UInt8(ascii: "a")...UInt8(ascii: "z"),
+                 UInt8(ascii: "A")...UInt8(ascii: "Z"),
+                 UInt8(ascii: "0")...UInt8(ascii: "9"):
+                bytes.append(byte)
+                trimmedCount = bytes.count
+            case space:
+                // Strip leading whitespace.
+                if !bytes.isEmpty {
+                    bytes.append(byte)
+                }
+            case 0x80...:
+                return nil
+            default:
+                continue
+            }
+        }
+        // Strip trailing whitespace.
+        bytes.removeLast(bytes.count - trimmedCount)
+
+        return String(decoding: bytes, as: UTF8.self)
+    }
+
+    class func normalizeUnicode(text: String) -> String {
         // 1. Filter out invalid characters.
         let filtered = text.removeCharacters(characterSet: charactersToRemove)
 
@@ -141,6 +242,23 @@ extension FullTextSearchFinder {
     // We want to match by prefix for "search as you type" functionality.
     // SQLite does not support suffix or contains matches.
     public class func query(searchText: String) -> String {
+        let filteredQueryTerms = queryTerms(searchText: searchText).map {
+            // Allow partial match of each term.
+            //
+            // Note that we use double-quotes to enclose each search term.
+            // Quoted search terms can include a few more characters than
+            // "bareword" (non-quoted) search terms.  This shouldn't matter,
+            // since we're filtering all of the affected characters, but
+            // quoting protects us from any bugs in that logic.
+            "\"\($0)\"*"
+        }
+
+        // Join terms into query string.
+        let query = filteredQueryTerms.joined(separator: " ")
+        return query
+    }
+
+    class func queryTerms(searchText: String) -> [String] {
         // 1. Normalize the search text.
         //
         // TODO: We could arguably convert to lowercase since the search
@@ -171,23 +289,10 @@ extension FullTextSearchFinder {
         queryTerms = Array(Set(queryTerms)).sorted()
 
         // 5. Filter the query terms.
-        let filteredQueryTerms = queryTerms.filter {
+        return queryTerms.filter {
             // Ignore empty terms.
             $0.count > 0
-            }.map {
-                // Allow partial match of each term.
-                //
-                // Note that we use double-quotes to enclose each search term.
-                // Quoted search terms can include a few more characters than
-                // "bareword" (non-quoted) search terms.  This shouldn't matter,
-                // since we're filtering all of the affected characters, but
-                // quoting protects us from any bugs in that logic.
-                "\"\($0)\"*"
-        }
-
-        // 6. Join terms into query string.
-        let query = filteredQueryTerms.joined(separator: " ")
-        return query
+        }.map { String($0) }
     }
 }
 
@@ -247,6 +352,10 @@ class GRDBFullTextSearchFinder: NSObject {
     }
 
     public class func modelWasInserted(model: SDSModel, transaction: GRDBWriteTransaction) {
+        guard !shouldDeferIndexing(model) else {
+            enqueueForDeferredIndexing(model, transaction: transaction)
+            return
+        }
         guard shouldIndexModel(model) else {
             Logger.verbose("Not indexing model: \(type(of: (model)))")
             removeModelFromIndex(model, transaction: transaction)
@@ -272,7 +381,41 @@ class GRDBFullTextSearchFinder: NSObject {
             transaction: transaction)
     }
 
+    public class func modelsWereInserted(models: [SDSModel], transaction: GRDBWriteTransaction) {
+        var rows = [(collection: String, uniqueId: String, ftsContent: String)]()
+        for model in models {
+            guard !shouldDeferIndexing(model), shouldIndexModel(model) else {
+                // These are rare enough to handle one-by-one.
+                modelWasInserted(model: model, transaction: transaction)
+                continue
+            }
+            let ftsContent = AnySearchIndexer.indexContent(object: model, transaction: transaction.asAnyRead) ?? ""
+            rows.append((collection: collection(forModel: model), uniqueId: model.uniqueId, ftsContent: ftsContent))
+        }
+        guard !rows.isEmpty, !disableFTS else {
+            return
+        }
+
+        serialQueue.sync {
+            for row in rows {
+                let cacheKey = self.cacheKey(collection: row.collection, uniqueId: row.uniqueId)
+                ftsCache.setObject(row.ftsContent as NSString, forKey: cacheKey as NSString)
+            }
+        }
+
+        transaction.executeMultiRowInsert(
+            sqlPrefix: """
+            INSERT INTO \(contentTableName)
+            (\(collectionColumn), \(uniqueIdColumn), \(ftsContentColumn))
+            """,
+            rows: rows.map { [$0.collection, $0.uniqueId, $0.ftsContent] })
+    }
+
     public class func modelWasUpdated(model: SDSModel, transaction: GRDBWriteTransaction) {
+        guard !shouldDeferIndexing(model) else {
+            enqueueForDeferredIndexing(model, transaction: transaction)
+            return
+        }
         guard shouldIndexModel(model) else {
             Logger.verbose("Not indexing model: \(type(of: (model)))")
             removeModelFromIndex(model, transaction: transaction)
@@ -333,6 +476,15 @@ class GRDBFullTextSearchFinder: NSObject {
             """,
             arguments: [uniqueId, collection],
             transaction: transaction)
+
+        executeUpdate(
+            sql: """
+            DELETE FROM \(pendingTableName)
+            WHERE \(uniqueIdColumn) == ?
+            AND \(collectionColumn) == ?
+            """,
+            arguments: [uniqueId, collection],
+            transaction: transaction)
     }
 
     public class func allModelsWereRemoved(collection: String, transaction: GRDBWriteTransaction) {
@@ -348,6 +500,14 @@ class GRDBFullTextSearchFinder: NSObject {
             """,
             arguments: [collection],
             transaction: transaction)
+
+        executeUpdate(
+            sql: """
+            DELETE FROM \(pendingTableName)
+            WHERE \(collectionColumn) == ?
+            """,
+            arguments: [collection],
+            transaction: transaction)
     }
 
     private static let disableFTS = false
@@ -366,41 +526,287 @@ class GRDBFullTextSearchFinder: NSObject {
     private class func modelForFTSMatch(collection: String,
                                         uniqueId: String,
                                         transaction: GRDBReadTransaction) -> SDSModel? {
+        guard let model = fetchModel(collection: collection,
+                                     uniqueId: uniqueId,
+                                     transaction: transaction) else {
+            owsFailDebug("Couldn't load record: \(collection)")
+            return nil
+        }
+        return model
+    }
+
+    private class func fetchModel(collection: String,
+                                  uniqueId: String,
+                                  transaction: GRDBReadTransaction) -> SDSModel? {
         switch collection {
         case SignalAccount.collection():
-            guard let model = SignalAccount.anyFetch(uniqueId: uniqueId,
-                                                     transaction: transaction.asAnyRead) else {
-                                                        owsFailDebug("Couldn't load record: \(collection)")
-                                                        return nil
-            }
-            return model
+            return SignalAccount.anyFetch(uniqueId: uniqueId, transaction: transaction.asAnyRead)
         case TSThread.collection():
-            guard let model = TSThread.anyFetch(uniqueId: uniqueId,
-                                                transaction: transaction.asAnyRead) else {
-                                                    owsFailDebug("Couldn't load record: \(collection)")
-                                                    return nil
-            }
-            return model
+            return TSThread.anyFetch(uniqueId: uniqueId, transaction: transaction.asAnyRead)
         case TSInteraction.collection():
-            guard let model = TSInteraction.anyFetch(uniqueId: uniqueId,
-                                                     transaction: transaction.asAnyRead) else {
-                                                        owsFailDebug("Couldn't load record: \(collection)")
-                                                        return nil
-            }
-            return model
+            return TSInteraction.anyFetch(uniqueId: uniqueId, transaction: transaction.asAnyRead)
         case SignalRecipient.collection():
-            guard let model = SignalRecipient.anyFetch(uniqueId: uniqueId,
-                                                     transaction: transaction.asAnyRead) else {
-                                                        owsFailDebug("Couldn't load record: \(collection)")
-                                                        return nil
-            }
-            return model
+            return SignalRecipient.anyFetch(uniqueId: uniqueId, transaction: transaction.asAnyRead)
         default:
             owsFailDebug("Unexpected record type: \(collection)")
             return nil
         }
     }
 
+    // MARK: - Deferred Indexing
+
+    static let pendingTableName = "indexable_text_pending"
+
+    private static let indexerQueue = DispatchQueue(label: "org.signal.fts.indexer", qos: .utility)
+    private static let isIndexerScheduled = AtomicBool(false)
+    private static let indexerBatchSize = 100
+    private static let deferredIndexingFinalizationKey = "GRDBFullTextSearchFinder.deferredIndexing"
+
+    private class func shouldDeferIndexing(_ model: SDSModel) -> Bool {
+        // Messages dominate the write volume on the receive path;
+        // other models are rare enough to index inline.
+        return FullTextSearchFinder.isDeferredIndexingEnabled && model is TSInteraction
+    }
+
+    private class func enqueueForDeferredIndexing(_ model: SDSModel, transaction: GRDBWriteTransaction) {
+        executeUpdate(
+            sql: """
+            INSERT OR IGNORE INTO \(pendingTableName)
+            (\(collectionColumn), \(uniqueIdColumn))
+            VALUES
+            (?, ?)
+            """,
+            arguments: [collection(forModel: model), model.uniqueId],
+            transaction: transaction)
+
+        // Kick the indexer once per transaction, after it commits.
+        transaction.asAnyWrite.addTransactionFinalizationBlock(forKey: deferredIndexingFinalizationKey) { transaction in
+            transaction.addAsyncCompletion(queue: indexerQueue) {
+                scheduleDeferredIndexing()
+            }
+        }
+    }
+
+    class func scheduleDeferredIndexing() {
+        // App extensions leave their queued models for the main app.
+        guard CurrentAppContext().isMainApp else {
+            return
+        }
+        guard isIndexerScheduled.tryToSetFlag() else {
+            return
+        }
+        indexerQueue.async {
+            // Clear the flag before reading the queue so that models
+            // enqueued while we index are never missed.
+            isIndexerScheduled.set(false)
+            indexNextPendingBatch()
+        }
+    }
+
+    private class func indexNextPendingBatch() {
+        assertOnQueue(indexerQueue)
+
+        let indexedCount = databaseStorage.write { transaction in
+            indexPendingBatch(transaction: transaction.unwrapGrdbWrite)
+        }
+        guard indexedCount >= indexerBatchSize else {
+            return
+        }
+        // Yield to other writers between batches.
+        indexerQueue.asyncAfter(deadline: .now() + 0.05) {
+            indexNextPendingBatch()
+        }
+    }
+
+    class func indexBacklogForSearch() {
+        owsAssertDebug(!Thread.isMainThread)
+
+        // Each batch removes its models from the queue. Models enqueued
+        // concurrently could keep us going, so bound the number of batches.
+        for _ in 0..<maxBacklogBatchesForSearch {
+            let hasBacklog = databaseStorage.read { transaction in
+                pendingCount(transaction: transaction.unwrapGrdbRead) > maxPendingEntriesToMerge
+            }
+            guard hasBacklog else {
+                return
+            }
+            databaseStorage.write { transaction in
+                indexPendingBatch(transaction: transaction.unwrapGrdbWrite)
+            }
+        }
+        Logger.warn("Search backlog is still above \(maxPendingEntriesToMerge) models.")
+    }
+
+    private static let maxBacklogBatchesForSearch = 1000
+
+    // Counts at most maxPendingEntriesToMerge + 1 queued models.
+    private class func pendingCount(transaction: GRDBReadTransaction) -> Int {
+        let sql = """
+            SELECT COUNT(*) FROM (
+                SELECT 1
+                FROM \(pendingTableName)
+                LIMIT \(maxPendingEntriesToMerge + 1)
+            )
+        """
+        return transaction.database.strictRead { database in
+            try Int.fetchOne(database, sql: sql) ?? 0
+        }
+    }
+
+    // Returns the number of queued models that were processed.
+    @discardableResult
+    class func indexPendingBatch(transaction: GRDBWriteTransaction) -> Int {
+        let sql = """
+            SELECT id, \(collectionColumn), \(uniqueIdColumn)
+            FROM \(pendingTableName)
+            ORDER BY id
+            LIMIT \(indexerBatchSize)
+        """
+        let rows = transaction.database.strictRead { database in
+            try Row.fetchAll(database, sql: sql)
+        }
+
+        for row in rows {
+            let rowId: Int64 = row[0]
+            let collection: String = row[1]
+            let uniqueId: String = row[2]
+
+            if let model = fetchModel(collection: collection, uniqueId: uniqueId, transaction: transaction),
+               shouldIndexModel(model) {
+                let ftsContent = AnySearchIndexer.indexContent(object: model, transaction: transaction.asAnyRead) ?? ""
+                let isUnchanged: Bool = serialQueue.sync {
+                    let cacheKey = self.cacheKey(collection: collection, uniqueId: uniqueId)
+                    if let cachedValue = ftsCache.object(forKey: cacheKey as NSString),
+                       (cachedValue as String) == ftsContent {
+                        return true
+                    }
+                    ftsCache.setObject(ftsContent as NSString, forKey: cacheKey as NSString)
+                    return false
+                }
+                if !isUnchanged {
+                    deleteContent(collection: collection, uniqueId: uniqueId, transaction: transaction)
+                    executeUpdate(
+                        sql: """
+                        INSERT INTO \(contentTableName)
+                        (\(collectionColumn), \(uniqueIdColumn), \(ftsContentColumn))
+                        VALUES
+                        (?, ?, ?)
+                        """,
+                        arguments: [collection, uniqueId, ftsContent],
+                        transaction: transaction)
+                }
+            } else {
+                // The model was removed or shouldn't be indexed.
+                deleteContent(collection: collection, uniqueId: uniqueId, transaction: transaction)
+            }
+
+            executeUpdate(
+                sql: "DELETE FROM \(pendingTableName) WHERE id == ?",
+                arguments: [rowId],
+                transaction: transaction)
+        }
+        return rows.count
+    }
+
+    private class func deleteContent(collection: String, uniqueId: String, transaction: GRDBWriteTransaction) {
+        executeUpdate(
+            sql: """
+            DELETE FROM \(contentTableName)
+            WHERE \(uniqueIdColumn) == ?
+            AND \(collectionColumn) == ?
+            """,
+            arguments: [uniqueId, collection],
+            transaction: transaction)
+    }
+
+    // Returns (collection, uniqueId) of queued models, most recent first.
+    private class func pendingEntries(collections: [String],
+                                      transaction: GRDBReadTransaction) -> [(String, String)] {
+        let sql = """
+            SELECT \(collectionColumn), \(uniqueIdColumn)
+            FROM \(pendingTableName)
+            WHERE \(collectionColumn) IN (\(collections.map { "'\($0)'" }.joined(separator: ",")))
+            ORDER BY id DESC
+            LIMIT \(maxPendingEntriesToMerge)
+        """
+        let rows = transaction.database.strictRead { database in
+            try Row.fetchAll(database, sql: sql)
+        }
+        if rows.count >= maxPendingEntriesToMerge {
+            // Callers should use indexDeferredBacklogForSearch(completion:)
+            // first; this can only happen if models were queued since.
+            Logger.warn("Search is only merging the \(maxPendingEntriesToMerge) most recent unindexed models.")
+        }
+        return rows.map { row in
+            let collection: String = row[0]
+            let uniqueId: String = row[1]
+            return (collection, uniqueId)
+        }
+    }
+
+    // Queued models are re-indexed in memory on every search, so this
+    // bounds query latency. The indexer normally keeps up with writes;
+    // any larger backlog is indexed before searching.
+    private static let maxPendingEntriesToMerge = 200
+
+    // The number of words in a snippet, matching the FTS snippet() length.
+    private static let snippetWordCount = 15
+
+    private static let tokenSeparators = CharacterSet.alphanumerics.inverted
+
+    // The FTS table uses the unicode61 tokenizer, which is case-insensitive
+    // and removes diacritics. Like unicode61, we only strip marks that come
+    // from canonical decomposition, so e.g. "ø" doesn't match "o".
+    private class func foldForMatching(_ text: String) -> String {
+        let decomposed = text.lowercased().decomposedStringWithCanonicalMapping
+        return String(String.UnicodeScalarView(decomposed.unicodeScalars.lazy.filter {
+            !CharacterSet.nonBaseCharacters.contains($0)
+        }))
+    }
+
+    // Matches the content of a not-yet-indexed model against the query
+    // terms the same way the FTS query does: every term must be a prefix
+    // of some token. Returns a snippet with the matches tagged, or nil if
+    // the content doesn't match.
+    class func matchSnippet(forUnindexedContent content: String, queryTerms: [String]) -> String? {
+        let foldedTerms = queryTerms.map { foldForMatching($0) }
+        guard !foldedTerms.isEmpty else {
+            return nil
+        }
+        var unmatchedTerms = Set(foldedTerms)
+        var firstMatchIndex: Int?
+        var words = [String]()
+        for word in content.split(separator: " ") {
+            let tokens = foldForMatching(String(word)).components(separatedBy: tokenSeparators)
+            let matchedTerms = foldedTerms.filter { term in
+                tokens.contains { !$0.isEmpty && $0.hasPrefix(term) }
+            }
+            if matchedTerms.isEmpty {
+                words.append(String(word))
+            } else {
+                unmatchedTerms.subtract(matchedTerms)
+                if firstMatchIndex == nil {
+                    firstMatchIndex = words.count
+                }
+                words.append("<\(matchTag)>\(word)</\(matchTag)>")
+            }
+        }
+        guard unmatchedTerms.isEmpty, let matchIndex = firstMatchIndex else {
+            return nil
+        }
+
+        let startIndex = max(0, min(matchIndex, words.count - snippetWordCount))
+        let endIndex = min(words.count, startIndex + snippetWordCount)
+        var snippet = words[startIndex..<endIndex].joined(separator: " ")
+        if startIndex > 0 {
+            snippet = "…" + snippet
+        }
+        if endIndex < words.count {
+            snippet += "…"
+        }
+        return snippet
+    }
+
     // MARK: - Querying
 
     public class func enumerateObjects<T: SDSModel>(searchText: String, maxResults: UInt, transaction: GRDBReadTransaction, block: @escaping (T, String, UnsafeMutablePointer<ObjCBool>) -> Void) {
@@ -431,9 +837,17 @@ class GRDBFullTextSearchFinder: NSObject {
             return
         }
 
+        // Models queued for deferred indexing may be missing from the
+        // FTS table or indexed with stale content, so we exclude them
+        // from the FTS results and match them in memory instead.
+        let pendingEntries = self.pendingEntries(collections: collections, transaction: transaction)
+        let pendingKeys = Set(pendingEntries.map { cacheKey(collection: $0.0, uniqueId: $0.1) })
+
+        var stop: ObjCBool = false
+        var resultCount: UInt = 0
+
         // Search with the query interface or SQL
         do {
-            var stop: ObjCBool = false
 
             // GRDB TODO: We could use bm25() instead of rank to order results.
             let indexOfContentColumnInFTSTable = 0
@@ -450,7 +864,7 @@ class GRDBFullTextSearchFinder: NSObject {
                 WHERE \(ftsTableName) MATCH '"\(ftsContentColumn)" : \(query)'
                 AND \(collectionColumn) IN (\(collections.map { "'\($0)'" }.joined(separator: ",")))
                 ORDER BY rank
-                LIMIT \(maxResults)
+                LIMIT \(maxResults + UInt(pendingKeys.count))
             """
 
             let cursor = try Row.fetchCursor(transaction.database, sql: sql)
@@ -463,6 +877,9 @@ class GRDBFullTextSearchFinder: NSObject {
                         owsFailDebug("Invalid match: collection: \(collection), uniqueId: \(uniqueId).")
                         continue
                 }
+                guard !pendingKeys.contains(cacheKey(collection: collection, uniqueId: uniqueId)) else {
+                    continue
+                }
                 guard let model = modelForFTSMatch(collection: collection,
                                                    uniqueId: uniqueId,
                                                    transaction: transaction) else {
@@ -471,13 +888,33 @@ class GRDBFullTextSearchFinder: NSObject {
                 }
 
                 block(model, snippet, &stop)
-                guard !stop.boolValue else {
-                    break
+                resultCount += 1
+                guard !stop.boolValue, resultCount < maxResults else {
+                    return
                 }
             }
         } catch {
             owsFailDebug("Couldn't fetch results: \(error)")
         }
+
+        guard !pendingEntries.isEmpty else {
+            return
+        }
+        let queryTerms = FullTextSearchFinder.queryTerms(searchText: searchText)
+        for (collection, uniqueId) in pendingEntries {
+            guard let model = fetchModel(collection: collection, uniqueId: uniqueId, transaction: transaction),
+                  shouldIndexModel(model),
+                  let content = AnySearchIndexer.indexContent(object: model, transaction: transaction.asAnyRead),
+                  let snippet = matchSnippet(forUnindexedContent: content, queryTerms: queryTerms) else {
+                continue
+            }
+
+            block(model, snippet, &stop)
+            resultCount += 1
+            guard !stop.boolValue, resultCount < maxResults else {
+                return
+            }
+        }
     }
 
 }
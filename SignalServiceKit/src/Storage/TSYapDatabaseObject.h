@@ -73,6 +73,12 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)anyWillRemoveWithTransaction:(SDSAnyWriteTransaction *)transaction;
 - (void)anyDidRemoveWithTransaction:(SDSAnyWriteTransaction *)transaction;
 
+// Called once per batch by SDSModel.anyInsert(batch:) in place of
+// anyDidInsertWithTransaction:. By default this calls
+// anyDidInsertWithTransaction: on each model; subclasses can
+// override it to coalesce work such as cache updates.
++ (void)anyDidInsertBatch:(NSArray<TSYapDatabaseObject *> *)models transaction:(SDSAnyWriteTransaction *)transaction;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -123,6 +123,13 @@ NS_ASSUME_NONNULL_BEGIN
     // Do nothing.
 }
 
++ (void)anyDidInsertBatch:(NSArray<TSYapDatabaseObject *> *)models transaction:(SDSAnyWriteTransaction *)transaction
+{
+    for (TSYapDatabaseObject *model in models) {
+        [model anyDidInsertWithTransaction:transaction];
+    }
+}
+
 - (NSString *)transactionFinalizationKey
 {
     return [NSString stringWithFormat:@"%@.%@", self.class.collection, self.uniqueId];
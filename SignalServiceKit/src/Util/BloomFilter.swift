@@ -0,0 +1,92 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+// A compact, probabilistic set of strings.
+//
+// `contains()` never returns false for a string that was inserted, but may
+// return true for a string that wasn't. It should only be used where a
+// false positive is harmless, e.g. to decide which data to keep.
+//
+// The hash functions are seeded per process, so filters must not be
+// persisted.
+@objc
+public class BloomFilter: NSObject {
+
+    private var words: [UInt64]
+    private let bitCount: UInt64
+    private let hashCount: Int
+
+    @objc
+    public private(set) var count: Int = 0
+
+    @objc
+    public convenience init(expectedCount: Int) {
+        self.init(expectedCount: expectedCount, falsePositiveRate: 0.001)
+    }
+
+    public init(expectedCount: Int, falsePositiveRate: Double) {
+        owsAssertDebug(falsePositiveRate > 0 && falsePositiveRate < 1)
+
+        // m = -n * ln(p) / ln(2)^2, k = m / n * ln(2)
+        let expectedCount = Double(max(expectedCount, 1))
+        let bitCount = max(64, Int(ceil(-expectedCount * log(falsePositiveRate) / (M_LN2 * M_LN2))))
+        let wordCount = (bitCount + 63) / 64
+        self.words = Array(repeating: 0, count: wordCount)
+        self.bitCount = UInt64(wordCount * 64)
+        self.hashCount = max(1, Int(round(Double(self.bitCount) / expectedCount * M_LN2)))
+
+        super.init()
+    }
+
+    // The size of the filter, in bytes.
+    @objc
+    public var byteCount: Int {
+        words.count * MemoryLayout<UInt64>.size
+    }
+
+    // Uses double hashing to derive the bit positions from two hashes.
+    private func forEachBitIndex(_ element: String, block: (Int, UInt64) -> Void) {
+        var hasher = Hasher()
+        hasher.combine(element)
+        let hash1 = UInt64(bitPattern: Int64(hasher.finalize()))
+        hasher = Hasher()
+        hasher.combine(hash1)
+        hasher.combine(element)
+        // The step must be non-zero.
+        let hash2 = UInt64(bitPattern: Int64(hasher.finalize())) | 1
+
+        for index in 0..<UInt64(hashCount) {
+            let bitIndex = (hash1 &+ index &* hash2) % bitCount
+            block(Int(bitIndex / 64), 1 << (bitIndex % 64))
+        }
+    }
+
+    @objc
+    public func insert(_ element: String) {
+        forEachBitIndex(element) { wordIndex, mask in
+            words[wordIndex] |= mask
+        }
+        count += 1
+    }
+
+    @objc
+    public func insertAll(_ elements: [String]) {
+        for element in elements {
+            insert(element)
+        }
+    }
+
+    @objc
+    public func contains(_ element: String) -> Bool {
+        var result = true
+        forEachBitIndex(element) { wordIndex, mask in
+            if words[wordIndex] & mask == 0 {
+                result = false
+            }
+        }
+        return result
+    }
+}
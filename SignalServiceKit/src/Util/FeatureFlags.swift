@@ -89,6 +89,10 @@ public class FeatureFlags: BaseFlags {
     @objc
     public static let complainAboutSlowDBWrites = true
 
+    // Index messages for full-text search off the write path.
+    @objc
+    public static let deferredMessageIndexing = build.includes(.beta)
+
     // Don't consult this flags; consult RemoteConfig.usernames.
     static let usernamesSupported = build.includes(.qa)
 
@@ -239,6 +243,9 @@ public class DebugFlags: BaseFlags {
     @objc
     public static let logSQLQueries = build.includes(.dev) && !reduceLogChatter
 
+    @objc
+    public static let logSQLStatistics = build.includes(.qa)
+
     @objc
     public static let groupsV2IgnoreCapability = false
 
@@ -75,6 +75,11 @@ public protocol JobQueue: DurableOperationDelegate, Dependencies {
     func workStep()
     func defaultSetup()
 
+    /// The maximum number of ready jobs started by each `workStep()`, in a single
+    /// write transaction. Jobs are always started in the order they were added,
+    /// so jobs which share an operation queue still run in order.
+    var maxJobsPerWorkStep: Int { get }
+
     // MARK: Required
 
     var runningOperations: AtomicArray<DurableOperationType> { get set }
@@ -119,6 +124,10 @@ public extension JobQueue {
         }
     }
 
+    var maxJobsPerWorkStep: Int {
+        return 1
+    }
+
     func hasPendingJobs(transaction: SDSAnyReadTransaction) -> Bool {
         return nil != finder.getNextReady(label: self.jobRecordLabel, transaction: transaction)
     }
@@ -158,42 +167,51 @@ public extension JobQueue {
         }
 
         self.databaseStorage.write { transaction in
-            guard let nextJob: JobRecordType = self.finder.getNextReady(label: self.jobRecordLabel, transaction: transaction) else {
+            let readyJobs = self.finder.getNextReady(label: self.jobRecordLabel,
+                                                     limit: self.maxJobsPerWorkStep,
+                                                     transaction: transaction)
+            guard !readyJobs.isEmpty else {
                 Logger.verbose("nothing left to enqueue")
                 self.didFlushQueue(transaction: transaction)
                 return
             }
 
-            do {
-                try nextJob.saveAsStarted(transaction: transaction)
+            for nextJob in readyJobs {
+                self.startJob(nextJob, transaction: transaction)
+            }
+
+            DispatchQueue.global().async {
+                self.workStep()
+            }
+        }
+    }
 
-                let operationQueue = self.operationQueue(jobRecord: nextJob)
-                let durableOperation = try self.buildOperation(jobRecord: nextJob, transaction: transaction)
+    private func startJob(_ nextJob: JobRecordType, transaction: SDSAnyWriteTransaction) {
+        do {
+            try nextJob.saveAsStarted(transaction: transaction)
 
-                durableOperation.durableOperationDelegate = self as? Self.DurableOperationType.DurableOperationDelegateType
-                assert(durableOperation.durableOperationDelegate != nil)
+            let operationQueue = self.operationQueue(jobRecord: nextJob)
+            let durableOperation = try self.buildOperation(jobRecord: nextJob, transaction: transaction)
 
-                let remainingRetries = self.remainingRetries(durableOperation: durableOperation)
-                durableOperation.remainingRetries = remainingRetries
+            durableOperation.durableOperationDelegate = self as? Self.DurableOperationType.DurableOperationDelegateType
+            assert(durableOperation.durableOperationDelegate != nil)
 
-                self.runningOperations.append(durableOperation)
+            let remainingRetries = self.remainingRetries(durableOperation: durableOperation)
+            durableOperation.remainingRetries = remainingRetries
 
-                Logger.debug("adding operation: \(durableOperation) with remainingRetries: \(remainingRetries)")
-                operationQueue.addOperation(durableOperation.operation)
-            } catch JobError.assertionFailure(let description) {
-                owsFailDebug("assertion failure: \(description)")
-                nextJob.saveAsPermanentlyFailed(transaction: transaction)
-            } catch JobError.obsolete(let description) {
-                // TODO is this even worthwhile to have obsolete state? Should we just delete the task outright?
-                Logger.verbose("marking obsolete task as such. description:\(description)")
-                nextJob.saveAsObsolete(transaction: transaction)
-            } catch {
-                owsFailDebug("unexpected error")
-            }
+            self.runningOperations.append(durableOperation)
 
-            DispatchQueue.global().async {
-                self.workStep()
-            }
+            Logger.debug("adding operation: \(durableOperation) with remainingRetries: \(remainingRetries)")
+            operationQueue.addOperation(durableOperation.operation)
+        } catch JobError.assertionFailure(let description) {
+            owsFailDebug("assertion failure: \(description)")
+            nextJob.saveAsPermanentlyFailed(transaction: transaction)
+        } catch JobError.obsolete(let description) {
+            // TODO is this even worthwhile to have obsolete state? Should we just delete the task outright?
+            Logger.verbose("marking obsolete task as such. description:\(description)")
+            nextJob.saveAsObsolete(transaction: transaction)
+        } catch {
+            owsFailDebug("unexpected error")
         }
     }
 
@@ -323,6 +341,43 @@ public extension JobQueue {
     }
 }
 
+// MARK: -
+
+/// Serial operation queues keyed by "lane", e.g. by thread.
+///
+/// Operations in different lanes run concurrently; operations in the same
+/// lane run one at a time, in the order they were added.
+public class JobQueueLanes {
+    private let name: String
+
+    private let lock = UnfairLock()
+    // This should only be accessed with lock acquired.
+    private var operationQueues = [String: OperationQueue]()
+
+    public init(name: String) {
+        self.name = name
+    }
+
+    public func operationQueue(forLane lane: String) -> OperationQueue {
+        lock.withLock {
+            if let operationQueue = operationQueues[lane] {
+                return operationQueue
+            }
+            let operationQueue = OperationQueue()
+            operationQueue.name = "\(name):\(lane)"
+            operationQueue.maxConcurrentOperationCount = 1
+            operationQueues[lane] = operationQueue
+            return operationQueue
+        }
+    }
+
+    public func existingOperationQueue(forLane lane: String) -> OperationQueue? {
+        lock.withLock { operationQueues[lane] }
+    }
+}
+
+// MARK: -
+
 public protocol JobRecordFinder {
     associatedtype ReadTransaction
     associatedtype JobRecordType: SSKJobRecord
@@ -343,6 +398,17 @@ extension JobRecordFinder {
         return result
     }
 
+    public func getNextReady(label: String, limit: Int, transaction: ReadTransaction) -> [JobRecordType] {
+        var result: [JobRecordType] = []
+        self.enumerateJobRecords(label: label, status: .ready, transaction: transaction) { jobRecord, stopPointer in
+            result.append(jobRecord)
+            if result.count >= limit {
+                stopPointer.pointee = true
+            }
+        }
+        return result
+    }
+
     public func allRecords(label: String, status: SSKJobRecordStatus, transaction: ReadTransaction) -> [JobRecordType] {
         var result: [JobRecordType] = []
         self.enumerateJobRecords(label: label, status: status, transaction: transaction) { jobRecord, _ in
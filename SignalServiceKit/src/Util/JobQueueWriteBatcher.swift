@@ -0,0 +1,101 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+
+/// Coalesces the job status writes of concurrently running durable
+/// operations (e.g. sends in different lanes) into shared write transactions.
+///
+/// `write()` blocks until the caller's block has been committed, so
+/// callers see the same durability and ordering as `databaseStorage.write`.
+/// Writes are committed on a dedicated serial queue; callers which arrive
+/// while a transaction is in progress are committed together in the next
+/// transaction.
+public class JobQueueWriteBatcher: Dependencies {
+
+    public static let shared = JobQueueWriteBatcher()
+
+    public typealias WriteBlock = (SDSAnyWriteTransaction) -> Void
+
+    private struct PendingWrite {
+        let block: WriteBlock
+        let semaphore: DispatchSemaphore
+    }
+
+    // Bounds the size of each write transaction.
+    private let maxBatchSize: Int
+
+    // Batches are committed serially on this queue, rather than on the
+    // callers' threads, which are all blocked waiting for their writes.
+    private let flushQueue = DispatchQueue(label: "org.signal.job-queue-write-batcher")
+
+    private let lock = UnfairLock()
+    // These should only be accessed with lock acquired.
+    private var pendingWrites = [PendingWrite]()
+    private var isFlushing = false
+
+    #if TESTABLE_BUILD
+    public let writeCount = AtomicValue<Int>(0)
+    public let transactionCount = AtomicValue<Int>(0)
+    #endif
+
+    public init(maxBatchSize: Int = 64) {
+        owsAssertDebug(maxBatchSize > 0)
+
+        self.maxBatchSize = maxBatchSize
+    }
+
+    public func write(_ block: @escaping WriteBlock) {
+        let semaphore = DispatchSemaphore(value: 0)
+        let shouldFlush: Bool = lock.withLock {
+            pendingWrites.append(PendingWrite(block: block, semaphore: semaphore))
+            guard !isFlushing else {
+                return false
+            }
+            isFlushing = true
+            return true
+        }
+
+        if shouldFlush {
+            flushQueue.async {
+                self.flushPendingWrites()
+            }
+        }
+        semaphore.wait()
+    }
+
+    // Drains pending writes in batches until none remain.
+    private func flushPendingWrites() {
+        assertOnQueue(flushQueue)
+
+        while true {
+            let batch: [PendingWrite] = lock.withLock {
+                let batch = Array(pendingWrites.prefix(maxBatchSize))
+                pendingWrites.removeFirst(batch.count)
+                if batch.isEmpty {
+                    isFlushing = false
+                }
+                return batch
+            }
+            guard !batch.isEmpty else {
+                return
+            }
+
+            databaseStorage.write { transaction in
+                for pendingWrite in batch {
+                    pendingWrite.block(transaction)
+                }
+            }
+
+            #if TESTABLE_BUILD
+            writeCount.map { $0 + batch.count }
+            transactionCount.map { $0 + 1 }
+            #endif
+
+            for pendingWrite in batch {
+                pendingWrite.semaphore.signal()
+            }
+        }
+    }
+}
@@ -1,5 +1,5 @@
 //
-//  Copyright (c) 2019 Open Whisper Systems. All rights reserved.
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
 //
 
 @objc
@@ -12,6 +12,11 @@ public class AnyLRUCache: NSObject {
         backingCache = LRUCache(maxSize: maxSize)
     }
 
+    @objc
+    public init(maxSize: Int, maxCost: Int) {
+        backingCache = LRUCache(maxSize: maxSize, maxCost: maxCost)
+    }
+
     @objc
     public func get(key: NSObject) -> NSObject? {
         return self.backingCache.get(key: key)
@@ -22,22 +27,88 @@ public class AnyLRUCache: NSObject {
         self.backingCache.set(key: key, value: value)
     }
 
+    @objc
+    public func set(key: NSObject, value: NSObject, cost: Int) {
+        self.backingCache.set(key: key, value: value, cost: cost)
+    }
+
+    @objc
+    public func remove(key: NSObject) {
+        self.backingCache.remove(key: key)
+    }
+
     @objc
     public func clear() {
         self.backingCache.clear()
     }
 }
 
-// A simple LRU cache bounded by the number of entries.
+// MARK: -
+
+// An LRU cache bounded by the number of entries and, optionally,
+// by the total "cost" (e.g. byte size) of its values.
+//
+// Recency is tracked with an intrusive doubly-linked list whose
+// nodes are indexed by a dictionary, so get(), set() and remove()
+// are all O(1).
+//
+// On memory warnings and when the app enters the background, the
+// cache is trimmed down to a fraction of its limits (evicting the
+// least recently used entries first) rather than being emptied.
+//
+// This class is not thread-safe.
 public class LRUCache<KeyType: Hashable & Equatable, ValueType> {
 
-    private var cacheMap: [KeyType: ValueType] = [:]
-    private var cacheOrder: [KeyType] = []
+    private final class Node {
+        let key: KeyType
+        var value: ValueType
+        var cost: Int
+
+        // The "newer" neighbor retains its "older" neighbor;
+        // the reverse link is weak to avoid retain cycles.
+        var older: Node?
+        weak var newer: Node?
+
+        init(key: KeyType, value: ValueType, cost: Int) {
+            self.key = key
+            self.value = value
+            self.cost = cost
+        }
+    }
+
+    private var nodeMap: [KeyType: Node] = [:]
+    // The most recently used entry.
+    private var newest: Node?
+    // The least recently used entry.
+    private weak var oldest: Node?
+
     private let maxSize: Int
+    // If zero, the cache is only bounded by the number of entries.
+    private let maxCost: Int
+    public private(set) var totalCost: Int = 0
+
+    // When trimming in response to memory pressure or backgrounding,
+    // we retain this fraction of the cache's limits.
+    private let trimFactorOnMemoryWarning: Double
+    private let trimFactorOnBackground: Double
+
+    public var count: Int {
+        return nodeMap.count
+    }
+
+    public init(maxSize: Int,
+                maxCost: Int = 0,
+                trimFactorOnMemoryWarning: Double = 0,
+                trimFactorOnBackground: Double = 0.5) {
+        owsAssertDebug(maxSize > 0)
+        owsAssertDebug(maxCost >= 0)
+        owsAssertDebug(trimFactorOnMemoryWarning >= 0 && trimFactorOnMemoryWarning <= 1)
+        owsAssertDebug(trimFactorOnBackground >= 0 && trimFactorOnBackground <= 1)
 
-    @objc
-    public init(maxSize: Int) {
         self.maxSize = maxSize
+        self.maxCost = maxCost
+        self.trimFactorOnMemoryWarning = trimFactorOnMemoryWarning
+        self.trimFactorOnBackground = trimFactorOnBackground
 
         NotificationCenter.default.addObserver(self,
                                                selector: #selector(didReceiveMemoryWarning),
@@ -51,55 +122,153 @@ public class LRUCache<KeyType: Hashable & Equatable, ValueType> {
 
     deinit {
         NotificationCenter.default.removeObserver(self)
+
+        // Release the nodes iteratively; see clear().
+        clear()
     }
 
     @objc func didEnterBackground() {
         AssertIsOnMainThread()
 
-        clear()
+        trim(factor: trimFactorOnBackground)
     }
 
     @objc func didReceiveMemoryWarning() {
         AssertIsOnMainThread()
 
-        clear()
+        trim(factor: trimFactorOnMemoryWarning)
     }
 
-    private func updateCacheOrder(key: KeyType) {
-        cacheOrder = cacheOrder.filter { $0 != key }
-        cacheOrder.append(key)
+    private func trim(factor: Double) {
+        guard factor > 0 else {
+            clear()
+            return
+        }
+        trim(toCount: Int(Double(maxSize) * factor),
+             cost: Int(Double(maxCost) * factor))
+    }
+
+    // MARK: - Linked List
+
+    private func unlink(_ node: Node) {
+        let older = node.older
+        let newer = node.newer
+
+        if let newer = newer {
+            newer.older = older
+        } else {
+            owsAssertDebug(newest === node)
+            newest = older
+        }
+        if let older = older {
+            older.newer = newer
+        } else {
+            owsAssertDebug(oldest === node)
+            oldest = newer
+        }
+
+        node.older = nil
+        node.newer = nil
+    }
+
+    private func pushNewest(_ node: Node) {
+        owsAssertDebug(node.older == nil && node.newer == nil)
+
+        node.older = newest
+        newest?.newer = node
+        newest = node
+        if oldest == nil {
+            oldest = node
+        }
+    }
+
+    @discardableResult
+    private func evictOldest() -> Bool {
+        guard let node = oldest else {
+            owsFailDebug("Cache ordering unexpectedly empty")
+            return false
+        }
+        unlink(node)
+        nodeMap.removeValue(forKey: node.key)
+        totalCost -= node.cost
+        return true
     }
 
+    // MARK: -
+
     public func get(key: KeyType) -> ValueType? {
-        guard let value = cacheMap[key] else {
+        guard let node = nodeMap[key] else {
             // Miss
             return nil
         }
 
         // Hit
-        updateCacheOrder(key: key)
+        if newest !== node {
+            unlink(node)
+            pushNewest(node)
+        }
 
-        return value
+        return node.value
     }
 
     public func set(key: KeyType, value: ValueType) {
-        cacheMap[key] = value
+        set(key: key, value: value, cost: 0)
+    }
 
-        updateCacheOrder(key: key)
+    public func set(key: KeyType, value: ValueType, cost: Int) {
+        owsAssertDebug(cost >= 0)
 
-        while cacheOrder.count > maxSize {
-            guard let staleKey = cacheOrder.first else {
-                owsFailDebug("Cache ordering unexpectedly empty")
-                return
+        if let node = nodeMap[key] {
+            totalCost += cost - node.cost
+            node.value = value
+            node.cost = cost
+            if newest !== node {
+                unlink(node)
+                pushNewest(node)
             }
-            cacheOrder.removeFirst()
-            cacheMap.removeValue(forKey: staleKey)
+        } else {
+            let node = Node(key: key, value: value, cost: cost)
+            nodeMap[key] = node
+            totalCost += cost
+            pushNewest(node)
+        }
+
+        trim(toCount: maxSize, cost: maxCost)
+    }
+
+    public func remove(key: KeyType) {
+        guard let node = nodeMap.removeValue(forKey: key) else {
+            return
+        }
+        unlink(node)
+        totalCost -= node.cost
+    }
+
+    // Evicts least recently used entries until the cache holds no more
+    // than `count` entries and (if cost-bounded) no more than `cost`,
+    // which defaults to the cache's cost limit.
+    public func trim(toCount count: Int, cost: Int? = nil) {
+        while nodeMap.count > count {
+            guard evictOldest() else { return }
+        }
+        guard maxCost > 0 else {
+            return
+        }
+        let cost = cost ?? maxCost
+        while totalCost > cost, !nodeMap.isEmpty {
+            guard evictOldest() else { return }
         }
     }
 
-    @objc
     public func clear() {
-        cacheMap.removeAll()
-        cacheOrder.removeAll()
+        // Unlink iteratively; releasing a long chain of
+        // strongly-linked nodes recursively could overflow the stack.
+        while let node = newest {
+            newest = node.older
+            node.older = nil
+        }
+        oldest = nil
+        nodeMap.removeAll()
+        totalCost = 0
     }
 }
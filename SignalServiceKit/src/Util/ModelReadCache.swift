@@ -11,13 +11,26 @@ protocol ModelCache {
 
 // MARK: -
 
-private struct ModelReadCacheStats {
+class ModelReadCacheStats {
     static let shouldLogCacheStats = false
 
     let cacheHitCount = AtomicUInt()
     let cacheReadCount = AtomicUInt()
+    // Cache hits that returned the cached instance without copying.
+    let sharedHitCount = AtomicUInt()
 
-    func recordCacheHit(_ cache: ModelCache) {
+    // Time spent copying cached values on cache hits vs.
+    // reading values from the database on cache misses.
+    private let durationLock = UnfairLock()
+    private var copyCount: UInt = 0
+    private var copyDuration: TimeInterval = 0
+    private var databaseReadCount: UInt = 0
+    private var databaseReadDuration: TimeInterval = 0
+
+    func recordCacheHit(_ cache: ModelCache, wasShared: Bool) {
+        if wasShared {
+            sharedHitCount.increment()
+        }
         let hitCount = cacheHitCount.increment()
         let totalCount = cacheReadCount.increment()
         logStats(hitCount: hitCount, totalCount: totalCount, cache: cache)
@@ -29,10 +42,45 @@ private struct ModelReadCacheStats {
         logStats(hitCount: hitCount, totalCount: totalCount, cache: cache)
     }
 
+    func recordCopy(duration: TimeInterval) {
+        durationLock.withLock {
+            copyCount += 1
+            copyDuration += duration
+        }
+    }
+
+    func recordDatabaseRead(duration: TimeInterval) {
+        durationLock.withLock {
+            databaseReadCount += 1
+            databaseReadDuration += duration
+        }
+    }
+
+    struct Snapshot {
+        let hitCount: UInt
+        let readCount: UInt
+        let sharedHitCount: UInt
+        let copyCount: UInt
+    }
+
+    var snapshot: Snapshot {
+        durationLock.withLock {
+            Snapshot(hitCount: cacheHitCount.get(),
+                     readCount: cacheReadCount.get(),
+                     sharedHitCount: sharedHitCount.get(),
+                     copyCount: copyCount)
+        }
+    }
+
     private func logStats(hitCount: UInt, totalCount: UInt, cache: ModelCache) {
         if Self.shouldLogCacheStats, totalCount > 0, totalCount % 100 == 0 {
             let percentage = 100 * Double(hitCount) / Double(totalCount)
-            Logger.verbose("---- \(cache.logName): \(percentage)% \(totalCount)")
+            Logger.verbose("---- \(cache.logName): \(percentage)% \(totalCount), shared hits: \(sharedHitCount.get())")
+            durationLock.withLock {
+                let copyMs = copyDuration * 1000
+                let readMs = databaseReadDuration * 1000
+                Logger.verbose("---- \(cache.logName): copies: \(copyCount) in \(String(format: "%.1f", copyMs))ms, db reads: \(databaseReadCount) in \(String(format: "%.1f", readMs))ms")
+            }
         }
     }
 }
@@ -185,18 +233,39 @@ private class ModelReadCache<KeyType: AnyObject & Hashable, ValueType: BaseModel
         AssertIsOnMainThread()
         assert(mode == .read)
 
-        evacuateCache()
+        // If we know what the other process changed, we only
+        // need to evacuate the affected values.
+        let evacuate: () -> Void
+        if let databaseChanges = SDSDatabaseStorage.crossProcessDatabaseChanges(notification: notification) {
+            evacuate = {
+                self.adapter.uiReadEvacuation(databaseChanges: databaseChanges, nsCache: self.nsCache)
+            }
+        } else {
+            evacuate = {
+                self.evacuateCache()
+            }
+        }
+
+        evacuate()
 
         DispatchQueue.global().async {
             self.performSync {
-                self.evacuateCache()
+                evacuate()
             }
         }
     }
 
     // This method should only be called within performSync().
     private func readValue(for cacheKey: ModelCacheKey<KeyType>, transaction: SDSAnyReadTransaction) -> ValueType? {
-        if let value = adapter.read(key: cacheKey.key, transaction: transaction) {
+        #if TESTABLE_BUILD
+        let startTime = CACurrentMediaTime()
+        let databaseValue = adapter.read(key: cacheKey.key, transaction: transaction)
+        cacheStats.recordDatabaseRead(duration: CACurrentMediaTime() - startTime)
+        #else
+        let databaseValue = adapter.read(key: cacheKey.key, transaction: transaction)
+        #endif
+
+        if let value = databaseValue {
             #if TESTABLE_BUILD
             if !isExcluded(cacheKey: cacheKey, transaction: transaction),
                 canUseCache(cacheKey: cacheKey, transaction: transaction) {
@@ -244,7 +313,17 @@ private class ModelReadCache<KeyType: AnyObject & Hashable, ValueType: BaseModel
         return readFromCache(cacheKey: cacheKey)
     }
 
-    func getValue(for cacheKey: ModelCacheKey<KeyType>, transaction: SDSAnyReadTransaction, returnNilOnCacheMiss: Bool = false) -> ValueType? {
+    // By default, cache hits return a copy of the cached model so that
+    // callers can't mutate the shared instance.
+    //
+    // If shouldCopy is false, the cached instance itself is returned.
+    // This avoids any allocation on cache hits, but callers MUST treat
+    // the value as immutable: they can read its properties, but must not
+    // modify it, write it to the database or retain it beyond the read.
+    func getValue(for cacheKey: ModelCacheKey<KeyType>,
+                  transaction: SDSAnyReadTransaction,
+                  returnNilOnCacheMiss: Bool = false,
+                  shouldCopy: Bool = true) -> ValueType? {
         // This can be used to verify that cached values exactly
         // align with database contents.
         #if TESTABLE_BUILD
@@ -266,12 +345,13 @@ private class ModelReadCache<KeyType: AnyObject & Hashable, ValueType: BaseModel
             if let cachedValue = self.cachedValue(for: cacheKey, transaction: transaction) {
 
                 #if TESTABLE_BUILD
-                cacheStats.recordCacheHit(self)
+                cacheStats.recordCacheHit(self, wasShared: !shouldCopy && cachedValue.value != nil)
                 #endif
 
                 if let value = cachedValue.value {
-                    // Return a copy of the model.
-                    let cachedValue = self.copyValue(value)
+                    // Return a copy of the model, unless the caller
+                    // has promised not to mutate it.
+                    let cachedValue = shouldCopy ? self.copyValue(value) : value
 
                     #if TESTABLE_BUILD
                     if shouldCheckValues {
@@ -319,9 +399,11 @@ private class ModelReadCache<KeyType: AnyObject & Hashable, ValueType: BaseModel
             // This is a hot code path, so only bench in debug builds.
             let cachedValue: ValueType
             #if TESTABLE_BUILD
+            let startTime = CACurrentMediaTime()
             cachedValue = try Bench(title: "Slow copy: \(logName)", logIfLongerThan: 0.001, logInProduction: false) {
                 try adapter.copy(value: value)
             }
+            cacheStats.recordCopy(duration: CACurrentMediaTime() - startTime)
             #else
             cachedValue = try adapter.copy(value: value)
             #endif
@@ -344,34 +426,52 @@ private class ModelReadCache<KeyType: AnyObject & Hashable, ValueType: BaseModel
         updateCacheForWrite(cacheKey: cacheKey, value: value, transaction: transaction)
     }
 
+    func didInsertOrUpdate(values: [ValueType], transaction: SDSAnyWriteTransaction) {
+        assert(mode == .read)
+        let writes = values.map { value in
+            (cacheKey: adapter.cacheKey(forValue: value), value: Optional(value))
+        }
+        updateCacheForWrites(writes, transaction: transaction)
+    }
+
     private func updateCacheForWrite(cacheKey: ModelCacheKey<KeyType>, value: ValueType?, transaction: SDSAnyWriteTransaction) {
-        guard canUseCache(cacheKey: cacheKey, transaction: transaction) else {
+        updateCacheForWrites([(cacheKey: cacheKey, value: value)], transaction: transaction)
+    }
+
+    private func updateCacheForWrites(_ writes: [(cacheKey: ModelCacheKey<KeyType>, value: ValueType?)],
+                                      transaction: SDSAnyWriteTransaction) {
+        let writes = writes.filter { canUseCache(cacheKey: $0.cacheKey, transaction: transaction) }
+        guard !writes.isEmpty else {
             return
         }
 
-        // Exclude this key from being used in the cache
+        // Exclude these keys from being used in the cache
         // until the write transaction has committed.
         performSync {
-            // Update the cache to reflect the new value.
-            // The cache won't be used during the exclusion,
-            // so we could also update this when we remove
-            // the exclusion.
-            writeToCache(cacheKey: cacheKey, value: value)
-
-            if self.mode == .read {
-                // Protect the cache from being corrupted by reads
-                // by excluding the key until the write transaction
-                // commits.
-                addExclusion(for: cacheKey)
+            for write in writes {
+                // Update the cache to reflect the new value.
+                // The cache won't be used during the exclusion,
+                // so we could also update this when we remove
+                // the exclusion.
+                writeToCache(cacheKey: write.cacheKey, value: write.value)
+
+                if self.mode == .read {
+                    // Protect the cache from being corrupted by reads
+                    // by excluding the key until the write transaction
+                    // commits.
+                    addExclusion(for: write.cacheKey)
+                }
             }
         }
 
         if mode == .read {
             // Once the write transaction has completed, it is safe
-            // to use the cache for this key again for .read caches.
+            // to use the cache for these keys again for .read caches.
             transaction.addSyncCompletion {
                 self.performSync {
-                    self.removeExclusion(for: cacheKey)
+                    for write in writes {
+                        self.removeExclusion(for: write.cacheKey)
+                    }
                 }
             }
         }
@@ -574,14 +674,22 @@ private class ModelReadCacheWrapper<KeyType: AnyObject & Hashable, ValueType: Ba
         readCache = ModelReadCache(mode: .read, adapter: adapter)
     }
 
-    func getValue(for cacheKey: ModelCacheKey<KeyType>, transaction: SDSAnyReadTransaction) -> ValueType? {
+    func getValue(for cacheKey: ModelCacheKey<KeyType>,
+                  transaction: SDSAnyReadTransaction,
+                  shouldCopy: Bool = true) -> ValueType? {
         if transaction.isUIRead {
             assert(Thread.isMainThread)
         }
         let cache = (transaction.isUIRead ? uiReadCache : readCache)
-        return cache.getValue(for: cacheKey, transaction: transaction)
+        return cache.getValue(for: cacheKey, transaction: transaction, shouldCopy: shouldCopy)
     }
 
+    #if TESTABLE_BUILD
+    var readCacheStats: ModelReadCacheStats.Snapshot {
+        readCache.cacheStats.snapshot
+    }
+    #endif
+
     func getValuesIfInCache(for keys: [KeyType], transaction: SDSAnyReadTransaction) -> [KeyType: ValueType] {
         if transaction.isUIRead {
             assert(Thread.isMainThread)
@@ -600,6 +708,11 @@ private class ModelReadCacheWrapper<KeyType: AnyObject & Hashable, ValueType: Ba
         readCache.didInsertOrUpdate(value: value, transaction: transaction)
     }
 
+    func didInsertOrUpdate(values: [ValueType], transaction: SDSAnyWriteTransaction) {
+        // Only update readCache to reflect writes.
+        readCache.didInsertOrUpdate(values: values, transaction: transaction)
+    }
+
     func didRead(value: ValueType, transaction: SDSAnyReadTransaction) {
         if transaction.isUIRead {
             uiReadCache.didRead(value: value, transaction: transaction)
@@ -663,6 +776,22 @@ public class UserProfileReadCache: NSObject {
         return cache.getValue(for: cacheKey, transaction: transaction)
     }
 
+    // Returns the cached instance without copying it; see
+    // ModelReadCache.getValue(). The profile must not be mutated.
+    @objc
+    public func getUserProfileForReadOnlyAccess(address: SignalServiceAddress,
+                                                transaction: SDSAnyReadTransaction) -> OWSUserProfile? {
+        let address = OWSUserProfile.resolve(address)
+        let cacheKey = adapter.cacheKey(forKey: address)
+        return cache.getValue(for: cacheKey, transaction: transaction, shouldCopy: false)
+    }
+
+    #if TESTABLE_BUILD
+    var readCacheStats: ModelReadCacheStats.Snapshot {
+        cache.readCacheStats
+    }
+    #endif
+
     @objc(didRemoveUserProfile:transaction:)
     public func didRemove(userProfile: OWSUserProfile, transaction: SDSAnyWriteTransaction) {
         cache.didRemove(value: userProfile, transaction: transaction)
@@ -741,6 +870,11 @@ public class SignalAccountReadCache: NSObject {
         cache.didInsertOrUpdate(value: signalAccount, transaction: transaction)
     }
 
+    @objc(didInsertOrUpdateSignalAccounts:transaction:)
+    public func didInsertOrUpdate(signalAccounts: [SignalAccount], transaction: SDSAnyWriteTransaction) {
+        cache.didInsertOrUpdate(values: signalAccounts, transaction: transaction)
+    }
+
     @objc(didReadSignalAccount:transaction:)
     public func didReadSignalAccount(_ signalAccount: SignalAccount, transaction: SDSAnyReadTransaction) {
         cache.didRead(value: signalAccount, transaction: transaction)
@@ -809,6 +943,11 @@ public class SignalRecipientReadCache: NSObject {
         cache.didInsertOrUpdate(value: signalRecipient, transaction: transaction)
     }
 
+    @objc(didInsertOrUpdateSignalRecipients:transaction:)
+    public func didInsertOrUpdate(signalRecipients: [SignalRecipient], transaction: SDSAnyWriteTransaction) {
+        cache.didInsertOrUpdate(values: signalRecipients, transaction: transaction)
+    }
+
     @objc(didReadSignalRecipient:transaction:)
     public func didReadSignalRecipient(_ signalRecipient: SignalRecipient, transaction: SDSAnyReadTransaction) {
         cache.didRead(value: signalRecipient, transaction: transaction)
@@ -0,0 +1,204 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+class AttachmentDownloadSchedulerTest: SSKBaseTestSwift {
+
+    func testPriorityOrder() {
+        let scheduler = AttachmentDownloadScheduler<String>()
+        scheduler.enqueue("backfill1", attachmentId: "backfill1", priority: .backfill)
+        scheduler.enqueue("media1", attachmentId: "media1", priority: .media)
+        scheduler.enqueue("thumbnail1", attachmentId: "thumbnail1", priority: .thumbnail)
+        scheduler.enqueue("media2", attachmentId: "media2", priority: .media)
+        scheduler.enqueue("backfill2", attachmentId: "backfill2", priority: .backfill)
+
+        var dequeued = [String]()
+        while let job = scheduler.dequeue(activeCount: 0) {
+            dequeued.append(job)
+        }
+        XCTAssertEqual(dequeued, ["thumbnail1", "media1", "media2", "backfill1", "backfill2"])
+        XCTAssertTrue(scheduler.isEmpty)
+    }
+
+    func testVisibleAttachments() {
+        let scheduler = AttachmentDownloadScheduler<String>()
+        for index in 0..<4 {
+            scheduler.enqueue("backfill\(index)", attachmentId: "backfill\(index)", priority: .backfill)
+        }
+        scheduler.enqueue("media", attachmentId: "media", priority: .media)
+
+        // Queued jobs are promoted when they become visible...
+        scheduler.setVisibleAttachmentIds(["backfill2"])
+        XCTAssertEqual(scheduler.priority(forAttachmentId: "backfill2"), .visible)
+        // ...and revert when they're no longer visible.
+        scheduler.setVisibleAttachmentIds(["backfill3"])
+        XCTAssertEqual(scheduler.priority(forAttachmentId: "backfill2"), .backfill)
+        XCTAssertEqual(scheduler.priority(forAttachmentId: "backfill3"), .visible)
+
+        // Jobs enqueued while visible are promoted.
+        scheduler.enqueue("late", attachmentId: "late", priority: .media)
+        scheduler.setVisibleAttachmentIds(["backfill3", "late"])
+
+        var dequeued = [String]()
+        while let job = scheduler.dequeue(activeCount: 0) {
+            dequeued.append(job)
+        }
+        XCTAssertEqual(dequeued, ["backfill3", "late", "media", "backfill0", "backfill1", "backfill2"])
+    }
+
+    func testReservedVisibleSlot() {
+        let scheduler = AttachmentDownloadScheduler<String>()
+        let limit = scheduler.concurrency.limit
+        scheduler.enqueue("media", attachmentId: "media", priority: .media)
+        scheduler.enqueue("visible", attachmentId: "visible", priority: .media)
+
+        XCTAssertNil(scheduler.dequeue(activeCount: limit))
+        scheduler.setVisibleAttachmentIds(["visible"])
+        XCTAssertEqual(scheduler.dequeue(activeCount: limit), "visible")
+        XCTAssertNil(scheduler.dequeue(activeCount: limit))
+        XCTAssertEqual(scheduler.dequeue(activeCount: limit - 1), "media")
+    }
+
+    // MARK: - Simulation
+
+    // A fake CDN which serves each connection at up to perConnectionBandwidth,
+    // sharing totalBandwidth between all active connections.
+    private struct FakeCDN {
+        let perConnectionBandwidth: Double
+        let totalBandwidth: Double
+
+        func bandwidth(connectionCount: Int) -> Double {
+            min(perConnectionBandwidth, totalBandwidth / Double(max(1, connectionCount)))
+        }
+    }
+
+    private struct SimulatedDownload {
+        let attachmentId: String
+        let byteCount: UInt64
+    }
+
+    private struct SimulationResult {
+        var completionTimes = [String: TimeInterval]()
+    }
+
+    // Runs the downloads to completion. dequeue() is consulted whenever a
+    // download completes or is enqueued, as in OWSAttachmentDownloads.
+    private func simulate(cdn: FakeCDN,
+                          dequeue: (_ activeCount: Int) -> SimulatedDownload?,
+                          didComplete: (SimulatedDownload, _ duration: TimeInterval, _ concurrentCount: Int) -> Void = { _, _, _ in }) -> SimulationResult {
+        var result = SimulationResult()
+        var now: TimeInterval = 0
+        var active = [(download: SimulatedDownload, startTime: TimeInterval, remainingBytes: Double)]()
+
+        func startDownloads() {
+            while let download = dequeue(active.count) {
+                active.append((download, now, Double(download.byteCount)))
+            }
+        }
+
+        startDownloads()
+        while !active.isEmpty {
+            let bandwidth = cdn.bandwidth(connectionCount: active.count)
+            let nextIndex = active.indices.min { active[$0].remainingBytes < active[$1].remainingBytes }!
+            let elapsed = active[nextIndex].remainingBytes / bandwidth
+            now += elapsed
+            for index in active.indices {
+                active[index].remainingBytes -= elapsed * bandwidth
+            }
+            let concurrentCount = active.count
+            let completed = active.remove(at: nextIndex)
+            result.completionTimes[completed.download.attachmentId] = now
+            didComplete(completed.download, now - completed.startTime, concurrentCount)
+            startDownloads()
+        }
+        return result
+    }
+
+    func testTimeToFirstVisibleImage() {
+        let cdn = FakeCDN(perConnectionBandwidth: 1_000_000, totalBandwidth: 4_000_000)
+
+        // A dozen videos are queued for backfill before the user opens
+        // the conversation, then a visible image is queued.
+        var downloads = (0..<12).map { SimulatedDownload(attachmentId: "video\($0)", byteCount: 10_000_000) }
+        let visibleImage = SimulatedDownload(attachmentId: "image", byteCount: 200_000)
+        downloads.append(visibleImage)
+
+        // The old behavior: a FIFO with 4 simultaneous downloads.
+        var fifo = downloads
+        let fifoResult = simulate(cdn: cdn) { activeCount in
+            guard activeCount < 4, !fifo.isEmpty else {
+                return nil
+            }
+            return fifo.removeFirst()
+        }
+
+        let scheduler = AttachmentDownloadScheduler<SimulatedDownload>()
+        for download in downloads.dropLast() {
+            scheduler.enqueue(download, attachmentId: download.attachmentId, priority: .backfill)
+        }
+        scheduler.enqueue(visibleImage, attachmentId: visibleImage.attachmentId, priority: .media)
+        scheduler.setVisibleAttachmentIds([visibleImage.attachmentId])
+        let schedulerResult = simulate(cdn: cdn) { activeCount in
+            scheduler.dequeue(activeCount: activeCount)
+        }
+
+        let fifoTime = fifoResult.completionTimes[visibleImage.attachmentId]!
+        let schedulerTime = schedulerResult.completionTimes[visibleImage.attachmentId]!
+        Logger.info("Time to first visible image; FIFO: \(fifoTime)s, scheduler: \(schedulerTime)s.")
+        XCTAssertLessThan(schedulerTime, 1)
+        XCTAssertLessThan(schedulerTime * 10, fifoTime)
+
+        // All downloads still complete.
+        XCTAssertEqual(schedulerResult.completionTimes.count, downloads.count)
+    }
+
+    func testAdaptiveConcurrency() {
+        // Each connection is throttled, but the CDN has room for more.
+        let cdn = FakeCDN(perConnectionBandwidth: 1_000_000, totalBandwidth: 6_000_000)
+
+        let scheduler = AttachmentDownloadScheduler<SimulatedDownload>()
+        for index in 0..<400 {
+            let download = SimulatedDownload(attachmentId: "download\(index)", byteCount: 1_000_000)
+            scheduler.enqueue(download, attachmentId: download.attachmentId, priority: .media)
+        }
+        let result = simulate(cdn: cdn,
+                              dequeue: { scheduler.dequeue(activeCount: $0) },
+                              didComplete: { download, duration, concurrentCount in
+                                scheduler.concurrency.didCompleteDownload(byteCount: download.byteCount,
+                                                                          duration: duration,
+                                                                          concurrentCount: concurrentCount)
+                              })
+        XCTAssertEqual(result.completionTimes.count, 400)
+
+        // The limit should have grown to saturate the CDN, without
+        // growing far beyond the point of diminishing returns.
+        let limit = scheduler.concurrency.limit
+        XCTAssertGreaterThanOrEqual(limit, 5)
+        XCTAssertLessThanOrEqual(limit, 8)
+    }
+
+    func testAdaptiveConcurrencyBackoff() {
+        let concurrency = AttachmentDownloadConcurrency()
+
+        // A congested network, where each additional download
+        // reduces the aggregate throughput.
+        func throughput(concurrentCount: Int) -> Double {
+            4_000_000 - Double(max(0, concurrentCount - AttachmentDownloadConcurrency.minLimit)) * 500_000
+        }
+        for _ in 0..<10 {
+            let concurrentCount = concurrency.limit
+            let byteCount: UInt64 = 1_000_000
+            let duration = Double(byteCount) * Double(concurrentCount) / throughput(concurrentCount: concurrentCount)
+            for _ in 0..<AttachmentDownloadConcurrency.windowSize {
+                concurrency.didCompleteDownload(byteCount: byteCount,
+                                                duration: duration,
+                                                concurrentCount: concurrentCount)
+            }
+        }
+        XCTAssertEqual(concurrency.limit, AttachmentDownloadConcurrency.minLimit)
+    }
+}
@@ -0,0 +1,160 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+class DisappearingMessagesTimerWheelTest: SSKBaseTestSwift {
+
+    private let startMs: UInt64 = 1_600_000_000_000
+
+    func testExpiration() {
+        let wheel = DisappearingMessagesTimerWheel(nowMs: startMs)
+        XCTAssertNil(wheel.nextDeadline)
+
+        wheel.insert(uniqueId: "a", expiresAt: startMs + 1500)
+        wheel.insert(uniqueId: "b", expiresAt: startMs + 2000)
+        wheel.insert(uniqueId: "c", expiresAt: startMs + 100_000)
+        wheel.insert(uniqueId: "d", expiresAt: startMs + 30 * kDayInMs)
+        XCTAssertEqual(wheel.count, 4)
+        XCTAssertEqual(wheel.nextDeadline?.uint64Value, startMs + 2000)
+
+        // Expirations are never found early.
+        XCTAssertEqual(wheel.popExpired(nowMs: startMs + 1999, limit: 10), [])
+        XCTAssertEqual(Set(wheel.popExpired(nowMs: startMs + 2000, limit: 10)), ["a", "b"])
+        XCTAssertEqual(wheel.popExpired(nowMs: startMs + 99_999, limit: 10), [])
+        XCTAssertEqual(wheel.popExpired(nowMs: startMs + 100_000, limit: 10), ["c"])
+        XCTAssertEqual(wheel.popExpired(nowMs: startMs + 30 * kDayInMs - 1, limit: 10), [])
+        XCTAssertEqual(wheel.popExpired(nowMs: startMs + 30 * kDayInMs, limit: 10), ["d"])
+        XCTAssertEqual(wheel.count, 0)
+        XCTAssertNil(wheel.nextDeadline)
+    }
+
+    func testInsertExpired() {
+        let wheel = DisappearingMessagesTimerWheel(nowMs: startMs)
+        wheel.insert(uniqueId: "a", expiresAt: startMs - 1000)
+        XCTAssertEqual(wheel.nextDeadline?.uint64Value, startMs)
+        XCTAssertEqual(wheel.popExpired(nowMs: startMs, limit: 10), ["a"])
+    }
+
+    func testLimit() {
+        let wheel = DisappearingMessagesTimerWheel(nowMs: startMs)
+        for index in 0..<25 {
+            wheel.insert(uniqueId: "\(index)", expiresAt: startMs + UInt64(index) * 1000)
+        }
+
+        let nowMs = startMs + 60_000
+        XCTAssertEqual(wheel.popExpired(nowMs: nowMs, limit: 10).count, 10)
+        XCTAssertEqual(wheel.popExpired(nowMs: nowMs, limit: 10).count, 10)
+        XCTAssertEqual(wheel.popExpired(nowMs: nowMs, limit: 10).count, 5)
+        XCTAssertEqual(wheel.popExpired(nowMs: nowMs, limit: 10), [])
+        XCTAssertEqual(wheel.count, 0)
+    }
+
+    func testInsertAndRemove() {
+        let wheel = DisappearingMessagesTimerWheel(nowMs: startMs)
+        wheel.insert(uniqueId: "a", expiresAt: startMs + 10 * kMinuteInMs)
+        wheel.insert(uniqueId: "b", expiresAt: startMs + 20 * kMinuteInMs)
+
+        // Inserting a message again replaces its expiration.
+        wheel.insert(uniqueId: "a", expiresAt: startMs + 5000)
+        XCTAssertEqual(wheel.count, 2)
+        XCTAssertEqual(wheel.popExpired(nowMs: startMs + 5000, limit: 10), ["a"])
+
+        wheel.remove(uniqueId: "b")
+        XCTAssertEqual(wheel.count, 0)
+        XCTAssertNil(wheel.nextDeadline)
+        XCTAssertEqual(wheel.popExpired(nowMs: startMs + kDayInMs, limit: 10), [])
+    }
+
+    func testReload() {
+        let wheel = DisappearingMessagesTimerWheel()
+        let now = NSDate.ows_millisecondTimeStamp()
+        wheel.insert(uniqueId: "stale", expiresAt: now + 1000)
+
+        let thread = ContactThreadFactory().create()
+        let messageFactory = IncomingMessageFactory()
+        messageFactory.threadCreator = { _ in thread }
+        messageFactory.expiresInSecondsBuilder = { 60 }
+        var messages = [TSIncomingMessage]()
+        write { transaction in
+            messages = messageFactory.create(count: 3, transaction: transaction)
+            for message in messages {
+                message.update(withExpireStartedAt: now, transaction: transaction)
+            }
+            // Not yet started.
+            _ = messageFactory.create(transaction: transaction)
+
+            wheel.reload(transaction: transaction)
+        }
+
+        XCTAssertEqual(wheel.count, messages.count)
+        XCTAssertEqual(wheel.nextDeadline?.uint64Value,
+                       DisappearingMessagesTimerWheel.deadline(forExpiresAt: now + 60 * 1000))
+        XCTAssertEqual(Set(wheel.popExpired(nowMs: now + 60 * 1000, limit: 10)), Set(messages.map { $0.uniqueId }))
+    }
+
+    func testUpdate() {
+        let wheel = DisappearingMessagesTimerWheel()
+        let now = NSDate.ows_millisecondTimeStamp()
+        wheel.insert(uniqueId: "deleted", expiresAt: now + 1000)
+
+        let thread = ContactThreadFactory().create()
+        let messageFactory = IncomingMessageFactory()
+        messageFactory.threadCreator = { _ in thread }
+        messageFactory.expiresInSecondsBuilder = { 60 }
+        var startedMessage: TSIncomingMessage!
+        var unstartedMessage: TSIncomingMessage!
+        var untouchedMessage: TSIncomingMessage!
+        write { transaction in
+            startedMessage = messageFactory.create(transaction: transaction)
+            startedMessage.update(withExpireStartedAt: now, transaction: transaction)
+            unstartedMessage = messageFactory.create(transaction: transaction)
+            untouchedMessage = messageFactory.create(transaction: transaction)
+            untouchedMessage.update(withExpireStartedAt: now, transaction: transaction)
+
+            // Only the given messages are read, e.g. those changed by another process.
+            wheel.update(uniqueIds: ["deleted", startedMessage.uniqueId, unstartedMessage.uniqueId],
+                         transaction: transaction)
+        }
+
+        XCTAssertEqual(wheel.count, 1)
+        XCTAssertEqual(wheel.popExpired(nowMs: now + 60 * 1000, limit: 10), [startedMessage.uniqueId])
+    }
+
+    // Each expiration is placed into at most one slot per level that it
+    // spans, however many expirations are pending.
+    func testCostPerExpiration() {
+        let expirationCount = 100 * 1000
+        // 4 weeks is less than 64^4 one-second ticks, so each expiration
+        // spans at most 5 levels.
+        let maxExpirationMs = 4 * kWeekInMs
+        let maxSlotOperationsPerExpiration: UInt64 = 5
+
+        let wheel = DisappearingMessagesTimerWheel(nowMs: startMs)
+        var lastExpiresAt = startMs
+        for index in 0..<expirationCount {
+            let expiresAt = startMs + UInt64.random(in: 1...maxExpirationMs)
+            lastExpiresAt = max(lastExpiresAt, expiresAt)
+            wheel.insert(uniqueId: "\(index)", expiresAt: expiresAt)
+        }
+        XCTAssertEqual(wheel.count, expirationCount)
+
+        // Expire the messages in a series of passes, as the
+        // disappearing messages job would.
+        var expiredCount = 0
+        var nowMs = startMs
+        while let nextDeadline = wheel.nextDeadline?.uint64Value {
+            XCTAssertGreaterThan(nextDeadline, nowMs)
+            nowMs = nextDeadline
+            expiredCount += wheel.popExpired(nowMs: nowMs, limit: Int.max).count
+        }
+
+        XCTAssertEqual(expiredCount, expirationCount)
+        XCTAssertEqual(wheel.count, 0)
+        XCTAssertLessThanOrEqual(nowMs, DisappearingMessagesTimerWheel.deadline(forExpiresAt: lastExpiresAt))
+        XCTAssertLessThanOrEqual(wheel.slotOperationCount, UInt64(expirationCount) * maxSlotOperationsPerExpiration)
+    }
+}
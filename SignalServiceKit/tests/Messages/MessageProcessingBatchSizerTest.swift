@@ -0,0 +1,49 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+
+@testable import SignalServiceKit
+
+class MessageProcessingBatchSizerTest: SSKBaseTestSwift {
+
+    func testGrowsWhenTransactionsAreFast() {
+        var sizer = MessageProcessingBatchSizer(initialBatchSize: 16, targetTransactionDuration: 0.1)
+        sizer.didProcessBatch(count: 16, duration: 0.01)
+        XCTAssertEqual(sizer.batchSize, 32)
+
+        for _ in 0..<100 {
+            sizer.didProcessBatch(count: sizer.batchSize, duration: 0.01)
+        }
+        XCTAssertEqual(sizer.batchSize, MessageProcessingBatchSizer.maxBatchSize)
+    }
+
+    func testShrinksWhenTransactionsAreSlow() {
+        var sizer = MessageProcessingBatchSizer(initialBatchSize: 16, targetTransactionDuration: 0.1)
+        sizer.didProcessBatch(count: 16, duration: 0.5)
+        XCTAssertEqual(sizer.batchSize, 8)
+
+        // Slow partial batches still shrink the batch size.
+        sizer.didProcessBatch(count: 2, duration: 0.5)
+        XCTAssertEqual(sizer.batchSize, 4)
+
+        for _ in 0..<100 {
+            sizer.didProcessBatch(count: sizer.batchSize, duration: 0.5)
+        }
+        XCTAssertEqual(sizer.batchSize, MessageProcessingBatchSizer.minBatchSize)
+    }
+
+    func testIgnoresFastPartialBatches() {
+        var sizer = MessageProcessingBatchSizer(initialBatchSize: 16, targetTransactionDuration: 0.1)
+        sizer.didProcessBatch(count: 3, duration: 0.001)
+        XCTAssertEqual(sizer.batchSize, 16)
+    }
+
+    func testHoldsSteadyNearTarget() {
+        var sizer = MessageProcessingBatchSizer(initialBatchSize: 16, targetTransactionDuration: 0.1)
+        sizer.didProcessBatch(count: 16, duration: 0.08)
+        XCTAssertEqual(sizer.batchSize, 16)
+    }
+}
@@ -162,6 +162,23 @@ class MessageProcessingIntegrationTest: SSKBaseTestSwift {
 
         waitForExpectations(timeout: 1.0)
     }
+
+    func test_malformedEnvelopeIsDropped() {
+        // The envelope has no source device. Malformed envelopes come from
+        // the service, so they're dropped without asserting.
+        let envelopeBuilder = SSKProtoEnvelope.builder(timestamp: 100)
+        envelopeBuilder.setType(.ciphertext)
+        envelopeBuilder.setSourceUuid(bobClient.uuidIdentifier)
+        let envelopeData = try! envelopeBuilder.buildSerializedData()
+
+        let expectCompletion = expectation(description: "completion")
+        messageProcessor.processEncryptedEnvelopeData(envelopeData, serverDeliveryTimestamp: NSDate.ows_millisecondTimeStamp()) { error in
+            XCTAssertNotNil(error)
+            expectCompletion.fulfill()
+        }
+
+        waitForExpectations(timeout: 1.0)
+    }
 }
 
 // MARK: - Helpers
@@ -18,7 +18,6 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface OWSDisappearingMessagesFinder (Testing)
 
-- (NSArray<TSMessage *> *)fetchExpiredMessagesWithTransaction:(SDSAnyReadTransaction *)transaction;
 - (NSArray<TSMessage *> *)fetchUnstartedExpiringMessagesInThread:(TSThread *)thread
                                                      transaction:(SDSAnyReadTransaction *)transaction;
 
@@ -126,45 +125,6 @@ NS_ASSUME_NONNULL_BEGIN
     return message;
 }
 
-- (void)testExpiredMessages
-{
-    TSMessage *expiredMessage1 = [self incomingMessageWithBody:@"expiredMessage1"
-                                              expiresInSeconds:2
-                                               expireStartedAt:self.now - 2001];
-    TSMessage *expiredMessage2 = [self incomingMessageWithBody:@"expiredMessage2"
-                                              expiresInSeconds:1
-                                               expireStartedAt:self.now - 20000];
-
-    __unused TSMessage *notYetExpiredMessage = [self incomingMessageWithBody:@"notYetExpiredMessage"
-                                                            expiresInSeconds:20
-                                                             expireStartedAt:self.now - 10000];
-
-    __unused TSMessage *unreadExpiringMessage = [self incomingMessageWithBody:@"unreadExpiringMessage"
-                                                             expiresInSeconds:10
-                                                              expireStartedAt:0];
-
-    __unused TSMessage *unExpiringMessage = [self incomingMessageWithBody:@"unexpiringMessage"
-                                                         expiresInSeconds:0
-                                                          expireStartedAt:0];
-
-    __unused TSMessage *unExpiringMessage2 = [self incomingMessageWithBody:@"unexpiringMessage2"
-                                                          expiresInSeconds:0
-                                                           expireStartedAt:0];
-
-    NSMutableSet<NSString *> *actualMessageIds = [NSMutableSet new];
-    [self readWithBlock:^(SDSAnyReadTransaction *transaction) {
-        for (TSMessage *message in [self.finder fetchExpiredMessagesWithTransaction:transaction]) {
-            [actualMessageIds addObject:message.uniqueId];
-        }
-    }];
-
-    NSSet<NSString *> *expectedMessageIds = [NSSet setWithArray:@[
-        expiredMessage1.uniqueId,
-        expiredMessage2.uniqueId,
-    ]];
-    XCTAssertEqualObjects(expectedMessageIds, actualMessageIds);
-}
-
 - (void)testUnstartedExpiredMessagesForThread
 {
     TSMessage *expiredIncomingMessage = [self incomingMessageWithBody:@"incoming expiredMessage"
@@ -286,48 +246,6 @@ NS_ASSUME_NONNULL_BEGIN
     XCTAssertEqualObjects([NSSet set], actualMessageIds);
 }
 
-- (nullable NSNumber *)nextExpirationTimestamp
-{
-    __block NSNumber *_Nullable nextExpirationTimestamp;
-
-    [self readWithBlock:^(SDSAnyReadTransaction *transaction) {
-        XCTAssertNotNil(self.finder);
-        nextExpirationTimestamp = [self.finder nextExpirationTimestampWithTransaction:transaction];
-    }];
-
-    return nextExpirationTimestamp;
-}
-
-- (void)testNextExpirationTimestampNilWhenNoExpiringMessages
-{
-    // Sanity check.
-
-    XCTAssertNil(self.nextExpirationTimestamp);
-
-    __unused TSMessage *unExpiringMessage = [self incomingMessageWithBody:@"unexpiringMessage"
-                                                         expiresInSeconds:0
-                                                          expireStartedAt:0];
-    XCTAssertNil(self.nextExpirationTimestamp);
-}
-
-- (void)testNextExpirationTimestampNotNilWithUpcomingExpiringMessages
-{
-    __unused TSMessage *soonToExpireMessage = [self incomingMessageWithBody:@"soonToExpireMessage"
-                                                           expiresInSeconds:10
-                                                            expireStartedAt:self.now - 9000];
-
-    XCTAssertNotNil(self.nextExpirationTimestamp);
-    XCTAssertEqual(self.now + 1000, [self.nextExpirationTimestamp unsignedLongLongValue]);
-
-    // expired message should take precedence
-    __unused TSMessage *expiredMessage = [self incomingMessageWithBody:@"expiredMessage"
-                                                      expiresInSeconds:10
-                                                       expireStartedAt:self.now - 11000];
-
-    XCTAssertNotNil(self.nextExpirationTimestamp);
-    XCTAssertEqual(self.now - 1000, [self.nextExpirationTimestamp unsignedLongLongValue]);
-}
-
 @end
 
 NS_ASSUME_NONNULL_END
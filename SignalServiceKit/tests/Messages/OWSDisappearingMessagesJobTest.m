@@ -84,6 +84,29 @@ NS_ASSUME_NONNULL_BEGIN
     }];
 }
 
+- (void)testRemoveExpiredMessagesInBatches
+{
+    uint64_t now = [NSDate ows_millisecondTimeStamp];
+    // More than one batch of expired messages.
+    const NSUInteger kMessageCount = 1200;
+    [self writeWithBlock:^(SDSAnyWriteTransaction *transaction) {
+        for (NSUInteger i = 0; i < kMessageCount; i++) {
+            TSMessage *expiredMessage = [self messageWithBody:@"expiredMessage"
+                                             expiresInSeconds:1
+                                              expireStartedAt:now - 20000];
+            [expiredMessage anyInsertWithTransaction:transaction];
+        }
+    }];
+
+    [self readWithBlock:^(SDSAnyReadTransaction *transaction) {
+        XCTAssertEqual(kMessageCount, [TSMessage anyCountWithTransaction:transaction]);
+    }];
+    [[OWSDisappearingMessagesJob shared] syncPassForTests];
+    [self readWithBlock:^(SDSAnyReadTransaction *transaction) {
+        XCTAssertEqual(0, [TSMessage anyCountWithTransaction:transaction]);
+    }];
+}
+
 @end
 
 NS_ASSUME_NONNULL_END
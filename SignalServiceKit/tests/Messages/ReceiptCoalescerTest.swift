@@ -0,0 +1,108 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+class ReceiptCoalescerTest: SSKBaseTestSwift {
+
+    private let linkedDeviceReadReceiptStore = SDSKeyValueStore(collection: "OWSReceiptManager.toLinkedDevicesReadReceiptMapStore")
+
+    override func setUp() {
+        super.setUp()
+
+        SDSKeyValueStoreStatistics.isEnabled = true
+        SDSKeyValueStoreStatistics.shared.reset()
+    }
+
+    override func tearDown() {
+        SDSKeyValueStoreStatistics.isEnabled = DebugFlags.logSQLStatistics
+        ReceiptCoalescing.isEnabled = true
+
+        super.tearDown()
+    }
+
+    private func writeCount(store: SDSKeyValueStore) -> UInt64 {
+        SDSKeyValueStoreStatistics.shared.entry(forCollection: store.collection)?.writeCount ?? 0
+    }
+
+    private func queuedTimestamps(address: SignalServiceAddress) -> Set<UInt64> {
+        var timestamps = Set<UInt64>()
+        read { transaction in
+            let key = address.uuidString ?? address.phoneNumber!
+            let numbers = OWSOutgoingReceiptManager.readReceiptStore().getObject(forKey: key, transaction: transaction) as? Set<NSNumber>
+            timestamps = Set((numbers ?? []).map { $0.uint64Value })
+        }
+        return timestamps
+    }
+
+    // MARK: -
+
+    func testOutgoingReceipts() {
+        let senders = [CommonGenerator.address(), CommonGenerator.address()]
+        write { transaction in
+            for timestamp in UInt64(1)...10 {
+                for sender in senders {
+                    self.outgoingReceiptManager.enqueueReadReceipt(for: sender, timestamp: timestamp, transaction: transaction)
+                }
+            }
+        }
+        write { transaction in
+            self.outgoingReceiptManager.enqueueReadReceipt(for: senders[0], timestamp: 11, transaction: transaction)
+        }
+
+        XCTAssertEqual(queuedTimestamps(address: senders[0]), Set(UInt64(1)...11))
+        XCTAssertEqual(queuedTimestamps(address: senders[1]), Set(UInt64(1)...10))
+        // Each transaction wrote the receipts for each sender once.
+        XCTAssertEqual(writeCount(store: OWSOutgoingReceiptManager.readReceiptStore()), 3)
+    }
+
+    func testOutgoingReceipts_uncoalesced() {
+        ReceiptCoalescing.isEnabled = false
+
+        let sender = CommonGenerator.address()
+        write { transaction in
+            for timestamp in UInt64(1)...10 {
+                self.outgoingReceiptManager.enqueueReadReceipt(for: sender, timestamp: timestamp, transaction: transaction)
+            }
+        }
+
+        XCTAssertEqual(queuedTimestamps(address: sender), Set(UInt64(1)...10))
+        XCTAssertEqual(writeCount(store: OWSOutgoingReceiptManager.readReceiptStore()), 10)
+    }
+
+    func testLinkedDeviceReceipts() {
+        let threads = [ContactThreadFactory().create(), ContactThreadFactory().create()]
+        var nextTimestamp: UInt64 = 1000
+        var newestMessages = [String: TSIncomingMessage]()
+        write { transaction in
+            for thread in threads {
+                let messageFactory = IncomingMessageFactory()
+                messageFactory.threadCreator = { _ in thread }
+                messageFactory.timestampBuilder = {
+                    nextTimestamp += 1
+                    return nextTimestamp
+                }
+                for message in messageFactory.create(count: 5, transaction: transaction) {
+                    self.receiptManager.messageWasRead(message,
+                                                       thread: thread,
+                                                       circumstance: .onThisDevice,
+                                                       transaction: transaction)
+                    newestMessages[thread.uniqueId] = message
+                }
+            }
+        }
+
+        read { transaction in
+            for thread in threads {
+                let receipt: ReceiptForLinkedDevice? = try! self.linkedDeviceReadReceiptStore.getCodableValue(forKey: thread.uniqueId,
+                                                                                                             transaction: transaction)
+                XCTAssertEqual(receipt?.messageIdTimestamp, newestMessages[thread.uniqueId]?.timestamp)
+            }
+        }
+        // Only the newest receipt for each thread was written.
+        XCTAssertEqual(writeCount(store: linkedDeviceReadReceiptStore), UInt64(threads.count))
+    }
+}
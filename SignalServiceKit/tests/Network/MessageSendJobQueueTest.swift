@@ -59,9 +59,14 @@ class MessageSenderJobQueueTest: SSKBaseTestSwift {
     }
 
     func test_respectsQueueOrder() {
-        let message1: TSOutgoingMessage = OutgoingMessageFactory().create()
-        let message2: TSOutgoingMessage = OutgoingMessageFactory().create()
-        let message3: TSOutgoingMessage = OutgoingMessageFactory().create()
+        // Order is only guaranteed within a thread; sends to
+        // different threads run concurrently.
+        let thread = ContactThreadFactory().create()
+        let messageFactory = OutgoingMessageFactory()
+        messageFactory.threadCreator = { _ in thread }
+        let message1: TSOutgoingMessage = messageFactory.create()
+        let message2: TSOutgoingMessage = messageFactory.create()
+        let message3: TSOutgoingMessage = messageFactory.create()
 
         let jobQueue = MessageSenderJobQueue()
         self.write { transaction in
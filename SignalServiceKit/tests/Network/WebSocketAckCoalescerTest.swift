@@ -0,0 +1,241 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import XCTest
+@testable import SignalServiceKit
+
+class WebSocketAckCoalescerTest: SSKBaseTestSwift {
+
+    let localE164Identifier = "+13235551234"
+    let localUUID = UUID()
+
+    override func setUp() {
+        super.setUp()
+
+        tsAccountManager.registerForTests(withLocalNumber: localE164Identifier, uuid: localUUID)
+    }
+
+    // MARK: -
+
+    private func buildRequest(requestId: UInt64, body: Data? = nil) -> WebSocketProtoWebSocketRequestMessage {
+        let builder = WebSocketProtoWebSocketRequestMessage.builder(verb: "PUT",
+                                                                    path: "/api/v1/message",
+                                                                    requestID: requestId)
+        if let body = body {
+            builder.setBody(body)
+        }
+        return try! builder.build()
+    }
+
+    func testCoalescesAcks() {
+        var ackedRequestIds = [UInt64]()
+        var flushCount = 0
+        let coalescer = WebSocketAckCoalescer { requests in
+            flushCount += 1
+            ackedRequestIds += requests.map { $0.requestID }
+        }
+
+        let expectCompletions = expectation(description: "completions")
+        expectCompletions.expectedFulfillmentCount = 100
+        for requestId in 0..<UInt64(100) {
+            coalescer.enqueueAck(for: buildRequest(requestId: requestId)) {
+                expectCompletions.fulfill()
+            }
+        }
+        XCTAssertEqual(flushCount, 0)
+
+        waitForExpectations(timeout: 1)
+        XCTAssertEqual(flushCount, 1)
+        XCTAssertEqual(ackedRequestIds, Array(0..<100))
+    }
+
+    func testReceiveBudget() {
+        let receiveBudget = WebSocketReceiveBudget(byteBudget: 100)
+
+        // A frame larger than the budget is accepted if nothing is retained.
+        XCTAssertTrue(receiveBudget.reserve(byteCount: 150))
+        XCTAssertFalse(receiveBudget.reserve(byteCount: 1))
+        XCTAssertTrue(receiveBudget.release(byteCount: 150))
+        receiveBudget.reset()
+
+        XCTAssertTrue(receiveBudget.reserve(byteCount: 60))
+        XCTAssertTrue(receiveBudget.reserve(byteCount: 40))
+        XCTAssertEqual(receiveBudget.retainedByteCount, 100)
+        XCTAssertFalse(receiveBudget.reserve(byteCount: 1))
+        // We only cycle once everything we accepted has been released.
+        XCTAssertFalse(receiveBudget.release(byteCount: 60))
+        XCTAssertTrue(receiveBudget.release(byteCount: 40))
+        XCTAssertEqual(receiveBudget.retainedByteCount, 0)
+        receiveBudget.reset()
+
+        // Nothing was dropped, so there's no need to cycle.
+        XCTAssertTrue(receiveBudget.reserve(byteCount: 10))
+        XCTAssertFalse(receiveBudget.release(byteCount: 10))
+    }
+
+    func testReceiveBudgetDropsEverythingAfterADroppedFrame() {
+        let receiveBudget = WebSocketReceiveBudget(byteBudget: 100)
+
+        XCTAssertTrue(receiveBudget.reserve(byteCount: 60))
+        XCTAssertFalse(receiveBudget.reserve(byteCount: 50))
+        XCTAssertTrue(receiveBudget.hasDroppedFrames)
+
+        // A small frame would fit in the budget, but accepting it would
+        // process it before the dropped frame is redelivered.
+        XCTAssertFalse(receiveBudget.reserve(byteCount: 1))
+        XCTAssertEqual(receiveBudget.retainedByteCount, 60)
+
+        // Frames are still dropped after the budget drains, until the
+        // socket has been cycled.
+        XCTAssertTrue(receiveBudget.release(byteCount: 60))
+        XCTAssertFalse(receiveBudget.reserve(byteCount: 1))
+        XCTAssertTrue(receiveBudget.hasDroppedFrames)
+
+        receiveBudget.reset()
+        XCTAssertFalse(receiveBudget.hasDroppedFrames)
+        XCTAssertTrue(receiveBudget.reserve(byteCount: 50))
+        XCTAssertFalse(receiveBudget.release(byteCount: 50))
+    }
+
+    // MARK: - Backlog
+
+    // A stand-in for the service which replays a backlog of envelopes
+    // over a websocket. Like OWSWebSocket, it reserves each frame's bytes
+    // as it is read, hands the envelope to the MessageProcessor on a
+    // serial queue and acks it once it has been processed. When the socket
+    // would be cycled, the service redelivers every unacked envelope, in order.
+    private class FakeBacklogWebSocket {
+        let ackCoalescer: WebSocketAckCoalescer
+        let receiveBudget: WebSocketReceiveBudget
+        let serialQueue = DispatchQueue(label: "FakeBacklogWebSocket")
+
+        // These properties should only be accessed on the main thread.
+        var ackedRequestIds = Set<UInt64>()
+        var acceptedRequestIds = [UInt64]()
+        var ackFlushCount = 0
+        var droppedRequests = [WebSocketProtoWebSocketRequestMessage]()
+        // In reverse order, so that the next request can be popped cheaply.
+        var undeliveredRequests = [WebSocketProtoWebSocketRequestMessage]()
+        var isDelivering = false
+        var redeliveryCount = 0
+        var maxRetainedByteCount = 0
+        var didAck: (() -> Void)?
+
+        init(byteBudget: Int) {
+            receiveBudget = WebSocketReceiveBudget(byteBudget: byteBudget)
+            var ackBlock: WebSocketAckCoalescer.AckBlock?
+            ackCoalescer = WebSocketAckCoalescer { ackBlock?($0) }
+            ackBlock = { [weak self] requests in
+                guard let self = self else { return }
+                self.ackFlushCount += 1
+                for request in requests {
+                    XCTAssertFalse(self.ackedRequestIds.contains(request.requestID))
+                    self.ackedRequestIds.insert(request.requestID)
+                }
+            }
+        }
+
+        func deliver(requests: [WebSocketProtoWebSocketRequestMessage]) {
+            AssertIsOnMainThread()
+
+            undeliveredRequests = undeliveredRequests + requests.reversed()
+            deliverNextIfNecessary()
+        }
+
+        // Frames are read on the main thread, as fast as the service sends them.
+        private func deliverNextIfNecessary() {
+            guard !isDelivering, let request = undeliveredRequests.popLast() else {
+                return
+            }
+            isDelivering = true
+            DispatchQueue.main.async {
+                self.isDelivering = false
+                self.receive(request: request)
+                self.deliverNextIfNecessary()
+            }
+        }
+
+        private func receive(request: WebSocketProtoWebSocketRequestMessage) {
+            AssertIsOnMainThread()
+
+            let frameByteCount = request.body!.count
+            guard receiveBudget.reserve(byteCount: frameByteCount) else {
+                droppedRequests.append(request)
+                return
+            }
+            acceptedRequestIds.append(request.requestID)
+            maxRetainedByteCount = max(maxRetainedByteCount, receiveBudget.retainedByteCount)
+
+            serialQueue.async {
+                MessageProcessor.shared.processDecryptedEnvelopeData(request.body!,
+                                                                     plaintextData: nil,
+                                                                     serverDeliveryTimestamp: request.requestID,
+                                                                     wasReceivedByUD: false) { _ in
+                    self.ackCoalescer.enqueueAck(for: request) {
+                        self.didAck?()
+                        if self.receiveBudget.release(byteCount: frameByteCount) {
+                            self.cycle()
+                        }
+                    }
+                }
+            }
+        }
+
+        // Cycling the socket; the service redelivers unacked messages,
+        // oldest first, on the new connection.
+        private func cycle() {
+            AssertIsOnMainThread()
+
+            redeliveryCount += 1
+            let redeliveredRequests = droppedRequests + undeliveredRequests.reversed()
+            droppedRequests = []
+            undeliveredRequests = []
+            receiveBudget.reset()
+            deliver(requests: redeliveredRequests)
+        }
+    }
+
+    func testBacklogReplay() {
+        let requestCount = 10 * 1000
+        let byteBudget = 64 * 1024
+
+        // Key exchange envelopes are dismissed by OWSMessageManager,
+        // so this exercises the receive path without message handling.
+        let sourceUuid = UUID().uuidString
+        let requests: [WebSocketProtoWebSocketRequestMessage] = (0..<requestCount).map { index in
+            let envelopeBuilder = SSKProtoEnvelope.builder(timestamp: UInt64(index + 1))
+            envelopeBuilder.setType(.keyExchange)
+            envelopeBuilder.setSourceUuid(sourceUuid)
+            envelopeBuilder.setSourceDevice(1)
+            envelopeBuilder.setContent(Randomness.generateRandomBytes(1024))
+            let envelopeData = try! envelopeBuilder.buildSerializedData()
+            return buildRequest(requestId: UInt64(index + 1), body: envelopeData)
+        }
+
+        let expectAcks = expectation(description: "acks")
+        expectAcks.expectedFulfillmentCount = requestCount
+
+        let webSocket = FakeBacklogWebSocket(byteBudget: byteBudget)
+        webSocket.didAck = { expectAcks.fulfill() }
+        webSocket.deliver(requests: requests)
+        waitForExpectations(timeout: 60)
+
+        XCTAssertEqual(webSocket.ackedRequestIds.count, requestCount)
+        XCTAssertTrue(webSocket.droppedRequests.isEmpty)
+        // Envelopes are handed to the processor in the order they were sent,
+        // even though some were dropped and redelivered.
+        XCTAssertEqual(webSocket.acceptedRequestIds, requests.map { $0.requestID })
+        Logger.info("Acked \(requestCount) requests in \(webSocket.ackFlushCount) flushes "
+                        + "and \(webSocket.redeliveryCount) redeliveries.")
+        XCTAssertLessThan(webSocket.ackFlushCount, requestCount)
+
+        // Every envelope is retained from when its frame is read until it
+        // is acked, whether it is queued for the processor or pending in it.
+        // Those bytes should never exceed the budget.
+        XCTAssertGreaterThan(webSocket.redeliveryCount, 0)
+        XCTAssertGreaterThan(webSocket.maxRetainedByteCount, 0)
+        XCTAssertLessThanOrEqual(webSocket.maxRetainedByteCount, byteBudget)
+        XCTAssertEqual(webSocket.receiveBudget.retainedByteCount, 0)
+    }
+}
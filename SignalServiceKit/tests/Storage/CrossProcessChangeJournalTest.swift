@@ -0,0 +1,255 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+import GRDB
+
+@testable import SignalServiceKit
+
+// These tests play both sides: the test's writes are journaled as if
+// they were made by an app extension, and a separate journal instance
+// replays them as if it were the main app.
+class CrossProcessChangeJournalTest: SSKBaseTestSwift {
+
+    private var mainAppJournal: CrossProcessChangeJournal!
+
+    override func setUp() {
+        super.setUp()
+
+        try! databaseStorage.grdbStorage.setupUIDatabase()
+
+        CrossProcessChangeJournal.shouldJournalWritesForTests = true
+
+        mainAppJournal = CrossProcessChangeJournal()
+        read { transaction in
+            self.mainAppJournal.markAllChangesSeen(transaction: transaction.unwrapGrdbRead)
+        }
+    }
+
+    override func tearDown() {
+        CrossProcessChangeJournal.shouldJournalWritesForTests = false
+        databaseStorage.grdbStorage.testing_tearDownUIDatabase()
+
+        super.tearDown()
+    }
+
+    private func replay() -> CrossProcessChangeJournal.ReplayResult {
+        var result: CrossProcessChangeJournal.ReplayResult!
+        read { transaction in
+            result = self.mainAppJournal.replayUnseenChanges(transaction: transaction.unwrapGrdbRead)
+        }
+        return result
+    }
+
+    private func replayChanges(file: StaticString = #file, line: UInt = #line) -> CrossProcessChangeJournal.Changes? {
+        switch replay() {
+        case .changes(let changes):
+            return changes
+        case .noChanges:
+            XCTFail("Unexpected noChanges.", file: file, line: line)
+            return nil
+        case .unknownChanges:
+            XCTFail("Unexpected unknownChanges.", file: file, line: line)
+            return nil
+        }
+    }
+
+    private func assertNoChanges(file: StaticString = #file, line: UInt = #line) {
+        guard case .noChanges = replay() else {
+            XCTFail("Expected noChanges.", file: file, line: line)
+            return
+        }
+    }
+
+    private func assertUnknownChanges(file: StaticString = #file, line: UInt = #line) {
+        guard case .unknownChanges = replay() else {
+            XCTFail("Expected unknownChanges.", file: file, line: line)
+            return
+        }
+    }
+
+    // MARK: -
+
+    func testReplay() {
+        assertNoChanges()
+
+        let thread = ContactThreadFactory().create()
+        let messageFactory = IncomingMessageFactory()
+        messageFactory.threadCreator = { _ in thread }
+        var messages = [TSIncomingMessage]()
+        write { transaction in
+            messages = messageFactory.create(count: 3, transaction: transaction)
+        }
+        let keyValueStore = SDSKeyValueStore(collection: "test")
+        write { transaction in
+            keyValueStore.setBool(true, key: "test", transaction: transaction)
+        }
+
+        guard let changes = replayChanges() else {
+            return
+        }
+        XCTAssertTrue(changes.isComplete)
+        XCTAssertTrue(changes.threadUniqueIds.contains(thread.uniqueId))
+        XCTAssertTrue(changes.interactionUniqueIds.isSuperset(of: messages.map { $0.uniqueId }))
+        XCTAssertTrue(changes.collections.contains(TSInteraction.collection()))
+        XCTAssertTrue(changes.collections.contains(SDSKeyValueStore.dataStoreCollection))
+        XCTAssertFalse(changes.collections.contains(SignalAccount.collection()))
+
+        // The changes were marked as seen.
+        assertNoChanges()
+
+        write { transaction in
+            messages[0].anyRemove(transaction: transaction)
+        }
+        guard let deleteChanges = replayChanges() else {
+            return
+        }
+        XCTAssertEqual(deleteChanges.interactionDeletedUniqueIds, [messages[0].uniqueId])
+    }
+
+    func testReplay_finalizationChanges() {
+        let thread = ContactThreadFactory().create()
+        assertNoChanges()
+
+        // Changes made by finalization blocks are journaled too.
+        write { transaction in
+            transaction.addTransactionFinalizationBlock(forKey: "testReplay_finalizationChanges") { transaction in
+                self.databaseStorage.touch(thread: thread, shouldReindex: false, transaction: transaction)
+            }
+        }
+        XCTAssertEqual(replayChanges()?.threadUniqueIds, [thread.uniqueId])
+    }
+
+    func testReplay_prunedEntries() {
+        let thread = ContactThreadFactory().create()
+        write { transaction in
+            thread.anyUpdate(transaction: transaction) { $0.shouldThreadBeVisible = true }
+        }
+
+        // Prune the entry before the main app replays it.
+        write { transaction in
+            transaction.unwrapGrdbWrite.executeUpdate(sql: "DELETE FROM \(CrossProcessChangeJournal.tableName)")
+        }
+        write { transaction in
+            thread.anyUpdate(transaction: transaction) { $0.shouldThreadBeVisible = false }
+        }
+        assertUnknownChanges()
+
+        // We're caught up again.
+        assertNoChanges()
+        write { transaction in
+            thread.anyUpdate(transaction: transaction) { $0.shouldThreadBeVisible = true }
+        }
+        XCTAssertEqual(replayChanges()?.threadUniqueIds, [thread.uniqueId])
+    }
+
+    func testReplay_largeTransaction() {
+        let messageFactory = IncomingMessageFactory()
+        let thread = ContactThreadFactory().create()
+        messageFactory.threadCreator = { _ in thread }
+        write { transaction in
+            _ = messageFactory.create(count: UInt(UIDatabaseObserver.kMaxIncrementalRowChanges), transaction: transaction)
+        }
+        assertUnknownChanges()
+    }
+
+    func testReplay_withoutBaseline() {
+        // A journal which hasn't marked any changes as seen can't
+        // account for changes until it has caught up.
+        let journal = CrossProcessChangeJournal()
+        read { transaction in
+            guard case .unknownChanges = journal.replayUnseenChanges(transaction: transaction.unwrapGrdbRead) else {
+                XCTFail("Expected unknownChanges.")
+                return
+            }
+            guard case .noChanges = journal.replayUnseenChanges(transaction: transaction.unwrapGrdbRead) else {
+                XCTFail("Expected noChanges.")
+                return
+            }
+        }
+    }
+
+    // Two writers contend on the database while the main app replays
+    // the journal. Every change should be replayed exactly once.
+    func testReplay_concurrentWriters() {
+        let messageCountPerWriter = 40
+        let threads = [ContactThreadFactory().create(), ContactThreadFactory().create()]
+        assertNoChanges()
+
+        let writeGroup = DispatchGroup()
+        let messageIdsLock = UnfairLock()
+        var writtenMessageIds = Set<String>()
+        for thread in threads {
+            let messageFactory = IncomingMessageFactory()
+            messageFactory.threadCreator = { _ in thread }
+            DispatchQueue.global().async(group: writeGroup) {
+                for _ in 0..<messageCountPerWriter {
+                    let message = self.databaseStorage.write { transaction in
+                        messageFactory.create(transaction: transaction)
+                    }
+                    messageIdsLock.withLock { _ = writtenMessageIds.insert(message.uniqueId) }
+                }
+            }
+        }
+
+        var replayedMessageIds = [String]()
+        let replayChanges = {
+            switch self.replay() {
+            case .changes(let changes):
+                replayedMessageIds += changes.interactionUniqueIds
+            case .noChanges:
+                break
+            case .unknownChanges:
+                XCTFail("Unexpected unknownChanges.")
+            }
+        }
+        while writeGroup.wait(timeout: .now() + .milliseconds(5)) == .timedOut {
+            replayChanges()
+        }
+        replayChanges()
+
+        XCTAssertEqual(replayedMessageIds.count, threads.count * messageCountPerWriter)
+        XCTAssertEqual(Set(replayedMessageIds), messageIdsLock.withLock { writtenMessageIds })
+    }
+
+    // MARK: - Observation
+
+    func testCrossProcessNotificationUpdatesSnapshot() {
+        let thread = ContactThreadFactory().create()
+        assertNoChanges()
+
+        write { transaction in
+            thread.anyUpdate(transaction: transaction) { $0.shouldThreadBeVisible = true }
+        }
+        guard let changes = replayChanges() else {
+            return
+        }
+
+        // Flush the snapshot update for this process' own write.
+        let flushExpectation = expectation(description: "flush")
+        DispatchQueue.main.async {
+            DispatchQueue.main.async {
+                flushExpectation.fulfill()
+            }
+        }
+        waitForExpectations(timeout: 1.0)
+
+        let mockObserver = MockObserver()
+        mockObserver.set(expectation: expectation(description: "Database Storage Observer"))
+        NotificationCenter.default.post(name: SDSDatabaseStorage.didReceiveCrossProcessNotification,
+                                        object: nil,
+                                        userInfo: [
+                                            SDSDatabaseStorage.crossProcessDatabaseChangesKey: CrossProcessDatabaseChanges(changes: changes)
+                                        ])
+        waitForExpectations(timeout: 1.0)
+
+        // The observer was updated incrementally, rather than externally.
+        XCTAssertEqual(1, mockObserver.updateCount)
+        XCTAssertEqual(0, mockObserver.externalUpdateCount)
+        XCTAssertEqual(0, mockObserver.resetCount)
+        XCTAssertEqual(mockObserver.lastChange?.threadUniqueIds, [thread.uniqueId])
+        XCTAssertEqual(mockObserver.lastChange?.didUpdateThreads, true)
+    }
+}
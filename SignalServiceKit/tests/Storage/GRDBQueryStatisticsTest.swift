@@ -0,0 +1,75 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+import GRDB
+
+@testable import SignalServiceKit
+
+class GRDBQueryStatisticsTest: SSKBaseTestSwift {
+
+    func testNormalization() {
+        XCTAssertEqual(GRDBQueryStatistics.normalize(sql: "SELECT *\n    FROM model_TSThread\n    WHERE id = 12"),
+                       "SELECT * FROM model_TSThread WHERE id = ?")
+        XCTAssertEqual(GRDBQueryStatistics.normalize(sql: "SELECT 1 FROM t WHERE a = 'it''s' AND b = x'00ff' AND c = -1.5"),
+                       "SELECT ? FROM t WHERE a = ? AND b = ? AND c = ?")
+        XCTAssertEqual(GRDBQueryStatistics.normalize(sql: "SELECT * FROM t WHERE a IN ('a','b', 'c') AND b IN (?, ?)"),
+                       "SELECT * FROM t WHERE a IN (...) AND b IN (...)")
+        // Digits within identifiers are preserved.
+        XCTAssertEqual(GRDBQueryStatistics.normalize(sql: "SELECT column2 FROM table_v2"),
+                       "SELECT column2 FROM table_v2")
+    }
+
+    func testPercentiles() {
+        let statistics = GRDBQueryStatistics()
+        let sql = "SELECT * FROM t WHERE id = ?"
+        for index in 1...100 {
+            // 1ms...100ms
+            statistics.record(sql: sql, durationNs: Int64(index) * 1_000_000, fullScanSteps: 2, vmSteps: 3)
+        }
+
+        guard let entry = statistics.entry(forSql: sql) else {
+            XCTFail("Missing entry.")
+            return
+        }
+        XCTAssertEqual(entry.executionCount, 100)
+        XCTAssertEqual(entry.fullScanSteps, 200)
+        XCTAssertEqual(entry.vmSteps, 300)
+        XCTAssertEqual(entry.maxDurationNs, 100_000_000)
+
+        // Percentiles are accurate to within a histogram bucket.
+        func assertDuration(percentile: Double, expectedMs: Double) {
+            let durationMs = Double(entry.durationNs(percentile: percentile)) / 1_000_000
+            XCTAssertGreaterThanOrEqual(durationMs, expectedMs)
+            XCTAssertLessThanOrEqual(durationMs, expectedMs * 1.2)
+        }
+        assertDuration(percentile: 0.5, expectedMs: 50)
+        assertDuration(percentile: 0.95, expectedMs: 95)
+        assertDuration(percentile: 0.99, expectedMs: 99)
+    }
+
+    func testStatementCacheLookups() {
+        let wasEnabled = GRDBQueryStatistics.isEnabled
+        GRDBQueryStatistics.isEnabled = true
+        defer { GRDBQueryStatistics.isEnabled = wasEnabled }
+        GRDBQueryStatistics.shared.reset()
+
+        let sql = "SELECT COUNT(*) FROM \(ThreadRecord.databaseTableName) WHERE \(threadColumn: .isArchived) = ?"
+        read { transaction in
+            let grdbTransaction = transaction.unwrapGrdbRead
+            for _ in 0..<3 {
+                let count = try! UInt.fetchOne(grdbTransaction.cachedSelectStatement(sql: sql), arguments: [false])
+                XCTAssertEqual(count, 0)
+            }
+        }
+
+        guard let entry = GRDBQueryStatistics.shared.entry(forSql: sql) else {
+            XCTFail("Missing entry.")
+            return
+        }
+        XCTAssertEqual(entry.cacheHits + entry.cacheMisses, 3)
+        XCTAssertGreaterThanOrEqual(entry.cacheHits, 2)
+    }
+}
@@ -65,4 +65,130 @@ class InteractionFinderTest: SSKBaseTestSwift {
             XCTAssertEqual(2, finder2.count(transaction: transaction))
         }
     }
+
+    func testRankCheckpoints() {
+        let thread = ContactThreadFactory().create()
+        let otherThread = ContactThreadFactory().create()
+        let messageFactory = IncomingMessageFactory()
+        messageFactory.threadCreator = { _ in thread }
+        let otherMessageFactory = IncomingMessageFactory()
+        otherMessageFactory.threadCreator = { _ in otherThread }
+
+        // Interleave the threads' interactions so that row ids aren't contiguous.
+        let stride = InteractionRankCheckpoints.stride
+        var messageIds = [String]()
+        write { transaction in
+            for _ in 0..<(stride * 2 + 10) {
+                messageIds += messageFactory.create(count: 1, transaction: transaction).map { $0.uniqueId }
+                _ = otherMessageFactory.create(count: 1, transaction: transaction)
+            }
+        }
+
+        let finder = InteractionFinder(threadUniqueId: thread.uniqueId)
+        func assertRanksMatch(file: StaticString = #file, line: UInt = #line) {
+            read { transaction in
+                XCTAssertEqual(finder.count(transaction: transaction), UInt(messageIds.count), file: file, line: line)
+                for sortIndex in [0, 1, stride - 1, stride, stride + 1, messageIds.count - 1] {
+                    let messageId = messageIds[sortIndex]
+                    XCTAssertEqual(try! finder.sortIndex(interactionUniqueId: messageId, transaction: transaction),
+                                   UInt(sortIndex),
+                                   file: file, line: line)
+                    XCTAssertEqual(try! finder.distanceFromLatest(interactionUniqueId: messageId, transaction: transaction),
+                                   UInt(messageIds.count - sortIndex - 1),
+                                   file: file, line: line)
+                    XCTAssertEqual(try! finder.interaction(at: UInt(messageIds.count - sortIndex - 1),
+                                                           transaction: transaction)?.uniqueId,
+                                   messageId,
+                                   file: file, line: line)
+                }
+                let range = NSRange(location: stride - 5, length: stride + 10)
+                XCTAssertEqual(try! finder.interactionIds(inRange: range, transaction: transaction),
+                               Array(messageIds[(stride - 5)..<(stride * 2 + 5)]),
+                               file: file, line: line)
+                var enumeratedIds = [String]()
+                try! finder.enumerateInteractions(range: range, transaction: transaction) { interaction, _ in
+                    enumeratedIds.append(interaction.uniqueId)
+                }
+                XCTAssertEqual(enumeratedIds, Array(messageIds[(stride - 5)..<(stride * 2 + 5)]), file: file, line: line)
+
+                // Ranges may extend past the newest interaction.
+                let tailRange = NSRange(location: messageIds.count - 2, length: 10)
+                XCTAssertEqual(try! finder.interactionIds(inRange: tailRange, transaction: transaction),
+                               Array(messageIds.suffix(2)),
+                               file: file, line: line)
+                let emptyRange = NSRange(location: messageIds.count, length: 10)
+                XCTAssertEqual(try! finder.interactionIds(inRange: emptyRange, transaction: transaction), [],
+                               file: file, line: line)
+            }
+        }
+        assertRanksMatch()
+
+        // Appending interactions extends the checkpoints.
+        write { transaction in
+            messageIds += messageFactory.create(count: UInt(stride), transaction: transaction).map { $0.uniqueId }
+        }
+        assertRanksMatch()
+
+        // Removing interactions shifts the sort indices of later interactions.
+        write { transaction in
+            for messageId in [messageIds[0], messageIds[stride + 1]] {
+                TSInteraction.anyFetch(uniqueId: messageId, transaction: transaction)!.anyRemove(transaction: transaction)
+            }
+        }
+        messageIds.remove(at: stride + 1)
+        messageIds.remove(at: 0)
+        assertRanksMatch()
+
+        // Deleting and appending the same number of interactions leaves the
+        // count unchanged, but still shifts the sort indices.
+        write { transaction in
+            TSInteraction.anyFetch(uniqueId: messageIds[1], transaction: transaction)!.anyRemove(transaction: transaction)
+            messageIds += messageFactory.create(count: 1, transaction: transaction).map { $0.uniqueId }
+        }
+        messageIds.remove(at: 1)
+        assertRanksMatch()
+
+        // Likewise across transactions.
+        write { transaction in
+            TSInteraction.anyFetch(uniqueId: messageIds[stride], transaction: transaction)!.anyRemove(transaction: transaction)
+        }
+        messageIds.remove(at: stride)
+        write { transaction in
+            messageIds += messageFactory.create(count: 1, transaction: transaction).map { $0.uniqueId }
+        }
+        assertRanksMatch()
+    }
+
+    func testBatchedThreadQueries() {
+        let threads = (0..<3).map { _ in ContactThreadFactory().create() }
+        write { transaction in
+            for (index, thread) in threads.enumerated() {
+                let messageFactory = IncomingMessageFactory()
+                messageFactory.threadCreator = { _ in thread }
+                _ = messageFactory.create(count: UInt(index * 2), transaction: transaction)
+            }
+            // Identity changes shouldn't appear in the inbox.
+            let errorMessage = TSErrorMessage.nonblockingIdentityChange(in: threads[1],
+                                                                        address: CommonGenerator.address(),
+                                                                        wasIdentityVerified: false)
+            errorMessage.anyInsert(transaction: transaction)
+        }
+
+        read { transaction in
+            let threadUniqueIds = threads.map { $0.uniqueId }
+            let lastMessagesForInbox = GRDBInteractionFinder.mostRecentInteractionsForInbox(
+                threadUniqueIds: threadUniqueIds,
+                transaction: transaction.unwrapGrdbRead
+            )
+            let unreadCounts = ThreadUnreadCountFinder.unreadCounts(threadUniqueIds: threadUniqueIds,
+                                                                    transaction: transaction.unwrapGrdbRead)
+            XCTAssertNil(lastMessagesForInbox[threads[0].uniqueId])
+            for thread in threads {
+                XCTAssertEqual(lastMessagesForInbox[thread.uniqueId]?.uniqueId,
+                               thread.lastInteractionForInbox(transaction: transaction)?.uniqueId)
+                XCTAssertEqual(unreadCounts[thread.uniqueId] ?? 0,
+                               InteractionFinder(threadUniqueId: thread.uniqueId).unreadCount(transaction: transaction.unwrapGrdbRead))
+            }
+        }
+    }
 }
@@ -0,0 +1,104 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+import GRDB
+
+@testable import SignalServiceKit
+
+class SDSCompactCodingTest: SSKBaseTestSwift {
+
+    func testStringArrayRoundTrip() throws {
+        let values: [[String]] = [
+            [],
+            ["a"],
+            [UUID().uuidString, "", "ünïcødé 🎉", String(repeating: "x", count: 1000)]
+        ]
+        for value in values {
+            let encoded = try XCTUnwrap(SDSCompactCoding.encode(value))
+            XCTAssertTrue(SDSCompactCoding.isCompact(encoded))
+            let decoded: [String] = try SDSDeserialization.unarchive(encoded, name: "test")
+            XCTAssertEqual(decoded, value)
+        }
+    }
+
+    func testAddressRoundTrip() throws {
+        let addresses = [
+            SignalServiceAddress(uuid: UUID()),
+            SignalServiceAddress(phoneNumber: "+13213214321")
+        ]
+        for address in addresses {
+            let encoded = try XCTUnwrap(SDSCompactCoding.encode(address))
+            XCTAssertTrue(SDSCompactCoding.isCompact(encoded))
+            let decoded: SignalServiceAddress = try SDSDeserialization.unarchive(encoded, name: "test")
+            XCTAssertEqual(decoded, address)
+        }
+    }
+
+    func testKeyedArchivesAreNotCompact() throws {
+        let legacyStrings = NSKeyedArchiver.archivedData(withRootObject: ["a", "b"])
+        XCTAssertFalse(SDSCompactCoding.isCompact(legacyStrings))
+        let decodedStrings: [String] = try SDSDeserialization.unarchive(legacyStrings, name: "test")
+        XCTAssertEqual(decodedStrings, ["a", "b"])
+
+        let address = SignalServiceAddress(uuid: UUID())
+        let legacyAddress = NSKeyedArchiver.archivedData(withRootObject: address)
+        XCTAssertFalse(SDSCompactCoding.isCompact(legacyAddress))
+        let decodedAddress: SignalServiceAddress = try SDSDeserialization.unarchive(legacyAddress, name: "test")
+        XCTAssertEqual(decodedAddress, address)
+    }
+
+    func testUnsupportedTypes() {
+        XCTAssertNil(SDSCompactCoding.encode(NSNumber(value: 1)))
+        XCTAssertNil(SDSCompactCoding.encode(["a": "b"]))
+    }
+
+    func testTruncatedData() throws {
+        let encoded = try XCTUnwrap(SDSCompactCoding.encode(["abc", "def"]))
+        for length in 0..<encoded.count {
+            XCTAssertThrowsError(try SDSCompactCoding.decode(encoded.prefix(length)))
+        }
+    }
+
+    func testOnlyCompactColumnsAreWrittenCompactly() throws {
+        let message = OutgoingMessageFactory().create()
+
+        read { transaction in
+            let row = try! Row.fetchOne(transaction.unwrapGrdbRead.database,
+                                        sql: "SELECT attachmentIds, recipientAddressStates FROM model_TSInteraction WHERE uniqueId = ?",
+                                        arguments: [message.uniqueId])!
+            let attachmentIds: Data = row[0]
+            let recipientAddressStates: Data? = row[1]
+            XCTAssertTrue(SDSCompactCoding.isCompact(attachmentIds))
+            // Other blob columns keep the keyed-archive format.
+            if let recipientAddressStates = recipientAddressStates {
+                XCTAssertFalse(SDSCompactCoding.isCompact(recipientAddressStates))
+            }
+
+            let fetched = TSOutgoingMessage.anyFetchOutgoingMessage(uniqueId: message.uniqueId, transaction: transaction)
+            XCTAssertEqual(fetched?.attachmentIds, message.attachmentIds)
+        }
+    }
+
+    func testLegacyRowsAreMigrated() throws {
+        let message = OutgoingMessageFactory().create()
+        let legacyData = NSKeyedArchiver.archivedData(withRootObject: ["attachment-id"])
+
+        write { transaction in
+            transaction.unwrapGrdbWrite.executeUpdate(
+                sql: "UPDATE model_TSInteraction SET attachmentIds = ? WHERE uniqueId = ?",
+                arguments: [legacyData, message.uniqueId]
+            )
+            _ = SDSCompactBlobMigrator.migrateBatch(afterRowId: 0, transaction: transaction.unwrapGrdbWrite)
+        }
+
+        read { transaction in
+            let data = try! Data.fetchOne(transaction.unwrapGrdbRead.database,
+                                          sql: "SELECT attachmentIds FROM model_TSInteraction WHERE uniqueId = ?",
+                                          arguments: [message.uniqueId])
+            XCTAssertTrue(SDSCompactCoding.isCompact(data!))
+        }
+    }
+}
@@ -0,0 +1,158 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+@testable import SignalServiceKit
+
+class SDSKeyValueStoreCacheTest: SSKBaseTestSwift {
+
+    private let store = SDSKeyValueStore(collection: SDSKeyValueCollectionCache.testCollection)
+
+    override func setUp() {
+        super.setUp()
+
+        SDSKeyValueStoreStatistics.isEnabled = true
+        SDSKeyValueStoreStatistics.shared.reset()
+    }
+
+    override func tearDown() {
+        SDSKeyValueStoreStatistics.isEnabled = DebugFlags.logSQLStatistics
+
+        super.tearDown()
+    }
+
+    private var statistics: SDSKeyValueStoreStatistics.Entry {
+        SDSKeyValueStoreStatistics.shared.entry(forCollection: store.collection) ?? SDSKeyValueStoreStatistics.Entry()
+    }
+
+    func testWriteThrough() {
+        write { transaction in
+            self.store.setString("value", key: "key", transaction: transaction)
+            // Reads in the write transaction don't use the cache.
+            XCTAssertEqual(self.store.getString("key", transaction: transaction), "value")
+        }
+        XCTAssertEqual(statistics.readCount, 1)
+        XCTAssertEqual(statistics.cacheHitCount, 0)
+
+        read { transaction in
+            XCTAssertEqual(self.store.getString("key", transaction: transaction), "value")
+            XCTAssertTrue(self.store.hasValue(forKey: "key", transaction: transaction))
+            XCTAssertNil(self.store.getString("missingKey", transaction: transaction))
+        }
+        read { transaction in
+            XCTAssertNil(self.store.getString("missingKey", transaction: transaction))
+        }
+        XCTAssertEqual(statistics.readCount, 5)
+        // The missing key is only cached once it has been read.
+        XCTAssertEqual(statistics.cacheHitCount, 3)
+
+        write { transaction in
+            self.store.removeValue(forKey: "key", transaction: transaction)
+        }
+        read { transaction in
+            XCTAssertNil(self.store.getString("key", transaction: transaction))
+            XCTAssertFalse(self.store.hasValue(forKey: "key", transaction: transaction))
+        }
+        XCTAssertEqual(statistics.cacheHitCount, 5)
+    }
+
+    func testUncachedCollection() {
+        let uncachedStore = SDSKeyValueStore(collection: "test")
+        write { transaction in
+            uncachedStore.setBool(true, key: "key", transaction: transaction)
+        }
+        read { transaction in
+            XCTAssertTrue(uncachedStore.getBool("key", defaultValue: false, transaction: transaction))
+            XCTAssertTrue(uncachedStore.getBool("key", defaultValue: false, transaction: transaction))
+        }
+        let entry = SDSKeyValueStoreStatistics.shared.entry(forCollection: uncachedStore.collection)
+        XCTAssertEqual(entry?.readCount, 2)
+        XCTAssertEqual(entry?.cacheHitCount, 0)
+    }
+
+    func testRemoveAll() {
+        write { transaction in
+            self.store.setInt(1, key: "a", transaction: transaction)
+            self.store.setInt(2, key: "b", transaction: transaction)
+        }
+        read { transaction in
+            XCTAssertEqual(self.store.getInt("a", transaction: transaction), 1)
+        }
+
+        write { transaction in
+            self.store.removeAll(transaction: transaction)
+            self.store.setInt(3, key: "b", transaction: transaction)
+            XCTAssertNil(self.store.getInt("a", transaction: transaction))
+            XCTAssertEqual(self.store.getInt("b", transaction: transaction), 3)
+        }
+        read { transaction in
+            XCTAssertNil(self.store.getInt("a", transaction: transaction))
+            XCTAssertEqual(self.store.getInt("b", transaction: transaction), 3)
+        }
+    }
+
+    // A read transaction which is open while another transaction
+    // writes shouldn't see the write, from the cache or otherwise.
+    func testConcurrentRead() {
+        write { transaction in
+            self.store.setString("old", key: "key", transaction: transaction)
+        }
+
+        let didReadExpectation = expectation(description: "didRead")
+        let didWriteSemaphore = DispatchSemaphore(value: 0)
+        DispatchQueue.global().async {
+            self.databaseStorage.read { transaction in
+                XCTAssertEqual(self.store.getString("key", transaction: transaction), "old")
+                didWriteSemaphore.wait()
+                XCTAssertEqual(self.store.getString("key", transaction: transaction), "old")
+            }
+            didReadExpectation.fulfill()
+        }
+
+        // Wait for the read transaction to begin.
+        while statistics.readCount < 1 {
+            usleep(1000)
+        }
+        write { transaction in
+            self.store.setString("new", key: "key", transaction: transaction)
+        }
+        didWriteSemaphore.signal()
+        waitForExpectations(timeout: 1.0)
+
+        read { transaction in
+            XCTAssertEqual(self.store.getString("key", transaction: transaction), "new")
+        }
+    }
+
+    func testEvacuateAll() {
+        write { transaction in
+            self.store.setBool(true, key: "key", transaction: transaction)
+        }
+
+        // Simulate a write by another process, which
+        // this process' cache doesn't know about.
+        write { transaction in
+            transaction.unwrapGrdbWrite.executeUpdate(sql: "DELETE FROM \(SDSKeyValueStore.tableName)")
+        }
+        read { transaction in
+            XCTAssertTrue(self.store.getBool("key", defaultValue: false, transaction: transaction))
+        }
+
+        SDSKeyValueCollectionCache.evacuateAll()
+        read { transaction in
+            XCTAssertFalse(self.store.getBool("key", defaultValue: false, transaction: transaction))
+        }
+    }
+
+    func testReport() {
+        read { transaction in
+            _ = self.store.getString("key", transaction: transaction)
+        }
+        XCTAssertTrue(SDSKeyValueStoreStatistics.shared.report().contains(store.collection))
+
+        SDSKeyValueStoreStatistics.shared.reset()
+        XCTAssertNil(SDSKeyValueStoreStatistics.shared.entry(forCollection: store.collection))
+    }
+}
@@ -0,0 +1,116 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+import GRDB
+
+@testable import SignalServiceKit
+
+class SDSModelBatchInsertTest: SSKBaseTestSwift {
+
+    override func setUp() {
+        super.setUp()
+
+        tsAccountManager.registerForTests(withLocalNumber: "+13235551234", uuid: UUID())
+    }
+
+    private func ftsRowCount(collection: String, transaction: SDSAnyReadTransaction) -> Int {
+        let sql = "SELECT COUNT(*) FROM \(GRDBFullTextSearchFinder.contentTableName) WHERE collection = ?"
+        return try! Int.fetchOne(transaction.unwrapGrdbRead.database, sql: sql, arguments: [collection]) ?? 0
+    }
+
+    func testBatchInsert() {
+        let accounts = (0..<1200).map { index in
+            SignalAccount(address: SignalServiceAddress(phoneNumber: String(format: "+1323555%04d", index)))
+        }
+
+        write { transaction in
+            SignalAccount.anyInsert(batch: accounts, transaction: transaction)
+        }
+
+        // The batch is larger than a single statement can insert.
+        var rowIds = Set<Int64>()
+        for account in accounts {
+            guard let grdbId = account.grdbId?.int64Value else {
+                XCTFail("Missing grdbId.")
+                continue
+            }
+            rowIds.insert(grdbId)
+        }
+        XCTAssertEqual(rowIds.count, accounts.count)
+
+        read { transaction in
+            XCTAssertEqual(SignalAccount.anyCount(transaction: transaction), UInt(accounts.count))
+            for account in [accounts.first!, accounts.last!] {
+                let fetched = SignalAccount.anyFetch(uniqueId: account.uniqueId, transaction: transaction)
+                XCTAssertEqual(fetched?.recipientAddress, account.recipientAddress)
+                XCTAssertEqual(fetched?.grdbId, account.grdbId)
+            }
+            XCTAssertEqual(self.ftsRowCount(collection: SignalAccount.collection(), transaction: transaction),
+                           accounts.count)
+        }
+    }
+
+    func testBatchInsertOfExistingModels() {
+        let existingAccount = SignalAccount(address: SignalServiceAddress(phoneNumber: "+13235550001"))
+        write { transaction in
+            existingAccount.anyInsert(transaction: transaction)
+        }
+
+        let newAccount = SignalAccount(address: SignalServiceAddress(phoneNumber: "+13235550002"))
+        write { transaction in
+            // Existing and duplicate models fall back to a per-model save.
+            SignalAccount.anyInsert(batch: [existingAccount, newAccount, newAccount], transaction: transaction)
+        }
+
+        read { transaction in
+            XCTAssertEqual(SignalAccount.anyCount(transaction: transaction), 2)
+            XCTAssertNotNil(SignalAccount.anyFetch(uniqueId: newAccount.uniqueId, transaction: transaction))
+            XCTAssertEqual(self.ftsRowCount(collection: SignalAccount.collection(), transaction: transaction), 2)
+        }
+    }
+
+    func testBatchInsertUpdatesReadCache() {
+        let address = SignalServiceAddress(phoneNumber: "+13235550003")
+        let account = SignalAccount(address: address)
+
+        write { transaction in
+            SignalAccount.anyInsert(batch: [account], transaction: transaction)
+        }
+
+        read { transaction in
+            let cachedAccount = self.modelReadCaches.signalAccountReadCache.getSignalAccount(address: address,
+                                                                                             transaction: transaction)
+            XCTAssertEqual(cachedAccount?.uniqueId, account.uniqueId)
+        }
+    }
+
+    func testInsertRegisteredRecipientsSkipsKnownAddresses() {
+        let existingAddress = SignalServiceAddress(uuid: UUID(), phoneNumber: "+13235550004")
+        write { transaction in
+            SignalRecipient.mark(asRegisteredAndGet: existingAddress, trustLevel: .high, transaction: transaction)
+        }
+
+        let newAddress = SignalServiceAddress(uuid: UUID(), phoneNumber: "+13235550005")
+        let otherNewAddress = SignalServiceAddress(phoneNumber: "+13235550006")
+        write { transaction in
+            SignalRecipient.insertRegisteredRecipients(forNewAddresses: [existingAddress,
+                                                                         newAddress,
+                                                                         newAddress,
+                                                                         otherNewAddress],
+                                                       transaction: transaction)
+        }
+
+        read { transaction in
+            let finder = AnySignalRecipientFinder()
+            for address in [existingAddress, newAddress, otherNewAddress] {
+                let recipient = finder.signalRecipient(for: address, transaction: transaction)
+                XCTAssertNotNil(recipient)
+                XCTAssertEqual(recipient?.devices.count, 1)
+            }
+            XCTAssertEqual(SignalRecipient.anyCount(transaction: transaction), 3)
+        }
+    }
+}
@@ -0,0 +1,112 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+import GRDB
+
+@testable import SignalServiceKit
+
+class ThreadUnreadCountFinderTest: SSKBaseTestSwift {
+
+    override func setUp() {
+        super.setUp()
+
+        tsAccountManager.registerForTests(withLocalNumber: "+13235551234", uuid: UUID())
+    }
+
+    private func assertCountsMatchScan(file: StaticString = #file, line: UInt = #line) {
+        read { transaction in
+            let grdbTransaction = transaction.unwrapGrdbRead
+            XCTAssertEqual(ThreadUnreadCountFinder.materializedUnreadCounts(transaction: grdbTransaction),
+                           ThreadUnreadCountFinder.scanUnreadCounts(transaction: grdbTransaction),
+                           file: file,
+                           line: line)
+            XCTAssertEqual(ThreadUnreadCountFinder.unreadCountInAllThreads(includeMutedThreads: true,
+                                                                           transaction: grdbTransaction),
+                           ThreadUnreadCountFinder.scanUnreadCountInAllThreads(includeMutedThreads: true,
+                                                                               transaction: grdbTransaction),
+                           file: file,
+                           line: line)
+        }
+    }
+
+    func testCountsTrackWrites() {
+        let thread1 = ContactThreadFactory().create()
+        let thread2 = ContactThreadFactory().create()
+
+        let messageFactory1 = IncomingMessageFactory()
+        messageFactory1.threadCreator = { _ in thread1 }
+        let messageFactory2 = IncomingMessageFactory()
+        messageFactory2.threadCreator = { _ in thread2 }
+
+        var messages1 = [TSIncomingMessage]()
+        write { transaction in
+            messages1 = messageFactory1.create(count: 5, transaction: transaction)
+            _ = messageFactory2.create(count: 3, transaction: transaction)
+            // Outgoing messages don't affect unread counts.
+            _ = OutgoingMessageFactory().create(count: 2, transaction: transaction)
+        }
+
+        read { transaction in
+            XCTAssertEqual(InteractionFinder(threadUniqueId: thread1.uniqueId).unreadCount(transaction: transaction.unwrapGrdbRead), 5)
+            XCTAssertEqual(InteractionFinder(threadUniqueId: thread2.uniqueId).unreadCount(transaction: transaction.unwrapGrdbRead), 3)
+        }
+        assertCountsMatchScan()
+
+        // Mark as read.
+        write { transaction in
+            for message in messages1.prefix(2) {
+                message.markAsRead(atTimestamp: NSDate.ows_millisecondTimeStamp(),
+                                   thread: thread1,
+                                   circumstance: .onLinkedDevice,
+                                   transaction: transaction)
+            }
+        }
+        read { transaction in
+            XCTAssertEqual(InteractionFinder(threadUniqueId: thread1.uniqueId).unreadCount(transaction: transaction.unwrapGrdbRead), 3)
+        }
+        assertCountsMatchScan()
+
+        // Remove unread and read messages.
+        write { transaction in
+            messages1[0].anyRemove(transaction: transaction)
+            messages1[4].anyRemove(transaction: transaction)
+        }
+        read { transaction in
+            XCTAssertEqual(InteractionFinder(threadUniqueId: thread1.uniqueId).unreadCount(transaction: transaction.unwrapGrdbRead), 2)
+        }
+        assertCountsMatchScan()
+
+        // Remove a thread and its messages.
+        write { transaction in
+            thread2.anyRemove(transaction: transaction)
+        }
+        read { transaction in
+            XCTAssertEqual(InteractionFinder(threadUniqueId: thread2.uniqueId).unreadCount(transaction: transaction.unwrapGrdbRead), 0)
+        }
+        assertCountsMatchScan()
+    }
+
+    func testVerifyAndRepair() {
+        let thread = ContactThreadFactory().create()
+        let messageFactory = IncomingMessageFactory()
+        messageFactory.threadCreator = { _ in thread }
+        write { transaction in
+            _ = messageFactory.create(count: 4, transaction: transaction)
+        }
+
+        write { transaction in
+            XCTAssertTrue(ThreadUnreadCountFinder.verifyAndRepairIfNecessary(transaction: transaction))
+
+            transaction.unwrapGrdbWrite.executeUpdate(sql: "UPDATE \(ThreadUnreadCountFinder.tableName) SET unreadCount = 7")
+            XCTAssertFalse(ThreadUnreadCountFinder.verifyAndRepairIfNecessary(transaction: transaction))
+            XCTAssertTrue(ThreadUnreadCountFinder.verifyAndRepairIfNecessary(transaction: transaction))
+        }
+
+        read { transaction in
+            XCTAssertEqual(InteractionFinder(threadUniqueId: thread.uniqueId).unreadCount(transaction: transaction.unwrapGrdbRead), 4)
+        }
+    }
+}
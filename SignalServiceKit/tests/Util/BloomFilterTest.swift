@@ -0,0 +1,46 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+
+@testable import SignalServiceKit
+
+class BloomFilterTest: SSKBaseTestSwift {
+
+    func testContainsInsertedElements() {
+        let elements = (0..<10 * 1000).map { "element-\($0)" }
+        let filter = BloomFilter(expectedCount: elements.count)
+        filter.insertAll(elements)
+
+        XCTAssertEqual(filter.count, elements.count)
+        for element in elements {
+            XCTAssertTrue(filter.contains(element))
+        }
+    }
+
+    func testFalsePositiveRate() {
+        let expectedCount = 10 * 1000
+        let falsePositiveRate = 0.01
+        let filter = BloomFilter(expectedCount: expectedCount, falsePositiveRate: falsePositiveRate)
+        for index in 0..<expectedCount {
+            filter.insert("element-\(index)")
+        }
+
+        let sampleCount = 10 * 1000
+        var falsePositiveCount = 0
+        for index in 0..<sampleCount where filter.contains("other-\(index)") {
+            falsePositiveCount += 1
+        }
+        // Allow for some variance.
+        XCTAssertLessThan(Double(falsePositiveCount) / Double(sampleCount), 2 * falsePositiveRate)
+    }
+
+    func testIsCompact() {
+        let expectedCount = 200 * 1000
+        let filter = BloomFilter(expectedCount: expectedCount)
+        // ~1.8 bytes per element at a 0.1% false positive rate.
+        XCTAssertLessThan(filter.byteCount, 2 * expectedCount)
+    }
+}
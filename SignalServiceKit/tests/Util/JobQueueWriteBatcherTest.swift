@@ -0,0 +1,47 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import XCTest
+@testable import SignalServiceKit
+
+class JobQueueWriteBatcherTest: SSKBaseTestSwift {
+
+    private let keyValueStore = SDSKeyValueStore(collection: "JobQueueWriteBatcherTest")
+
+    func testWriteIsCommittedBeforeReturning() {
+        let batcher = JobQueueWriteBatcher()
+
+        batcher.write { transaction in
+            self.keyValueStore.setInt(1, key: "key", transaction: transaction)
+        }
+
+        read { transaction in
+            XCTAssertEqual(1, self.keyValueStore.getInt("key", transaction: transaction))
+        }
+        XCTAssertEqual(1, batcher.writeCount.get())
+        XCTAssertEqual(1, batcher.transactionCount.get())
+    }
+
+    func testConcurrentWrites() {
+        let batcher = JobQueueWriteBatcher(maxBatchSize: 8)
+        let writerCount = 100
+
+        DispatchQueue.concurrentPerform(iterations: writerCount) { index in
+            batcher.write { transaction in
+                self.keyValueStore.setInt(index, key: "\(index)", transaction: transaction)
+            }
+            // Each writer's value is visible once its write returns.
+            self.read { transaction in
+                XCTAssertEqual(index, self.keyValueStore.getInt("\(index)", transaction: transaction))
+            }
+        }
+
+        XCTAssertEqual(writerCount, batcher.writeCount.get())
+        XCTAssertLessThanOrEqual(batcher.transactionCount.get(), writerCount)
+        XCTAssertGreaterThanOrEqual(batcher.transactionCount.get(), writerCount / 8)
+        read { transaction in
+            XCTAssertEqual(UInt(writerCount), self.keyValueStore.numberOfKeys(transaction: transaction))
+        }
+    }
+}
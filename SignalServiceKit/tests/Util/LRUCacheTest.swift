@@ -0,0 +1,148 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+
+@testable import SignalServiceKit
+
+class LRUCacheTest: SSKBaseTestSwift {
+
+    func testEvictsLeastRecentlyUsed() {
+        let cache = LRUCache<Int, String>(maxSize: 3)
+        cache.set(key: 1, value: "1")
+        cache.set(key: 2, value: "2")
+        cache.set(key: 3, value: "3")
+
+        // Touch 1 so that 2 becomes the least recently used entry.
+        XCTAssertEqual(cache.get(key: 1), "1")
+
+        cache.set(key: 4, value: "4")
+
+        XCTAssertEqual(cache.count, 3)
+        XCTAssertNil(cache.get(key: 2))
+        XCTAssertEqual(cache.get(key: 1), "1")
+        XCTAssertEqual(cache.get(key: 3), "3")
+        XCTAssertEqual(cache.get(key: 4), "4")
+    }
+
+    func testOverwriteRefreshesRecency() {
+        let cache = LRUCache<Int, String>(maxSize: 2)
+        cache.set(key: 1, value: "a")
+        cache.set(key: 2, value: "b")
+        cache.set(key: 1, value: "c")
+        cache.set(key: 3, value: "d")
+
+        XCTAssertEqual(cache.count, 2)
+        XCTAssertEqual(cache.get(key: 1), "c")
+        XCTAssertNil(cache.get(key: 2))
+        XCTAssertEqual(cache.get(key: 3), "d")
+    }
+
+    func testCostBound() {
+        let cache = LRUCache<Int, String>(maxSize: 100, maxCost: 10)
+        cache.set(key: 1, value: "1", cost: 4)
+        cache.set(key: 2, value: "2", cost: 4)
+        XCTAssertEqual(cache.totalCost, 8)
+
+        cache.set(key: 3, value: "3", cost: 4)
+        XCTAssertEqual(cache.count, 2)
+        XCTAssertEqual(cache.totalCost, 8)
+        XCTAssertNil(cache.get(key: 1))
+
+        // Re-setting an entry replaces its cost.
+        cache.set(key: 2, value: "2", cost: 1)
+        XCTAssertEqual(cache.totalCost, 5)
+
+        // A single entry that exceeds the cost limit is not retained.
+        cache.set(key: 4, value: "4", cost: 11)
+        XCTAssertEqual(cache.count, 0)
+        XCTAssertEqual(cache.totalCost, 0)
+    }
+
+    func testRemove() {
+        let cache = LRUCache<Int, String>(maxSize: 3, maxCost: 100)
+        cache.set(key: 1, value: "1", cost: 5)
+        cache.set(key: 2, value: "2", cost: 5)
+        cache.remove(key: 1)
+        cache.remove(key: 42)
+
+        XCTAssertEqual(cache.count, 1)
+        XCTAssertEqual(cache.totalCost, 5)
+        XCTAssertNil(cache.get(key: 1))
+        XCTAssertEqual(cache.get(key: 2), "2")
+    }
+
+    func testTrim() {
+        let cache = LRUCache<Int, Int>(maxSize: 10)
+        for i in 0..<10 {
+            cache.set(key: i, value: i)
+        }
+        _ = cache.get(key: 0)
+
+        cache.trim(toCount: 3)
+
+        XCTAssertEqual(cache.count, 3)
+        XCTAssertEqual(cache.get(key: 0), 0)
+        XCTAssertEqual(cache.get(key: 9), 9)
+        XCTAssertEqual(cache.get(key: 8), 8)
+        XCTAssertNil(cache.get(key: 7))
+    }
+
+    func testTrimRetainsCostUnderLimit() {
+        let cache = LRUCache<Int, Int>(maxSize: 10, maxCost: 100)
+        for i in 0..<10 {
+            cache.set(key: i, value: i, cost: 5)
+        }
+
+        // Only the count is trimmed; the cost is already under the limit.
+        cache.trim(toCount: 4)
+
+        XCTAssertEqual(cache.count, 4)
+        XCTAssertEqual(cache.totalCost, 20)
+
+        cache.trim(toCount: 4, cost: 10)
+
+        XCTAssertEqual(cache.count, 2)
+        XCTAssertEqual(cache.get(key: 9), 9)
+    }
+
+    func testTrimOnBackground() {
+        let cache = LRUCache<Int, Int>(maxSize: 10, trimFactorOnBackground: 0.5)
+        for i in 0..<10 {
+            cache.set(key: i, value: i)
+        }
+
+        NotificationCenter.default.post(name: .OWSApplicationDidEnterBackground, object: nil)
+
+        XCTAssertEqual(cache.count, 5)
+        XCTAssertNil(cache.get(key: 4))
+        XCTAssertEqual(cache.get(key: 5), 5)
+    }
+
+    func testClear() {
+        let cache = LRUCache<Int, Int>(maxSize: 100_000)
+        for i in 0..<100_000 {
+            cache.set(key: i, value: i)
+        }
+        cache.clear()
+
+        XCTAssertEqual(cache.count, 0)
+        XCTAssertNil(cache.get(key: 0))
+
+        cache.set(key: 1, value: 1)
+        XCTAssertEqual(cache.get(key: 1), 1)
+    }
+
+    func testDeallocateLargeCache() {
+        var cache: LRUCache<Int, Int>? = LRUCache<Int, Int>(maxSize: 100_000)
+        for i in 0..<100_000 {
+            cache?.set(key: i, value: i)
+        }
+
+        // Should not overflow the stack.
+        cache = nil
+        XCTAssertNil(cache)
+    }
+}
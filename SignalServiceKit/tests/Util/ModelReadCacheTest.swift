@@ -0,0 +1,63 @@
+//
+//  Copyright (c) 2021 Open Whisper Systems. All rights reserved.
+//
+
+import Foundation
+import XCTest
+
+@testable import SignalServiceKit
+
+class ModelReadCacheTest: SSKBaseTestSwift {
+
+    func testReadOnlyAccessSharesCachedProfile() {
+        let address = CommonGenerator.address()
+        write { transaction in
+            OWSUserProfile.getOrBuild(for: address, transaction: transaction).anyInsert(transaction: transaction)
+        }
+
+        let cache = modelReadCaches.userProfileReadCache
+        read { transaction in
+            // Warm the cache.
+            XCTAssertNotNil(cache.getUserProfile(address: address, transaction: transaction))
+
+            // Read-only access returns the cached instance itself.
+            let statsBeforeShared = cache.readCacheStats
+            let sharedProfile = cache.getUserProfileForReadOnlyAccess(address: address, transaction: transaction)
+            let sharedProfileAgain = cache.getUserProfileForReadOnlyAccess(address: address, transaction: transaction)
+            XCTAssertNotNil(sharedProfile)
+            XCTAssertTrue(sharedProfile === sharedProfileAgain)
+
+            let statsAfterShared = cache.readCacheStats
+            XCTAssertEqual(statsAfterShared.hitCount - statsBeforeShared.hitCount, 2)
+            XCTAssertEqual(statsAfterShared.readCount - statsBeforeShared.readCount, 2)
+            XCTAssertEqual(statsAfterShared.sharedHitCount - statsBeforeShared.sharedHitCount, 2)
+            XCTAssertEqual(statsAfterShared.copyCount, statsBeforeShared.copyCount)
+
+            // Normal access still returns a copy.
+            let copiedProfile = cache.getUserProfile(address: address, transaction: transaction)
+            XCTAssertNotNil(copiedProfile)
+            XCTAssertFalse(copiedProfile === sharedProfile)
+            XCTAssertEqual(copiedProfile?.address, address)
+
+            let statsAfterCopy = cache.readCacheStats
+            XCTAssertEqual(statsAfterCopy.hitCount - statsAfterShared.hitCount, 1)
+            XCTAssertEqual(statsAfterCopy.sharedHitCount, statsAfterShared.sharedHitCount)
+            XCTAssertEqual(statsAfterCopy.copyCount - statsAfterShared.copyCount, 1)
+        }
+    }
+
+    func testReadOnlyAccessMissReadsDatabase() {
+        let address = CommonGenerator.address()
+
+        let cache = modelReadCaches.userProfileReadCache
+        read { transaction in
+            let statsBefore = cache.readCacheStats
+            XCTAssertNil(cache.getUserProfileForReadOnlyAccess(address: address, transaction: transaction))
+
+            let statsAfter = cache.readCacheStats
+            XCTAssertEqual(statsAfter.readCount - statsBefore.readCount, 1)
+            XCTAssertEqual(statsAfter.hitCount, statsBefore.hitCount)
+            XCTAssertEqual(statsAfter.sharedHitCount, statsBefore.sharedHitCount)
+        }
+    }
+}